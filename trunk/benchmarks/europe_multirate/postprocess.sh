@@ -0,0 +1,8 @@
+#!/bin/bash
+describe_benchmark "LPJ-GUESS - European Benchmarks, 10 day decomposition steps"
+
+# The europe benchmark is the daily reference. If it wasn't finished when this
+# ran, rerun with: benchmarks -p -i europe_multirate <workdir>
+compare_annual_output.sh ../europe comparison_europe.txt cpool.out cflux.out npool.out nflux.out
+describe_textfile comparison_europe.txt "Annual pools and fluxes compared with the europe benchmark (daily decomposition). /
+Means over all grid cells and years, largest difference for a grid cell and year, and RMS difference relative to the mean."
@@ -0,0 +1,26 @@
+#!/bin/bash
+describe_benchmark "LPJ-GUESS - Global Benchmarks, analog spinup"
+
+# The global benchmark is the reference with a full spinup. If it wasn't
+# finished when this ran, rerun with: benchmarks -p -i global_analogspinup <workdir>
+compare_annual_output.sh ../global comparison_global.txt cpool.out cflux.out npool.out nflux.out anpp.out lai.out
+describe_textfile comparison_global.txt "Annual pools and fluxes compared with the global benchmark (full spinup). /
+Means over all grid cells and years, largest difference for a grid cell and year, and RMS difference relative to the mean."
+
+# Savings summed over the processes
+grep -h "^Analog spinup: .* grid cells seeded" guess.log | awk '
+{
+    nseeded += $3
+    ncells += $5
+    simulated += $9
+    total += $11
+}
+END {
+    printf "Grid cells seeded from analogs: %d of %d\n", nseeded, ncells
+    if (total > 0) {
+        printf "Spinup years simulated: %d of %d (%.1f%% saved)\n", simulated, total, 100 * (total - simulated) / total
+    }
+}' > analog_spinup.txt
+grep -h "^WARNING ! Analog spinup: C stocks" guess.log | wc -l | \
+    awk '{ printf "Seeded grid cells not converged at the end of the spinup: %d\n", $1 }' >> analog_spinup.txt
+describe_textfile analog_spinup.txt "Grid cells seeded from climate analogs and spinup years saved."
@@ -0,0 +1,8 @@
+#!/bin/bash
+describe_benchmark "LPJ-GUESS - Global Benchmarks, 10 day decomposition steps"
+
+# The global benchmark is the daily reference. If it wasn't finished when this
+# ran, rerun with: benchmarks -p -i global_multirate <workdir>
+compare_annual_output.sh ../global comparison_global.txt cpool.out cflux.out npool.out nflux.out soil_nflux.out
+describe_textfile comparison_global.txt "Annual pools and fluxes compared with the global benchmark (daily decomposition). /
+Means over all grid cells and years, largest difference for a grid cell and year, and RMS difference relative to the mean."
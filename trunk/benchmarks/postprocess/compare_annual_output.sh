@@ -0,0 +1,98 @@
+#!/bin/bash
+
+# This script compares annual output files with the same output from a
+# reference run, for instance a benchmark run with a model option against
+# the same benchmark with default settings.
+#
+# Rows are matched by Lon, Lat and Year, and columns by name. For each
+# column the table lists the mean over all matched rows in both runs, the
+# relative difference of the means, the largest absolute difference in a
+# row, and the relative RMS difference (RMS difference divided by the mean
+# absolute reference value).
+
+if [ $# -lt 3 ]; then
+    echo "Usage: $0 <reference directory> <table> <output file>..."
+    echo
+    echo "For instance:"
+    echo "$0 ../europe comparison.txt cpool.out cflux.out npool.out nflux.out"
+    exit 1
+fi
+
+REFERENCE_DIR=$1
+TABLE=$2
+shift 2
+
+printf "%-16s %-12s %14s %14s %10s %14s %10s\n" \
+    File Column Reference Run "Diff(%)" MaxAbsDiff "RelRMS(%)" > $TABLE
+
+for FILE in "$@"; do
+    if [ ! -f $FILE ]; then
+	echo "$FILE is missing" >&2
+	continue
+    fi
+    if [ ! -f $REFERENCE_DIR/$FILE ]; then
+	echo "$REFERENCE_DIR/$FILE is missing" >&2
+	continue
+    fi
+
+    awk -v file=$FILE '
+FNR == 1 {
+    for (i = 4; i <= NF; i++) {
+        if (FILENAME == ARGV[1]) {
+            refcol[$i] = i
+        }
+        else {
+            name[i] = $i
+        }
+    }
+    ncol = NF
+    next
+}
+FILENAME == ARGV[1] {
+    key = $1 " " $2 " " $3
+    for (i = 4; i <= NF; i++) {
+        ref[key, i] = $i
+    }
+    seen[key] = 1
+    next
+}
+{
+    key = $1 " " $2 " " $3
+    if (!(key in seen)) {
+        next
+    }
+    n++
+    for (i = 4; i <= ncol; i++) {
+        if (!(name[i] in refcol)) {
+            continue
+        }
+        r = ref[key, refcol[name[i]]]
+        d = $i - r
+        sumref[i] += r
+        sumabsref[i] += (r < 0 ? -r : r)
+        sumrun[i] += $i
+        sumsq[i] += d * d
+        if ((d < 0 ? -d : d) > maxdiff[i]) {
+            maxdiff[i] = (d < 0 ? -d : d)
+        }
+    }
+}
+END {
+    if (n == 0) {
+        print file ": no rows in common with the reference" > "/dev/stderr"
+        exit
+    }
+    for (i = 4; i <= ncol; i++) {
+        if (!(name[i] in refcol)) {
+            continue
+        }
+        meanref = sumref[i] / n
+        meanrun = sumrun[i] / n
+        meanabsref = sumabsref[i] / n
+        reldiff = meanref != 0 ? 100 * (meanrun - meanref) / meanref : 0
+        relrms = meanabsref != 0 ? 100 * sqrt(sumsq[i] / n) / meanabsref : 0
+        printf "%-16s %-12s %14.6g %14.6g %10.4f %14.6g %10.4f\n",
+            file, name[i], meanref, meanrun, reldiff, maxdiff[i], relrms
+    }
+}' $REFERENCE_DIR/$FILE $FILE >> $TABLE
+done
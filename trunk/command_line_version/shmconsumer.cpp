@@ -0,0 +1,138 @@
+///////////////////////////////////////////////////////////////////////////////////////
+/// \file shmconsumer.cpp
+/// \brief Reference consumer for output published in shared memory
+///
+/// Reads the output of a model run with the shm_output parameter set while
+/// the model runs, and writes it to text files identical to those the
+/// model writes itself. Meant as a starting point for consumers doing
+/// something more useful with the rows, see shmring.h.
+///
+/// Usage: guess_shmconsumer [-timeout <seconds>] <shm name> <output directory>
+///
+/// The consumer can be started before the model, it waits for the shared
+/// memory object to appear.
+///
+/// $Date$
+///
+///////////////////////////////////////////////////////////////////////////////////////
+
+#include "shmring.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+
+using namespace GuessOutput;
+
+namespace {
+
+void usage() {
+	fprintf(stderr, "Usage: guess_shmconsumer [-timeout <seconds>] <shm name> <output directory>\n");
+	exit(1);
+}
+
+}
+
+int main(int argc, char* argv[]) {
+
+	int timeout = 60;
+	int arg = 1;
+
+	if (arg < argc && strcmp(argv[arg], "-timeout") == 0) {
+		if (arg + 1 >= argc) {
+			usage();
+		}
+		timeout = atoi(argv[arg + 1]);
+		arg += 2;
+	}
+
+	if (argc - arg != 2) {
+		usage();
+	}
+
+	const char* name = argv[arg];
+	std::string outdir = argv[arg + 1];
+	if (!outdir.empty() && outdir[outdir.size() - 1] != '/') {
+		outdir += '/';
+	}
+
+	// Wait for the model to create the buffer
+	ShmRingBuffer ring;
+	int waited = 0;
+	while (!ring.attach(name)) {
+		if (waited >= timeout * 10) {
+			fprintf(stderr, "Could not attach to %s: %s\n", name, ring.error().c_str());
+			return 1;
+		}
+		usleep(100000);
+		waited++;
+	}
+
+	ShmOutputReader reader(ring);
+
+	std::vector<FILE*> files;
+	std::vector<bool> printed_header;
+	unsigned long nrows = 0;
+
+	for (;;) {
+		int type = reader.next();
+
+		if (type == -1) {
+			usleep(1000);
+			continue;
+		}
+
+		if (type == SHM_END) {
+			break;
+		}
+
+		const int table = reader.table();
+
+		switch (type) {
+		case SHM_SCHEMA: {
+			std::string path = outdir + reader.schema(table).name;
+			FILE* file = fopen(path.c_str(), "w");
+			if (!file) {
+				fprintf(stderr, "Could not open %s for output\n", path.c_str());
+				return 1;
+			}
+			if (table >= (int)files.size()) {
+				files.resize(table + 1, (FILE*)NULL);
+				printed_header.resize(table + 1, false);
+			}
+			files[table] = file;
+			printed_header[table] = false;
+			break;
+		}
+		case SHM_ROW:
+			if (!printed_header[table]) {
+				fputs(reader.format_header(table, reader.row().day >= 0).c_str(), files[table]);
+				printed_header[table] = true;
+			}
+			fputs(reader.format_row().c_str(), files[table]);
+			nrows++;
+			break;
+		case SHM_CLOSE_TABLE:
+			fclose(files[table]);
+			files[table] = NULL;
+			break;
+		}
+	}
+
+	for (size_t i = 0; i < files.size(); i++) {
+		if (files[i]) {
+			fclose(files[i]);
+		}
+	}
+
+	printf("%lu rows in %d tables read from %s", nrows, (int)files.size(), name);
+	if (ring.dropped() > 0) {
+		printf(", %llu records dropped by the model", (unsigned long long)ring.dropped());
+	}
+	printf("\n");
+
+	return 0;
+}
@@ -16,7 +16,10 @@
 #include "weathergen.h"
 #include "driver.h"
 #include "parameters.h"
+#include "ioforwarding.h"
+#include "archive.h"
 #include <stdio.h>
+#include <sstream>
 #include <utility>
 #include <vector>
 #include <algorithm>
@@ -198,13 +201,20 @@ bool CRUInput::getgridcell(Gridcell& gridcell) {
 
 				lon = gridlist.getobj().lon;
 				lat = gridlist.getobj().lat;
-				gridfound = CRU_FastArchive::findnearestCRUdata(searchradius, file_cru, lon, lat, soilcode,
-				                                         hist_mtemp, hist_mprec, hist_msun);
 
-				if (gridfound) // Get more historical CRU data for this grid cell
-					gridfound = CRU_FastArchive::searchcru_misc(file_cru_misc, lon, lat, elevation,
-									     hist_mfrs, hist_mwet, hist_mdtr, 
-									     hist_mwind, hist_mrhum);
+				if (IOForwarding::active()) {
+					// The archives have been read by the I/O process, see read_forcing
+					std::string buffer;
+					gridfound = IOForwarding::fetch(lon, lat, buffer);
+					if (gridfound) {
+						std::istringstream is(buffer);
+						ArchiveInStream arch(is);
+						transfer_forcing(arch, lon, lat, soilcode, elevation);
+					}
+				}
+				else {
+					gridfound = read_cru(lon, lat, soilcode, elevation);
+				}
 
 				if (run_landcover && gridfound) {
 					LUerror = landcover_input.loadlandcover(gridlist.getobj().lon, gridlist.getobj().lat);
@@ -263,7 +273,10 @@ bool CRUInput::getgridcell(Gridcell& gridcell) {
 		// Get nitrogen deposition data.
 		/* Since the historic data set does not reach decade 2010-2019,
 		 * we need to use the RCP data for the last decade. */
-		ndep.getndep(param["file_ndep"].str, lon, lat, Lamarque::RCP60);
+		// (forwarded together with the climate under I/O forwarding)
+		if (!IOForwarding::active()) {
+			ndep.getndep(param["file_ndep"].str, lon, lat, Lamarque::RCP60);
+		}
 
 		// The insolation data will be sent (in function getclimate, below)
 		// as incoming shortwave radiation, averages are over 24 hours
@@ -283,6 +296,49 @@ bool CRUInput::getgridcell(Gridcell& gridcell) {
 }
 
 
+bool CRUInput::read_cru(double& lon, double& lat, int& soilcode, int& elevation) {
+
+	bool gridfound = CRU_FastArchive::findnearestCRUdata(searchradius, file_cru, lon, lat, soilcode,
+	                                                     hist_mtemp, hist_mprec, hist_msun);
+
+	if (gridfound) // Get more historical CRU data for this grid cell
+		gridfound = CRU_FastArchive::searchcru_misc(file_cru_misc, lon, lat, elevation,
+		                                            hist_mfrs, hist_mwet, hist_mdtr,
+		                                            hist_mwind, hist_mrhum);
+
+	return gridfound;
+}
+
+void CRUInput::transfer_forcing(ArchiveStream& arch, double& lon, double& lat,
+                                int& soilcode, int& elevation) {
+	arch & lon & lat & soilcode & elevation
+		& hist_mtemp & hist_mprec & hist_msun
+		& hist_mfrs & hist_mwet & hist_mdtr & hist_mwind & hist_mrhum
+		& ndep;
+}
+
+bool CRUInput::read_forcing(double lon, double lat, std::string& buffer) {
+
+	// See base class for documentation about this function's responsibilities
+
+	int soilcode;
+	int elevation;
+
+	if (!read_cru(lon, lat, soilcode, elevation)) {
+		return false;
+	}
+
+	// For the coordinates of the CRU data found, as in getgridcell
+	ndep.getndep(param["file_ndep"].str, lon, lat, Lamarque::RCP60);
+
+	std::ostringstream os;
+	ArchiveOutStream arch(os);
+	transfer_forcing(arch, lon, lat, soilcode, elevation);
+	buffer = os.str();
+
+	return true;
+}
+
 void CRUInput::getlandcover(Gridcell& gridcell) {
 
 	landcover_input.getlandcover(gridcell);
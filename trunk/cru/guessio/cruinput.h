@@ -52,6 +52,14 @@ public:
 	/// Obtains land management data for one day
 	void getmanagement(Gridcell& gridcell) {management_input.getmanagement(gridcell);}
 
+	/// The CRU archives and nitrogen deposition are forwarded, soil and landcover are read locally
+	bool allows_forwarding() const { return true; }
+
+	/// See base class for documentation about this function's responsibilities
+	bool read_forcing(double lon, double lat, std::string& buffer);
+
+	int get_gridlist_size() const { return (int)gridlist.nobj; }
+
 	// Constants associated with historical climate data set
 
 	/// number of years of historical climate
@@ -105,6 +113,14 @@ protected:
 private:
 	std::vector<std::pair<double, double> > translate_gridlist_to_coord(ListArray_id<Coord>& gridlist);
 
+	/// Reads the historical climate from the CRU archives into the hist_ arrays
+	/** lon and lat are moved to the nearest grid cell with data */
+	bool read_cru(double& lon, double& lat, int& soilcode, int& elevation);
+
+	/// (De)serializes what read_forcing forwards to compute processes
+	void transfer_forcing(ArchiveStream& arch, double& lon, double& lat,
+	                      int& soilcode, int& elevation);
+
 	SoilInput soilinput;
 
 	/// Land cover input module
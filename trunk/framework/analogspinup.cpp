@@ -0,0 +1,303 @@
+///////////////////////////////////////////////////////////////////////////////////////
+/// \file analogspinup.cpp
+/// \brief Shortened spinup of grid cells seeded from climate analogs
+///
+/// $Date$
+///
+///////////////////////////////////////////////////////////////////////////////////////
+
+#include "config.h"
+#include "analogspinup.h"
+#include "guess.h"
+#include "archive.h"
+#include "soil.h"
+
+#include <sstream>
+
+namespace {
+
+/// Length of the periods whose mean C stocks are compared (years)
+const int CONVERGENCE_PERIOD = 10;
+
+/// Mean of values [first, first + n)
+double mean(const std::vector<double>& values, size_t first, size_t n) {
+	double sum = 0.0;
+	for (size_t i = first; i < first + n; i++) {
+		sum += values[i];
+	}
+	return sum / (double)n;
+}
+
+}
+
+AnalogSpinup::AnalogSpinup(bool enabled)
+	: enabled(enabled),
+	  seedable(false),
+	  analog(-1),
+	  library_entry(-1),
+	  warned_years(false),
+	  sum_temp(0.0),
+	  sum_prec(0.0),
+	  sum_rad(0.0),
+	  ndays(0),
+	  years_simulated(0),
+	  ncells(0),
+	  nseeded(0),
+	  nunconverged(0),
+	  spinup_years(0),
+	  spinup_years_simulated(0) {
+
+	for (int i = 0; i < NFEATURE; i++) {
+		features[i] = 0.0;
+	}
+}
+
+AnalogSpinup::~AnalogSpinup() {
+	if (enabled && spinup_years > 0) {
+		dprintf("Analog spinup: %d of %d grid cells seeded, %ld of %ld spinup years simulated (%.1f%% saved)\n",
+		        nseeded, ncells, spinup_years_simulated, spinup_years,
+		        100.0 * (spinup_years - spinup_years_simulated) / (double)spinup_years);
+		if (nunconverged) {
+			dprintf("Analog spinup: %d seeded grid cell(s) not converged at the end of the spinup\n",
+			        nunconverged);
+		}
+	}
+}
+
+void AnalogSpinup::begin_gridcell(bool seedable) {
+
+	this->seedable = enabled && seedable;
+	analog = -1;
+	library_entry = -1;
+
+	sum_temp = sum_prec = sum_rad = 0.0;
+	ndays = 0;
+	years_simulated = 0;
+	ccont.clear();
+}
+
+void AnalogSpinup::day(const Gridcell& gridcell) {
+
+	if (!seedable || date.year != 0) {
+		return;
+	}
+
+	sum_temp += gridcell.climate.temp;
+	sum_prec += gridcell.climate.prec;
+	sum_rad  += gridcell.climate.rad;
+	ndays++;
+}
+
+void AnalogSpinup::end_of_year(Gridcell& gridcell) {
+
+	if (!seedable || date.year >= nyear_spinup) {
+		return;
+	}
+
+	years_simulated++;
+	ccont.push_back(gridcell.ccont());
+
+	// The adjustment covers the last analog_spinup_years of the spinup, so
+	// that a seeded grid cell is as far into the spinup as its analog was
+	int first_year = nyear_spinup - analog_spinup_years;
+
+	if (date.year == 0) {
+		ncells++;
+		calculate_features(gridcell);
+
+		// Seeding only skips years in which the spinup brings soil pools to
+		// equilibrium, and the nitrogen-free years
+		int solvesom_end = gridcell.soiltype.solvesom_end;
+		if (ifcentury) {
+			solvesom_end = (int)(SOLVESOMCENT_SPINEND * (nyear_spinup - freenyears) + freenyears);
+		}
+		int last_fixed_year = max(solvesom_end, FIRST_FREEZE_YEAR + 10);
+		if (first_year <= last_fixed_year) {
+			if (!warned_years) {
+				dprintf("WARNING ! Analog spinup: adjustment would start in year %d, not after year %d\n"
+				        "          (soil equilibrium and freezing set up), increase nyear_spinup or decrease analog_spinup_years\n",
+				        first_year, last_fixed_year);
+				warned_years = true;
+			}
+			seedable = false;
+			return;
+		}
+
+		double distance;
+		analog = find_analog(distance);
+		if (analog < 0) {
+			return;
+		}
+
+		seed(gridcell, library[analog].state);
+
+		dprintf("Analog spinup: seeded from (%g,%g), distance %.3g, continuing in year %d\n",
+		        library[analog].lon, library[analog].lat, distance, first_year);
+
+		nseeded++;
+		date.year = first_year - 1;
+		gridcell.resume_year = first_year;
+		ccont.clear();
+		return;
+	}
+
+	if (analog < 0 && date.year == first_year - 1 && (int)library.size() < analog_library_size) {
+		Analog entry;
+		entry.lon = gridcell.get_lon();
+		entry.lat = gridcell.get_lat();
+		for (int i = 0; i < NFEATURE; i++) {
+			entry.features[i] = features[i];
+		}
+		entry.drift = 0.0;
+
+		std::ostringstream os;
+		ArchiveOutStream arch(os);
+		gridcell.serialize(arch);
+		entry.state = os.str();
+
+		library.push_back(entry);
+		library_entry = (int)library.size() - 1;
+	}
+
+	if (date.year != nyear_spinup - 1) {
+		return;
+	}
+
+	double drift;
+	bool settled = converged(drift);
+
+	if (analog < 0) {
+		// The fluctuations left after a full spinup, for the grid cells seeded from this one
+		if (library_entry >= 0) {
+			library[library_entry].drift = drift;
+		}
+	}
+	else if (!settled && drift > 2.0 * library[analog].drift) {
+		// Fluctuations of decadal means in single grid cells are tolerated
+		// up to twice those of the analog
+		if (years_simulated + analog_spinup_years <= nyear_spinup) {
+			// Adjust for another analog_spinup_years from the current state
+			date.year = first_year - 1;
+			gridcell.resume_year = first_year;
+			ccont.clear();
+			return;
+		}
+
+		dprintf("WARNING ! Analog spinup: C stocks changed by %.2g%% in the last decade of the spinup\n",
+		        100.0 * drift);
+		nunconverged++;
+	}
+
+	spinup_years += nyear_spinup;
+	spinup_years_simulated += years_simulated;
+}
+
+void AnalogSpinup::calculate_features(const Gridcell& gridcell) {
+
+	const Climate& climate = gridcell.climate;
+	const Soiltype& soiltype = gridcell.soiltype;
+
+	int n = max(ndays, 1);
+
+	features[0] = sum_temp / n;
+	features[1] = climate.mtemp_min / 2.0;
+	features[2] = climate.mtemp_max;
+	features[3] = log(sum_prec + 10.0) / 0.1;
+	features[4] = sum_rad / n * 1.0e-6;
+	features[5] = soiltype.sand_frac / 0.1;
+	features[6] = soiltype.clay_frac / 0.1;
+}
+
+int AnalogSpinup::find_analog(double& distance) const {
+
+	int nearest = -1;
+	distance = 0.0;
+
+	for (size_t a = 0; a < library.size(); a++) {
+		double sum = 0.0;
+		for (int i = 0; i < NFEATURE; i++) {
+			double d = features[i] - library[a].features[i];
+			sum += d * d;
+		}
+		double dist = sqrt(sum);
+		if (dist <= analog_max_distance && (nearest < 0 || dist < distance)) {
+			nearest = (int)a;
+			distance = dist;
+		}
+	}
+
+	return nearest;
+}
+
+void AnalogSpinup::seed(Gridcell& gridcell, const std::string& state) {
+
+	// Keep the grid cell's own climate records and mass balance, and its
+	// random number stream, as the analog's don't belong to this location
+	std::ostringstream own;
+	{
+		ArchiveOutStream arch(own);
+		arch & gridcell.climate & gridcell.balance;
+	}
+	long seed = gridcell.seed;
+
+	{
+		std::istringstream is(state);
+		ArchiveInStream arch(is);
+		gridcell.serialize(arch);
+	}
+
+	{
+		std::istringstream is(own.str());
+		ArchiveInStream arch(is);
+		arch & gridcell.climate & gridcell.balance;
+	}
+	gridcell.seed = seed;
+
+	// The 20-year records of the coldest and warmest months only hold the
+	// first year, which stands in for the years skipped
+	Climate& climate = gridcell.climate;
+	for (int y = 0; y < 19; y++) {
+		climate.history->mtemp_min_20[y] = climate.history->mtemp_min_20[19];
+		climate.history->mtemp_max_20[y] = climate.history->mtemp_max_20[19];
+	}
+	climate.mtemp_min20 = climate.history->mtemp_min_20[19];
+	climate.mtemp_max20 = climate.history->mtemp_max_20[19];
+
+	// Soil temperature state isn't serialized, initialise it as for cloned
+	// patches, and give the layers the water holding capacity of this grid
+	// cell's soil rather than the analog's
+	Gridcell::iterator gc_itr = gridcell.begin();
+	while (gc_itr != gridcell.end()) {
+		Stand& stand = *gc_itr;
+		stand.firstobj();
+		while (stand.isobj) {
+			Patch& patch = stand.getobj();
+			patch.cloned = true;
+			patch.soil.reset_water_capacity();
+			stand.nextobj();
+		}
+		++gc_itr;
+	}
+}
+
+bool AnalogSpinup::converged(double& drift) const {
+
+	drift = 0.0;
+
+	if (ccont.size() < 2 * CONVERGENCE_PERIOD) {
+		return true;
+	}
+
+	size_t last = ccont.size() - CONVERGENCE_PERIOD;
+	double previous_mean = mean(ccont, last - CONVERGENCE_PERIOD, CONVERGENCE_PERIOD);
+	double last_mean = mean(ccont, last, CONVERGENCE_PERIOD);
+
+	if (last_mean == 0.0) {
+		drift = previous_mean == 0.0 ? 0.0 : 1.0;
+	}
+	else {
+		drift = fabs(last_mean - previous_mean) / fabs(last_mean);
+	}
+
+	return drift <= analog_spinup_tol;
+}
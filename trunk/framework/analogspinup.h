@@ -0,0 +1,150 @@
+///////////////////////////////////////////////////////////////////////////////////////
+/// \file analogspinup.h
+/// \brief Shortened spinup of grid cells seeded from climate analogs
+///
+/// Most of the cost of a run goes into the spinup, which takes every grid
+/// cell from bare ground to equilibrium vegetation and soil pools. Grid
+/// cells with similar climate and soil end up in similar states, so with
+/// analog spinup enabled (ifanalogspinup) a grid cell doesn't need to get
+/// there all on its own:
+///
+/// - Each grid cell simulates the first spinup year as usual, which gives
+///   its climate and soil features: annual mean, coldest and warmest month
+///   temperatures, annual precipitation, mean radiation and the sand and
+///   clay fractions.
+/// - Grid cells without an analog get a full spinup. Their state at the
+///   start of the last analog_spinup_years of the spinup is added to the
+///   analog library, up to analog_library_size grid cells per process.
+/// - If a grid cell in the library is within analog_max_distance in this
+///   feature space, the nearest one is the analog. The grid cell takes over
+///   the analog's vegetation and soil state from the library, keeping its
+///   own climate records and random number stream, and jumps to the last
+///   analog_spinup_years of the spinup, in which it adjusts to its own
+///   climate and soil.
+/// - At the end of the spinup the decadal means of total C stocks of the
+///   last two decades are compared. If they differ by more than
+///   analog_spinup_tol (relative), and by more than twice as much as they
+///   did for the analog at the end of its full spinup, the adjustment is
+///   repeated from the current state, as long as the grid cell doesn't
+///   simulate more years than a full spinup. Pools which are still building
+///   up at the end of the spinup (such as litter in short spinups) end up
+///   larger in grid cells adjusted more than once.
+///
+/// The features are scaled so that a distance of 1 corresponds to, for
+/// instance, a difference of 1 degC in annual mean temperature, 2 degC in
+/// the coldest month, 10% in precipitation, 1 MJ/m2/day in radiation or
+/// 0.1 in the sand or clay fraction.
+///
+/// Analog spinup shortens the spinup of grid cells, it doesn't change the
+/// model, so the states after the spinup are close to but not the same as
+/// with a full spinup. Since the library only holds grid cells simulated
+/// earlier by the same process, the results also depend on the order of the
+/// gridlist and on the number of processes. Grid cells received from other
+/// processes (-migrate) continue their spinup where it was.
+///
+/// $Date$
+///
+///////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef LPJ_GUESS_ANALOGSPINUP_H
+#define LPJ_GUESS_ANALOGSPINUP_H
+
+#include <string>
+#include <vector>
+
+class Gridcell;
+
+/// Seeds the spinup of grid cells from the spun-up state of climate analogs
+/** Without analog spinup enabled, all functions return without doing anything. */
+class AnalogSpinup {
+public:
+
+	/// Creates the object, with an empty analog library
+	AnalogSpinup(bool enabled);
+
+	/// Writes a summary of the savings to the log
+	~AnalogSpinup();
+
+	/// To be called when the simulation of a grid cell begins
+	/** \param seedable  Whether the grid cell starts from the first spinup
+	 *                   year, false for grid cells received from other processes
+	 */
+	void begin_gridcell(bool seedable);
+
+	/// To be called every simulated day, collects the features in the first year
+	void day(const Gridcell& gridcell);
+
+	/// To be called after the last day of each year has been simulated for a grid cell
+	/** May seed the grid cell from an analog, or repeat the adjustment at
+	 *  the end of the spinup, in both cases the global date is set back or
+	 *  ahead to the year before the next year to simulate.
+	 */
+	void end_of_year(Gridcell& gridcell);
+
+	/// Replaces the state of the grid cell with an analog's, see above
+	/** \param state  The analog grid cell, serialized without tags */
+	static void seed(Gridcell& gridcell, const std::string& state);
+
+private:
+
+	/// Number of features describing the climate and soil of a grid cell
+	static const int NFEATURE = 7;
+
+	/// A spun-up grid cell which may be used as analog
+	struct Analog {
+		double lon, lat;
+		double features[NFEATURE];
+
+		/// Relative change of decadal mean C stocks at the end of its own spinup
+		double drift;
+
+		/// The serialized grid cell at the start of the adjustment period
+		std::string state;
+	};
+
+	/// Calculates the features of the current grid cell at the end of the first year
+	void calculate_features(const Gridcell& gridcell);
+
+	/// Returns the nearest analog within analog_max_distance, or -1 if there is none
+	int find_analog(double& distance) const;
+
+	/// Whether the C stocks have settled at the end of the spinup
+	bool converged(double& drift) const;
+
+	/// Whether analog spinup is enabled
+	bool enabled;
+
+	/// Spun-up grid cells of this process
+	std::vector<Analog> library;
+
+	/// Whether the current grid cell may be seeded
+	bool seedable;
+
+	/// Analog of the current grid cell in the library, -1 if not seeded
+	int analog;
+
+	/// Library entry made from the current grid cell, -1 if none
+	int library_entry;
+
+	/// Whether the warning about a too long adjustment has been written
+	bool warned_years;
+
+	/// Features of the current grid cell
+	double features[NFEATURE];
+
+	/// Sums over the first year of the current grid cell
+	double sum_temp, sum_prec, sum_rad;
+	int ndays;
+
+	/// Spinup years simulated so far for the current grid cell
+	int years_simulated;
+
+	/// Total C stocks at the end of each year since the last jump
+	std::vector<double> ccont;
+
+	/// Totals over all grid cells for the summary
+	int ncells, nseeded, nunconverged;
+	long spinup_years, spinup_years_simulated;
+};
+
+#endif // LPJ_GUESS_ANALOGSPINUP_H
@@ -9,6 +9,8 @@
 #include "config.h"
 #include "archive.h"
 
+#include <sstream>
+
 ArchiveInStream::ArchiveInStream(std::istream& strm)
 	: in(strm) {
 }
@@ -32,3 +34,253 @@ bool ArchiveOutStream::save() const {
 void ArchiveOutStream::transfer(char* s, std::streamsize n) {
 	out.write(s, n);
 }
+
+namespace {
+
+/// Tag starting a Serializable object in tagged data
+const unsigned int TAG_OBJECT_BEGIN = 0xfffffffe;
+
+/// Tag ending a Serializable object in tagged data
+const unsigned int TAG_OBJECT_END = 0xffffffff;
+
+/// Longest class or field name accepted when reading tagged data
+const unsigned int MAX_NAME_LENGTH = 256;
+
+std::string describe_tag(unsigned int tag) {
+	std::ostringstream os;
+	if (tag == TAG_OBJECT_BEGIN) {
+		os << "an object";
+	}
+	else if (tag == TAG_OBJECT_END) {
+		os << "the end of the object";
+	}
+	else {
+		os << "a field of " << tag << " bytes";
+	}
+	return os.str();
+}
+
+}
+
+ArchiveStream::ArchiveStream()
+	: data_version(ARCHIVE_VERSION),
+	  tagged(false),
+	  next_name("") {
+}
+
+void ArchiveStream::set_format(int version, bool tagged) {
+	data_version = version;
+	this->tagged = tagged;
+}
+
+void ArchiveStream::set_pft_map(const std::vector<int>& map) {
+	pft_map = map;
+}
+
+int ArchiveStream::stored_npft(int npft_current) const {
+	return pft_map.empty() ? npft_current : (int)pft_map.size();
+}
+
+int ArchiveStream::current_pft(int stored_index) const {
+	if (pft_map.empty()) {
+		return stored_index;
+	}
+	if (stored_index < 0 || stored_index >= (int)pft_map.size()) {
+		mismatch("PFT index out of range");
+	}
+	return pft_map[stored_index];
+}
+
+void ArchiveStream::mismatch(const std::string& problem) const {
+	std::ostringstream os;
+	os << "Incompatible state in ";
+
+	if (scopes.empty()) {
+		os << "top level";
+	}
+	for (size_t i = 0; i < scopes.size(); i++) {
+		os << (i ? "/" : "") << scopes[i].name;
+	}
+
+	if (!scopes.empty()) {
+		os << ", field " << scopes.back().fields + 1;
+		if (*next_name) {
+			os << " (" << next_name << ")";
+		}
+	}
+	os << ": " << problem;
+
+	throw ArchiveError(os.str());
+}
+
+void ArchiveStream::transfer_name() {
+	if (!named()) {
+		next_name = "";
+		return;
+	}
+
+	std::string name = next_name;
+	unsigned int length = (unsigned int)name.size();
+	transfer((char*)&length, sizeof(length));
+
+	if (save()) {
+		if (length > 0) {
+			transfer(&name[0], length);
+		}
+	}
+	else {
+		if (length > MAX_NAME_LENGTH) {
+			mismatch("the state file is corrupt");
+		}
+
+		std::string stored(length, ' ');
+		if (length > 0) {
+			transfer(&stored[0], length);
+		}
+
+		if (stored != name) {
+			mismatch("expected " + (name.empty() ? std::string("an unnamed field") : name) +
+			         ", the state file has " + (stored.empty() ? std::string("an unnamed field") : stored));
+		}
+	}
+
+	next_name = "";
+}
+
+void ArchiveStream::transfer_field(char* s, std::streamsize n) {
+	if (tagged) {
+		unsigned int tag = (unsigned int)n;
+		transfer((char*)&tag, sizeof(tag));
+
+		if (!save() && tag != (unsigned int)n) {
+			std::ostringstream os;
+			os << "expected a field of " << n << " bytes, the state file has "
+			   << describe_tag(tag);
+			mismatch(os.str());
+		}
+
+		transfer_name();
+
+		if (!scopes.empty()) {
+			scopes.back().fields++;
+		}
+	}
+
+	transfer(s, n);
+}
+
+void ArchiveStream::begin_object(const char* class_tag) {
+	if (!tagged) {
+		return;
+	}
+
+	std::string name = class_tag;
+
+	unsigned int tag = TAG_OBJECT_BEGIN;
+	transfer((char*)&tag, sizeof(tag));
+
+	if (!save() && tag != TAG_OBJECT_BEGIN) {
+		mismatch("expected a " + name + " object, the state file has " + describe_tag(tag));
+	}
+
+	unsigned int length = (unsigned int)name.size();
+	transfer((char*)&length, sizeof(length));
+
+	if (save()) {
+		transfer(&name[0], length);
+	}
+	else {
+		if (length > MAX_NAME_LENGTH) {
+			mismatch("expected a " + name + " object, the state file is corrupt");
+		}
+
+		std::string stored(length, ' ');
+		if (length > 0) {
+			transfer(&stored[0], length);
+		}
+
+		if (stored != name) {
+			mismatch("expected a " + name + " object, the state file has a " + stored);
+		}
+	}
+
+	transfer_name();
+
+	if (!scopes.empty()) {
+		scopes.back().fields++;
+	}
+
+	Scope scope;
+	scope.name = name;
+	scope.fields = 0;
+	scopes.push_back(scope);
+}
+
+void ArchiveStream::skip_object() {
+	if (!can_skip()) {
+		throw ArchiveError("Objects can only be skipped when reading tagged data");
+	}
+
+	std::vector<char> buffer;
+	int depth = 0;
+
+	// Class and field names are skipped like this
+	const int names_per_object = named() ? 2 : 1;
+	const int names_per_field = named() ? 1 : 0;
+
+	do {
+		unsigned int tag;
+		transfer((char*)&tag, sizeof(tag));
+
+		int names = 0;
+		if (tag == TAG_OBJECT_BEGIN) {
+			names = names_per_object;
+			depth++;
+		}
+		else if (depth == 0) {
+			mismatch("expected an object to skip, the state file has " + describe_tag(tag));
+		}
+		else if (tag == TAG_OBJECT_END) {
+			depth--;
+		}
+		else {
+			names = names_per_field;
+		}
+
+		for (int i = 0; i < names; i++) {
+			unsigned int length;
+			transfer((char*)&length, sizeof(length));
+			if (length > MAX_NAME_LENGTH) {
+				mismatch("the state file is corrupt");
+			}
+			buffer.resize(length + 1);
+			transfer(&buffer.front(), length);
+		}
+
+		if (tag != TAG_OBJECT_BEGIN && tag != TAG_OBJECT_END && tag > 0) {
+			buffer.resize(tag);
+			transfer(&buffer.front(), tag);
+		}
+	} while (depth > 0);
+
+	next_name = "";
+
+	if (!scopes.empty()) {
+		scopes.back().fields++;
+	}
+}
+
+void ArchiveStream::end_object() {
+	if (!tagged) {
+		return;
+	}
+
+	unsigned int tag = TAG_OBJECT_END;
+	transfer((char*)&tag, sizeof(tag));
+
+	if (!save() && tag != TAG_OBJECT_END) {
+		mismatch("the state file has more fields, starting with " + describe_tag(tag));
+	}
+
+	scopes.pop_back();
+}
@@ -12,6 +12,28 @@
 #include <ostream>
 #include <istream>
 #include <vector>
+#include <string>
+#include <stdexcept>
+
+/// Version of the data written by the serialize functions
+/** Increase this when a serialize function changes. When reading, the
+ *  serialize function should then check ArchiveStream::version() to know
+ *  which fields are in the data, and if the new state can't simply be
+ *  left as initialised by the constructor, a migration should be
+ *  registered (see REGISTER_STATE_MIGRATION in guessserializer.h).
+ *
+ *  Version 1 is the untagged state format from before the format was
+ *  versioned, version 2 introduced field tags, version 3 added the stand
+ *  ids (which are part of the keys of the random streams), version 4 added
+ *  the field names to the tags.
+ */
+const int ARCHIVE_VERSION = 4;
+
+/// Thrown when tagged data doesn't match what is read
+class ArchiveError : public std::runtime_error {
+public:
+	ArchiveError(const std::string& what) : std::runtime_error(what) {}
+};
 
 /// Abstract base class for ArchiveInStream and ArchiveOutStream
 /** The base class declares the transfer function, which will read
@@ -23,9 +45,18 @@
  *  Sometimes we do need to know which direction the ArchiveStream
  *  is working in though, so that can be queried with the save
  *  function.
+ *
+ *  Data which is kept (state files) can be tagged. Each field is then
+ *  preceded by its size and name (see STATE_FIELD), and each Serializable
+ *  object is enclosed by its state_tag() and an end mark, so that data from
+ *  a different version of the model is detected and the first field which
+ *  doesn't match is reported (as an ArchiveError). Tags of version 2 and 3
+ *  data have no field names. Data which is only passed between parts of
+ *  the same program is untagged.
  */
 class ArchiveStream {
 public:
+	ArchiveStream();
 
 	/// Checks if this ArchiveStream is saving data to stream or reading
 	virtual bool save() const = 0;
@@ -36,6 +67,79 @@ public:
 	 *  \param n   Number of bytes to read or write
 	 */
 	virtual void transfer(char* s, std::streamsize n) = 0;
+
+	/// Write or read one field, with its tag if the data is tagged
+	void transfer_field(char* s, std::streamsize n);
+
+	/// Names the next field or object, see archive_field
+	void name_next(const char* name) { next_name = name; }
+
+	/// Starts a Serializable object, called by operator& below
+	/** \param class_tag The object's Serializable::state_tag() */
+	void begin_object(const char* class_tag);
+
+	/// Ends the most recently started object
+	void end_object();
+
+	/// Whether objects can be skipped with skip_object
+	bool can_skip() const { return tagged && !save(); }
+
+	/// Reads past a Serializable object without knowing what it is
+	/** Only possible when reading tagged data, see can_skip. */
+	void skip_object();
+
+	/// Sets the version of the data and whether it is tagged
+	/** Defaults to ARCHIVE_VERSION, untagged. */
+	void set_format(int version, bool tagged);
+
+	/// Version of the data (ARCHIVE_VERSION unless read from an older file)
+	int version() const { return data_version; }
+
+	/// Sets where PFTs in the data are in the current PFT list
+	/** \param map For each PFT in the data, its index in pftlist or -1 if
+	 *             it isn't in pftlist any more
+	 */
+	void set_pft_map(const std::vector<int>& map);
+
+	/// Number of PFTs in the data
+	/** \param npft_current Number of PFTs in pftlist, returned if there
+	 *                      is no PFT map
+	 */
+	int stored_npft(int npft_current) const;
+
+	/// Index in pftlist of a PFT in the data, -1 if it was removed
+	int current_pft(int stored_index) const;
+
+private:
+	/// Throws an ArchiveError about the current field
+	void mismatch(const std::string& problem) const;
+
+	/// Write or read the name of the current field, if the tags have names
+	void transfer_name();
+
+	/// Whether the tags include field names (version 4 and later)
+	bool named() const { return tagged && data_version >= 4; }
+
+	/// An object being read or written
+	struct Scope {
+		std::string name;
+
+		/// Number of fields transferred so far
+		int fields;
+	};
+
+	int data_version;
+
+	bool tagged;
+
+	/// Name of the next field, see name_next, empty for unnamed fields
+	const char* next_name;
+
+	/// See set_pft_map, empty if PFTs are stored as in pftlist
+	std::vector<int> pft_map;
+
+	/// The objects currently being read or written, outermost first
+	std::vector<Scope> scopes;
 };
 
 /// Class for reading data from an istream
@@ -76,6 +180,12 @@ class Serializable {
 public:
 	/// Needs to be implemented by all sub-classes
 	virtual void serialize(ArchiveStream& arch) = 0;
+
+	/// Name of the class in tagged data
+	/** Written out explicitly rather than taken from the type, so that
+	 *  state files don't depend on the compiler.
+	 */
+	virtual const char* state_tag() const = 0;
 };
 
 /// Function for checking if something inherits from Serializable
@@ -115,10 +225,12 @@ inline bool inheritsFromSerializable(const Serializable& s) {
 template<typename T>
 ArchiveStream& operator&(ArchiveStream& stream, T& data) {
 	if (inheritsFromSerializable(data)) {
+		stream.begin_object(((Serializable&)data).state_tag());
 		((Serializable&)data).serialize(stream);
+		stream.end_object();
 	}
 	else {
-		stream.transfer((char*)&data, sizeof(data));
+		stream.transfer_field((char*)&data, sizeof(data));
 	}
 	return stream;
 }
@@ -143,4 +255,46 @@ ArchiveStream& operator&(ArchiveStream& stream, std::vector<T>& data) {
 	return stream;
 }
 
+/// A field with its name, for tagged data
+template<typename T>
+struct ArchiveField {
+	ArchiveField(const char* name, T& data) : name(name), data(data) {}
+
+	const char* name;
+	T& data;
+};
+
+/// Names a field, for fields read and written with different expressions
+/** For instance indiv.pft.id when writing and a local variable when reading,
+ *  which both use:
+ *
+ *  \code
+ *    arch & archive_field("pft_id", ...);
+ *  \endcode
+ *
+ *  The name must be a string literal, or otherwise outlive the transfer.
+ *  Usually STATE_FIELD below is used instead.
+ */
+template<typename T>
+ArchiveField<T> archive_field(const char* name, T& data) {
+	return ArchiveField<T>(name, data);
+}
+
+template<typename T>
+ArchiveStream& operator&(ArchiveStream& stream, ArchiveField<T> field) {
+	stream.name_next(field.name);
+	return stream & field.data;
+}
+
+/// Transfers a field named as it is written in the serialize function
+/** \code
+ *    arch & STATE_FIELD(cmass_leaf) & STATE_FIELD(history->mtemp_20);
+ *  \endcode
+ *
+ *  A std::vector is named by its size, its elements are unnamed. Renaming
+ *  a field changes the state format like any other change of a serialize
+ *  function, see ARCHIVE_VERSION.
+ */
+#define STATE_FIELD(field) archive_field(#field, field)
+
 #endif // LPJ_GUESS_ARCHIVE_H
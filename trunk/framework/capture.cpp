@@ -0,0 +1,492 @@
+///////////////////////////////////////////////////////////////////////////////////////
+/// \file capture.cpp
+/// \brief Capture of single grid cells into bundles which can be replayed offline
+///
+/// $Date$
+///
+///////////////////////////////////////////////////////////////////////////////////////
+
+#include "config.h"
+#include "capture.h"
+#include "forcingcache.h"
+#include "guess.h"
+#include "guessserializer.h"
+#include "guessstring.h"
+#include "parameters.h"
+#include "plib.h"
+
+#include <errno.h>
+#include <sstream>
+#include <math.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#ifdef _WIN32
+#include <direct.h>
+#endif
+
+REGISTER_INPUT_MODULE("replay", ReplayInput)
+
+namespace {
+
+/// Identifies forcing.bin files and their layout, change when the layout changes
+const char MAGIC[8] = { 'L', 'P', 'J', 'G', 'C', 'A', 'P', '1' };
+
+/// Types of the records in forcing.bin, one for each call to the input module
+/** Each record is stored as its type and number of values, followed by the
+ *  values, all as doubles.
+ */
+enum RecordType {
+	/// The day's climate drivers, see record_forcing_day()
+	RECORD_DAY = 1,
+	/// The input fields after getlandcover(), no values if unchanged
+	RECORD_LANDCOVER,
+	/// The input fields after getmanagement(), no values if unchanged
+	RECORD_MANAGEMENT,
+	/// The end of the simulation of the grid cell
+	RECORD_END
+};
+
+/// Tolerance when comparing coordinates with the captured grid cells
+const double COORDINATE_EPSILON = 1e-5;
+
+/// Creates a directory unless it already exists
+bool make_directory(const std::string& path) {
+#ifdef _WIN32
+	int result = _mkdir(path.c_str());
+#else
+	int result = mkdir(path.c_str(), 0777);
+#endif
+	return result == 0 || errno == EEXIST;
+}
+
+/// Visits the grid cell fields which getlandcover() and getmanagement() set
+/** The land cover and management input (LandcoverInput, ManagementInput)
+ *  sets these fields in the grid cell, its stand types and PFTs, and the PFTs
+ *  of its stands.
+ */
+template<typename Visitor>
+void visit_input_fields(Gridcell& gridcell, Visitor& visit) {
+
+	Landcover& lc = gridcell.landcover;
+
+	for (int i = 0; i < NLANDCOVERTYPES; i++) {
+		visit(lc.frac[i]);
+		visit(lc.frac_old[i]);
+		visit(lc.frac_change[i]);
+		for (int j = 0; j < NLANDCOVERTYPES; j++) {
+			visit(lc.frac_transfer[i][j]);
+			visit(lc.primary_frac_transfer[i][j]);
+		}
+	}
+
+	for (unsigned int i = 0; i < gridcell.st.nobj; i++) {
+		Gridcellst& gcst = gridcell.st[i];
+		visit(gcst.frac);
+		visit(gcst.frac_old);
+		visit(gcst.frac_old_orig);
+		visit(gcst.frac_change);
+		visit(gcst.nfert);
+	}
+
+	for (unsigned int p = 0; p < gridcell.pft.nobj; p++) {
+		Gridcellpft& gcpft = gridcell.pft[p];
+		visit(gcpft.sdate_force);
+		visit(gcpft.hdate_force);
+		visit(gcpft.Nfert_read);
+		visit(gcpft.Nfert_man_read);
+	}
+
+	for (unsigned int s = 0; s < gridcell.nbr_stands(); s++) {
+		Stand& stand = gridcell[s];
+		for (unsigned int p = 0; p < stand.pft.nobj; p++) {
+			visit(stand.pft[p].sdate_force);
+			visit(stand.pft[p].hdate_force);
+		}
+	}
+}
+
+/// Collects the input fields of a grid cell
+struct FieldWriter {
+	FieldWriter(std::vector<double>& values) : values(values) {}
+
+	void operator()(double& value) { values.push_back(value); }
+	void operator()(int& value) { values.push_back(value); }
+
+	std::vector<double>& values;
+};
+
+/// Sets the input fields of a grid cell
+struct FieldReader {
+	FieldReader(const std::vector<double>& values) : values(values), position(0) {}
+
+	void operator()(double& value) { value = values[position++]; }
+	void operator()(int& value) { value = (int)values[position++]; }
+
+	const std::vector<double>& values;
+	size_t position;
+};
+
+void write_record(std::ofstream& out, int type, const std::vector<double>& values) {
+	double header[2] = { (double)type, (double)values.size() };
+	out.write((const char*)header, sizeof(header));
+	if (!values.empty()) {
+		out.write((const char*)&values.front(), (std::streamsize)(values.size() * sizeof(double)));
+	}
+}
+
+void write_text_file(const std::string& filename, const std::string& text) {
+	std::ofstream out(filename.c_str(), std::ios::trunc);
+	out << text;
+	if (!out) {
+		fail("Could not write %s\n", filename.c_str());
+	}
+}
+
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+// CaptureInput
+//
+
+CaptureInput::CaptureInput(InputModule* input_module,
+                           const std::string& instruction_file,
+                           const std::string& directory,
+                           const std::string& cells_file)
+	: input_module(input_module),
+	  instruction_file(instruction_file),
+	  directory(directory),
+	  cells_file(cells_file),
+	  first_day(false),
+	  ncaptured(0) {
+}
+
+CaptureInput::~CaptureInput() {
+	if (!flat_instruction_file.empty()) {
+		dprintf("Capture: %d grid cell(s) captured\n", ncaptured);
+	}
+}
+
+void CaptureInput::init() {
+	input_module->init();
+
+	if (!cells_file.empty()) {
+		std::ifstream in(cells_file.c_str());
+		if (!in) {
+			fail("Could not open %s for input\n", cells_file.c_str());
+		}
+
+		// Lines with the coordinates, optionally followed by a description
+		std::string line;
+		while (std::getline(in, line)) {
+			double lon, lat;
+			if (sscanf(line.c_str(), "%lf %lf", &lon, &lat) == 2) {
+				cells.push_back(std::make_pair(lon, lat));
+			}
+		}
+
+		if (cells.empty()) {
+			fail("No grid cells to capture in %s\n", cells_file.c_str());
+		}
+	}
+
+	if (!plibflatten(instruction_file.c_str(), flat_instruction_file)) {
+		fail("Could not read %s for capture\n", instruction_file.c_str());
+	}
+
+	dprintf("Capture: bundles in %s for %s\n", directory.c_str(),
+	        cells.empty() ? "all grid cells" : cells_file.c_str());
+}
+
+bool CaptureInput::chosen(double lon, double lat) const {
+	if (cells.empty()) {
+		return true;
+	}
+	for (size_t i = 0; i < cells.size(); i++) {
+		if (fabs(cells[i].first - lon) < COORDINATE_EPSILON &&
+		    fabs(cells[i].second - lat) < COORDINATE_EPSILON) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool CaptureInput::getgridcell(Gridcell& gridcell) {
+
+	bundle.clear();
+
+	if (!input_module->getgridcell(gridcell)) {
+		return false;
+	}
+
+	if (chosen(gridcell.get_lon(), gridcell.get_lat())) {
+		begin_bundle(gridcell);
+	}
+
+	return true;
+}
+
+void CaptureInput::begin_bundle(const Gridcell& gridcell) {
+
+	const double lon = gridcell.get_lon();
+	const double lat = gridcell.get_lat();
+
+	bundle = format_string("%s/%g_%g", directory.c_str(), lon, lat);
+
+	if (!make_directory(bundle) || (restart && !make_directory(bundle + "/state"))) {
+		fail("Could not create capture bundle directory %s\n", bundle.c_str());
+	}
+
+	// The instruction file, set up to be replayed from within the bundle
+	std::string settings = format_string("\n\n"
+		"! Replay of the capture bundle for grid cell (%g,%g), run from this directory:\n"
+		"! guess -input replay guess.ins\n"
+		"param \"file_replay\" (str \"forcing.bin\")\n"
+		"save_state 0\n", lon, lat);
+
+	if (restart) {
+		settings += "restart 1\nstate_path \"state\"\n";
+	}
+
+	write_text_file(bundle + "/guess.ins", flat_instruction_file + settings);
+	write_text_file(bundle + "/pft_parameters.txt", pft_parameters());
+
+	std::string filename = bundle + "/forcing.bin";
+	out.clear();
+	out.open(filename.c_str(), std::ios::binary | std::ios::trunc);
+	if (!out) {
+		fail("Could not open %s for output\n", filename.c_str());
+	}
+
+	// What getgridcell() delivered, and the input module's date settings
+	double header[] = {
+		lon,
+		lat,
+		(double)gridcell.climate.instype,
+		(double)gridcell.seed,
+		(double)date.first_calendar_year,
+		(double)date.subdaily
+	};
+	unsigned int soiltype_size = sizeof(Soiltype);
+
+	out.write(MAGIC, sizeof(MAGIC));
+	out.write((const char*)header, sizeof(header));
+	out.write((const char*)&soiltype_size, sizeof(soiltype_size));
+	out.write((const char*)&gridcell.soiltype, sizeof(Soiltype));
+
+	first_day = true;
+}
+
+bool CaptureInput::getclimate(Gridcell& gridcell) {
+
+	if (bundle.empty()) {
+		return input_module->getclimate(gridcell);
+	}
+
+	// The grid cell has now been restored from the state file, if restarting
+	if (first_day && restart) {
+		GuessSerializer serializer((bundle + "/state").c_str(), 0, 1);
+		serializer.serialize_gridcell(gridcell);
+	}
+	first_day = false;
+
+	long seed = gridcell.seed;
+	std::vector<double> values;
+
+	if (!input_module->getclimate(gridcell)) {
+		write_record(out, RECORD_END, values);
+		out.close();
+		if (out.fail()) {
+			fail("Could not write %s/forcing.bin\n", bundle.c_str());
+		}
+		dprintf("Captured grid cell to %s\n", bundle.c_str());
+		ncaptured++;
+		bundle.clear();
+		return false;
+	}
+
+	record_forcing_day(values, gridcell, seed != gridcell.seed);
+	write_record(out, RECORD_DAY, values);
+
+	return true;
+}
+
+void CaptureInput::capture_input_fields(Gridcell& gridcell, int record_type) {
+
+	std::vector<double> before, after;
+	FieldWriter write_before(before);
+	visit_input_fields(gridcell, write_before);
+
+	if (record_type == RECORD_LANDCOVER) {
+		input_module->getlandcover(gridcell);
+	}
+	else {
+		input_module->getmanagement(gridcell);
+	}
+
+	FieldWriter write_after(after);
+	visit_input_fields(gridcell, write_after);
+
+	if (after == before) {
+		after.clear();
+	}
+	write_record(out, record_type, after);
+}
+
+void CaptureInput::getlandcover(Gridcell& gridcell) {
+	if (bundle.empty()) {
+		input_module->getlandcover(gridcell);
+	}
+	else {
+		capture_input_fields(gridcell, RECORD_LANDCOVER);
+	}
+}
+
+void CaptureInput::getmanagement(Gridcell& gridcell) {
+	if (bundle.empty()) {
+		input_module->getmanagement(gridcell);
+	}
+	else {
+		capture_input_fields(gridcell, RECORD_MANAGEMENT);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+// ReplayInput
+//
+
+ReplayInput::ReplayInput()
+	: done(false) {
+
+	// The instruction file of the bundle may set parameters which the input
+	// module of the captured run declared, so all input modules are created
+	// to declare their parameters
+	InputModuleRegistry& registry = InputModuleRegistry::get_instance();
+	std::string list;
+	registry.get_input_module_list(list);
+
+	std::istringstream names(list);
+	std::string name;
+	while (std::getline(names, name, ';')) {
+		if (!name.empty() && name != "replay") {
+			declaring_modules.push_back(registry.create_input_module(name.c_str()));
+		}
+	}
+}
+
+ReplayInput::~ReplayInput() {
+	for (size_t i = 0; i < declaring_modules.size(); i++) {
+		delete declaring_modules[i];
+	}
+}
+
+void ReplayInput::init() {
+	filename = (char*)param["file_replay"].str;
+
+	in.open(filename.c_str(), std::ios::binary);
+	if (!in) {
+		fail("Could not open %s for input\n", filename.c_str());
+	}
+}
+
+bool ReplayInput::getgridcell(Gridcell& gridcell) {
+
+	if (done) {
+		return false;
+	}
+	done = true;
+
+	char magic[sizeof(MAGIC)];
+	double header[6];
+	unsigned int soiltype_size = 0;
+
+	in.read(magic, sizeof(magic));
+	in.read((char*)header, sizeof(header));
+	in.read((char*)&soiltype_size, sizeof(soiltype_size));
+
+	if (!in || !std::equal(magic, magic + sizeof(MAGIC), MAGIC) || soiltype_size != sizeof(Soiltype)) {
+		fail("%s is not a capture bundle of this version of LPJ-GUESS\n", filename.c_str());
+	}
+
+	in.read((char*)&gridcell.soiltype, sizeof(Soiltype));
+
+	gridcell.set_coordinates(header[0], header[1]);
+	gridcell.climate.instype = (insoltype)(int)header[2];
+	gridcell.seed = (long)header[3];
+	date.set_first_calendar_year((int)header[4]);
+	date.subdaily = (int)header[5];
+
+	dprintf("\nReplaying grid cell at (%g,%g) from %s\n", header[0], header[1], filename.c_str());
+
+	return true;
+}
+
+int ReplayInput::read_record() {
+
+	double header[2] = { 0, 0 };
+	in.read((char*)header, sizeof(header));
+
+	values.resize((size_t)header[1]);
+	if (!values.empty()) {
+		in.read((char*)&values.front(), (std::streamsize)(values.size() * sizeof(double)));
+	}
+
+	if (!in) {
+		fail("Capture bundle %s is truncated\n", filename.c_str());
+	}
+
+	return (int)header[0];
+}
+
+void ReplayInput::expect_record(int record_type, int expected) const {
+	if (record_type != expected) {
+		fail("Capture bundle %s is out of step with the simulation (year %d, day %d).\n"
+		     "Was the instruction file changed?\n", filename.c_str(), date.year, date.day);
+	}
+}
+
+bool ReplayInput::getclimate(Gridcell& gridcell) {
+
+	int record_type = read_record();
+	if (record_type == RECORD_END) {
+		return false;
+	}
+	expect_record(record_type, RECORD_DAY);
+
+	size_t position = 0;
+	if (!replay_forcing_day(values, position, gridcell) || position != values.size()) {
+		fail("Capture bundle %s is out of step with the simulation (year %d, day %d)\n",
+		     filename.c_str(), date.year, date.day);
+	}
+
+	return true;
+}
+
+void ReplayInput::replay_input_fields(Gridcell& gridcell, int record_type) {
+
+	expect_record(read_record(), record_type);
+
+	if (values.empty()) {
+		return;
+	}
+
+	// The grid cell must have the same stand types, PFTs and stands as in the capture
+	std::vector<double> current;
+	FieldWriter count(current);
+	visit_input_fields(gridcell, count);
+
+	if (current.size() != values.size()) {
+		fail("Capture bundle %s doesn't match the grid cell (year %d, day %d).\n"
+		     "Was the instruction file changed?\n", filename.c_str(), date.year, date.day);
+	}
+
+	FieldReader read(values);
+	visit_input_fields(gridcell, read);
+}
+
+void ReplayInput::getlandcover(Gridcell& gridcell) {
+	replay_input_fields(gridcell, RECORD_LANDCOVER);
+}
+
+void ReplayInput::getmanagement(Gridcell& gridcell) {
+	replay_input_fields(gridcell, RECORD_MANAGEMENT);
+}
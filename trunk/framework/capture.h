@@ -0,0 +1,176 @@
+///////////////////////////////////////////////////////////////////////////////////////
+/// \file capture.h
+/// \brief Capture of single grid cells into bundles which can be replayed offline
+///
+/// When a grid cell in a large run misbehaves, or is much slower than the
+/// others, reproducing it shouldn't need the whole run with all its input
+/// files. CaptureInput wraps the input module chosen on the command line
+/// (-capture <directory>) and writes a bundle for each chosen grid cell
+/// (-capture-cells <file>, all grid cells by default) to a directory of its
+/// own, named after the coordinates. A bundle holds:
+///
+/// - guess.ins, the instruction file with imported files inlined, set up to
+///   be replayed
+/// - pft_parameters.txt, the PFT parameters as resolved by the model (for
+///   reference, the replay reads them from guess.ins)
+/// - forcing.bin, everything the input module delivered for the grid cell:
+///   coordinates, soil, every day's climate drivers, and the land cover and
+///   management data from getlandcover() and getmanagement()
+/// - state/, the state the grid cell started from, if the run restarts
+///
+/// The "replay" input module (ReplayInput) simulates a bundle with exactly
+/// the same results as the grid cell had in the original run:
+///
+/// \code
+/// cd <directory>/<lon>_<lat>
+/// guess -input replay guess.ins
+/// \endcode
+///
+/// Only input delivered through the input module is captured, so data read
+/// by the model itself (the SIMFIRE input file) must still be available.
+///
+/// $Date$
+///
+///////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef LPJ_GUESS_CAPTURE_H
+#define LPJ_GUESS_CAPTURE_H
+
+#include "inputmodule.h"
+#include <fstream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+/// Writes capture bundles for the grid cells simulated with another input module
+class CaptureInput : public InputModule {
+public:
+
+	/// Creates the decorator
+	/** \param input_module      The module supplying the forcing (takes ownership)
+	 *  \param instruction_file  The instruction file of the run
+	 *  \param directory         Existing directory in which to create the bundles
+	 *  \param cells_file        File with the coordinates (lon lat) of the grid
+	 *                           cells to capture, one per line. If empty, all
+	 *                           grid cells are captured.
+	 */
+	CaptureInput(InputModule* input_module,
+	             const std::string& instruction_file,
+	             const std::string& directory,
+	             const std::string& cells_file);
+
+	~CaptureInput();
+
+	void init();
+
+	bool getgridcell(Gridcell& gridcell);
+
+	bool getclimate(Gridcell& gridcell);
+
+	void getlandcover(Gridcell& gridcell);
+
+	void getmanagement(Gridcell& gridcell);
+
+	void set_climate_replay(bool replay) { input_module->set_climate_replay(replay); }
+
+	bool next_gridcell_coordinates(double& lon, double& lat) {
+		return input_module->next_gridcell_coordinates(lon, lat);
+	}
+
+	bool allows_forwarding() const { return input_module->allows_forwarding(); }
+
+	bool read_forcing(double lon, double lat, std::string& buffer) {
+		return input_module->read_forcing(lon, lat, buffer);
+	}
+
+	int get_gridlist_size() const { return input_module->get_gridlist_size(); }
+
+private:
+
+	/// Whether the grid cell at (lon, lat) should be captured
+	bool chosen(double lon, double lat) const;
+
+	/// Creates the bundle directory for the current grid cell and writes its files
+	void begin_bundle(const Gridcell& gridcell);
+
+	/// Calls getlandcover() or getmanagement() and records what they changed
+	void capture_input_fields(Gridcell& gridcell, int record_type);
+
+	/// The wrapped input module
+	std::auto_ptr<InputModule> input_module;
+
+	/// Instruction file of the run
+	std::string instruction_file;
+
+	/// Directory for the bundles
+	std::string directory;
+
+	/// File with the grid cells to capture
+	std::string cells_file;
+
+	/// Coordinates of the grid cells to capture, empty for all grid cells
+	std::vector<std::pair<double, double> > cells;
+
+	/// The instruction file with imported files inlined
+	std::string flat_instruction_file;
+
+	/// Directory of the bundle of the current grid cell, empty if not captured
+	std::string bundle;
+
+	/// Whether the first day of the current grid cell is still to come
+	bool first_day;
+
+	/// forcing.bin of the current grid cell
+	std::ofstream out;
+
+	/// Number of grid cells captured, for the log
+	int ncaptured;
+};
+
+/// Input module which simulates a grid cell from a capture bundle
+/** \see capture.h */
+class ReplayInput : public InputModule {
+public:
+
+	ReplayInput();
+
+	~ReplayInput();
+
+	void init();
+
+	bool getgridcell(Gridcell& gridcell);
+
+	bool getclimate(Gridcell& gridcell);
+
+	void getlandcover(Gridcell& gridcell);
+
+	void getmanagement(Gridcell& gridcell);
+
+private:
+
+	/// Reads the next record into values, returns its type
+	int read_record();
+
+	/// Fails if a record isn't of the type expected from the simulation
+	void expect_record(int record_type, int expected) const;
+
+	/// Sets the fields recorded by getlandcover() or getmanagement() in the capture
+	void replay_input_fields(Gridcell& gridcell, int record_type);
+
+	/// forcing.bin of the bundle
+	std::string filename;
+
+	std::ifstream in;
+
+	/// Whether the grid cell has been handed out
+	bool done;
+
+	/// Values of the last record read
+	std::vector<double> values;
+
+	/// The other input modules, only created to declare their parameters
+	std::vector<InputModule*> declaring_modules;
+};
+
+#endif // LPJ_GUESS_CAPTURE_H
@@ -26,7 +26,10 @@ std::string tolower(const char* str) {
 CommandLineArguments::CommandLineArguments(int argc, char** argv) 
 : help(false),
   parallel(false),
-  input_module("cru_ncep") {
+  migrate(false),
+  input_module("cru_ncep"),
+  numa_policy(GuessNuma::NUMA_NONE),
+  io_processes(0) {
 
 	driver_file = "";
 
@@ -51,6 +54,9 @@ bool CommandLineArguments::parse_arguments(int argc, char** argv) {
 			else if (option == "-parallel") {
 				parallel = true;
 			}
+			else if (option == "-migrate") {
+				migrate = true;
+			}
 			else if (option == "-input") {
 				if (i+1 < argc) {
 					std::string module = tolower(argv[i + 1]);
@@ -76,6 +82,73 @@ bool CommandLineArguments::parse_arguments(int argc, char** argv) {
 					return false;
 				}
 			}
+			else if (option == "-numa") {
+				if (i+1 < argc) {
+					if (!GuessNuma::parse_policy(argv[i + 1], numa_policy)) {
+						fprintf(stderr, "Unknown NUMA placement policy: \"%s\"\n", argv[i + 1]);
+						return false;
+					}
+					++i; // skip the next argument
+				}
+				else {
+					fprintf(stderr, "Missing argument after -numa\n");
+					return false;
+				}
+			}
+			else if (option == "-numa-nodes") {
+				if (i+1 < argc) {
+					numa_topology = argv[i + 1];
+					++i; // skip the next argument
+				}
+				else {
+					fprintf(stderr, "Missing argument after -numa-nodes\n");
+					return false;
+				}
+			}
+			else if (option == "-forcing-cache") {
+				if (i+1 < argc) {
+					forcing_cache = argv[i + 1];
+					++i; // skip the next argument
+				}
+				else {
+					fprintf(stderr, "Missing directory after -forcing-cache\n");
+					return false;
+				}
+			}
+			else if (option == "-capture") {
+				if (i+1 < argc) {
+					capture = argv[i + 1];
+					++i; // skip the next argument
+				}
+				else {
+					fprintf(stderr, "Missing directory after -capture\n");
+					return false;
+				}
+			}
+			else if (option == "-capture-cells") {
+				if (i+1 < argc) {
+					capture_cells = argv[i + 1];
+					++i; // skip the next argument
+				}
+				else {
+					fprintf(stderr, "Missing file name after -capture-cells\n");
+					return false;
+				}
+			}
+			else if (option == "-io-procs") {
+				if (i+1 < argc) {
+					io_processes = atoi(argv[i + 1]);
+					if (io_processes < 0) {
+						fprintf(stderr, "Invalid number of I/O processes: \"%s\"\n", argv[i + 1]);
+						return false;
+					}
+					++i; // skip the next argument
+				}
+				else {
+					fprintf(stderr, "Missing number after -io-procs\n");
+					return false;
+				}
+			}
 			else {
 				fprintf(stderr, "Unknown option: \"%s\"\n", argv[i]);
 				return false;
@@ -103,7 +176,7 @@ bool CommandLineArguments::parse_arguments(int argc, char** argv) {
 }
 
 void CommandLineArguments::print_usage(const char* command_name) const {
-	fprintf(stderr, "\nUsage: %s [-parallel] [-input <module_name> [<GetClim-driver-file-path>] ] <instruction-script-filename> | -help\n", 
+	fprintf(stderr, "\nUsage: %s [-parallel [-migrate] [-io-procs <n>]] [-input <module_name> [<GetClim-driver-file-path>] ] [-numa none|compact|spread|node [-numa-nodes <cpulist>;<cpulist>...]] [-forcing-cache <directory>] [-capture <directory> [-capture-cells <file>]] <instruction-script-filename> | -help\n", 
 			  command_name);
 	exit(EXIT_FAILURE);
 }
@@ -116,6 +189,10 @@ bool CommandLineArguments::get_parallel() const {
 	return parallel;
 }
 
+bool CommandLineArguments::get_migrate() const {
+	return migrate;
+}
+
 const char* CommandLineArguments::get_instruction_file() const {
 	return insfile.c_str();
 }
@@ -127,3 +204,27 @@ const char* CommandLineArguments::get_input_module() const {
 const char* CommandLineArguments::get_driver_file() const {
 	return driver_file.c_str();
 }
+
+GuessNuma::numapolicytype CommandLineArguments::get_numa_policy() const {
+	return numa_policy;
+}
+
+const char* CommandLineArguments::get_numa_topology() const {
+	return numa_topology.c_str();
+}
+
+const char* CommandLineArguments::get_forcing_cache() const {
+	return forcing_cache.c_str();
+}
+
+const char* CommandLineArguments::get_capture() const {
+	return capture.c_str();
+}
+
+const char* CommandLineArguments::get_capture_cells() const {
+	return capture_cells.c_str();
+}
+
+int CommandLineArguments::get_io_processes() const {
+	return io_processes;
+}
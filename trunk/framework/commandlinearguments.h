@@ -10,6 +10,7 @@
 #define LPJ_GUESS_COMMAND_LINE_ARGUMENTS_H
 
 #include <string>
+#include "numaplacement.h"
 
 /// Parses and stores the user's command line arguments
 class CommandLineArguments {
@@ -29,12 +30,33 @@ public:
 	/// Returns true if the user has specified the parallel option
 	bool get_parallel() const;
 
+	/// Returns true if grid cells may migrate between processes in a parallel run
+	bool get_migrate() const;
+
 	/// Returns the chosen (or default) input module
 	const char* get_input_module() const;
 
 	/// Returns path to a GetClim-generated driver file if the 'getclim' input module was requested
 	const char* get_driver_file() const;
 
+	/// Returns the chosen NUMA placement policy (NUMA_NONE unless -numa is used)
+	GuessNuma::numapolicytype get_numa_policy() const;
+
+	/// Returns the user specified NUMA topology, empty if it should be discovered
+	const char* get_numa_topology() const;
+
+	/// Returns the forcing cache directory, empty if forcing shouldn't be cached
+	const char* get_forcing_cache() const;
+
+	/// Returns the directory for capture bundles, empty if no grid cells should be captured
+	const char* get_capture() const;
+
+	/// Returns the file listing the grid cells to capture, empty for all grid cells
+	const char* get_capture_cells() const;
+
+	/// Returns the number of processes per node reading forcing for the others, 0 if none
+	int get_io_processes() const;
+
 private:
 	/// Does the actual parsing of the arguments
 	bool parse_arguments(int argc, char** argv);
@@ -51,11 +73,32 @@ private:
 	/// Whether the user requested a parallel run
 	bool parallel;
 
+	/// Whether the user allowed grid cell migration between processes
+	bool migrate;
+
 	/// The chosen (or default) input module
 	std::string input_module;
 
 	/// Driver file name for GetClim input module
 	std::string driver_file;
+
+	/// NUMA placement policy for this process
+	GuessNuma::numapolicytype numa_policy;
+
+	/// NUMA topology specification (see GuessNuma::parse_topology)
+	std::string numa_topology;
+
+	/// Directory for the forcing replay cache
+	std::string forcing_cache;
+
+	/// Directory for capture bundles
+	std::string capture;
+
+	/// File with the grid cells to capture
+	std::string capture_cells;
+
+	/// Number of I/O forwarding processes per node
+	int io_processes;
 };
 
 #endif // LPJ_GUESS_COMMAND_LINE_ARGUMENTS_H
@@ -51,6 +51,11 @@ template <class T> inline T min(const T& a, const T& b) {
 using std::min;
 using std::max;
 
+// Iteration counters for the iterative solvers of the model, written to the
+// solver statistics output files (see solverstats.h). Uncomment to enable,
+// or define SOLVER_STATISTICS on the compiler command line.
+//#define SOLVER_STATISTICS
+
 // platform independent function for changing working directory
 // we'll call our new function change_directory
 #ifdef _MSC_VER
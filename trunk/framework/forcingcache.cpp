@@ -0,0 +1,411 @@
+///////////////////////////////////////////////////////////////////////////////////////
+/// \file forcingcache.cpp
+/// \brief Input module decorator which records and replays prepared daily forcing
+///
+/// $Date$
+///
+///////////////////////////////////////////////////////////////////////////////////////
+
+#include "config.h"
+#include "forcingcache.h"
+#include "guess.h"
+#include "guessstring.h"
+#include "parameters.h"
+#include "parallel.h"
+
+#include <sys/stat.h>
+#include <stdio.h>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+/// Identifies cache files and their layout, change when the layout changes
+const char MAGIC[8] = { 'L', 'P', 'J', 'G', 'F', 'C', '0', '1' };
+
+/// Number of values stored per day before the sub-daily values
+const int NFIXED = 17;
+
+/// Files up to this size (bytes) are included in the key by content
+const long MAX_HASHED_FILE_SIZE = 1 << 20;
+
+/// 64-bit FNV-1a hash
+class Hash {
+public:
+	Hash() : value(14695981039346656037ULL) {}
+
+	void add(const char* data, size_t size) {
+		for (size_t i = 0; i < size; i++) {
+			value ^= (unsigned char)data[i];
+			value *= 1099511628211ULL;
+		}
+	}
+
+	void add(const std::string& str) {
+		add(str.c_str(), str.size() + 1); // include terminator as separator
+	}
+
+	std::string hex() const {
+		return format_string("%016llx", value);
+	}
+
+private:
+	unsigned long long value;
+};
+
+/// Adds size, modification time and, for small files, the content of a file
+void add_file_to_hash(Hash& hash, const std::string& filename) {
+	struct stat info;
+	if (stat(filename.c_str(), &info) != 0 || !(info.st_mode & S_IFREG)) {
+		return;
+	}
+
+	hash.add(format_string("%ld:%ld", (long)info.st_size, (long)info.st_mtime));
+
+	if (info.st_size <= MAX_HASHED_FILE_SIZE) {
+		std::ifstream in(filename.c_str(), std::ios::binary);
+		char buf[4096];
+		while (in.read(buf, sizeof(buf)) || in.gcount() > 0) {
+			hash.add(buf, (size_t)in.gcount());
+		}
+	}
+}
+
+/// Whether a param names the grid list (file_gridlist, file_gridlist_cf)
+bool is_gridlist_param(Paramtype& p) {
+	return std::string((char*)p.name).compare(0, 13, "file_gridlist") == 0;
+}
+
+}
+
+ForcingCacheInput::ForcingCacheInput(InputModule* input_module,
+                                     const std::string& input_module_name,
+                                     const std::string& directory)
+	: input_module(input_module),
+	  input_module_name(input_module_name),
+	  directory(directory),
+	  replaying(false),
+	  lon(0.0),
+	  lat(0.0),
+	  position(0),
+	  nreplayed(0),
+	  nrecorded(0) {
+}
+
+ForcingCacheInput::~ForcingCacheInput() {
+	if (!key.empty()) {
+		dprintf("Forcing cache: %d grid cell(s) replayed, %d recorded\n",
+		        nreplayed, nrecorded);
+	}
+}
+
+void ForcingCacheInput::init() {
+	input_module->init();
+
+	key = make_key();
+
+	dprintf("Forcing cache: %s (key %s)\n", directory.c_str(), key.c_str());
+}
+
+std::string ForcingCacheInput::make_key() const {
+
+	Hash hash;
+
+	hash.add(std::string(MAGIC, sizeof(MAGIC)));
+	hash.add(to_lower(input_module_name));
+
+	// Global settings which change the forcing or the days it covers
+	hash.add(format_string("nyear_spinup=%d", nyear_spinup));
+	hash.add(format_string("weathergenerator=%d", (int)weathergenerator));
+	hash.add(format_string("ifbvoc=%d", (int)ifbvoc));
+	hash.add(format_string("randomseed=%d", randomseed));
+	hash.add(format_string("restart=%d state_year=%d", (int)restart, restart ? state_year : 0));
+
+	// Analog spinup skips spinup years depending on the grid cells before
+	hash.add(format_string("ifanalogspinup=%d", (int)ifanalogspinup));
+	if (ifanalogspinup) {
+		hash.add(format_string("analog_spinup_years=%d analog_max_distance=%.17g analog_spinup_tol=%.17g analog_library_size=%d",
+		                       analog_spinup_years, analog_max_distance, analog_spinup_tol, analog_library_size));
+	}
+
+	// The custom params hold the names of all input files. The grid list only
+	// decides which cache files are used.
+	std::vector<std::string> params;
+	param.firstobj();
+	while (param.isobj) {
+		Paramtype& p = param.getobj();
+		if (is_gridlist_param(p)) {
+			param.nextobj();
+			continue;
+		}
+		if (p.str != "") {
+			params.push_back(std::string((char*)p.name) + "=\"" + (char*)p.str + "\"");
+		}
+		else {
+			params.push_back(std::string((char*)p.name) + "=" + format_string("%.17g", p.num));
+		}
+		param.nextobj();
+	}
+	std::sort(params.begin(), params.end());
+
+	for (size_t i = 0; i < params.size(); i++) {
+		hash.add(params[i]);
+	}
+
+	param.firstobj();
+	while (param.isobj) {
+		Paramtype& p = param.getobj();
+		if (p.str != "" && !is_gridlist_param(p)) {
+			add_file_to_hash(hash, (char*)p.str);
+		}
+		param.nextobj();
+	}
+
+	return hash.hex();
+}
+
+std::string ForcingCacheInput::cache_file(double lon, double lat) const {
+	return format_string("%s/%s_%g_%g.frc", directory.c_str(), key.c_str(), lon, lat);
+}
+
+bool ForcingCacheInput::getgridcell(Gridcell& gridcell) {
+
+	// If the module tells which grid cell comes next, it needn't prepare
+	// the climate of a grid cell in the cache
+	double next_lon, next_lat;
+	replaying = false;
+	if (input_module->next_gridcell_coordinates(next_lon, next_lat)) {
+		current_file = cache_file(next_lon, next_lat);
+		replaying = read_cache(current_file);
+	}
+	position = 0;
+
+	input_module->set_climate_replay(replaying);
+
+	if (!input_module->getgridcell(gridcell)) {
+		return false;
+	}
+
+	if (!replaying) {
+		current_file = cache_file(gridcell.get_lon(), gridcell.get_lat());
+		replaying = read_cache(current_file);
+	}
+
+	if (replaying) {
+		if (gridcell.get_lon() != lon || gridcell.get_lat() != lat) {
+			fail("Forcing cache file %s is for (%g,%g), not (%g,%g).\n"
+			     "Remove the cache files with key %s and rerun.\n",
+			     current_file.c_str(), lon, lat, gridcell.get_lon(), gridcell.get_lat(),
+			     key.c_str());
+		}
+		dprintf("Replaying climate from forcing cache\n");
+		nreplayed++;
+	}
+	else {
+		lon = gridcell.get_lon();
+		lat = gridcell.get_lat();
+		stream.clear();
+	}
+
+	return true;
+}
+
+bool ForcingCacheInput::getclimate(Gridcell& gridcell) {
+
+	// The wrapped module decides when the grid cell is done. When replaying
+	// it only does its bookkeeping, the climate comes from the cache.
+	long seed = gridcell.seed;
+	bool more = input_module->getclimate(gridcell);
+
+	if (replaying) {
+		if (!more) {
+			if (position != stream.size()) {
+				fail("Forcing cache file %s has more days than the simulation period\n",
+				     current_file.c_str());
+			}
+			return false;
+		}
+		if (position >= stream.size()) {
+			fail("Forcing cache file %s ends before the simulation period\n",
+			     current_file.c_str());
+		}
+		if (!replay_forcing_day(stream, position, gridcell)) {
+			fail("Forcing cache file %s is truncated or out of step with the simulation (year %d, day %d)\n",
+			     current_file.c_str(), date.year, date.day);
+		}
+	}
+	else {
+		if (!more) {
+			write_cache(current_file);
+			nrecorded++;
+			return false;
+		}
+		record_forcing_day(stream, gridcell, seed != gridcell.seed);
+	}
+
+	return true;
+}
+
+void ForcingCacheInput::getlandcover(Gridcell& gridcell) {
+	input_module->getlandcover(gridcell);
+}
+
+void ForcingCacheInput::getmanagement(Gridcell& gridcell) {
+	input_module->getmanagement(gridcell);
+}
+
+void record_forcing_day(std::vector<double>& stream, const Gridcell& gridcell, bool seed_used) {
+
+	const Climate& climate = gridcell.climate;
+
+	// Fixed part, NFIXED values
+	stream.push_back(date.year);
+	stream.push_back(date.day);
+	stream.push_back(climate.temp);
+	stream.push_back(climate.prec);
+	stream.push_back(climate.insol);
+	stream.push_back(climate.dtr);
+	stream.push_back(climate.co2);
+	stream.push_back(climate.relhum);
+	stream.push_back(climate.u10);
+	stream.push_back(climate.tmin);
+	stream.push_back(climate.tmax);
+	stream.push_back(climate.distprob);
+	stream.push_back(gridcell.dNH4dep);
+	stream.push_back(gridcell.dNO3dep);
+
+	// Weather generators draw from the grid cell's random number stream,
+	// which must be left as in the recording run
+	stream.push_back(seed_used);
+	stream.push_back(gridcell.seed);
+
+	// Sub-daily values in diurnal mode
+	size_t nsub = date.diurnal() ? climate.temps.size() : 0;
+	stream.push_back((double)nsub);
+	for (size_t i = 0; i < nsub; i++) {
+		stream.push_back(climate.temps[i]);
+	}
+	for (size_t i = 0; i < nsub; i++) {
+		stream.push_back(climate.insols[i]);
+	}
+}
+
+bool replay_forcing_day(const std::vector<double>& stream, size_t& position, Gridcell& gridcell) {
+
+	Climate& climate = gridcell.climate;
+
+	if (position > stream.size() || stream.size() - position < (size_t)NFIXED) {
+		return false;
+	}
+
+	const double* day = &stream[position];
+
+	if ((int)day[0] != date.year || (int)day[1] != date.day) {
+		return false;
+	}
+
+	size_t nsub = (size_t)day[16];
+	if (stream.size() - position - NFIXED < 2*nsub) {
+		return false;
+	}
+
+	climate.temp     = day[2];
+	climate.prec     = day[3];
+	climate.insol    = day[4];
+	climate.dtr      = day[5];
+	climate.co2      = day[6];
+	climate.relhum   = day[7];
+	climate.u10      = day[8];
+	climate.tmin     = day[9];
+	climate.tmax     = day[10];
+	climate.distprob = day[11];
+	gridcell.dNH4dep = day[12];
+	gridcell.dNO3dep = day[13];
+
+	if (day[14]) {
+		gridcell.seed = (long)day[15];
+	}
+
+	position += NFIXED;
+
+	if (nsub) {
+		climate.temps.assign(stream.begin() + position, stream.begin() + position + nsub);
+		position += nsub;
+		climate.insols.assign(stream.begin() + position, stream.begin() + position + nsub);
+		position += nsub;
+	}
+
+	return true;
+}
+
+bool ForcingCacheInput::read_cache(const std::string& filename) {
+
+	std::ifstream in(filename.c_str(), std::ios::binary);
+	if (!in) {
+		return false;
+	}
+
+	char magic[sizeof(MAGIC)];
+	unsigned long long nvalues = 0;
+
+	in.read(magic, sizeof(magic));
+	in.read((char*)&lon, sizeof(lon));
+	in.read((char*)&lat, sizeof(lat));
+	in.read((char*)&nvalues, sizeof(nvalues));
+
+	if (!in || !std::equal(magic, magic + sizeof(MAGIC), MAGIC)) {
+		dprintf("Ignoring unreadable forcing cache file %s\n", filename.c_str());
+		return false;
+	}
+
+	stream.resize((size_t)nvalues);
+	if (nvalues) {
+		in.read((char*)&stream.front(), (std::streamsize)(nvalues * sizeof(double)));
+	}
+
+	if (!in) {
+		dprintf("Ignoring truncated forcing cache file %s\n", filename.c_str());
+		stream.clear();
+		return false;
+	}
+
+	return true;
+}
+
+void ForcingCacheInput::write_cache(const std::string& filename) const {
+
+	// Write to a temporary file and rename, so that concurrent runs and
+	// aborted runs never leave a partial cache file behind
+	std::string tmpname = format_string("%s.%d.tmp", filename.c_str(), GuessParallel::get_rank());
+
+	{
+		std::ofstream out(tmpname.c_str(), std::ios::binary | std::ios::trunc);
+
+		unsigned long long nvalues = stream.size();
+
+		out.write(MAGIC, sizeof(MAGIC));
+		out.write((const char*)&lon, sizeof(lon));
+		out.write((const char*)&lat, sizeof(lat));
+		out.write((const char*)&nvalues, sizeof(nvalues));
+		if (nvalues) {
+			out.write((const char*)&stream.front(), (std::streamsize)(nvalues * sizeof(double)));
+		}
+
+		if (!out) {
+			dprintf("Could not write forcing cache file %s\n", tmpname.c_str());
+			out.close();
+			remove(tmpname.c_str());
+			return;
+		}
+	}
+
+	if (rename(tmpname.c_str(), filename.c_str()) != 0) {
+		// Some platforms won't rename over an existing file
+		remove(filename.c_str());
+		if (rename(tmpname.c_str(), filename.c_str()) != 0) {
+			dprintf("Could not create forcing cache file %s\n", filename.c_str());
+			remove(tmpname.c_str());
+		}
+	}
+}
@@ -0,0 +1,141 @@
+///////////////////////////////////////////////////////////////////////////////////////
+/// \file forcingcache.h
+/// \brief Input module decorator which records and replays prepared daily forcing
+///
+/// Preparing the daily forcing for a grid cell (reading the input files,
+/// calendar alignment, interpolation of monthly values, distribution of
+/// precipitation over wet days, the weather generator, nitrogen deposition)
+/// is repeated every time the same configuration is run. ForcingCacheInput
+/// wraps the input module chosen on the command line and, the first time a
+/// grid cell is simulated, records the daily climate drivers it produces to a
+/// local cache file, named after the grid cell's coordinates. Later runs with the same input configuration read the
+/// whole file at once and replay the drivers from memory, while the wrapped
+/// module is told (InputModule::set_climate_replay) that it may skip its own
+/// climate preparation.
+///
+/// The cache is keyed by the input module name, the settings which affect the
+/// forcing and all custom "param" items in the instruction file except the
+/// grid list. For params naming a file, the file size and modification time
+/// are included as well, and the content of small files. Since the cache files
+/// are named after the coordinates, runs with another grid list, a different
+/// order of grid cells or another number of processes share the cache.
+///
+/// Where the wrapped module draws random numbers (e.g. to distribute monthly
+/// precipitation over wet days), the state of the grid cell's random number
+/// stream after getclimate() is recorded too, so a replayed run reproduces
+/// the recording run exactly. Since that stream is shared with vegetation
+/// dynamics, the replayed forcing is the realisation from the recording run
+/// even if vegetation parameters have been changed since.
+///
+/// $Date$
+///
+///////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef LPJ_GUESS_FORCING_CACHE_H
+#define LPJ_GUESS_FORCING_CACHE_H
+
+#include "inputmodule.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+/// Appends today's climate drivers of a grid cell to a stream of values
+/** The layout is shared by the forcing cache and capture bundles (see
+ *  capture.h).
+ *
+ *  \param seed_used  Whether the input module drew random numbers today
+ */
+void record_forcing_day(std::vector<double>& stream, const Gridcell& gridcell, bool seed_used);
+
+/// Sets today's climate drivers of a grid cell from a stream of values
+/** \param position  Read position in stream, moved to the next day
+ *  \returns false if the stream is truncated, or isn't at today's date
+ */
+bool replay_forcing_day(const std::vector<double>& stream, size_t& position, Gridcell& gridcell);
+
+/// Records and replays the daily climate drivers of another input module
+class ForcingCacheInput : public InputModule {
+public:
+
+	/// Creates the decorator
+	/** \param input_module       The module supplying the forcing (takes ownership)
+	 *  \param input_module_name  Name of the module, part of the cache key
+	 *  \param directory          Existing directory in which to keep the cache files
+	 */
+	ForcingCacheInput(InputModule* input_module,
+	                  const std::string& input_module_name,
+	                  const std::string& directory);
+
+	~ForcingCacheInput();
+
+	void init();
+
+	bool getgridcell(Gridcell& gridcell);
+
+	bool getclimate(Gridcell& gridcell);
+
+	void getlandcover(Gridcell& gridcell);
+
+	void getmanagement(Gridcell& gridcell);
+
+	bool allows_forwarding() const { return input_module->allows_forwarding(); }
+
+	bool read_forcing(double lon, double lat, std::string& buffer) {
+		return input_module->read_forcing(lon, lat, buffer);
+	}
+
+	int get_gridlist_size() const { return input_module->get_gridlist_size(); }
+
+	/// Key identifying the input configuration (hex string, set in init())
+	const std::string& get_key() const { return key; }
+
+private:
+
+	/// Builds the cache key from the current settings
+	std::string make_key() const;
+
+	/// Cache file name for the grid cell at (lon, lat)
+	/** Named after the coordinates rather than the position in the gridlist,
+	 *  so the cache is reused whatever the order of the gridlist and the
+	 *  number of processes.
+	 */
+	std::string cache_file(double lon, double lat) const;
+
+	/// Reads a complete cache file into stream, returns false if unavailable
+	bool read_cache(const std::string& filename);
+
+	/// Writes the recorded stream for the current grid cell
+	void write_cache(const std::string& filename) const;
+
+	/// The wrapped input module
+	std::auto_ptr<InputModule> input_module;
+
+	/// Name of the wrapped module
+	std::string input_module_name;
+
+	/// Cache directory
+	std::string directory;
+
+	/// Cache key
+	std::string key;
+
+	/// Whether the current grid cell is replayed (otherwise it is recorded)
+	bool replaying;
+
+	/// Coordinates of the current grid cell as stored in the cache
+	double lon, lat;
+
+	/// Cache file of the current grid cell
+	std::string current_file;
+
+	/// Daily drivers of the current grid cell, see record_forcing_day()
+	std::vector<double> stream;
+
+	/// Read position in stream when replaying
+	size_t position;
+
+	/// Number of cells replayed and recorded, for the log
+	int nreplayed, nrecorded;
+};
+
+#endif // LPJ_GUESS_FORCING_CACHE_H
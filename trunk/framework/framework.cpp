@@ -12,12 +12,20 @@
 #include "commandlinearguments.h"
 #include "guessserializer.h"
 #include "parallel.h"
+#include "numaplacement.h"
+#include "migration.h"
+#include "analogspinup.h"
+#include "ioforwarding.h"
+#include "solverstats.h"
 
 #include "inputmodule.h"
+#include "forcingcache.h"
+#include "capture.h"
 #include "driver.h"
 #include "canexch.h"
 #include "soilwater.h"
 #include "somdynam.h"
+#include "ntransform.h"
 #include "growth.h"
 #include "vegdynam.h"
 #include "blaze.h"
@@ -46,6 +54,12 @@ void print_logfile_heading() {
 	        dashed_line.c_str(), (char*)title, dashed_line.c_str());
 }
 
+/// Position in its stand of the i'th patch to simulate
+/** Patches are simulated in reverse order with ifreversepatchorder */
+unsigned int patch_index(unsigned int i, unsigned int npatch) {
+	return ifreversepatchorder ? npatch - 1 - i : i;
+}
+
 /// Simulate one day for a given Gridcell
 /**
  * The climate object in the gridcell needs to be set up with
@@ -65,9 +79,15 @@ void simulate_day(Gridcell& gridcell, InputModule* input_module) {
 	// Update crop sowing date calculation framework
 	crop_sowing_gridcell(gridcell);
 
+	// Derived daily quantities of individuals are reused within the
+	// processes below, and invalidated after each process changing
+	// biomass, allometry or phenology
+	Individual::invalidate_all_day_caches();
+
 	// Dynamic landcover and crop fraction data during historical
 	// period and create/kill stands.
 	landcover_dynamics(gridcell, input_module);
+	Individual::invalidate_all_day_caches();
 
 	// Update dynamic management options
 	input_module->getmanagement(gridcell);
@@ -83,13 +103,16 @@ void simulate_day(Gridcell& gridcell, InputModule* input_module) {
 
 		dailyaccounting_stand(stand);
 
-		stand.firstobj();
-		while (stand.isobj) {
+		// No-stress photosynthesis used for forest-floor conditions
+		forest_floor_photosynthesis(stand, gridcell.climate);
+
+		const unsigned int nstandpatch = stand.nobj;
+		for (unsigned int i = 0; i < nstandpatch; i++) {
 
 			// START OF LOOP THROUGH PATCHES
 
 			// Get reference to this patch
-			Patch& patch = stand.getobj();
+			Patch& patch = stand[patch_index(i, nstandpatch)];
 			// Update daily soil drivers including soil temperature
 			dailyaccounting_patch(patch);
 
@@ -104,6 +127,7 @@ void simulate_day(Gridcell& gridcell, InputModule* input_module) {
 
 			// Leaf phenology for PFTs and individuals
 			leaf_phenology(patch, gridcell.climate);
+			Individual::invalidate_all_day_caches();
 
 			// Interception
 			interception(patch, gridcell.climate);
@@ -119,6 +143,7 @@ void simulate_day(Gridcell& gridcell, InputModule* input_module) {
 
 			// Daily C allocation (cropland)
 			growth_daily(patch);
+			Individual::invalidate_all_day_caches();
 
 			// Soil organic matter and litter dynamics
 			som_dynamics(patch, gridcell.climate);
@@ -136,24 +161,30 @@ void simulate_day(Gridcell& gridcell, InputModule* input_module) {
 				// updated allometry
 				growth(stand, patch);
 			}
-			stand.nextobj();
+			Individual::invalidate_all_day_caches();
 		}// End of loop through patches
 
+		// Nitrogen transformations in soil for the patches of this stand
+		ntransform_run();
+
 		// Update crop rotation status
 		crop_rotation(stand);
+		Individual::invalidate_all_day_caches();
 
 		if (date.islastday && date.islastmonth) {
 
             // LAST DAY OF YEAR
-			stand.firstobj();
-			while (stand.isobj) {
+			// Propagule pool for establishment, from all patches
+			stand_reproduction(stand);
+
+			for (unsigned int i = 0; i < nstandpatch; i++) {
 
 				// For each patch ...
-				Patch& patch = stand.getobj();
+				Patch& patch = stand[patch_index(i, nstandpatch)];
 				// Establishment, mortality and disturbance by fire
 				vegetation_dynamics(stand, patch, gridcell);
-				stand.nextobj();
 			}
+			Individual::invalidate_all_day_caches();
 		}
 
 		++gc_itr;
@@ -161,6 +192,58 @@ void simulate_day(Gridcell& gridcell, InputModule* input_module) {
 }
 
 
+/// Adds replicate patches to stands whose patch means have not converged
+/** Called at the end of each spinup year when ifadaptivenpatch is set. For
+ *  each stand with adaptive patch count, the variation coefficients of patch
+ *  C content and annual NPP give the number of patches needed for a relative
+ *  standard error of npatch_tol. Missing patches are cloned from the existing
+ *  ones in turn, at most doubling the count per year and never beyond npatch.
+ *
+ *  \param report  Whether to write the patch count of each stand to the log
+ */
+void adapt_patch_count(Gridcell& gridcell, bool report) {
+
+	Gridcell::iterator gc_itr = gridcell.begin();
+	while (gc_itr != gridcell.end()) {
+		Stand& stand = *gc_itr;
+		++gc_itr;
+
+		if (!stand.adaptive_npatch) {
+			continue;
+		}
+
+		const int n = stand.npatch();
+		std::vector<double> cmass(n), anpp(n);
+
+		for (int p = 0; p < n; p++) {
+			Patch& patch = stand[p];
+			cmass[p] = patch.ccont();
+			anpp[p] = 0.0;
+
+			Vegetation& vegetation = patch.vegetation;
+			vegetation.firstobj();
+			while (vegetation.isobj) {
+				anpp[p] += vegetation.getobj().anpp;
+				vegetation.nextobj();
+			}
+		}
+
+		double cv = max(variation_coefficient(&cmass.front(), n),
+		                variation_coefficient(&anpp.front(), n));
+
+		int needed = min(min(sample_size(cv, npatch_tol), 2 * n), npatch);
+
+		for (int p = n; p < needed; p++) {
+			stand.clone_patch(p % n);
+		}
+
+		if (report) {
+			dprintf("Adaptive patch count: stand %d has %d patches (relative standard error %.4f)\n",
+			        stand.id, (int)stand.npatch(), cv / sqrt((double)n));
+		}
+	}
+}
+
 int framework(const CommandLineArguments& args) {
 
 	// The 'mission control' of the model, responsible for maintaining the
@@ -169,10 +252,29 @@ int framework(const CommandLineArguments& args) {
 
 	using std::auto_ptr;
 
+	// Place this process on its NUMA node before anything large is allocated,
+	// so that input buffers and grid cells are first-touched locally
+	GuessNuma::init(args.get_numa_policy(), args.get_numa_topology());
+
 	const char* input_module_name = args.get_input_module();
 
 	auto_ptr<InputModule> input_module(InputModuleRegistry::get_instance().create_input_module(input_module_name));
 
+	// Optionally record/replay the prepared daily forcing in a local cache
+	if (*args.get_forcing_cache()) {
+		input_module = auto_ptr<InputModule>(new ForcingCacheInput(input_module.release(),
+		                                                           input_module_name,
+		                                                           args.get_forcing_cache()));
+	}
+
+	// Optionally write capture bundles to replay grid cells offline
+	if (*args.get_capture()) {
+		input_module = auto_ptr<InputModule>(new CaptureInput(input_module.release(),
+		                                                      args.get_instruction_file(),
+		                                                      args.get_capture(),
+		                                                      args.get_capture_cells()));
+	}
+
 	GuessOutput::OutputModuleContainer output_modules;
 	GuessOutput::OutputModuleRegistry::get_instance().create_all_modules(output_modules);
 
@@ -183,10 +285,20 @@ int framework(const CommandLineArguments& args) {
 	// Initialise input/output
 
 	input_module->init();
+
+	// Optionally let some processes read the forcing for the others
+	IOForwarding::init(args.get_io_processes(), *input_module);
+	if (IOForwarding::is_io_process()) {
+		IOForwarding::serve(*input_module);
+		return 0;
+	}
+
 	output_modules.init();
 
 	print_logfile_heading();
 
+	GuessNuma::report();
+
 	// Nitrogen limitation
 	if (ifnlim && !ifcentury) {
 		fail("\n\nIf nitrogen limitation is switched on then century soil module also needs to be switched on!");
@@ -209,30 +321,75 @@ int framework(const CommandLineArguments& args) {
 		deserializer = auto_ptr<GuessDeserializer>(new GuessDeserializer(state_path));
 	}
 
+	// Grid cells may move to idle processes at year boundaries
+	bool migrate = args.get_migrate();
+	if (migrate) {
+		if (GuessParallel::get_num_processes() < 2) {
+			dprintf("WARNING ! Grid cell migration needs a parallel run with more than one process\n");
+			migrate = false;
+		}
+		else if (!input_module->allows_migration()) {
+			dprintf("WARNING ! Input module %s doesn't support grid cell migration with the current settings\n",
+			        input_module_name);
+			migrate = false;
+		}
+		else if (printseparatestands) {
+			dprintf("WARNING ! Grid cell migration is not possible with printseparatestands\n");
+			migrate = false;
+		}
+		else if (args.get_io_processes() > 0) {
+			dprintf("WARNING ! Grid cell migration is not possible with I/O forwarding\n");
+			migrate = false;
+		}
+	}
+
+	GridcellMigration migration(migrate, *input_module);
+
+	// Grid cells may start their spinup from the state of a climate analog
+	if (ifanalogspinup && *args.get_capture()) {
+		dprintf("WARNING ! Analog spinup is not possible when capturing grid cells, disabled\n");
+		ifanalogspinup = false;
+	}
+
+	AnalogSpinup analog_spinup(ifanalogspinup);
+
+	bool own_gridcells_left = true;
+
 	while (true) {
 
 		// START OF LOOP THROUGH GRID CELLS
 
 		// Initialise global variable date
-		// (argument nyear not used in this implementation)
-		date.init(1);
+		// (the number of years only sets islastyear, the input module
+		// decides when the simulation of the grid cell ends)
+		date.init(input_module->get_simulation_years());
 
 		// Create and initialise a new Gridcell object for each locality
 		Gridcell gridcell;
 
-		// Call input module to obtain latitude and driver data for this grid cell.
-		if (!input_module->getgridcell(gridcell)) {
-			break;
+		// Call input module to obtain latitude and driver data for this grid cell,
+		// once the gridlist is done, ask the other processes for one
+		bool migrated = false;
+		if (own_gridcells_left && !input_module->getgridcell(gridcell)) {
+			own_gridcells_left = false;
+		}
+		if (!own_gridcells_left) {
+			if (!migration.receive(gridcell)) {
+				break;
+			}
+			migrated = true;
 		}
 
-		// Initialise certain climate and soil drivers
-		gridcell.climate.initdrivers(gridcell.get_lat());
+		if (!migrated) {
+			// Initialise certain climate and soil drivers
+			gridcell.climate.initdrivers(gridcell.get_lat());
 
-		// Read landcover and cft fraction data from 
-		// data files for the spinup period and create stands
-		landcover_init(gridcell, input_module.get());
+			// Read landcover and cft fraction data from
+			// data files for the spinup period and create stands
+			landcover_init(gridcell, input_module.get());
+		}
 
-		if (restart) {
+		if (restart && !migrated) {
 			// Get the whole grid cell from file...
 			deserializer->deserialize_gridcell(gridcell);
 			// ...and jump to the restart year
@@ -241,6 +398,8 @@ int framework(const CommandLineArguments& args) {
             // Add randomseed to gridcell, otherwise old seed from state file is used
             gridcell.seed = randomseed;
 
+			gridcell.resume_year = state_year;
+
 		}
 
 
@@ -248,6 +407,10 @@ int framework(const CommandLineArguments& args) {
 		// day of the simulation. Function getclimate returns false if last year
 		// has already been simulated for this grid cell
 
+		bool sent = false;
+
+		analog_spinup.begin_gridcell(!restart && !migrated);
+
 		while (input_module->getclimate(gridcell)) {
 
 			// START OF LOOP THROUGH SIMULATION DAYS
@@ -258,6 +421,8 @@ int framework(const CommandLineArguments& args) {
 
 			output_modules.outdaily(gridcell);
 
+			analog_spinup.day(gridcell);
+
 			if (date.islastday && date.islastmonth) {
 				// LAST DAY OF YEAR
 				if(printseparatestands)
@@ -265,14 +430,30 @@ int framework(const CommandLineArguments& args) {
 				// Call output module to output results for end of year
 				// or end of simulation for this grid cell
 				output_modules.outannual(gridcell);
+				SolverStats::end_of_year();
 
 				gridcell.balance.check_year(gridcell);
 
+				// Replicate patches where needed, patch counts are fixed
+				// from the end of the spinup on
+				if (ifadaptivenpatch && date.year < nyear_spinup) {
+					adapt_patch_count(gridcell, date.year == nyear_spinup - 1);
+				}
+
+				// Seed from a climate analog, or repeat the adjustment to it
+				analog_spinup.end_of_year(gridcell);
+
 				// Time to save state?
 				if (date.year == state_year-1 && save_state) {
 					serializer->serialize_gridcell(gridcell);
 				}
 
+				// Hand the grid cell over to an idle process?
+				if (migration.end_of_year(gridcell, !migrated)) {
+					sent = true;
+					break;
+				}
+
 				// Check whether to abort
 				if (abort_request_received()) {
 					return 99;
@@ -285,6 +466,11 @@ int framework(const CommandLineArguments& args) {
 			// End of loop through simulation days
 		}	//while (getclimate())
 
+		// The rest of the simulation is done by another process
+		if (sent) {
+			continue;
+		}
+
 		if(printseparatestands)
 			output_modules.closelocalfiles(gridcell);
 
@@ -294,5 +480,14 @@ int framework(const CommandLineArguments& args) {
 
 	// END OF SIMULATION
 
+	IOForwarding::finish();
+
+	SolverStats::report();
+
+	if (migrate) {
+		dprintf("Grid cell migration: %d sent to and %d received from other processes\n",
+		        migration.get_nsent(), migration.get_nreceived());
+	}
+
 	return 0;
 }
@@ -34,6 +34,49 @@ const double Fluxes::NOx_FIRERATIO = 0.237;
 const double Fluxes::N2O_FIRERATIO = 0.036;
 const double Fluxes::N2_FIRERATIO  = 0.722;
 
+namespace {
+
+/// Reads past the state of a PFT which isn't in pftlist any more
+void skip_removed_pft(ArchiveStream& arch) {
+	if (!arch.can_skip()) {
+		throw ArchiveError("PFTs can't be removed when restarting from an untagged state file");
+	}
+	arch.skip_object();
+}
+
+/// Reads or writes the per-PFT objects of a Gridcell, Stand or Patch
+/** When reading, objects are created for all PFTs in pftlist. PFTs in the
+ *  state file are mapped to pftlist by name (see ArchiveStream::set_pft_map),
+ *  PFTs which aren't in the state file keep their initial state.
+ */
+template<class T>
+void serialize_pfts(ArchiveStream& arch, ListArray_idin1<T, Pft>& pfts) {
+	if (arch.save()) {
+		for (unsigned int i = 0; i < pfts.nobj; i++) {
+			arch & archive_field("pft", pfts[i]);
+		}
+	}
+	else {
+		pfts.killall();
+		for (unsigned int i = 0; i < pftlist.nobj; i++) {
+			pfts.createobj(pftlist[i]);
+		}
+
+		const int stored_npft = arch.stored_npft(pftlist.nobj);
+		for (int i = 0; i < stored_npft; i++) {
+			const int current = arch.current_pft(i);
+			if (current >= 0) {
+				arch & archive_field("pft", pfts[current]);
+			}
+			else {
+				skip_removed_pft(arch);
+			}
+		}
+	}
+}
+
+}
+
 
 ////////////////////////////////////////////////////////////////////////////////
 // Implementation of PhotosynthesisResult member functions
@@ -41,13 +84,13 @@ const double Fluxes::N2_FIRERATIO  = 0.722;
 
 
 void PhotosynthesisResult::serialize(ArchiveStream& arch) {
-	arch & agd_g
-		& adtmm
-		& rd_g
-		& vm
-		& je
-		& nactive_opt
-		& vmaxnlim;
+	arch & STATE_FIELD(agd_g)
+		& STATE_FIELD(adtmm)
+		& STATE_FIELD(rd_g)
+		& STATE_FIELD(vm)
+		& STATE_FIELD(je)
+		& STATE_FIELD(nactive_opt)
+		& STATE_FIELD(vmaxnlim);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -55,91 +98,91 @@ void PhotosynthesisResult::serialize(ArchiveStream& arch) {
 ////////////////////////////////////////////////////////////////////////////////
 
 void Climate::serialize(ArchiveStream& arch) {
-	arch & temp
-		& rad
-		& par
-		& prec
-		& aprec
-		& aprec_lastyear
-		& daylength
-		& co2
-        & distprob
-		& lat
-		& insol
-		& instype
-		& eet
-		& mtemp
-		& mtemp_min20
-		& mtemp_max20
-		& mtemp_max
-		& gdd5
-		& gdd0
-		& agdd5
-		& agdd0
-		& agdd0_20
-		& chilldays
-		& ifsensechill
-		& gtemp
-		& dtemp_31
-		& dprec_31
-		& deet_31
-		& mtemp_min_20
-		& mtemp_max_20
-		& mtemp_min
-		& atemp_mean
-		& sinelat
-		& cosinelat
-		& qo & u & v & hh & sinehh
-		& daylength_save
-		& doneday
-		& dprec_10
-		& sprec_2
-		& maxtemp
-		& mtemp_20
-		& mprec_20
-		& mpet_20
-		& mprec_pet_20
-		& mprec_petmin_20
-		& mprec_petmax_20
-		& mtemp20
-		& mprec20
-		& mpet20
-		& mprec_pet20
-		& mprec_petmin20
-		& mprec_petmax20
-		& hmtemp_20
-		& hmprec_20
-		& hmeet_20
-		& seasonality
-		& seasonality_lastyear
-		& prec_seasonality
-		& prec_seasonality_lastyear
-		& prec_range
-		& prec_range_lastyear
-		& temp_seasonality
-		& temp_seasonality_lastyear
-		& var_prec
-		& var_temp
-		& aprec
-		& rainfall_annual_avg
-		& last_rainfall
-		& days_since_last_rainfall
-		& kbdi
-		& ffdi_monthly
-		& weathergenstate;
+	arch & STATE_FIELD(temp)
+		& STATE_FIELD(rad)
+		& STATE_FIELD(par)
+		& STATE_FIELD(prec)
+		& STATE_FIELD(aprec)
+		& STATE_FIELD(aprec_lastyear)
+		& STATE_FIELD(daylength)
+		& STATE_FIELD(co2)
+        & STATE_FIELD(distprob)
+		& STATE_FIELD(lat)
+		& STATE_FIELD(insol)
+		& STATE_FIELD(instype)
+		& STATE_FIELD(eet)
+		& STATE_FIELD(mtemp)
+		& STATE_FIELD(mtemp_min20)
+		& STATE_FIELD(mtemp_max20)
+		& STATE_FIELD(mtemp_max)
+		& STATE_FIELD(gdd5)
+		& STATE_FIELD(gdd0)
+		& STATE_FIELD(agdd5)
+		& STATE_FIELD(agdd0)
+		& STATE_FIELD(agdd0_20)
+		& STATE_FIELD(chilldays)
+		& STATE_FIELD(ifsensechill)
+		& STATE_FIELD(gtemp)
+		& STATE_FIELD(dtemp_31)
+		& STATE_FIELD(dprec_31)
+		& STATE_FIELD(deet_31)
+		& STATE_FIELD(history->mtemp_min_20)
+		& STATE_FIELD(history->mtemp_max_20)
+		& STATE_FIELD(mtemp_min)
+		& STATE_FIELD(atemp_mean)
+		& STATE_FIELD(sinelat)
+		& STATE_FIELD(cosinelat)
+		& STATE_FIELD(qo) & STATE_FIELD(u) & STATE_FIELD(v) & STATE_FIELD(hh) & STATE_FIELD(sinehh)
+		& STATE_FIELD(daylength_save)
+		& STATE_FIELD(doneday)
+		& STATE_FIELD(dprec_10)
+		& STATE_FIELD(sprec_2)
+		& STATE_FIELD(maxtemp)
+		& STATE_FIELD(history->mtemp_20)
+		& STATE_FIELD(history->mprec_20)
+		& STATE_FIELD(history->mpet_20)
+		& STATE_FIELD(history->mprec_pet_20)
+		& STATE_FIELD(history->mprec_petmin_20)
+		& STATE_FIELD(history->mprec_petmax_20)
+		& STATE_FIELD(mtemp20)
+		& STATE_FIELD(mprec20)
+		& STATE_FIELD(mpet20)
+		& STATE_FIELD(mprec_pet20)
+		& STATE_FIELD(mprec_petmin20)
+		& STATE_FIELD(mprec_petmax20)
+		& STATE_FIELD(history->hmtemp_20)
+		& STATE_FIELD(history->hmprec_20)
+		& STATE_FIELD(history->hmeet_20)
+		& STATE_FIELD(seasonality)
+		& STATE_FIELD(seasonality_lastyear)
+		& STATE_FIELD(prec_seasonality)
+		& STATE_FIELD(prec_seasonality_lastyear)
+		& STATE_FIELD(prec_range)
+		& STATE_FIELD(prec_range_lastyear)
+		& STATE_FIELD(temp_seasonality)
+		& STATE_FIELD(temp_seasonality_lastyear)
+		& STATE_FIELD(var_prec)
+		& STATE_FIELD(var_temp)
+		& STATE_FIELD(aprec)
+		& STATE_FIELD(rainfall_annual_avg)
+		& STATE_FIELD(last_rainfall)
+		& STATE_FIELD(days_since_last_rainfall)
+		& STATE_FIELD(kbdi)
+		& STATE_FIELD(ffdi_monthly)
+		& STATE_FIELD(weathergenstate);
 }
 
 void WeatherGenState::serialize(ArchiveStream& arch) {
 
-	arch & carry
-		& xcng
-		& xs
-		& indx
-		& have
-		& gamma_vals
-		& pday
-		& resid
-		& q;
+	arch & STATE_FIELD(carry)
+		& STATE_FIELD(xcng)
+		& STATE_FIELD(xs)
+		& STATE_FIELD(indx)
+		& STATE_FIELD(have)
+		& STATE_FIELD(gamma_vals)
+		& STATE_FIELD(pday)
+		& STATE_FIELD(resid)
+		& STATE_FIELD(q);
 
 }
 
@@ -149,11 +192,16 @@ void WeatherGenState::serialize(ArchiveStream& arch) {
 
 Fluxes::Fluxes(Patch& p)
   : patch(p),
-    annual_fluxes_per_pft(npft, std::vector<double>(NPERPFTFLUXTYPES)) {
+    annual_fluxes_per_pft(npft, std::vector<double>(NPERPFTFLUXTYPES)),
+    daily_fluxes(new DailyFluxes) {
 
 	reset();
 }
 
+Fluxes::~Fluxes() {
+	delete daily_fluxes;
+}
+
 void Fluxes::reset() {
 	for (size_t i = 0; i < annual_fluxes_per_pft.size(); ++i) {
 		std::fill_n(annual_fluxes_per_pft[i].begin(), int(NPERPFTFLUXTYPES), 0);
@@ -165,34 +213,48 @@ void Fluxes::reset() {
 	}
 
 	for (int d = 0; d < date.year_length(); ++d) {
-		std::fill_n(daily_fluxes_pft[d], int(NPERPFTFLUXTYPES), 0);
-		std::fill_n(daily_fluxes_patch[d], int(NPERPATCHFLUXTYPES), 0);
+		std::fill_n(daily_fluxes->pft[d], int(NPERPFTFLUXTYPES), 0);
+		std::fill_n(daily_fluxes->patch[d], int(NPERPATCHFLUXTYPES), 0);
 	}
 }
 
 void Fluxes::serialize(ArchiveStream& arch) {
-	arch & annual_fluxes_per_pft
-		& monthly_fluxes_patch
-		& monthly_fluxes_pft;
+	arch & STATE_FIELD(annual_fluxes_per_pft)
+		& STATE_FIELD(monthly_fluxes_patch)
+		& STATE_FIELD(monthly_fluxes_pft);
+
+	if (!arch.save()) {
+		// The PFTs in the state file may differ from pftlist
+		std::vector<std::vector<double> > stored;
+		stored.swap(annual_fluxes_per_pft);
+		annual_fluxes_per_pft.resize(npft, std::vector<double>(NPERPFTFLUXTYPES));
+
+		for (size_t i = 0; i < stored.size(); i++) {
+			const int current = arch.current_pft(i);
+			if (current >= 0) {
+				annual_fluxes_per_pft[current] = stored[i];
+			}
+		}
+	}
 }
 
 void Fluxes::report_flux(PerPFTFluxType flux_type, int pft_id, double value) {
 	annual_fluxes_per_pft[pft_id][flux_type] += value;
 	monthly_fluxes_pft[date.month][flux_type] += value;
-	daily_fluxes_pft[date.day][flux_type] += value;	//Var = value ???
+	daily_fluxes->pft[date.day][flux_type] += value;	//Var = value ???
 }
 
 void Fluxes::report_flux(PerPatchFluxType flux_type, double value) {
 	monthly_fluxes_patch[date.month][flux_type] += value;
-	daily_fluxes_patch[date.day][flux_type] += value;
+	daily_fluxes->patch[date.day][flux_type] += value;
 }
 
 double Fluxes::get_daily_flux(PerPFTFluxType flux_type, int day) const {
-	return daily_fluxes_pft[day][flux_type];
+	return daily_fluxes->pft[day][flux_type];
 }
 
 double Fluxes::get_daily_flux(PerPatchFluxType flux_type, int day) const {
-	return daily_fluxes_patch[day][flux_type];
+	return daily_fluxes->patch[day][flux_type];
 }
 
 double Fluxes::get_monthly_flux(PerPFTFluxType flux_type, int month) const {
@@ -230,24 +292,31 @@ double Fluxes::get_annual_flux(PerPatchFluxType flux_type) const {
 
 void Vegetation::serialize(ArchiveStream& arch) {
 	if (arch.save()) {
-		arch & nobj;
+		arch & archive_field("number_of_individuals", nobj);
 
 		for (unsigned int i = 0; i < nobj; i++) {
 			Individual& indiv = (*this)[i];
-			arch & indiv.pft.id
-				& indiv;
+			arch & archive_field("pft_id", indiv.pft.id)
+				& STATE_FIELD(indiv);
 		}
 	}
 	else {
 		killall();
 		unsigned int number_of_individuals;
-		arch & number_of_individuals;
+		arch & STATE_FIELD(number_of_individuals);
 
 		for (unsigned int i = 0; i < number_of_individuals; i++) {
 			int pft_id;
-			arch & pft_id;
+			arch & STATE_FIELD(pft_id);
+
+			pft_id = arch.current_pft(pft_id);
+			if (pft_id < 0) {
+				skip_removed_pft(arch);
+				continue;
+			}
+
 			Individual& indiv = createobj(pftlist[pft_id], *this);
-			arch & indiv;
+			arch & STATE_FIELD(indiv);
 		}
 	}
 }
@@ -258,8 +327,8 @@ void Vegetation::serialize(ArchiveStream& arch) {
 
 
 void LitterSolveSOM::serialize(ArchiveStream& arch) {
-	arch & clitter
-		& nlitter;
+	arch & STATE_FIELD(clitter)
+		& STATE_FIELD(nlitter);
 }
 
 
@@ -268,47 +337,47 @@ void LitterSolveSOM::serialize(ArchiveStream& arch) {
 ////////////////////////////////////////////////////////////////////////////////
 
 void cropphen_struct::serialize(ArchiveStream& arch) {
-	arch & sdate
-		& sdate_harv
-		& sdate_harvest
-		& hdate
-		& hlimitdate
-		& hucountend
-		& sendate
-		& bicdate
-		& eicdate
-		& growingdays
-		& growingdays_y
-		& lgp
-		& tb
-		& pvd
-		& vdsum
-		& vrf
-		& prf
-		& phu
-		& phu_old
-		& husum
-		& husum_max
-		& husum_sampled
-		& husum_max_10
-		& nyears_hu_sample
-		& hu_samplingperiod
-		& hu_samplingdays
-		& fphu
-		& fphu_harv
-		& hi
-		& fhi_harv
-		& demandsum_crop
-		& supplysum_crop
-		& growingseason
-		& growingseason_ystd
-		& senescence
-		& senescence_ystd
-		& intercropseason
-		& fertilised
-		& vdsum_alloc
-		& vd
-		& dev_stage;
+	arch & STATE_FIELD(sdate)
+		& STATE_FIELD(sdate_harv)
+		& STATE_FIELD(sdate_harvest)
+		& STATE_FIELD(hdate)
+		& STATE_FIELD(hlimitdate)
+		& STATE_FIELD(hucountend)
+		& STATE_FIELD(sendate)
+		& STATE_FIELD(bicdate)
+		& STATE_FIELD(eicdate)
+		& STATE_FIELD(growingdays)
+		& STATE_FIELD(growingdays_y)
+		& STATE_FIELD(lgp)
+		& STATE_FIELD(tb)
+		& STATE_FIELD(pvd)
+		& STATE_FIELD(vdsum)
+		& STATE_FIELD(vrf)
+		& STATE_FIELD(prf)
+		& STATE_FIELD(phu)
+		& STATE_FIELD(phu_old)
+		& STATE_FIELD(husum)
+		& STATE_FIELD(husum_max)
+		& STATE_FIELD(husum_sampled)
+		& STATE_FIELD(husum_max_10)
+		& STATE_FIELD(nyears_hu_sample)
+		& STATE_FIELD(hu_samplingperiod)
+		& STATE_FIELD(hu_samplingdays)
+		& STATE_FIELD(fphu)
+		& STATE_FIELD(fphu_harv)
+		& STATE_FIELD(hi)
+		& STATE_FIELD(fhi_harv)
+		& STATE_FIELD(demandsum_crop)
+		& STATE_FIELD(supplysum_crop)
+		& STATE_FIELD(growingseason)
+		& STATE_FIELD(growingseason_ystd)
+		& STATE_FIELD(senescence)
+		& STATE_FIELD(senescence_ystd)
+		& STATE_FIELD(intercropseason)
+		& STATE_FIELD(fertilised)
+		& STATE_FIELD(vdsum_alloc)
+		& STATE_FIELD(vd)
+		& STATE_FIELD(dev_stage);
 }
 
 
@@ -318,41 +387,41 @@ void cropphen_struct::serialize(ArchiveStream& arch) {
 
 
 void Patchpft::serialize(ArchiveStream& arch) {
-	arch & anetps_ff
-		& wscal
-		& wscal_mean
-		& anetps_ff_est
-		& anetps_ff_est_initial
-		& wscal_mean_est
-		& phen
-		& aphen
-		& establish
-		& nsapling
-        & exp_est
-		& litter_leaf
-		& litter_root
-		& litter_sap
-		& litter_heart
-		& litter_repr
-		& gcbase
-		& gcbase_day
-		& wsupply
-		& wsupply_leafon
-		& fwuptake
-		& wstress
-		& wstress_day
-		& harvested_products_slow
-		& nmass_litter_leaf
-		& nmass_litter_root
-		& nmass_litter_sap
-		& nmass_litter_heart
-		& harvested_products_slow_nmass
-		& swindow
-		& water_deficit_y
-		& inund_count
-		& inund_stress;
+	arch & STATE_FIELD(anetps_ff)
+		& STATE_FIELD(wscal)
+		& STATE_FIELD(wscal_mean)
+		& STATE_FIELD(anetps_ff_est)
+		& STATE_FIELD(anetps_ff_est_initial)
+		& STATE_FIELD(wscal_mean_est)
+		& STATE_FIELD(phen)
+		& STATE_FIELD(aphen)
+		& STATE_FIELD(establish)
+		& STATE_FIELD(nsapling)
+        & STATE_FIELD(exp_est)
+		& STATE_FIELD(litter_leaf)
+		& STATE_FIELD(litter_root)
+		& STATE_FIELD(litter_sap)
+		& STATE_FIELD(litter_heart)
+		& STATE_FIELD(litter_repr)
+		& STATE_FIELD(gcbase)
+		& STATE_FIELD(gcbase_day)
+		& STATE_FIELD(wsupply)
+		& STATE_FIELD(wsupply_leafon)
+		& STATE_FIELD(fwuptake)
+		& STATE_FIELD(wstress)
+		& STATE_FIELD(wstress_day)
+		& STATE_FIELD(harvested_products_slow)
+		& STATE_FIELD(nmass_litter_leaf)
+		& STATE_FIELD(nmass_litter_root)
+		& STATE_FIELD(nmass_litter_sap)
+		& STATE_FIELD(nmass_litter_heart)
+		& STATE_FIELD(harvested_products_slow_nmass)
+		& STATE_FIELD(swindow)
+		& STATE_FIELD(water_deficit_y)
+		& STATE_FIELD(inund_count)
+		& STATE_FIELD(inund_stress);
 	if (pft.landcover==CROPLAND)
-		arch & *cropphen;
+		arch & STATE_FIELD(*cropphen);
 
 }
 
@@ -392,6 +461,7 @@ Patch::Patch(int i,Stand& s,Soiltype& st):
 
 	age = 0;
 	disturbed = false;
+	cloned = false;
 	managed = false;
 	man_strength = 0.0;
 	managed_this_year = false;
@@ -424,75 +494,63 @@ Patch::Patch(int i,Stand& s,Soiltype& st):
 }
 
 void Patch::serialize(ArchiveStream& arch) {
-	if (arch.save()) {
-		for (unsigned int i = 0; i < pft.nobj; i++) {
-			arch & pft[i];
-		}
-	}
-	else {
-		pft.killall();
-
-		for (unsigned int i = 0; i < pftlist.nobj; i++) {
-			pft.createobj(pftlist[i]);
-			arch & pft[i];
-		}
-	}
-
-	arch & vegetation
-		& soil
-		& fluxes
-		& fpar_grass
-		& fpar_ff
-		& par_grass_mean
-		& nday_growingseason
-		& fpc_total
-		& disturbed
-		& managed
-		& age
-		& fireprob
-		& growingseasondays
-		& intercep
-		& aaet
-		& aaet_5
-		& aevap
-		& aintercep
-		& arunoff
-		& awetland_water_added
-		& apet
-		& eet_net_veg
-		& wdemand
-		& wdemand_day
-		& wdemand_leafon
-		& fpc_rescale
-		& maet
-		& mevap
-		& mintercep
-		& mrunoff
-		& mpet
-		& ndemand
-		& irrigation_y
-		& fire_line_intensity
-		& wood_to_atm
-		& leaf_to_atm
-		& leaf_to_lit
-		& wood_to_str
-		& wood_to_fwd
-		& wood_to_cwd
-		& litf_to_atm
-		& lfwd_to_atm
-		& lcwd_to_atm;
+	serialize_pfts(arch, pft);
+
+	arch & STATE_FIELD(vegetation)
+		& STATE_FIELD(soil)
+		& STATE_FIELD(fluxes)
+		& STATE_FIELD(fpar_grass)
+		& STATE_FIELD(fpar_ff)
+		& STATE_FIELD(par_grass_mean)
+		& STATE_FIELD(nday_growingseason)
+		& STATE_FIELD(fpc_total)
+		& STATE_FIELD(disturbed)
+		& STATE_FIELD(managed)
+		& STATE_FIELD(age)
+		& STATE_FIELD(fireprob)
+		& STATE_FIELD(growingseasondays)
+		& STATE_FIELD(intercep)
+		& STATE_FIELD(aaet)
+		& STATE_FIELD(aaet_5)
+		& STATE_FIELD(aevap)
+		& STATE_FIELD(aintercep)
+		& STATE_FIELD(arunoff)
+		& STATE_FIELD(awetland_water_added)
+		& STATE_FIELD(apet)
+		& STATE_FIELD(eet_net_veg)
+		& STATE_FIELD(wdemand)
+		& STATE_FIELD(wdemand_day)
+		& STATE_FIELD(wdemand_leafon)
+		& STATE_FIELD(fpc_rescale)
+		& STATE_FIELD(maet)
+		& STATE_FIELD(mevap)
+		& STATE_FIELD(mintercep)
+		& STATE_FIELD(mrunoff)
+		& STATE_FIELD(mpet)
+		& STATE_FIELD(ndemand)
+		& STATE_FIELD(irrigation_y)
+		& STATE_FIELD(fire_line_intensity)
+		& STATE_FIELD(wood_to_atm)
+		& STATE_FIELD(leaf_to_atm)
+		& STATE_FIELD(leaf_to_lit)
+		& STATE_FIELD(wood_to_str)
+		& STATE_FIELD(wood_to_fwd)
+		& STATE_FIELD(wood_to_cwd)
+		& STATE_FIELD(litf_to_atm)
+		& STATE_FIELD(lfwd_to_atm)
+		& STATE_FIELD(lcwd_to_atm);
 		for (unsigned int i=0; i < N_YEAR_BIOMEAVG; i++)
-			arch & fapar_grass_avg[i];
+			arch & STATE_FIELD(fapar_grass_avg[i]);
 		for (unsigned int i=0; i < N_YEAR_BIOMEAVG; i++)
-			arch & fapar_ndlt_avg[i];
+			arch & STATE_FIELD(fapar_ndlt_avg[i]);
 		for (unsigned int i=0; i < N_YEAR_BIOMEAVG; i++)
-			arch & fapar_brlt_avg[i];
+			arch & STATE_FIELD(fapar_brlt_avg[i]);
 		for (unsigned int i=0; i < N_YEAR_BIOMEAVG; i++)
-			arch & fapar_trbr_avg[i];
+			arch & STATE_FIELD(fapar_trbr_avg[i]);
 		for (unsigned int i=0; i < N_YEAR_BIOMEAVG; i++)
-			arch & fapar_shrub_avg[i];
+			arch & STATE_FIELD(fapar_shrub_avg[i]);
 		for (unsigned int i=0; i < N_YEAR_BIOMEAVG; i++)
-			arch & fapar_total_avg[i];
+			arch & STATE_FIELD(fapar_total_avg[i]);
 }
 
 const Climate& Patch::get_climate() const {
@@ -633,13 +691,13 @@ double Patch::nflux() {
 
 
 void Standpft::serialize(ArchiveStream& arch) {
-	arch & cmass_repr
-		& anetps_ff_max
-		& fpc_total
-		& active
-		& plant
-		& reestab
-		& irrigated;
+	arch & STATE_FIELD(cmass_repr)
+		& STATE_FIELD(anetps_ff_max)
+		& STATE_FIELD(fpc_total)
+		& STATE_FIELD(active)
+		& STATE_FIELD(plant)
+		& STATE_FIELD(reestab)
+		& STATE_FIELD(irrigated);
 }
 
 
@@ -666,11 +724,17 @@ Stand::Stand(int i, Gridcell* gc, Soiltype& st, landcovertype landcoverX, int np
 	}
 
 	unsigned int num_patches = 1;
+	adaptive_npatch = false;
 	if (landcover == FOREST || landcover == NATURAL || (disturb_pasture && landcover == PASTURE)) {
 		num_patches = ::npatch; // use the global variable npatch for stands with stochastic events
+		if (ifadaptivenpatch) {
+			num_patches = npatch_min; // more are added during spinup if needed
+			adaptive_npatch = true;
+		}
 	}
 	if (npatch > 0) {
 		num_patches = npatch;	// use patch number provided by calling function
+		adaptive_npatch = false;
 	}
 
 	for (unsigned int p=0;p<num_patches;p++) {
@@ -1049,6 +1113,22 @@ Stand& Stand::clone(StandType& st, double fraction) {
 	return new_stand;
 }
 
+Patch& Stand::clone_patch(unsigned int source) {
+
+	// Serialize the source patch to an in-memory stream...
+	std::stringstream ss;
+	ArchiveOutStream aos(ss);
+	aos & (*this)[source];
+
+	// ...and deserialize to a new patch
+	Patch& new_patch = createobj(*this, soiltype);
+	ArchiveInStream ais(ss);
+	ais & new_patch;
+	new_patch.cloned = true;
+
+	return new_patch;
+}
+
 double Stand::get_landcover_fraction() const {
 	if (get_gridcell().landcover.frac[landcover])
 		return frac / get_gridcell().landcover.frac[landcover];
@@ -1061,47 +1141,46 @@ void Stand::set_gridcell_fraction(double fraction) {
 }
 
 void Stand::serialize(ArchiveStream& arch) {
-	if (arch.save()) {
-		for (unsigned int i = 0; i < pft.nobj; i++) {
-			arch & pft[i];
-		}
+	serialize_pfts(arch, pft);
 
-		arch & nobj;
+	if (arch.save()) {
+		arch & archive_field("npatch", nobj);
 		for (unsigned int k = 0; k < nobj; k++) {
-			arch & (*this)[k];
+			arch & archive_field("patch", (*this)[k]);
 		}
 	}
 	else {
-		pft.killall();
-		for (unsigned int i = 0; i < pftlist.nobj; i++) {
-			Standpft& standpft = pft.createobj(pftlist[i]);
-			arch & standpft;
-		}
-
 		killall();
 		unsigned int npatch;
-		arch & npatch;
+		arch & STATE_FIELD(npatch);
 		for (unsigned int k = 0; k < npatch; k++) {
 			Patch& patch = createobj(*this, soiltype);
-			arch & patch;
+			arch & STATE_FIELD(patch);
 		}
 	}
 
-	arch & first_year
-		& clone_year
-		& frac
-		& stid
-		& pftid
-		& current_rot
-		& ndays_inrotation
-		& infallow
-		& isirrigated
-		& hasgrassintercrop
-		& gdd5_intercrop
-		& cloned
-		& origin
-		& landcover
-		& seed;
+	arch & STATE_FIELD(first_year)
+		& STATE_FIELD(clone_year)
+		& STATE_FIELD(frac)
+		& STATE_FIELD(stid)
+		& STATE_FIELD(pftid)
+		& STATE_FIELD(current_rot)
+		& STATE_FIELD(ndays_inrotation)
+		& STATE_FIELD(infallow)
+		& STATE_FIELD(isirrigated)
+		& STATE_FIELD(hasgrassintercrop)
+		& STATE_FIELD(gdd5_intercrop)
+		& STATE_FIELD(cloned)
+		& STATE_FIELD(origin)
+		& STATE_FIELD(landcover)
+		& STATE_FIELD(seed);
+
+	if (!arch.save() && pftid >= 0) {
+		pftid = arch.current_pft(pftid);
+		if (pftid < 0) {
+			throw ArchiveError("The main crop of a stand in the state file is not in the PFT list");
+		}
+	}
 }
 
 const Climate& Stand::get_climate() const {
@@ -1124,24 +1203,26 @@ Gridcell& Stand::get_gridcell() const {
 ////////////////////////////////////////////////////////////////////////////////
 
 void cropindiv_struct::serialize(ArchiveStream& arch) {
-	arch & grs_cmass_plant
-		& grs_cmass_leaf
-		& grs_cmass_root
-		& grs_cmass_ho
-		& grs_cmass_agpool
-		& grs_cmass_dead_leaf
-		& grs_cmass_stem
-		& cmass_leaf_sen
-		& nmass_ho
-		& nmass_agpool
-		& nmass_dead_leaf
-		& isintercropgrass;
+	arch & STATE_FIELD(grs_cmass_plant)
+		& STATE_FIELD(grs_cmass_leaf)
+		& STATE_FIELD(grs_cmass_root)
+		& STATE_FIELD(grs_cmass_ho)
+		& STATE_FIELD(grs_cmass_agpool)
+		& STATE_FIELD(grs_cmass_dead_leaf)
+		& STATE_FIELD(grs_cmass_stem)
+		& STATE_FIELD(cmass_leaf_sen)
+		& STATE_FIELD(nmass_ho)
+		& STATE_FIELD(nmass_agpool)
+		& STATE_FIELD(nmass_dead_leaf)
+		& STATE_FIELD(isintercropgrass);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 // Implementation of Individual member functions
 ////////////////////////////////////////////////////////////////////////////////
 
+unsigned long IndividualDayCache::generation = 1;
+
 Individual::Individual(int i,Pft& p,Vegetation& v):pft(p),vegetation(v),id(i) {
 
 	anpp              = 0.0;
@@ -1241,81 +1322,81 @@ Individual::Individual(int i,Pft& p,Vegetation& v):pft(p),vegetation(v),id(i) {
 }
 
 void Individual::serialize(ArchiveStream& arch) {
-	arch & cmass_leaf
-		& cmass_root
-		& cmass_sap
-		& cmass_heart
-		& cmass_debt
-		& cmass_leaf_post_turnover
-		& cmass_root_post_turnover
-		& last_turnover_day
-		& fpc
-		& fpc_daily
-		& fpar
-		& densindiv
-		& phen
-		& aphen
-		& aphen_raingreen
-		& anpp
-		& aet
-		& aaet
-		& ltor
-		& height
-		& crownarea
-		& deltafpc
-		& boleht
-		& lai
-		& lai_layer
-		& lai_indiv
-		& lai_daily
-		& lai_indiv_daily
-		& greff_5
-		& age
-		& mlai
-		& fpar_leafon
-		& lai_leafon_layer
-		& intercep
-		& phen_mean
-		& wstress
-		& alive
-		& monstor
-		& fvocseas
-		& nmass_leaf
-		& nmass_root
-		& nmass_sap
-		& nmass_heart
-		& nactive
-		& nextin
-		& nstore_longterm
-		& nstore_labile
-		& ndemand
-		& fnuptake
-		& anuptake
-		& max_n_storage
-		& scale_n_storage
-		& avmaxnlim
-		& cton_leaf_aopt
-		& cton_leaf_aavr
-		& cton_status
-		& cmass_veg
-		& nmass_veg
-
-		& photosynthesis
-		& nstress
-		& leafndemand
-		& rootndemand
-		& sapndemand
-		& storendemand
-		& leaffndemand
-		& rootfndemand
-		& sapfndemand
-		& storefndemand
-		& leafndemand_store
-		& rootndemand_store
-		& nday_leafon;
+	arch & STATE_FIELD(cmass_leaf)
+		& STATE_FIELD(cmass_root)
+		& STATE_FIELD(cmass_sap)
+		& STATE_FIELD(cmass_heart)
+		& STATE_FIELD(cmass_debt)
+		& STATE_FIELD(cmass_leaf_post_turnover)
+		& STATE_FIELD(cmass_root_post_turnover)
+		& STATE_FIELD(last_turnover_day)
+		& STATE_FIELD(fpc)
+		& STATE_FIELD(fpc_daily)
+		& STATE_FIELD(fpar)
+		& STATE_FIELD(densindiv)
+		& STATE_FIELD(phen)
+		& STATE_FIELD(aphen)
+		& STATE_FIELD(aphen_raingreen)
+		& STATE_FIELD(anpp)
+		& STATE_FIELD(aet)
+		& STATE_FIELD(aaet)
+		& STATE_FIELD(ltor)
+		& STATE_FIELD(height)
+		& STATE_FIELD(crownarea)
+		& STATE_FIELD(deltafpc)
+		& STATE_FIELD(boleht)
+		& STATE_FIELD(lai)
+		& STATE_FIELD(lai_layer)
+		& STATE_FIELD(lai_indiv)
+		& STATE_FIELD(lai_daily)
+		& STATE_FIELD(lai_indiv_daily)
+		& STATE_FIELD(greff_5)
+		& STATE_FIELD(age)
+		& STATE_FIELD(mlai)
+		& STATE_FIELD(fpar_leafon)
+		& STATE_FIELD(lai_leafon_layer)
+		& STATE_FIELD(intercep)
+		& STATE_FIELD(phen_mean)
+		& STATE_FIELD(wstress)
+		& STATE_FIELD(alive)
+		& STATE_FIELD(monstor)
+		& STATE_FIELD(fvocseas)
+		& STATE_FIELD(nmass_leaf)
+		& STATE_FIELD(nmass_root)
+		& STATE_FIELD(nmass_sap)
+		& STATE_FIELD(nmass_heart)
+		& STATE_FIELD(nactive)
+		& STATE_FIELD(nextin)
+		& STATE_FIELD(nstore_longterm)
+		& STATE_FIELD(nstore_labile)
+		& STATE_FIELD(ndemand)
+		& STATE_FIELD(fnuptake)
+		& STATE_FIELD(anuptake)
+		& STATE_FIELD(max_n_storage)
+		& STATE_FIELD(scale_n_storage)
+		& STATE_FIELD(avmaxnlim)
+		& STATE_FIELD(cton_leaf_aopt)
+		& STATE_FIELD(cton_leaf_aavr)
+		& STATE_FIELD(cton_status)
+		& STATE_FIELD(cmass_veg)
+		& STATE_FIELD(nmass_veg)
+
+		& STATE_FIELD(photosynthesis)
+		& STATE_FIELD(nstress)
+		& STATE_FIELD(leafndemand)
+		& STATE_FIELD(rootndemand)
+		& STATE_FIELD(sapndemand)
+		& STATE_FIELD(storendemand)
+		& STATE_FIELD(leaffndemand)
+		& STATE_FIELD(rootfndemand)
+		& STATE_FIELD(sapfndemand)
+		& STATE_FIELD(storefndemand)
+		& STATE_FIELD(leafndemand_store)
+		& STATE_FIELD(rootndemand_store)
+		& STATE_FIELD(nday_leafon);
 
 	if (pft.landcover==CROPLAND)
-		arch & *cropindiv;
+		arch & STATE_FIELD(*cropindiv);
 }
 
 Individual::~Individual() {
@@ -1381,6 +1462,8 @@ void Individual::reduce_biomass(double mortality, double mortality_fire, bool bf
 	// specifically to deal with nstore().
 	assert(pft.lifeform == TREE || pft.lifeform == GRASS || pft.lifeform == MOSS);
 
+	invalidate_day_cache();
+
 	if (!negligible(mortality)) {
 
 		const double mortality_non_fire = mortality - mortality_fire;
@@ -1561,6 +1644,25 @@ double Individual::cton_sap() const {
  */
 double Individual::ccont(double scale_indiv, bool luc) const {
 
+	if (scale_indiv == 1.0 && !luc) {
+
+		if (cache.ccont_stamp != IndividualDayCache::generation) {
+			cache.ccont = calculate_ccont(1.0, false);
+			cache.ccont_stamp = IndividualDayCache::generation;
+		}
+		else if (ifverifydaycache && calculate_ccont(1.0, false) != cache.ccont) {
+			fail("Stale daily ccont of %s individual %d on day %d of year %d: %g (%g)\n",
+				(char*)pft.name, id, date.day, date.year, cache.ccont, calculate_ccont(1.0, false));
+		}
+
+		return cache.ccont;
+	}
+
+	return calculate_ccont(scale_indiv, luc);
+}
+
+double Individual::calculate_ccont(double scale_indiv, bool luc) const {
+
 	double ccont = 0.0;
 
 	if (alive || istruecrop_or_intercropgrass()) {
@@ -1864,49 +1966,79 @@ void Individual::save_nmass_luc() {
 	nmass_tot_luc = ncont();
 }
 
+void Individual::calculate_day_cache(IndividualDayCache& values) const {
+
+	if (istruecrop_or_intercropgrass()) {
+		bool growingseason = patchpft().cropphen->growingseason;
+		values.cmass_leaf = growingseason ? cropindiv->grs_cmass_leaf : 0;
+		values.cmass_root = growingseason ? cropindiv->grs_cmass_root : 0;
+	}
+	else {
+		values.cmass_leaf = cmass_leaf * phen;
+		values.cmass_root = cmass_root * phen;
+	}
+
+	if (pft.phenology == CROPGREEN) {
+		bool growingseason = patchpft().cropphen->growingseason;
+		values.fpc = growingseason ? fpc_daily : 0;
+		values.lai = growingseason ? lai_daily : 0;
+		values.lai_indiv = growingseason ? lai_indiv_daily : 0;
+	}
+	else {
+		values.fpc = fpc * phen;
+		values.lai = lai * phen;
+		values.lai_indiv = lai_indiv * phen;
+	}
+}
+
+const IndividualDayCache& Individual::day_cache() const {
+
+	if (cache.stamp != IndividualDayCache::generation) {
+		calculate_day_cache(cache);
+		cache.stamp = IndividualDayCache::generation;
+	}
+	else if (ifverifydaycache) {
+		IndividualDayCache fresh;
+		calculate_day_cache(fresh);
+
+		if (fresh.cmass_leaf != cache.cmass_leaf || fresh.cmass_root != cache.cmass_root ||
+			fresh.lai != cache.lai || fresh.lai_indiv != cache.lai_indiv ||
+			fresh.fpc != cache.fpc) {
+			fail("Stale daily values of %s individual %d on day %d of year %d:\n"
+				"cmass_leaf %g (%g), cmass_root %g (%g), lai %g (%g), lai_indiv %g (%g), fpc %g (%g)\n",
+				(char*)pft.name, id, date.day, date.year,
+				cache.cmass_leaf, fresh.cmass_leaf, cache.cmass_root, fresh.cmass_root,
+				cache.lai, fresh.lai, cache.lai_indiv, fresh.lai_indiv,
+				cache.fpc, fresh.fpc);
+		}
+	}
+
+	return cache;
+}
+
 /// Gets the individual's daily cmass_leaf value
 double Individual::cmass_leaf_today() const {
-
-	if (istruecrop_or_intercropgrass())
-		return patchpft().cropphen->growingseason ? cropindiv->grs_cmass_leaf : 0;
-	else
-		return cmass_leaf * phen;
+	return day_cache().cmass_leaf;
 }
 
 /// Gets the individual's daily cmass_root value
 double Individual::cmass_root_today() const {
-
-	if (istruecrop_or_intercropgrass())
-		return patchpft().cropphen->growingseason ? cropindiv->grs_cmass_root : 0;
-	else
-		return cmass_root * phen;
+	return day_cache().cmass_root;
 }
 
 /// Gets the individual's daily fpc value
 double Individual::fpc_today() const {
-
-	if (pft.phenology == CROPGREEN)
-		return patchpft().cropphen->growingseason ? fpc_daily : 0;
-	else
-		return fpc * phen;
+	return day_cache().fpc;
 }
 
 /// Gets the individual's daily lai value
 double Individual::lai_today() const {
-
-	if (pft.phenology == CROPGREEN)
-		return patchpft().cropphen->growingseason ? lai_daily : 0;
-	else
-		return lai * phen;
+	return day_cache().lai;
 }
 
 /// Gets the individual's daily lai_indiv value
 double Individual::lai_indiv_today() const {
-
-	if (pft.phenology == CROPGREEN)
-		return patchpft().cropphen->growingseason ? lai_indiv_daily : 0;
-	else
-		return lai_indiv * phen;
+	return day_cache().lai_indiv;
 }
 
 /// Gets the Nitrigen limited LAI
@@ -1988,6 +2120,8 @@ void partition_wood_biomass(double mass_sap, double mass_heart,
 void Individual::kill(bool harvest, bool disturbing, bool bioclimatic, bool negbiom, bool badallom  /* = false */) {
 	Patchpft& ppft = patchpft();
 
+	invalidate_day_cache();
+
 	double charvest_flux = 0.0;
 	double charvested_products_slow = 0.0;
 
@@ -2242,32 +2376,32 @@ double Individual::wscal_mean() const {
 
 
 void Gridcellpft::serialize(ArchiveStream& arch) {
-	arch & addtw
-		& Km
-		& autumnoccurred
-		& springoccurred
-		& vernstartoccurred
-		& vernendoccurred
-		& first_autumndate
-		& first_autumndate20
-		& first_autumndate_20
-		& last_springdate
-		& last_springdate20
-		& last_springdate_20
-		& last_verndate
-		& last_verndate20
-		& last_verndate_20
-		& sdate_default
-		& sdatecalc_temp
-		& sdatecalc_prec
-		& sdate_force
-		& hdate_force
-		& Nfert_read
-		& hlimitdate_default
-		& wintertype
-		& swindow
-		& swindow_irr
-		& sowing_restriction;
+	arch & STATE_FIELD(addtw)
+		& STATE_FIELD(Km)
+		& STATE_FIELD(autumnoccurred)
+		& STATE_FIELD(springoccurred)
+		& STATE_FIELD(vernstartoccurred)
+		& STATE_FIELD(vernendoccurred)
+		& STATE_FIELD(first_autumndate)
+		& STATE_FIELD(first_autumndate20)
+		& STATE_FIELD(first_autumndate_20)
+		& STATE_FIELD(last_springdate)
+		& STATE_FIELD(last_springdate20)
+		& STATE_FIELD(last_springdate_20)
+		& STATE_FIELD(last_verndate)
+		& STATE_FIELD(last_verndate20)
+		& STATE_FIELD(last_verndate_20)
+		& STATE_FIELD(sdate_default)
+		& STATE_FIELD(sdatecalc_temp)
+		& STATE_FIELD(sdatecalc_prec)
+		& STATE_FIELD(sdate_force)
+		& STATE_FIELD(hdate_force)
+		& STATE_FIELD(Nfert_read)
+		& STATE_FIELD(hlimitdate_default)
+		& STATE_FIELD(wintertype)
+		& STATE_FIELD(swindow)
+		& STATE_FIELD(swindow_irr)
+		& STATE_FIELD(sowing_restriction);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -2275,10 +2409,10 @@ void Gridcellpft::serialize(ArchiveStream& arch) {
 ////////////////////////////////////////////////////////////////////////////////
 
 void Gridcellst::serialize(ArchiveStream& arch) {
-	arch & frac
-		& frac_old_orig
-		& nstands
-		& nfert;
+	arch & STATE_FIELD(frac)
+		& STATE_FIELD(frac_old_orig)
+		& STATE_FIELD(nstands)
+		& STATE_FIELD(nfert);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -2317,7 +2451,7 @@ Landcover::Landcover() {
 }
 
 void Landcover::serialize(ArchiveStream& arch) {
-	arch & frac;
+	arch & STATE_FIELD(frac);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -2351,6 +2485,8 @@ Gridcell::Gridcell():climate(*this) {
 	}
 	nesterov_cur = 0.;
 
+	resume_year = -1;
+
 	// Initialise BLAZE variables
 	seed = randomseed;
 	for (int i=0;i<12;i++) {
@@ -2436,55 +2572,64 @@ double Gridcell::nflux() {
 }
 
 void Gridcell::serialize(ArchiveStream& arch) {
-	arch & climate
-		& landcover
-		& seed
-		& balance
-		& nesterov_max
-		& nesterov_monthly_max
-		& nesterov_cur
-		& fapar_recent_max;
+	arch & STATE_FIELD(climate)
+		& STATE_FIELD(landcover)
+		& STATE_FIELD(seed)
+		& STATE_FIELD(balance)
+		& STATE_FIELD(nesterov_max)
+		& STATE_FIELD(nesterov_monthly_max)
+		& STATE_FIELD(nesterov_cur)
+		& STATE_FIELD(fapar_recent_max);
 
-	if (arch.save()) {
-		for (unsigned int i = 0; i < pft.nobj; i++) {
-			arch & pft[i];
-		}
+	serialize_pfts(arch, pft);
 
+	if (arch.save()) {
 		for (unsigned int i = 0; i < st.nobj; i++) {
-			arch & st[i];
+			arch & STATE_FIELD(st[i]);
 		}
 
 		unsigned int nstands = nbr_stands();
-		arch & nstands;
+		arch & archive_field("number_of_stands", nstands);
 		for (unsigned int s = 0; s < nstands; s++) {
-			arch & (*this)[s].landcover
-				& (*this)[s];
+			arch & archive_field("landcover", (*this)[s].landcover)
+				& archive_field("stand.id", (*this)[s].id)
+				& archive_field("stand", (*this)[s]);
 		}
+		arch & STATE_FIELD(next_id());
 	}
 	else {
-		pft.killall();
-
-		for (unsigned int i = 0; i < pftlist.nobj; i++) {
-			pft.createobj(pftlist[i]);
-			arch & pft[i];
-		}
-
 		st.killall();
 
 		for (unsigned int i = 0; i < stlist.nobj; i++) {
 			st.createobj(stlist[i]);
-			arch & st[i];
+			arch & STATE_FIELD(st[i]);
 		}
 
 		clear();
 		unsigned int number_of_stands;
-		arch & number_of_stands;
+		arch & STATE_FIELD(number_of_stands);
 
 		for (unsigned int s = 0; s < number_of_stands; s++) {
 			landcovertype landcover;
-			arch & landcover;
-			create_stand(landcover);
-			arch & (*this)[s];
+			arch & STATE_FIELD(landcover);
+			Stand& stand = create_stand(landcover);
+
+			// The stand ids are part of the keys of the random streams, so
+			// they must be the same as before, not numbered anew
+			if (arch.version() >= 3) {
+				arch & STATE_FIELD(stand.id);
+			}
+			else {
+				stand.id = s;
+			}
+			arch & STATE_FIELD(stand);
+		}
+
+		if (arch.version() >= 3) {
+			arch & STATE_FIELD(next_id());
+		}
+		else {
+			next_id() = number_of_stands;
 		}
 	}
 }
@@ -2506,18 +2651,18 @@ unsigned int Gridcell::nbr_stands() const {
 }
 
 void Sompool::serialize(ArchiveStream& arch) {
-	arch & cmass
-		& nmass
-		& cdec
-		& ndec
-		& delta_cmass
-		& delta_nmass
-		& ligcfrac
-		& fracremain
-		& ntoc
-		& litterme
-		& fireresist
-		& mfracremain_mean;
+	arch & STATE_FIELD(cmass)
+		& STATE_FIELD(nmass)
+		& STATE_FIELD(cdec)
+		& STATE_FIELD(ndec)
+		& STATE_FIELD(delta_cmass)
+		& STATE_FIELD(delta_nmass)
+		& STATE_FIELD(ligcfrac)
+		& STATE_FIELD(fracremain)
+		& STATE_FIELD(ntoc)
+		& STATE_FIELD(litterme)
+		& STATE_FIELD(fireresist)
+		& STATE_FIELD(mfracremain_mean);
 }
 
 
@@ -2526,17 +2671,17 @@ void Sompool::serialize(ArchiveStream& arch) {
 ////////////////////////////////////////////////////////////////////////////////
 
 void MassBalance::serialize(ArchiveStream& arch) {
-	arch & start_year
-		& ccont_zero
-		& ccont_zero_scaled
-		& cflux_zero
-		& ncont_zero
-		& ncont_zero_scaled
-		& nflux_zero
-		& ccont
-		& ncont
-		& cflux
-		& nflux;
+	arch & STATE_FIELD(start_year)
+		& STATE_FIELD(ccont_zero)
+		& STATE_FIELD(ccont_zero_scaled)
+		& STATE_FIELD(cflux_zero)
+		& STATE_FIELD(ncont_zero)
+		& STATE_FIELD(ncont_zero_scaled)
+		& STATE_FIELD(nflux_zero)
+		& STATE_FIELD(ccont)
+		& STATE_FIELD(ncont)
+		& STATE_FIELD(cflux)
+		& STATE_FIELD(nflux);
 }
 
 /// Should be used together with check_indiv()
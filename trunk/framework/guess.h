@@ -560,6 +560,7 @@ public:
 	void check_period(Gridcell& gridcell);
 
 	void serialize(ArchiveStream& arch);
+	const char* state_tag() const { return "MassBalance"; }
 };
 
 /// This struct contains the result of a photosynthesis calculation.
@@ -613,6 +614,7 @@ struct PhotosynthesisResult : public Serializable {
     }
 
 	void serialize(ArchiveStream& arch);
+	const char* state_tag() const { return "PhotosynthesisResult"; }
 };
 
 /// Class containing serializable variables for Weathergenerator GWGen
@@ -655,6 +657,7 @@ public:
 	}
 
 	void serialize(ArchiveStream& arch);
+	const char* state_tag() const { return "WeatherGenState"; }
 };
 
 /// This struct contains the environmental input to a photosynthesis calculation.
@@ -790,6 +793,58 @@ public:
 };
 
 
+/// Multi-year climate records for a grid cell
+/** The 20-year records of monthly climate, which are updated once a month or
+ *  once a year and mainly used for crop sowing dates. They are allocated
+ *  separately from the Climate object, which holds the state needed every
+ *  day, so that the daily updates don't pull these arrays through the cache.
+ *  Serialized as part of Climate.
+ */
+struct ClimateHistory {
+
+	/// minimum monthly temperatures for the last 20 years (deg C)
+	double mtemp_min_20[20];
+
+	/// maximum monthly temperatures for the last 20 years (deg C)
+	double mtemp_max_20[20];
+
+	/// past 20 years monthly temperature values
+	double mtemp_20[20][12];
+	/// past 20 years monthly precipitation values
+	double mprec_20[20][12];
+	/// past 20 years monthly PET values
+	double mpet_20[20][12];
+	/// past 20 years monthly precipitation to PET ratios
+	double mprec_pet_20[20][12];
+	/// past 20 years minimum of monthly precipitation to PET ratios
+	double mprec_petmin_20[20];
+	/// past 20 years maximum of monthly precipitation to PET ratios
+	double mprec_petmax_20[20];
+
+	Historic<double, 20> hmtemp_20[12];
+	Historic<double, 20> hmprec_20[12];
+	Historic<double, 20> hmeet_20[12];
+
+	ClimateHistory() {
+
+		for(int y=0;y<20;y++) {
+
+			mtemp_min_20[y] = 0.0;
+			mtemp_max_20[y] = 0.0;
+
+			for(int m=0;m<12;m++) {
+				mtemp_20[y][m] = 0.0;
+				mprec_20[y][m] = 0.0;
+				mpet_20[y][m] = 0.0;
+				mprec_pet_20[y][m] = 0.0;
+			}
+
+			mprec_petmin_20[y] = 0.0;
+			mprec_petmax_20[y] = 0.0;
+		}
+	}
+};
+
 /// The Climate for a grid cell
 /** Stores all static and variable data relating to climate parameters, as well as
  *  latitude, atmospheric CO2 concentration and daylength for a grid cell. Includes
@@ -903,11 +958,8 @@ public:
 	/// daily eet for the last 31 days (deg C)
 	Historic<double, 31> deet_31;
 
-	/// minimum monthly temperatures for the last 20 years (deg C)
-	double mtemp_min_20[20];
-
-	/// maximum monthly temperatures for the last 20 years (deg C)
-	double mtemp_max_20[20];
+	/// 20-year records of monthly climate (see ClimateHistory)
+	ClimateHistory* history;
 
 	/// minimum monthly temperature for the last 12 months (deg C)
 	double mtemp_min;
@@ -986,18 +1038,6 @@ public:
 	int adjustlat;
 	/// accumulated monthly pet values for this year
 	double mpet_year[12];
-	/// past 20 years monthly temperature values
-	double mtemp_20[20][12];
-	/// past 20 years monthly precipitation values
-	double mprec_20[20][12];
-	/// past 20 years monthly PET values
-	double mpet_20[20][12];
-	/// past 20 years monthly precipitation to PET ratios
-	double mprec_pet_20[20][12];
-	/// past 20 years minimum of monthly precipitation to PET ratios
-	double mprec_petmin_20[20];
-	/// past 20 years maximum of monthly precipitation to PET ratios
-	double mprec_petmax_20[20];
 	/// 20-year running average monthly temperature values
 	double mtemp20[12];
 	/// 20-year running average monthly precipitation values
@@ -1011,10 +1051,6 @@ public:
 	/// 20-year running average of maximum monthly precipitation to PET ratios
 	double mprec_petmax20;
 
-	Historic<double, 20> hmtemp_20[12];
-	Historic<double, 20> hmprec_20[12];
-	Historic<double, 20> hmeet_20[12];
-
 	/// seasonality type (SEASONALITY_NO, SEASONALITY_PREC, SEASONALITY_PRECTEMP, SEASONALITY_TEMP, SEASONALITY_TEMPPREC)
 	seasonality_type seasonality;
 	seasonality_type seasonality_lastyear;
@@ -1052,6 +1088,8 @@ public:
 	/// constructor function: initialises gridcell member
 	Climate(Gridcell& gc):gridcell(gc) {
 
+		history = new ClimateHistory;
+
 		aprec = 0.0;
 		aprec_lastyear = 0.0;
 
@@ -1062,19 +1100,6 @@ public:
 			mpet20[m] = 0.0;
 			mpet_year[m] = 0.0;
 			mprec_pet20[m] = 0.0;
-
-			for(int y=0;y<20;y++) {
-				mtemp_20[y][m] = 0.0;
-				mprec_20[y][m] = 0.0;
-				mpet_20[y][m] = 0.0;
-				mprec_pet_20[y][m] = 0.0;
-			}
-		}
-
-		for(int y=0;y<20;y++) {
-
-			mprec_petmin_20[y] = 0.0;
-			mprec_petmax_20[y] = 0.0;
 		}
 
 		mprec_petmin20=0.0;
@@ -1096,12 +1121,16 @@ public:
 		agdd0 = 0.0;
 	};
 
+	~Climate() {
+		delete history;
+	}
+
 	/// Initialises certain member variables
 	/** Should be called before Climate object is applied to a new grid cell */
 	void initdrivers(double latitude) {
 
-		std::fill_n(mtemp_min_20, 20, 0.0);
-		std::fill_n(mtemp_max_20, 20, 0.0);
+		std::fill_n(history->mtemp_min_20, 20, 0.0);
+		std::fill_n(history->mtemp_max_20, 20, 0.0);
 
 		mtemp_min20 = 0.0;
 		mtemp_max20 = 0.0;
@@ -1144,6 +1173,13 @@ public:
 	}
 
 	void serialize(ArchiveStream& arch);
+	const char* state_tag() const { return "Climate"; }
+
+private:
+
+	// Not copyable, the history is owned by this object
+	Climate(const Climate&);
+	Climate& operator=(const Climate&);
 };
 
 
@@ -1284,10 +1320,13 @@ public:
 	/// constructor: initialises members
 	Fluxes(Patch& p);
 
+	~Fluxes();
+
 	/// Sets all fluxes to zero (call at the beginning of each year)
 	void reset();
 
 	void serialize(ArchiveStream& arch);
+	const char* state_tag() const { return "Fluxes"; }
 
 	/// Report flux for a certain flux type
 	void report_flux(PerPFTFluxType flux_type, int pft_id, double value);
@@ -1329,11 +1368,26 @@ private:
 	/** For the fluxes stored per pft for annual values */
 	double monthly_fluxes_pft[12][NPERPFTFLUXTYPES];
 
-	/// Stores one flux value per day and flux type
-	double daily_fluxes_patch[365][NPERPATCHFLUXTYPES];
+	/// The daily fluxes of the year
+	/** Only today's values are updated, the rest is read for daily output.
+	 *  Allocated separately to keep most of its size out of the Patch object.
+	 */
+	struct DailyFluxes {
+
+		/// Stores one flux value per day and flux type
+		double patch[365][NPERPATCHFLUXTYPES];
+
+		/// Stores one flux value per day and flux type
+		double pft[365][NPERPFTFLUXTYPES];
+	};
 
-	/// Stores one flux value per day and flux type
-	double daily_fluxes_pft[365][NPERPFTFLUXTYPES];
+	DailyFluxes* daily_fluxes;
+
+private:
+
+	// Not copyable, daily_fluxes is owned by this object
+	Fluxes(const Fluxes&);
+	Fluxes& operator=(const Fluxes&);
 };
 
 /// Storage class of crop management information for one rotation period for a stand type, read from the instruction file.
@@ -2493,6 +2547,32 @@ struct cropindiv_struct : public Serializable {
 	}
 
 	void serialize(ArchiveStream& arch);
+	const char* state_tag() const { return "cropindiv_struct"; }
+};
+
+/// Daily quantities of an Individual derived from its biomass and phenology
+/** Calculated on first use and reused until invalidated, see Individual::day_cache().
+ *  Not serialized.
+ */
+struct IndividualDayCache {
+
+	IndividualDayCache() : stamp(0), ccont_stamp(0) {}
+
+	/// Value of generation when the values were calculated, 0 if invalid
+	/** ccont is calculated separately, only when asked for */
+	unsigned long stamp, ccont_stamp;
+
+	/// Values of Individual::cmass_leaf_today() and cmass_root_today()
+	double cmass_leaf, cmass_root;
+
+	/// Values of Individual::lai_today(), lai_indiv_today() and fpc_today()
+	double lai, lai_indiv, fpc;
+
+	/// Value of Individual::ccont() with default arguments
+	double ccont;
+
+	/// Incremented to invalidate the values of all individuals at once
+	static unsigned long generation;
 };
 
 
@@ -2725,6 +2805,17 @@ public:
 	/// Pointer to struct with crop-specific data
 	cropindiv_struct *cropindiv;
 
+private:
+
+	/// Derived daily quantities, see day_cache()
+	mutable IndividualDayCache cache;
+
+	/// Calculates the derived daily quantities from the pools and phenology, except ccont
+	void calculate_day_cache(IndividualDayCache& values) const;
+
+	/// ccont() without the cache
+	double calculate_ccont(double scale_indiv, bool luc) const;
+
 	// MEMBER FUNCTIONS
 
 public:
@@ -2740,6 +2831,7 @@ public:
 	cropindiv_struct* set_cropindiv();
 
 	void serialize(ArchiveStream& arch);
+	const char* state_tag() const { return "Individual"; }
 
 	/// Report a flux associated with this Individual
 	/** Fluxes from 'new' Individuals (alive == false) will not be reported */
@@ -2842,6 +2934,26 @@ public:
 	 */
 	double wscal_mean() const;
 
+	/// Derived daily quantities (cmass_leaf_today() etc.), calculated when first needed
+	/** The values are reused until invalidated. Code changing the biomass,
+	 *  phenology or allometry of an individual outside the daily processes
+	 *  in simulate_day() must call invalidate_day_cache(). With ifverifydaycache
+	 *  the values are recalculated on every use and the simulation stops if
+	 *  they differ from the cached ones.
+	 */
+	const IndividualDayCache& day_cache() const;
+
+	/// Invalidates the derived daily quantities of this individual
+	void invalidate_day_cache() {
+		cache.stamp = 0;
+		cache.ccont_stamp = 0;
+	}
+
+	/// Invalidates the derived daily quantities of all individuals
+	static void invalidate_all_day_caches() {
+		IndividualDayCache::generation++;
+	}
+
 	/// Gets the individual's daily cmass_leaf value
 	double cmass_leaf_today() const;
 	/// Gets the individual's daily cmass_root value
@@ -2906,6 +3018,7 @@ public:
 	Vegetation(Patch& p):patch(p) {};
 
 	void serialize(ArchiveStream& arch);
+	const char* state_tag() const { return "Vegetation"; }
 };
 
 
@@ -3066,6 +3179,7 @@ public:
 		delta_cmass = 0.0;
 		delta_nmass = 0.0;
 		fracremain = 0.0;
+		fracremain_step = 1.0;
 		litterme = 0.0;
 		fireresist = 0.0;
 
@@ -3088,6 +3202,9 @@ public:
 	double ligcfrac;
 	/// fraction of pool remaining after decomposition
 	double fracremain;
+	/// fraction of pool remaining after the days since the last decomposition
+	/** Not serialized, decomposition steps end by the last day of each month (\see somdynam_step) */
+	double fracremain_step;
 	/// nitrogen to carbon ratio
 	double ntoc;
 
@@ -3103,6 +3220,7 @@ public:
 	double mfracremain_mean[12];
 
 	void serialize(ArchiveStream& arch);
+	const char* state_tag() const { return "Sompool"; }
 };
 
 /// This struct contains litter for solving Century SOM pools.
@@ -3135,6 +3253,7 @@ struct LitterSolveSOM : public Serializable {
 	}
 
 	void serialize(ArchiveStream& arch);
+	const char* state_tag() const { return "LitterSolveSOM"; }
 
 private:
 	/// Carbon litter
@@ -3144,6 +3263,23 @@ private:
 	double nlitter[NSOMPOOL];
 };
 
+/// Daily records of soil state for the current year
+/** Each day only today's entry is written, and the whole year is only read
+ *  for annual summaries and outputs. Allocated separately from the Soil
+ *  object, which holds the state needed every day, and serialized as part
+ *  of Soil.
+ */
+struct SoilHistory {
+	/// daily water content in upper soil layer for each day of year
+	double dwcontupper[Date::MAX_YEAR_LENGTH];
+	/// daily water content in lower soil layer for each day of year
+	double dwcontlower[Date::MAX_YEAR_LENGTH];
+	/// daily thawing depth full, where ALL the ice has melted [mm]
+	double dthaw[Date::MAX_YEAR_LENGTH];
+	/// daily water table position [mm]
+	double wtp[Date::MAX_YEAR_LENGTH];
+};
+
 /// Soil stores state variables for soils and the snow pack.
 /** Initialised by a call to initdrivers. One Soil object is defined for each patch.
  *  A reference to the parent Patch object (defined below) is included as a member
@@ -3174,8 +3310,8 @@ public:
 	Soiltype& soiltype;
 	/// the average wcont over the growing season, for each of the upper soil layers. Used in drought limited establishment. 
 	double awcont_upper;
-	/// daily water content in upper soil layer for each day of year
-	double dwcontupper[Date::MAX_YEAR_LENGTH];
+	/// daily records for this year (see SoilHistory)
+	SoilHistory* history;
 	/// mean water content in upper soil layer for last month
 	/** (valid only on last day of month following call to daily_accounting_patch) */
 	double mwcontupper;
@@ -3207,6 +3343,20 @@ public:
 	/// mean value of decay constant for slow SOM fraction
 	double k_soilslow_mean;
 
+	// Accumulated over the days since the last decomposition (\see somdynam_step).
+	// Not serialized, decomposition steps end by the last day of each month.
+
+	/// number of days since the last decomposition
+	int decomp_ndays;
+	/// litter fraction remaining after the days since the last decomposition
+	double fr_litter_step;
+	/// fast SOM fraction remaining after the days since the last decomposition
+	double fr_soilfast_step;
+	/// slow SOM fraction remaining after the days since the last decomposition
+	double fr_soilslow_step;
+	/// sum of orgleachfrac over the days since the last decomposition
+	double orgleachfrac_step;
+
 
 	// Parameters used by function soiltemp and updated monthly
 
@@ -3214,8 +3364,6 @@ public:
 
 	/// water content of soil layers [0=upper layer] as fraction of available water holding capacity
 	double mwcont[12][NSOILLAYER];
-	/// daily water content in lower soil layer for each day of year
-	double dwcontlower[Date::MAX_YEAR_LENGTH];
 	/// mean water content in lower soil layer for last month
 	/** (valid only on last day of month following call to daily_accounting_patch) */
 	double mwcontlower;
@@ -3318,8 +3466,6 @@ public:
 	double thaw;
 	/// monthly thawing depth full, where ALL the ice has melted [mm]
 	double mthaw[12];
-	/// daily thawing depth full, where ALL the ice has melted [mm]
-	double dthaw[Date::MAX_YEAR_LENGTH];
 	
 	/// depth of the acrotelm [mm]
 	double acro_depth;
@@ -3357,8 +3503,6 @@ public:
 
 	// Peatland hydrology variables:
     
-	/// daily water table position [mm]
-	double wtp[Date::MAX_YEAR_LENGTH];
 	/// monthly average water table position [mm]
 	double mwtp[12];
 	/// annual average water table position [mm]
@@ -3575,11 +3719,23 @@ public:
 public:
 	/// constructor (initialises member variable patch)
 	Soil(Patch& p,Soiltype& s):patch(p),soiltype(s) {
+			history = new SoilHistory;
 			init_states();
 	}
 
+	~Soil() {
+		delete history;
+	}
+
 	void init_states();
 
+	/// Re-derives the layer water holding capacities from the patch's soil type
+	/** For soil state taken over from a grid cell with another soil
+	 *  (\see AnalogSpinup), the rest of the soil type dependent layer
+	 *  properties are set as for cloned patches on the next day.
+	 */
+	void reset_water_capacity();
+
 	/// return soil temperature at 25cm depth
 	double get_soil_temp_25() const;
 
@@ -3699,6 +3855,13 @@ private:
 	bool calculate_gas_ebullition(double& ebull_today);
 
 	void serialize(ArchiveStream& arch);
+	const char* state_tag() const { return "Soil"; }
+
+private:
+
+	// Not copyable, the history is owned by this object
+	Soil(const Soil&);
+	Soil& operator=(const Soil&);
 };
 
 /// Container for crop-specific data at patchpft level
@@ -3878,6 +4041,7 @@ struct cropphen_struct : public Serializable {
 	}
 
 	void serialize(ArchiveStream& arch);
+	const char* state_tag() const { return "cropphen_struct"; }
 };
 
 
@@ -3916,6 +4080,8 @@ public:
 	bool establish;
 	/// running total for number of saplings of this PFT to establish (cohort mode)
 	double nsapling;
+	/// net C allocated to reproduction for this PFT in this patch this year (kgC/m2)
+	double cmass_repr;
     /// expected value of number of seedling in stochest
     int exp_est;
 	/// leaf-derived litter for PFT on modelled area basis (kgC/m2)
@@ -3975,6 +4141,10 @@ public:
 	/// [0,1] - a measure of the inundation stress. Daily photosynthesis is reduced by this factor.
 	double inund_stress;
 
+	/// number of cohort merges for this PFT this year (cohort/individual mode with ifmergecohorts)
+	/** Reset each year in vegetation_dynamics(), not serialized */
+	int cohort_merges;
+
 
 	// MEMBER FUNCTIONS:
 
@@ -4004,6 +4174,7 @@ public:
 		wscal_mean_est = 0.0;
 		nsapling = 0;
         exp_est = 0;
+		cmass_repr = 0.0;
 
 		for(int i=0;i<NSOILLAYER;i++)
 			fwuptake[i]=0.0;
@@ -4022,6 +4193,8 @@ public:
 
 		inund_count=0;
 		inund_stress=1.0; // No stress by default
+
+		cohort_merges=0;
 	}
 
 	~Patchpft() {
@@ -4038,6 +4211,7 @@ public:
 	bool growingseason() const;
 
 	void serialize(ArchiveStream& arch);
+	const char* state_tag() const { return "Patchpft"; }
 };
 
 
@@ -4125,6 +4299,13 @@ public:
 	/// SIMFIRE fapar: Total fapar
 	double fapar_total_avg[N_YEAR_BIOMEAVG];
 
+	/// whether this patch was created as a copy of another patch (\see Stand::clone_patch)
+	/** Also set for the patches of grid cells received from another process
+	 *  (\see GridcellMigration), whose soil temperature state is initialised
+	 *  as for cloned patches.
+	 */
+	bool cloned;
+
 	/// whether management has started on this patch
 	bool managed;
 	/// cutting intensity (initial percent of trees cut, further selection at individual level has to be done in a separate function)
@@ -4215,6 +4396,7 @@ public:
 	Patch(int i,Stand& s,Soiltype& st);
 
 	void serialize(ArchiveStream& arch);
+	const char* state_tag() const { return "Patch"; }
 
 	/// Returns the Climate for this Patch
 	/** This function returns a const reference to prevent code which operates
@@ -4315,6 +4497,7 @@ public:
 	}
 
 	void serialize(ArchiveStream& arch);
+	const char* state_tag() const { return "Standpft"; }
 };
 
 
@@ -4373,6 +4556,8 @@ public:
 	double cloned_fraction;
 	/// Returns true if this stand is cloned from another stand
 	bool cloned;
+	/// Whether patches may be added to this stand during spinup (\see ifadaptivenpatch)
+	bool adaptive_npatch;
 	/// pointer to array of fractions transferred from this stand to other stand types
 	double *transfer_area_st;
 	/// land cover origin of this stand
@@ -4383,12 +4568,9 @@ public:
 	double cmass;
 
 	/// Seed for generating random numbers within this Stand
-	/** The reason why Stand has its own seed, rather than using for instance
-	 *  a single global seed is to make it easier to compare results when using
-	 *  different land cover types.
-	 *
-	 *  Randomness not associated with a specific stand, but rather a whole
-	 *  grid cell should instead use the seed in the Gridcell class.
+	/** No longer used, the stochastic vegetation processes draw their random
+	 *  numbers from a RandomStream for each patch instead. Kept so that state
+	 *  files stay compatible.
 	 *
 	 *  \see randfrac()
 	 */
@@ -4466,7 +4648,16 @@ public:
 	*/
 	Stand& clone(StandType& st, double fraction);
 
+	/// Adds a replicate of an existing patch to this stand
+	/** The new patch gets the id npatch() and a copy of the state of
+	 *  patch source.
+	 *
+	 *  \returns reference to the new patch
+	 */
+	Patch& clone_patch(unsigned int source);
+
 	void serialize(ArchiveStream& arch);
+	const char* state_tag() const { return "Stand"; }
 
 	/// Returns the Climate for this Stand
 	/** This function returns a const reference to prevent code which operates
@@ -4613,6 +4804,7 @@ public:
 	}
 
 	void serialize(ArchiveStream& arch);
+	const char* state_tag() const { return "Gridcellpft"; }
 };
 
 /// State variables common to all individuals of a particular STANDTYPE in a GRIDCELL.
@@ -4668,6 +4860,7 @@ public:
 	}
 
 	void serialize(ArchiveStream& arch);
+	const char* state_tag() const { return "Gridcellst"; }
 };
 
 /// Storage of land cover fraction data and some land cover change-related pools and fluxes
@@ -4732,6 +4925,7 @@ struct Landcover : public Serializable {
 	bool pool_from_all_landcovers[NLANDCOVERTYPES];
 
 	void serialize(ArchiveStream& arch);
+	const char* state_tag() const { return "Landcover"; }
 };
 
 /// The Gridcell class corresponds to a modelled locality or grid cell.
@@ -4820,10 +5014,21 @@ public:
 	 *  gets serialized together with the rest of the Gridcell state to make it
 	 *  possible to get exactly identical results after a restart.
 	 *
+	 *  Used by the input modules when generating daily forcing from monthly
+	 *  data. Processes in the patches use a RandomStream instead, so they
+	 *  don't depend on the order of the patches.
+	 *
 	 *  \see randfrac()
 	 */
 	long seed;
 
+	/// Simulation year from which this grid cell was resumed, -1 if simulated from the start
+	/** Set when the grid cell state is restored from a state file or received
+	 *  from another process, so that forcing read once at the beginning of
+	 *  the simulation is read again in that year. Not serialized.
+	 */
+	int resume_year;
+
 	// MEMBER FUNCTIONS
 
 	/// Constructs a Gridcell object
@@ -4839,6 +5044,7 @@ public:
 	void set_coordinates(double longitude, double latitude);
 
 	void serialize(ArchiveStream& arch);
+	const char* state_tag() const { return "Gridcell"; }
 
 	/// Creates a new Stand in this grid cell
 	Stand& create_stand(landcovertype lc, int no_patch = 0);
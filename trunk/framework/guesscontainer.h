@@ -163,6 +163,11 @@ protected:
 		return next_unique_id++;
 	}
 
+	/// The id number get_next_id() returns next, so it can be serialized
+	unsigned int& next_id() {
+		return next_unique_id;
+	}
+
 private:
 	/// Everything is implemented with std::vector
 	std::vector<T*> objects;
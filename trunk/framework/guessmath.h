@@ -112,6 +112,21 @@ inline double variation_coefficient(double* data, int n) {
 	return 0;
 }
 
+/// Number of samples needed for a mean with a given relative standard error
+/** The relative standard error of the mean of n samples with variation
+ *  coefficient cv is cv/sqrt(n).
+ *
+ *  \param cv         variation coefficient of the samples
+ *  \param tolerance  wanted relative standard error of the mean (> 0)
+ */
+inline int sample_size(double cv, double tolerance) {
+	double n = ceil(cv * cv / (tolerance * tolerance));
+	if (n < 1) {
+		return 1;
+	}
+	return n > 1e9 ? 1000000000 : (int)n;
+}
+
 /// A short version of Richards curve where:
 /** a is the lower asymptote,
  *  b is the upper asymptote. If a=0 then b is called the carrying capacity,
@@ -34,7 +34,8 @@ class GridcellSerializer {
 public:
 	void operator()(std::ostream& os, const Gridcell& gridcell) {
 		ArchiveOutStream aos(os);
-		const_cast<Gridcell&>(gridcell).serialize(aos);
+		aos.set_format(ARCHIVE_VERSION, true);
+		aos & const_cast<Gridcell&>(gridcell);
 	}
 };
 
@@ -48,12 +49,35 @@ public:
 	}
 };
 
+/// Format of a state file, as found in its meta data
+struct StateFormat {
+	/// The ARCHIVE_VERSION of the model which wrote the state
+	int version;
+
+	/// For each PFT in the state file, its index in pftlist (or -1)
+	/** Empty if the PFTs are the same as in pftlist */
+	std::vector<int> pft_map;
+};
+
 class GridcellDeserializer {
 public:
+	GridcellDeserializer(const StateFormat& format)
+		: format(format) {}
+
 	void operator()(std::istream& is, Gridcell& gridcell) {
 		ArchiveInStream ais(is);
-		gridcell.serialize(ais);
+
+		// Version 1 state files are untagged
+		ais.set_format(format.version, format.version >= 2);
+		ais.set_pft_map(format.pft_map);
+
+		ais & gridcell;
+
+		StateMigrationRegistry::get_instance().migrate(gridcell, format.version);
 	}
+
+private:
+	StateFormat format;
 };
 
 
@@ -67,6 +91,12 @@ std::string meta_file_path(const char* directory) {
 	return std::string(directory)+"/meta.bin";
 }
 
+/// Identifies meta data files with a format version
+/** Meta data files from before the format was versioned start with the
+ *  number of processes, and are taken to be version 1.
+ */
+const char META_MAGIC[8] = { 'L', 'P', 'J', 'G', 'S', 'T', 'A', 'T' };
+
 /// Creates the meta data file
 /** The meta data file contains information about the simulation
  *  for which we're saving the state, so that we can do some
@@ -83,6 +113,10 @@ void create_meta_data(const char* directory, int num_processes) {
 		fail("Failed to open meta data file for writing");
 	}
 
+	// Write the format version of the state
+	file.write(META_MAGIC, sizeof(META_MAGIC));
+	file.write((const char*)&ARCHIVE_VERSION, sizeof(ARCHIVE_VERSION));
+
 	// Write number of processes involved,
 	// we need to know this when we restart so we know how many
 	// state files to try and open
@@ -104,9 +138,15 @@ void create_meta_data(const char* directory, int num_processes) {
 /// Reads in the meta data and checks it
 /** This is only some basic checking, there are probably
  *  a lot of other things that are unwise to change
- *  before restarting from state files.
+ *  before restarting from state files. Changes to the
+ *  serialized classes are found by the tags in the state
+ *  itself.
+ *
+ *  PFTs are matched by name, so PFTs may be added to or
+ *  removed from the instruction file, see set_pft_map in
+ *  ArchiveStream.
  */
-void verify_meta_data(const char* directory, int& num_processes) {
+void verify_meta_data(const char* directory, int& num_processes, StateFormat& format) {
 
 	// Open the file
 	std::ifstream file(meta_file_path(directory).c_str(),
@@ -116,6 +156,26 @@ void verify_meta_data(const char* directory, int& num_processes) {
 		fail("Failed to open meta data file for reading");
 	}
 
+	// Read the format version
+	char magic[sizeof(META_MAGIC)];
+	file.read(magic, sizeof(magic));
+
+	if (file.good() && std::equal(magic, magic + sizeof(magic), META_MAGIC)) {
+		file.read((char*)&format.version, sizeof(format.version));
+
+		if (format.version > ARCHIVE_VERSION) {
+			fail("State file has format version %d, this version of LPJ-GUESS reads up to version %d",
+			     format.version, ARCHIVE_VERSION);
+		}
+	}
+	else {
+		file.clear();
+		file.seekg(0);
+		format.version = 1;
+	}
+
+	dprintf("Reading state with format version %d\n", format.version);
+
 	// Read number of processes involved in the old simulation
 	// (not necessarily the same number as in the current job)
 	file.read((char*)&num_processes, sizeof(num_processes));
@@ -128,16 +188,15 @@ void verify_meta_data(const char* directory, int& num_processes) {
 		fail("State file has incompatible vegetation mode");
 	}
 
-	// Verify that the number of PFTs is the same
 	int npft_from_file;
 	file.read((char*)&npft_from_file, sizeof(npft_from_file));
 
-	if (npft != npft_from_file) {
-		fail("State file has different number of PFTs");
-	}
+	// Find the PFTs of the state file in the PFT list
+	std::vector<int> pft_map;
+	std::vector<bool> in_state(npft, false);
+	bool same_pfts = npft == npft_from_file;
 
-	// Verify that the PFTs have the same names
-	for (int i = 0; i < npft; i++) {
+	for (int i = 0; i < npft_from_file; i++) {
 
 		const size_t PFT_NAME_MAX_SIZE = 256;
 
@@ -152,12 +211,34 @@ void verify_meta_data(const char* directory, int& num_processes) {
 		file.read(buffer, length);
 		buffer[length] = '\0';
 
-		if (xtring(buffer) != pftlist[i].name) {
-			fail("PFT list changed, expected %s, got %s", 
-			     (char*)pftlist[i].name,
-			     buffer);
+		const int current = pftlist.getpftid(buffer);
+		pft_map.push_back(current);
+
+		if (current < 0) {
+			dprintf("WARNING ! PFT %s in the state file is not in the PFT list, its state is dropped\n",
+			        buffer);
+		}
+		else {
+			in_state[current] = true;
+		}
+
+		same_pfts = same_pfts && current == i;
+	}
+
+	if (file.fail()) {
+		fail("Failed to read meta data file");
+	}
+
+	for (int i = 0; i < npft; i++) {
+		if (!in_state[i]) {
+			dprintf("WARNING ! PFT %s is not in the state file, it starts from its initial state\n",
+			        (char*)pftlist[i].name);
 		}
 	}
+
+	if (!same_pfts) {
+		format.pft_map = pft_map;
+	}
 }
 
 }
@@ -214,10 +295,10 @@ void GuessSerializer::serialize_gridcell(const Gridcell& gridcell) {
 
 // Contains members of GuessDeserializer which we don't want in the header
 struct GuessDeserializer::Impl {
-	Impl(const char* directory, int max_rank)
+	Impl(const char* directory, int max_rank, const StateFormat& format)
 		: pmd(directory,
 		      max_rank,
-		      GridcellDeserializer(),
+		      GridcellDeserializer(format),
 		      CoordDeserializer()) {
 	}
 
@@ -231,9 +312,12 @@ struct GuessDeserializer::Impl {
 GuessDeserializer::GuessDeserializer(const char* directory) {
 	try {
 		int num_processes;
-		verify_meta_data(directory, num_processes);
+		StateFormat format;
+		verify_meta_data(directory, num_processes, format);
+
+		StateMigrationRegistry::get_instance().report(format.version);
 
-		pimpl = new Impl(directory, num_processes - 1);
+		pimpl = new Impl(directory, num_processes - 1, format);
 	}
 	catch (const PartitionedMapSerializerError& e) {
 		fail(e.what());
@@ -252,6 +336,9 @@ void GuessDeserializer::deserialize_gridcell(Gridcell& gridcell) {
 	catch (const PartitionedMapSerializerError& e) {
 		fail(e.what());
 	}
+	catch (const ArchiveError& e) {
+		fail("Failed to read state for (%g,%g). %s", gridcell.get_lon(), gridcell.get_lat(), e.what());
+	}
 }
 
 void GuessDeserializer::deserialize_gridcells(const std::vector<Gridcell*>& gridcells) {
@@ -267,4 +354,36 @@ void GuessDeserializer::deserialize_gridcells(const std::vector<Gridcell*>& grid
 	catch (const PartitionedMapSerializerError& e) {
 		fail(e.what());
 	}
+	catch (const ArchiveError& e) {
+		fail("Failed to read state. %s", e.what());
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+// StateMigrationRegistry
+//
+
+StateMigrationRegistry& StateMigrationRegistry::get_instance() {
+	static StateMigrationRegistry instance;
+	return instance;
+}
+
+void StateMigrationRegistry::register_migration(int version,
+                                                StateMigrationFunction migration,
+                                                const char* description) {
+	migrations.insert(std::make_pair(version, Migration(migration, description)));
+}
+
+void StateMigrationRegistry::migrate(Gridcell& gridcell, int from_version) const {
+	std::multimap<int, Migration>::const_iterator itr;
+	for (itr = migrations.upper_bound(from_version); itr != migrations.end(); ++itr) {
+		(itr->second.first)(gridcell);
+	}
+}
+
+void StateMigrationRegistry::report(int from_version) const {
+	std::multimap<int, Migration>::const_iterator itr;
+	for (itr = migrations.upper_bound(from_version); itr != migrations.end(); ++itr) {
+		dprintf("Migrating state to version %d: %s\n", itr->first, itr->second.second.c_str());
+	}
 }
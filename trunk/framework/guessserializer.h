@@ -10,6 +10,8 @@
 #define LPJ_GUESS_GUESS_SERIALIZER_H
 
 #include <vector>
+#include <map>
+#include <string>
 
 class Gridcell;
 
@@ -61,4 +63,73 @@ private:
 	Impl* pimpl;
 };
 
+/// Brings a grid cell read from an older state file up to date
+typedef void (*StateMigrationFunction)(Gridcell& gridcell);
+
+/// Keeps track of the migrations of state from older format versions
+/** When a serialize function changes, ARCHIVE_VERSION (see archive.h) is
+ *  increased and the serialize function reads the fields of older versions
+ *  depending on ArchiveStream::version(). Whatever can't be read from the
+ *  old state (e.g. a new field which should be derived from others) is
+ *  then set up by a migration, registered with the REGISTER_STATE_MIGRATION
+ *  macro for the version which introduced the change.
+ *
+ *  After a grid cell has been read from a state file, the migrations for
+ *  all versions newer than the state file are run, oldest first.
+ *
+ *  The StateMigrationRegistry is a singleton, retrieved with the
+ *  get_instance() member function.
+ */
+class StateMigrationRegistry {
+public:
+	/// Returns the one and only migration registry
+	static StateMigrationRegistry& get_instance();
+
+	/// Registers a migration
+	/** This function shouldn't be called directly, use the
+	 *  REGISTER_STATE_MIGRATION macro below instead.
+	 */
+	void register_migration(int version,
+	                        StateMigrationFunction migration,
+	                        const char* description);
+
+	/// Runs the migrations for the versions after from_version
+	void migrate(Gridcell& gridcell, int from_version) const;
+
+	/// Prints the migrations which will be run for state of from_version
+	void report(int from_version) const;
+
+private:
+	/// Private constructor to make sure we only have one instance
+	StateMigrationRegistry() {}
+
+	/// Also private to prevent copying
+	StateMigrationRegistry(const StateMigrationRegistry&);
+
+	typedef std::pair<StateMigrationFunction, std::string> Migration;
+
+	/// The migrations and their descriptions, by version
+	std::multimap<int, Migration> migrations;
+};
+
+/// A macro used to register migrations of state
+/** For instance:
+ *
+ *  REGISTER_STATE_MIGRATION(3, init_soil_layers, "Soil layers from the old soil water")
+ *
+ *  where 3 is the version which needs the migration (the ARCHIVE_VERSION
+ *  which introduced the change), init_soil_layers a StateMigrationFunction
+ *  and the last argument a description printed when the migration is used.
+ */
+#define REGISTER_STATE_MIGRATION(version, function, description) \
+namespace function##_migration_registration { \
+\
+int dummy() {\
+	StateMigrationRegistry::get_instance().register_migration(version, function, description);\
+	return 0;\
+}\
+\
+int x = dummy();\
+}
+
 #endif // LPJ_GUESS_GUESS_SERIALIZER_H
@@ -13,6 +13,11 @@
 #include "config.h"
 #include "guess.h"
 
+#ifdef HAVE_NETCDF
+#include "guessnc.h"
+#include "cf.h"
+#endif
+
 using namespace InData;
 
 /// Default value for gridlist and text input spatial resolution.
@@ -27,6 +32,178 @@ const bool MAPFILE = true;
 
 const bool ascendinglongitudes = false;	//Not true for randomised gridlists; set to false for now
 
+/// Chunk cache size (bytes) per variable in NetCDF input; enough for the chunks along the time axis of a typical grid cell
+const size_t NC_CHUNK_CACHE = 64 * 1024 * 1024;
+
+namespace {
+
+/// Checks whether a file is a NetCDF file (classic or NetCDF-4/HDF5 format) by its first bytes
+bool is_netcdf_file(const char* name) {
+
+	FILE* f = fopen(name, "rb");
+	if(!f)
+		return false;
+
+	unsigned char magic[4] = {0};
+	size_t n = fread(magic, 1, 4, f);
+	fclose(f);
+
+	return n == 4 && ((magic[0] == 'C' && magic[1] == 'D' && magic[2] == 'F') ||
+	                  (magic[0] == 0x89 && magic[1] == 'H' && magic[2] == 'D' && magic[3] == 'F'));
+}
+
+}
+
+namespace InData {
+
+/// Reads yearly or static data for one coordinate at a time from a CF NetCDF file
+/** Every variable in the file with (lon,lat) dimensions is a data column.
+ *  Variables with a time dimension are yearly, each coordinate's whole time
+ *  series is read in one request per variable. Variables without one are
+ *  static, their value is used for every year.
+ */
+class TimeDataDnc {
+
+public:
+
+#ifdef HAVE_NETCDF
+	/// Opens all data variables in a file, throws GuessNC::GuessNCError if the file can't be used
+	TimeDataDnc(const char* name);
+
+	~TimeDataDnc();
+
+	/// Loads data for a coordinate into data (nyears x number of columns). Returns false if coordinate not found.
+	bool Load(Coord c, double* data) const;
+
+	/// Data column (variable) names
+	std::vector<std::string> names;
+	/// Whether any variable has a time dimension
+	bool yearly;
+	/// First year of data, -1 if static
+	int firstyear;
+	/// Number of data years, 1 if static
+	int nyears;
+
+private:
+
+	/// Deletes the variables
+	void Clear();
+
+	/// One variable per data column
+	std::vector<GuessNC::CF::GridcellOrderedVariable*> columns;
+#endif
+};
+
+#ifdef HAVE_NETCDF
+
+TimeDataDnc::TimeDataDnc(const char* name) : yearly(false), firstyear(-1), nyears(1) {
+
+	using namespace GuessNC::CF;
+
+	int ncid = GuessNC::open_ncdf(name);
+	std::vector<std::string> variables = GuessNC::get_data_variables(ncid);
+	GuessNC::close_ncdf(ncid);
+
+	try {
+		for(size_t i=0; i<variables.size() && columns.size()<MAXRECORDS; i++) {
+
+			GridcellOrderedVariable* var;
+
+			try {
+				// Static variables (no time dimension) allowed
+				var = new GridcellOrderedVariable(name, variables[i].c_str(), 2, true);
+			}
+			catch(const CFError& e) {
+				// Bounds, grid mapping variables etc.
+				dprintf("Ignoring %s in %s: %s\n", variables[i].c_str(), name, e.what());
+				continue;
+			}
+			columns.push_back(var);
+			names.push_back(variables[i]);
+
+			if(var->is_reduced())
+				throw CFError(variables[i], "Reduced grids are not supported for land cover and management input");
+
+			if(var->is_static())
+				continue;
+
+			int n = var->get_timesteps();
+			if(!n)
+				throw CFError(variables[i], "No time steps");
+
+			int first = var->get_date_time(0).get_year();
+			for(int t=1; t<n; t++) {
+				if(var->get_date_time(t).get_year() != first + t)
+					throw CFError(variables[i], "Time dimension must have one time step per year");
+			}
+
+			if(!yearly) {
+				yearly = true;
+				firstyear = first;
+				nyears = n;
+			}
+			else if(first != firstyear || n != nyears) {
+				throw CFError(variables[i], "Years differ from other variables in the file");
+			}
+
+			if(!var->set_location_chunk_cache(NC_CHUNK_CACHE))
+				dprintf("WARNING: %s in %s is chunked in a way that is slow to read by grid cell, consider rechunking along the time dimension\n",
+					variables[i].c_str(), name);
+		}
+
+		if(columns.empty())
+			throw GuessNC::GuessNCError(std::string("No data variables found in ") + name);
+	}
+	catch(...) {
+		Clear();
+		throw;
+	}
+}
+
+TimeDataDnc::~TimeDataDnc() {
+	Clear();
+}
+
+void TimeDataDnc::Clear() {
+
+	for(size_t i=0; i<columns.size(); i++)
+		delete columns[i];
+	columns.clear();
+}
+
+bool TimeDataDnc::Load(Coord c, double* data) const {
+
+	size_t x, y;
+
+	// All variables in the file share the same grid
+	try {
+		columns.front()->get_index_for_coords(c.lon, c.lat, x, y);
+	}
+	catch(const GuessNC::CF::CFError&) {
+		return false;
+	}
+
+	const size_t ncolumns = columns.size();
+
+	for(size_t i=0; i<ncolumns; i++) {
+
+		GuessNC::CF::GridcellOrderedVariable& var = *columns[i];
+
+		// Whole time series for the coordinate, false if missing values
+		if(!var.load_data_for(x, y))
+			return false;
+
+		for(int t=0; t<nyears; t++)
+			data[t * ncolumns + i] = var.get_value(var.is_static() ? 0 : t);
+	}
+
+	return true;
+}
+
+#endif // HAVE_NETCDF
+
+}
+
 bool TimeDataD::item_has_data(char* name) {
 
 	int column = GetColumn(name);
@@ -84,7 +261,7 @@ void TimeDataD::CheckIfPresent(ListArray_id<Coord>& gridlist) { //Requires gutil
 	}
 
 	gridlist.firstobj();
-	rewind(ifp);
+	Rewind();
 	ischeckingdata = false;
 }
 
@@ -230,6 +407,13 @@ bool TimeDataD::Open(const char* name) {
 		delete []fileName;
 		fileName = NULL;
 	}
+	if(nc_source) {
+		delete nc_source;
+		nc_source = NULL;
+	}
+
+	if(name && is_netcdf_file(name))
+		return OpenNetCDF(name);
 
 	if(name)
 		ifp = fopen(name, "r");
@@ -289,6 +473,92 @@ bool TimeDataD::Open(const char* name) {
 	return true;
 }
 
+bool TimeDataD::OpenNetCDF(const char* name) {
+
+#ifdef HAVE_NETCDF
+	try {
+		nc_source = new TimeDataDnc(name);
+	}
+	catch(const std::runtime_error& e) {
+		printf("TimeDataD::Open: File %s could not be used for input: %s\n\n", name, e.what());
+		return false;
+	}
+
+	fileName = new char[strlen(name) + 1];
+	strcpy(fileName, name);
+
+	nColumns = (int)nc_source->names.size();
+	for(int i=0; i<nColumns; i++) {
+		header_arr[i] = new char[MAXNAMESIZE];
+		strncpy(header_arr[i], nc_source->names[i].c_str(), MAXNAMESIZE - 1);
+		header_arr[i][MAXNAMESIZE - 1] = '\0';
+	}
+
+	ifheader = true;
+	format = nc_source->yearly ? LOCAL_YEARLY : LOCAL_STATIC;
+	firstyear = nc_source->firstyear;
+	nYears = nc_source->nyears;
+	nCells = 1;					// Set to the gridlist size when opened with a gridlist
+	unity_data = true;
+
+	if(!Allocate())	{
+		printf("Could not allocate memory for data from file %s!\n", name);
+		return false;
+	}
+
+	return true;
+#else
+	printf("TimeDataD::Open: File %s is a NetCDF file, but this version of LPJ-GUESS is built without NetCDF support !\n\n", name);
+	return false;
+#endif
+}
+
+bool TimeDataD::LoadNetCDF(Coord c) {
+
+#ifdef HAVE_NETCDF
+	loaded = nc_source->Load(c, data);
+
+	if(loaded) {
+		currentStand = c;
+		if(format == LOCAL_YEARLY) {
+			for(int i=0; i<nYears; i++)
+				year[i] = firstyear + i;
+		}
+	}
+	return loaded;
+#else
+	return false;
+#endif
+}
+
+bool TimeDataD::ParseNormalisationNetCDF(ListArray_id<Coord>& gridlist) {
+
+	// As ParseNormalisation(), but samples the gridlist as there is no file to step through
+	bool unity_data = true;
+	int cell = 0;
+	const int maxnsample = 200;
+
+	gridlist.firstobj();
+	while(gridlist.isobj && cell < maxnsample) {
+		if(Load(gridlist.getobj())) {
+			for(int y=0;y<nYears;y++) {
+				double sum = 0.0;
+				for(int i=0;i<nColumns;i++) {
+					sum += Get(y + firstyear, i);
+				}
+				if(sum > 0.0 && (sum < 0.99 || sum > 1.01))
+					unity_data = false;
+			}
+			cell++;
+		}
+		gridlist.nextobj();
+	}
+	gridlist.firstobj();
+	loaded = false;
+
+	return unity_data;
+}
+
 bool TimeDataD::ParseNormalisation() {
 
 	bool unity_data = true;
@@ -378,7 +648,12 @@ bool TimeDataD::Open(const char* name, ListArray_id<Coord>& gridlist, double gri
 
 		SetOffset(gridlist_offset);
 
-		if(format == GLOBAL_STATIC || format == GLOBAL_YEARLY) {
+		if(nc_source) {
+			// Data for each coordinate are read directly from the NetCDF file
+			nCells = gridlist.nobj;
+			unity_data = ParseNormalisationNetCDF(gridlist);
+		}
+		else if(format == GLOBAL_STATIC || format == GLOBAL_YEARLY) {
 		}
 		else if (LUTOMEMORY) {
 			CopyToMemory(gridlist.nobj, gridlist);
@@ -998,7 +1273,9 @@ bool TimeDataD::Load(Coord c) {
 		c.lon += offset;
 		c.lat += offset;
 	}
-	if(memory_copy)
+	if(nc_source)
+		return LoadNetCDF(c);
+	else if(memory_copy)
 		return memory_copy->Load(c);
 	else if(filemap)
 		return LoadFromMap(c);
@@ -1671,6 +1948,7 @@ TimeDataD::TimeDataD(fileformat formatX) {
 	format = formatX;
 	memory_copy = NULL;
 	filemap = NULL;
+	nc_source = NULL;
 	spatial_resolution = DEFAULT_SPATIAL_RESOLUTION;
 	offset = 0.0;
 	loaded = false;
@@ -1707,6 +1985,10 @@ void TimeDataD::Close() {
 	}
 	if(filemap)
 		delete[] filemap;
+	if(nc_source) {
+		delete nc_source;
+		nc_source = NULL;
+	}
 
 	for(int i=0;i<MAXRECORDS;i++) {
 		if(&header_arr[i]) {
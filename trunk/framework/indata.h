@@ -4,6 +4,7 @@
 /// File format can be either line 1:lon lat, line 2 etc.: year data-columns OR line 1: header, 
 /// line 2 etc.: lon lat year data-columns. For local static data, use: lon lat data-columns,
 /// for global static data, use: dummy data-columns (with "static" as first word in header).
+/// Local yearly and static data can also be read from CF NetCDF files (see TimeDataD::Open).
 /// \author Mats Lindeskog
 /// $Date: 2016-12-08 18:24:04 +0100 (Do, 08 Dez 2016) $
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -46,6 +47,9 @@ struct CoordPos {
 // Forward declaration of TimeDataDmem
 class TimeDataDmem;
 
+// Forward declaration of TimeDataDnc
+class TimeDataDnc;
+
 /// Class for reading a set of double data at coordinate positions over time (years), alternatively static or/and global.
 class TimeDataD	{
 
@@ -92,6 +96,8 @@ class TimeDataD	{
 	TimeDataDmem *memory_copy;
 	/// Pointer to map of file positions of data for all gridcells in the file
 	CoordPos *filemap;
+	/// Pointer to NetCDF reader if the input file is a NetCDF file
+	TimeDataDnc *nc_source;
 
 	// PRIVATE METHODS
 
@@ -127,6 +133,11 @@ class TimeDataD	{
 	/// Copies all data for the specified gridlist to memory
 	void CopyToMemory(int ncells, ListArray_id<Coord>& lonlatlist);
 
+	/// Methods for NetCDF input files
+	bool OpenNetCDF(const char* name);			//Called from Open()
+	bool LoadNetCDF(Coord c);					//Called from Load(Coord)
+	bool ParseNormalisationNetCDF(ListArray_id<Coord>& gridlist);
+
 public:
 
 	// PUBLIC METHODS
@@ -139,6 +150,13 @@ public:
 	// Methods to open input files and access data
 
 	/// Opens input file, checks format and allocates memory. Returns false if error
+	/** A NetCDF file is recognised by its content. Each variable in it with two
+	 *  spatial dimensions is a data column named as the variable. A time dimension
+	 *  must have one time step per year, a variable without one is static and its
+	 *  value used for all years. A file with only static variables is read as
+	 *  LOCAL_STATIC data. Data for a coordinate are read directly from the file
+	 *  by Load(Coord), nothing is copied to memory.
+	 */
 	bool Open(const char* name);
 	/// Opens input file, checks format and allocates memory. Copies all data for the gridlist into memory if LUTOMEMORY is defined. Returns false if error.
 	bool Open(const char* name, ListArray_id<Coord>& gridlist, double gridlist_offset = 0.0);
@@ -83,6 +83,78 @@ public:
 
 	/// Obtains land management data for one day
 	virtual void getmanagement(Gridcell& gridcell) = 0;
+
+	/// Tells the module whether the climate for the next grid cell will be replayed
+	/** Called by the forcing cache (see ForcingCacheInput) before getgridcell().
+	 *  When replay is true, all climate values set by getclimate() will be
+	 *  overwritten with values from the cache, so the module may skip reading
+	 *  and preparing the climate forcing for that grid cell. Everything else
+	 *  (coordinates, soil, land cover and management data, and returning false
+	 *  from getclimate() when the grid cell is done) must still be done as usual.
+	 *
+	 *  The default implementation ignores the hint.
+	 */
+	virtual void set_climate_replay(bool replay) {}
+
+	/// Coordinates of the grid cell the next call to getgridcell() will return
+	/** Called by the forcing cache before set_climate_replay(), to look
+	 *  for the cache file of the grid cell. Should return false if there
+	 *  are no more grid cells, or if the module can't tell (the default),
+	 *  in which case the climate is prepared by the module and replaced
+	 *  by the cached climate if there is any.
+	 */
+	virtual bool next_gridcell_coordinates(double& lon, double& lat) { return false; }
+
+	/// Whether the module can supply forcing for grid cells migrated from another process
+	/** \see getmigratedgridcell, migration.h. The default is false, which
+	 *  disables migration.
+	 */
+	virtual bool allows_migration() const { return false; }
+
+	/// Obtains coordinates and soil static parameters for a grid cell from another process
+	/** Does what getgridcell() does, but for the grid cell at (lon, lat), which
+	 *  needn't be in this process's gridlist, and without moving on to the next
+	 *  grid cell of the gridlist. The framework then restores the state of the
+	 *  grid cell from the other process and continues its simulation, so
+	 *  getclimate() is called from the year the grid cell arrives in, not from
+	 *  the first year of the simulation.
+	 *
+	 *  Only called if allows_migration() returns true. Should return false if
+	 *  no forcing can be found for the grid cell.
+	 */
+	virtual bool getmigratedgridcell(Gridcell& gridcell, double lon, double lat) { return false; }
+
+	/// Number of years getclimate() will simulate for each grid cell
+	/** Used by the framework to set Date::islastyear, so grid cells aren't
+	 *  migrated after their last year. The default, 0, means the module
+	 *  can't tell, islastyear is then never set.
+	 */
+	virtual int get_simulation_years() const { return 0; }
+
+	/// Whether the module can get its forcing from an I/O process
+	/** \see read_forcing, ioforwarding.h. The default is false, which
+	 *  disables I/O forwarding.
+	 */
+	virtual bool allows_forwarding() const { return false; }
+
+	/// Reads the raw forcing of a grid cell for another process
+	/** Called in I/O processes for the grid cells of the processes they
+	 *  serve. Should read what getgridcell() would otherwise read from the
+	 *  forcing files for the grid cell at (lon, lat), and pack it into
+	 *  buffer. When IOForwarding::active() is true, getgridcell() should get
+	 *  that buffer with IOForwarding::fetch() instead of reading the files.
+	 *
+	 *  Only called if allows_forwarding() returns true. Should return false
+	 *  if no forcing can be found for the grid cell.
+	 */
+	virtual bool read_forcing(double lon, double lat, std::string& buffer) { return false; }
+
+	/// Number of grid cells in the gridlist of this process
+	/** Used to check that I/O processes, which simulate no grid cells, have
+	 *  an empty gridlist. Modules allowing forwarding should implement it,
+	 *  the default, -1, means the module can't tell.
+	 */
+	virtual int get_gridlist_size() const { return -1; }
 };
 
 
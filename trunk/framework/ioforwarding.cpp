@@ -0,0 +1,162 @@
+///////////////////////////////////////////////////////////////////////////////////////
+/// \file ioforwarding.cpp
+/// \brief Dedicated processes reading the forcing for the others in a parallel run
+///
+/// $Date$
+///
+///////////////////////////////////////////////////////////////////////////////////////
+
+#include "config.h"
+#include "ioforwarding.h"
+#include "inputmodule.h"
+#include "parallel.h"
+#include "archive.h"
+#include "shell.h"
+
+#include <algorithm>
+#include <sstream>
+#include <vector>
+
+namespace IOForwarding {
+
+namespace {
+
+/// Tag of requests for the forcing of a grid cell, an empty request means finished
+const int TAG_REQUEST = 7101;
+
+/// Tag of the answers, with the forcing or empty if none was found
+const int TAG_REPLY = 7102;
+
+/// Whether this process is an I/O process
+bool io = false;
+
+/// Rank of the I/O process serving this process, -1 if it reads its own forcing
+int io_process = -1;
+
+/// Number of compute processes served by this process
+int nclients = 0;
+
+}
+
+void init(int nio_per_node, InputModule& input_module) {
+
+	if (nio_per_node <= 0) {
+		return;
+	}
+
+	// Collective, so all processes must get here
+	std::vector<int> node = GuessParallel::get_node_processes();
+
+	if (!input_module.allows_forwarding()) {
+		dprintf("WARNING ! The input module doesn't support I/O forwarding, all processes read their own forcing\n");
+		return;
+	}
+
+	// Leave at least one process on the node to do the computing
+	const int nio = std::min(nio_per_node, (int)node.size() - 1);
+	const int rank = GuessParallel::get_rank();
+
+	for (int i = 0; i < nio; i++) {
+		if (node[i] == rank) {
+			io = true;
+		}
+	}
+
+	// The compute processes are dealt out to the I/O processes in turn
+	for (int i = nio; nio > 0 && i < (int)node.size(); i++) {
+		int serving = node[(i - nio) % nio];
+		if (node[i] == rank) {
+			io_process = serving;
+		}
+		if (serving == rank) {
+			nclients++;
+		}
+	}
+
+	// The gridlist of an I/O process would silently go unsimulated. All
+	// processes stop, a single failing process would leave the others
+	// waiting for it.
+	const int ngridcells = io ? input_module.get_gridlist_size() : 0;
+	if (GuessParallel::any(ngridcells > 0)) {
+		if (ngridcells > 0) {
+			fail("I/O forwarding: process %d reads forcing for other processes and can't simulate "
+			     "the %d grid cell(s) in its gridlist. Give the first %d process(es) on each node "
+			     "an empty gridlist, or run without -io-procs\n", rank, ngridcells, nio);
+		}
+		fail("I/O forwarding: an I/O process has grid cells in its gridlist, see its log\n");
+	}
+
+	if (nio <= 0) {
+		dprintf("WARNING ! Too few processes on this node for I/O forwarding, reading own forcing\n");
+	}
+	else if (io) {
+		dprintf("I/O forwarding: this process reads the forcing for %d other process(es)\n", nclients);
+	}
+	else {
+		dprintf("I/O forwarding: forcing is read by process %d\n", io_process);
+	}
+}
+
+bool is_io_process() {
+	return io;
+}
+
+bool active() {
+	return io_process >= 0;
+}
+
+bool fetch(double lon, double lat, std::string& buffer) {
+
+	std::ostringstream os;
+	ArchiveOutStream arch(os);
+	arch & lon & lat;
+
+	GuessParallel::send(io_process, TAG_REQUEST, os.str());
+
+	int from = io_process;
+	buffer = GuessParallel::receive(from, TAG_REPLY);
+
+	return !buffer.empty();
+}
+
+void serve(InputModule& input_module) {
+
+	int nfinished = 0;
+	int ncells = 0;
+
+	// Requests are answered in the order they arrive, the compute processes
+	// only wait for their own grid cells
+	while (nfinished < nclients) {
+
+		int from = -1;
+		std::string request = GuessParallel::receive(from, TAG_REQUEST);
+
+		if (request.empty()) {
+			nfinished++;
+			continue;
+		}
+
+		std::istringstream is(request);
+		ArchiveInStream arch(is);
+		double lon, lat;
+		arch & lon & lat;
+
+		std::string buffer;
+		if (!input_module.read_forcing(lon, lat, buffer)) {
+			buffer.clear();
+		}
+
+		GuessParallel::send(from, TAG_REPLY, buffer);
+		ncells++;
+	}
+
+	dprintf("I/O forwarding: forcing read for %d grid cell(s)\n", ncells);
+}
+
+void finish() {
+	if (active()) {
+		GuessParallel::send(io_process, TAG_REQUEST, std::string());
+	}
+}
+
+}
@@ -0,0 +1,78 @@
+///////////////////////////////////////////////////////////////////////////////////////
+/// \file ioforwarding.h
+/// \brief Dedicated processes reading the forcing for the others in a parallel run
+///
+/// Normally every process of a parallel run opens and reads the forcing
+/// files by itself, which on a shared file system means many small
+/// uncoordinated reads once the number of processes gets large. With the
+/// -io-procs option, the first few processes on each node only read
+/// forcing. The other processes on the node (the compute processes) are
+/// shared out among them, and get the forcing of each grid cell as one
+/// message from their I/O process instead of reading the files.
+///
+/// What is forwarded is the raw forcing of a grid cell as read from the
+/// files (see InputModule::read_forcing), the compute process prepares the
+/// daily forcing from it as usual. The simulation is therefore unaffected,
+/// random numbers drawn while preparing the forcing included.
+///
+/// I/O processes don't simulate any grid cells, so their gridlists must be
+/// empty: the run stops with an error otherwise, rather than leaving the
+/// grid cells out. Grid cells are not redistributed from I/O processes to
+/// compute processes, the gridlists are split among the compute processes
+/// when the run is set up.
+///
+/// Forwarding is supported by the CRU and demo input modules. The CF input
+/// module, and SIMFIRE and other auxiliary inputs of all modules, are still
+/// read by each process itself. An I/O process reads the forcing of one
+/// grid cell per request, it doesn't read slabs of several grid cells.
+///
+/// $Date$
+///
+///////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef LPJ_GUESS_IO_FORWARDING_H
+#define LPJ_GUESS_IO_FORWARDING_H
+
+#include <string>
+
+class InputModule;
+
+namespace IOForwarding {
+
+/// Decides which processes read the forcing for the others
+/** Must be called by all processes, after the input module is initialised.
+ *  Forwarding is only used if the input module supports it, and on nodes
+ *  with at least one process left for computing. Fails if an I/O process
+ *  has grid cells in its gridlist.
+ *
+ *  \param nio_per_node  Number of I/O processes on each node, 0 disables forwarding
+ *  \param input_module  The input module, the same in all processes
+ */
+void init(int nio_per_node, InputModule& input_module);
+
+/// Whether this process reads forcing for other processes (and does nothing else)
+bool is_io_process();
+
+/// Whether this process gets its forcing from an I/O process
+/** Input modules supporting forwarding check this in getgridcell() */
+bool active();
+
+/// Gets the forcing of a grid cell from the I/O process
+/** \param lon     Longitude of the grid cell, as given in the gridlist
+ *  \param lat     Latitude of the grid cell, as given in the gridlist
+ *  \param buffer  Set to the forcing as written by InputModule::read_forcing
+ *  \returns false if the I/O process found no forcing for the grid cell
+ */
+bool fetch(double lon, double lat, std::string& buffer);
+
+/// Reads forcing for the compute processes until they have all finished
+/** Only to be called in I/O processes */
+void serve(InputModule& input_module);
+
+/// Tells the I/O process that this process doesn't need any more forcing
+/** To be called by all processes at the end of the simulation */
+void finish();
+
+}
+
+#endif // LPJ_GUESS_IO_FORWARDING_H
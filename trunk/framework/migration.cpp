@@ -0,0 +1,183 @@
+///////////////////////////////////////////////////////////////////////////////////////
+/// \file migration.cpp
+/// \brief Moving grid cells from busy to idle processes in a parallel run
+///
+/// $Date$
+///
+///////////////////////////////////////////////////////////////////////////////////////
+
+#include "config.h"
+#include "migration.h"
+#include "guess.h"
+#include "inputmodule.h"
+#include "parallel.h"
+#include "archive.h"
+
+#include <sstream>
+#include <string>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+/// Tag of the messages asking for a grid cell
+const int TAG_REQUEST = 7001;
+
+/// Tag of the answers, with a serialized grid cell or empty
+const int TAG_REPLY = 7002;
+
+/// Pause between polls while waiting for other processes
+void wait_a_moment() {
+#ifdef _WIN32
+	Sleep(1);
+#else
+	usleep(1000);
+#endif
+}
+
+}
+
+GridcellMigration::GridcellMigration(bool enabled, InputModule& input_module)
+	: enabled(enabled && GuessParallel::get_num_processes() > 1),
+	  input_module(input_module),
+	  next((GuessParallel::get_rank() + 1) % GuessParallel::get_num_processes()),
+	  nsent(0),
+	  nreceived(0) {
+}
+
+bool GridcellMigration::end_of_year(Gridcell& gridcell, bool own) {
+
+	if (!enabled) {
+		return false;
+	}
+
+	if (!own) {
+		decline_requests();
+		return false;
+	}
+
+	// Nothing left to simulate for this grid cell. The request is left
+	// waiting, it is answered after a year of the next grid cell or, if
+	// there is none, with an empty reply once this process asks for work.
+	if (date.islastyear) {
+		return false;
+	}
+
+	int to = -1;
+	if (!GuessParallel::message_arrived(to, TAG_REQUEST)) {
+		return false;
+	}
+	GuessParallel::receive(to, TAG_REQUEST);
+
+	// The receiving process continues with the next year
+	double lon = gridcell.get_lon();
+	double lat = gridcell.get_lat();
+	int year = date.year + 1;
+
+	std::ostringstream os;
+	ArchiveOutStream arch(os);
+	arch & lon & lat & year;
+	gridcell.serialize(arch);
+
+	GuessParallel::send(to, TAG_REPLY, os.str());
+	nsent++;
+
+	dprintf("Grid cell at (%g,%g) migrated to process %d after simulation year %d\n",
+	        lon, lat, to, date.year);
+
+	return true;
+}
+
+bool GridcellMigration::receive(Gridcell& gridcell) {
+
+	if (!enabled) {
+		return false;
+	}
+
+	const int rank = GuessParallel::get_rank();
+	const int nprocesses = GuessParallel::get_num_processes();
+
+	// A process only answers with an empty reply once its own gridlist is
+	// done, so one round without work means there is nothing left to take
+	for (int asked = 0; asked < nprocesses - 1; asked++) {
+
+		if (next == rank) {
+			next = (next + 1) % nprocesses;
+		}
+		int from = next;
+		next = (next + 1) % nprocesses;
+
+		GuessParallel::send(from, TAG_REQUEST, std::string());
+
+		// Others may be asking us meanwhile
+		while (!GuessParallel::message_arrived(from, TAG_REPLY)) {
+			decline_requests();
+			wait_a_moment();
+		}
+
+		std::string reply = GuessParallel::receive(from, TAG_REPLY);
+		if (reply.empty()) {
+			continue;
+		}
+
+		std::istringstream is(reply);
+		ArchiveInStream arch(is);
+
+		double lon, lat;
+		int year;
+		arch & lon & lat & year;
+
+		if (!input_module.getmigratedgridcell(gridcell, lon, lat)) {
+			fail("No input data for grid cell at (%g,%g) received from process %d\n",
+			     lon, lat, from);
+		}
+
+		gridcell.climate.initdrivers(gridcell.get_lat());
+		gridcell.serialize(arch);
+
+		date.year = year;
+		date.islastyear = year == input_module.get_simulation_years() - 1;
+		gridcell.resume_year = year;
+
+		// Soil temperature state isn't serialized, initialise it as for cloned patches
+		Gridcell::iterator gc_itr = gridcell.begin();
+		while (gc_itr != gridcell.end()) {
+			Stand& stand = *gc_itr;
+			stand.firstobj();
+			while (stand.isobj) {
+				stand.getobj().cloned = true;
+				stand.nextobj();
+			}
+			++gc_itr;
+		}
+
+		nreceived++;
+
+		dprintf("\nResuming simulation for stand at (%g,%g) in year %d, received from process %d\n\n",
+		        lon, lat, year, from);
+
+		return true;
+	}
+
+	// Keep answering the others until they have all run out of work too
+	GuessParallel::start_barrier();
+	while (!GuessParallel::barrier_completed()) {
+		decline_requests();
+		wait_a_moment();
+	}
+
+	return false;
+}
+
+void GridcellMigration::decline_requests() {
+	int from = -1;
+	while (GuessParallel::message_arrived(from, TAG_REQUEST)) {
+		GuessParallel::receive(from, TAG_REQUEST);
+		GuessParallel::send(from, TAG_REPLY, std::string());
+		from = -1;
+	}
+}
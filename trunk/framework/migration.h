@@ -0,0 +1,90 @@
+///////////////////////////////////////////////////////////////////////////////////////
+/// \file migration.h
+/// \brief Moving grid cells from busy to idle processes in a parallel run
+///
+/// In a parallel run each process simulates the grid cells of its own
+/// gridlist. Grid cells differ in cost (number of stands, patches and
+/// individuals, land use), so some processes run out of grid cells long
+/// before others. With migration enabled (the -migrate option), a process
+/// which has finished its own grid cells asks the others for work. A process
+/// with a request waiting at the end of a simulation year serializes the
+/// grid cell it is simulating and sends it to the idle process, which
+/// continues the simulation from the next year on. Grid cells received this
+/// way are not passed on again.
+///
+/// The receiving process gets the forcing for the grid cell from its input
+/// module (InputModule::getmigratedgridcell), so migration is only possible
+/// with input modules supporting that. The results are the same as without
+/// migration, but the output for the later years of a migrated grid cell is
+/// written by the receiving process.
+///
+/// $Date$
+///
+///////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef LPJ_GUESS_MIGRATION_H
+#define LPJ_GUESS_MIGRATION_H
+
+class Gridcell;
+class InputModule;
+
+/// Sends and receives grid cells between the processes of a parallel run
+/** Without migration enabled, or in a serial run, end_of_year() and
+ *  receive() return false without doing anything.
+ */
+class GridcellMigration {
+public:
+
+	/// Creates the object, all processes must agree on whether to enable migration
+	GridcellMigration(bool enabled, InputModule& input_module);
+
+	/// To be called after the last day of each year has been simulated for a grid cell
+	/** Answers a request for work from another process, if there is one.
+	 *  After the last simulation year (Date::islastyear) the grid cell is
+	 *  never sent.
+	 *
+	 *  \param gridcell  The grid cell being simulated
+	 *  \param own       Whether the grid cell is from this process's gridlist,
+	 *                   received grid cells are never sent on
+	 *  \returns true if the grid cell has been sent to the other process, in
+	 *           which case this process should stop simulating it
+	 */
+	bool end_of_year(Gridcell& gridcell, bool own);
+
+	/// To be called when this process has no grid cells of its own left
+	/** Asks the other processes for a grid cell until one is received or
+	 *  none of them has any grid cell left to give away.
+	 *
+	 *  \param gridcell  A newly created grid cell, receives the state of
+	 *                   the grid cell from the other process. The global date
+	 *                   is set to the first year to simulate.
+	 *  \returns false if there are no more grid cells to simulate, once all
+	 *           processes have reached that point
+	 */
+	bool receive(Gridcell& gridcell);
+
+	/// Number of grid cells sent to other processes so far
+	int get_nsent() const { return nsent; }
+
+	/// Number of grid cells received from other processes so far
+	int get_nreceived() const { return nreceived; }
+
+private:
+
+	/// Answers any waiting requests for work with an empty reply
+	void decline_requests();
+
+	/// Whether migration is enabled in this run
+	bool enabled;
+
+	/// Supplies forcing for received grid cells
+	InputModule& input_module;
+
+	/// Rank of the process to ask for work next
+	int next;
+
+	int nsent;
+	int nreceived;
+};
+
+#endif // LPJ_GUESS_MIGRATION_H
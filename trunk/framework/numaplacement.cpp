@@ -0,0 +1,358 @@
+///////////////////////////////////////////////////////////////////////////////////////
+/// \file numaplacement.cpp
+/// \brief NUMA-aware placement of LPJ-GUESS processes on multi-socket nodes
+///
+/// $Date$
+///
+///////////////////////////////////////////////////////////////////////////////////////
+
+#include "config.h"
+#include "numaplacement.h"
+#include "parallel.h"
+#include "shell.h"
+#include "guessstring.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sstream>
+#include <algorithm>
+
+#ifdef __linux__
+#include <sched.h>
+#include <dirent.h>
+#endif
+
+namespace GuessNuma {
+
+namespace {
+
+/// Placement chosen in init(), reported by report()
+struct {
+	bool initialised;
+	numapolicytype policy;
+	Topology topology;
+	Placement placement;
+	int local_rank;
+	int local_size;
+	bool bound;
+} state = { false, NUMA_NONE, Topology(), Placement(), 0, 1, false };
+
+/// Reads the first line of a text file, returns false if it can't be read
+bool read_line(const std::string& filename, std::string& line) {
+	FILE* in = fopen(filename.c_str(), "r");
+	if (!in) {
+		return false;
+	}
+	char buf[4096];
+	bool ok = fgets(buf, sizeof(buf), in) != 0;
+	fclose(in);
+	if (ok) {
+		line = trim(buf);
+	}
+	return ok;
+}
+
+/// Formats a CPU set compactly as a CPU list, e.g. "0-3,8"
+std::string format_cpulist(const std::vector<int>& cpus) {
+	std::ostringstream os;
+	size_t i = 0;
+	while (i < cpus.size()) {
+		size_t j = i;
+		while (j+1 < cpus.size() && cpus[j+1] == cpus[j]+1) {
+			++j;
+		}
+		if (i > 0) {
+			os << ",";
+		}
+		os << cpus[i];
+		if (j > i) {
+			os << "-" << cpus[j];
+		}
+		i = j+1;
+	}
+	return os.str();
+}
+
+}
+
+int Topology::ncpus() const {
+	int n = 0;
+	for (size_t i = 0; i < node_cpus.size(); ++i) {
+		n += (int)node_cpus[i].size();
+	}
+	return n;
+}
+
+bool parse_policy(const std::string& name, numapolicytype& policy) {
+	std::string lower = to_lower(trim(name));
+	if (lower == "none") {
+		policy = NUMA_NONE;
+	}
+	else if (lower == "compact") {
+		policy = NUMA_COMPACT;
+	}
+	else if (lower == "spread") {
+		policy = NUMA_SPREAD;
+	}
+	else if (lower == "node") {
+		policy = NUMA_NODE;
+	}
+	else {
+		return false;
+	}
+	return true;
+}
+
+const char* policy_name(numapolicytype policy) {
+	switch (policy) {
+	case NUMA_COMPACT: return "compact";
+	case NUMA_SPREAD:  return "spread";
+	case NUMA_NODE:    return "node";
+	default:           return "none";
+	}
+}
+
+bool parse_cpulist(const std::string& list, std::vector<int>& cpus) {
+	cpus.clear();
+
+	std::istringstream is(list);
+	std::string range;
+
+	while (std::getline(is, range, ',')) {
+		range = trim(range);
+		if (range.empty()) {
+			continue;
+		}
+
+		int first, last;
+		char dummy;
+		if (sscanf(range.c_str(), "%d-%d%c", &first, &last, &dummy) == 2) {
+			if (first < 0 || last < first) {
+				return false;
+			}
+		}
+		else if (sscanf(range.c_str(), "%d%c", &first, &dummy) == 1) {
+			if (first < 0) {
+				return false;
+			}
+			last = first;
+		}
+		else {
+			return false;
+		}
+
+		for (int cpu = first; cpu <= last; ++cpu) {
+			cpus.push_back(cpu);
+		}
+	}
+
+	std::sort(cpus.begin(), cpus.end());
+	cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+
+	return !cpus.empty();
+}
+
+bool parse_topology(const std::string& spec, Topology& topology) {
+	topology.node_cpus.clear();
+	topology.source = "user specified";
+
+	size_t begin = 0;
+	while (true) {
+		size_t end = spec.find(';', begin);
+
+		// Every node must have a non-empty CPU list
+		std::vector<int> cpus;
+		if (!parse_cpulist(spec.substr(begin, end - begin), cpus)) {
+			return false;
+		}
+		topology.node_cpus.push_back(cpus);
+
+		if (end == std::string::npos) {
+			break;
+		}
+		begin = end + 1;
+	}
+
+	return true;
+}
+
+Topology discover_topology() {
+	Topology topology;
+
+#ifdef __linux__
+	const std::string node_dir = "/sys/devices/system/node";
+
+	// Collect the node numbers first since readdir gives no particular order
+	std::vector<int> nodes;
+	DIR* dir = opendir(node_dir.c_str());
+	if (dir) {
+		struct dirent* entry;
+		while ((entry = readdir(dir)) != 0) {
+			int node;
+			char dummy;
+			if (sscanf(entry->d_name, "node%d%c", &node, &dummy) == 1) {
+				nodes.push_back(node);
+			}
+		}
+		closedir(dir);
+	}
+	std::sort(nodes.begin(), nodes.end());
+
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		std::ostringstream filename;
+		filename << node_dir << "/node" << nodes[i] << "/cpulist";
+
+		std::string line;
+		std::vector<int> cpus;
+		// Memory-only nodes have an empty CPU list, skip those
+		if (read_line(filename.str(), line) && parse_cpulist(line, cpus)) {
+			topology.node_cpus.push_back(cpus);
+		}
+	}
+
+	if (!topology.node_cpus.empty()) {
+		topology.source = node_dir;
+		return topology;
+	}
+
+	std::string line;
+	std::vector<int> cpus;
+	if (read_line("/sys/devices/system/cpu/online", line) && parse_cpulist(line, cpus)) {
+		topology.node_cpus.push_back(cpus);
+		topology.source = "/sys/devices/system/cpu/online (no NUMA information)";
+		return topology;
+	}
+#endif
+
+	topology.source = "unknown";
+	return topology;
+}
+
+Placement compute_placement(const Topology& topology, numapolicytype policy,
+                            int local_rank, int local_size) {
+	Placement placement;
+
+	const int nnodes = (int)topology.node_cpus.size();
+	const int ncpus = topology.ncpus();
+
+	if (policy == NUMA_NONE || nnodes == 0 || ncpus == 0 || local_rank < 0) {
+		return placement;
+	}
+
+	if (policy == NUMA_COMPACT) {
+		// Fill the nodes in order, wrapping around if oversubscribed
+		int slot = local_rank % ncpus;
+		for (int node = 0; node < nnodes; ++node) {
+			const std::vector<int>& cpus = topology.node_cpus[node];
+			if (slot < (int)cpus.size()) {
+				placement.node = node;
+				placement.cpus.push_back(cpus[slot]);
+				break;
+			}
+			slot -= (int)cpus.size();
+		}
+	}
+	else {
+		// Round-robin over the nodes so that memory bandwidth is shared
+		// evenly when there are fewer processes than cores
+		placement.node = local_rank % nnodes;
+		const std::vector<int>& cpus = topology.node_cpus[placement.node];
+		const int ncpus_node = (int)cpus.size();
+
+		if (policy == NUMA_NODE) {
+			placement.cpus = cpus;
+		}
+		else {
+			// The processes placed on this node are spaced evenly over its
+			// cores, so that they share as few caches as possible
+			const int index = local_rank / nnodes;
+			const int nprocesses = std::max(local_size, local_rank + 1);
+			const int nprocesses_node = (nprocesses - placement.node + nnodes - 1) / nnodes;
+
+			int slot;
+			if (nprocesses_node <= ncpus_node) {
+				slot = index * ncpus_node / nprocesses_node;
+			}
+			else {
+				slot = index % ncpus_node;
+			}
+			placement.cpus.push_back(cpus[slot]);
+		}
+	}
+
+	return placement;
+}
+
+bool apply_placement(const Placement& placement) {
+	if (placement.cpus.empty()) {
+		return false;
+	}
+
+#ifdef __linux__
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	for (size_t i = 0; i < placement.cpus.size(); ++i) {
+		if (placement.cpus[i] < CPU_SETSIZE) {
+			CPU_SET(placement.cpus[i], &set);
+		}
+	}
+	return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+	return false;
+#endif
+}
+
+void init(numapolicytype policy, const std::string& topology_spec) {
+	state.initialised = true;
+	state.policy = policy;
+
+	if (policy == NUMA_NONE) {
+		return;
+	}
+
+	if (topology_spec.empty()) {
+		state.topology = discover_topology();
+	}
+	else if (!parse_topology(topology_spec, state.topology)) {
+		fail("Malformed NUMA topology specification: \"%s\"\n", topology_spec.c_str());
+	}
+
+	state.local_rank = GuessParallel::get_local_rank();
+	state.local_size = GuessParallel::get_local_num_processes();
+
+	state.placement = compute_placement(state.topology, policy,
+	                                    state.local_rank, state.local_size);
+	state.bound = apply_placement(state.placement);
+}
+
+void report() {
+	if (!state.initialised || state.policy == NUMA_NONE) {
+		return;
+	}
+
+	dprintf("NUMA placement policy: %s\n", policy_name(state.policy));
+	dprintf("NUMA topology (%s): %d node(s), %d CPU(s)\n",
+	        state.topology.source.c_str(),
+	        (int)state.topology.node_cpus.size(), state.topology.ncpus());
+
+	for (size_t i = 0; i < state.topology.node_cpus.size(); ++i) {
+		dprintf("  node %d: CPUs %s\n", (int)i,
+		        format_cpulist(state.topology.node_cpus[i]).c_str());
+	}
+
+	dprintf("Process %d of %d on this node", state.local_rank, state.local_size);
+	if (state.bound) {
+		dprintf(" bound to node %d, CPUs %s\n\n", state.placement.node,
+		        format_cpulist(state.placement.cpus).c_str());
+	}
+	else {
+		dprintf(" could not be bound, placement left to the operating system\n\n");
+	}
+
+	if (state.topology.ncpus() < state.local_size) {
+		dprintf("WARNING: more processes (%d) than CPUs (%d) on this node\n\n",
+		        state.local_size, state.topology.ncpus());
+	}
+}
+
+}
@@ -0,0 +1,115 @@
+///////////////////////////////////////////////////////////////////////////////////////
+/// \file numaplacement.h
+/// \brief NUMA-aware placement of LPJ-GUESS processes on multi-socket nodes
+///
+/// Each LPJ-GUESS process simulates its share of the gridlist on a single thread,
+/// so NUMA locality is decided by where the process runs when it first touches
+/// its memory. This module discovers the node topology, chooses a CPU set for
+/// the process according to a placement policy and its rank among the processes
+/// on the same node, and binds the process to it.
+///
+/// Binding is done before the input module is initialised and before any
+/// Gridcell is created. With the default (local) memory policy of the operating
+/// system, the forcing buffers read by the input module and the object graph of
+/// every Gridcell are then first-touched, and thereby allocated, on the NUMA
+/// domain of the core which will simulate them.
+///
+/// $Date$
+///
+///////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef LPJ_GUESS_NUMA_PLACEMENT_H
+#define LPJ_GUESS_NUMA_PLACEMENT_H
+
+#include <string>
+#include <vector>
+
+namespace GuessNuma {
+
+/// How processes on a node are placed on its cores
+/** NUMA_NONE     Leave placement to the operating system (default)
+ *  NUMA_COMPACT  Fill the cores of one NUMA node before moving on to the next
+ *  NUMA_SPREAD   Round-robin over NUMA nodes, one core per process, with the
+ *                processes on a node spaced evenly over its cores
+ *  NUMA_NODE     Round-robin over NUMA nodes, bind to all cores of the node
+ */
+typedef enum {NUMA_NONE, NUMA_COMPACT, NUMA_SPREAD, NUMA_NODE} numapolicytype;
+
+/// The NUMA nodes of a machine and the logical CPUs belonging to each
+struct Topology {
+	/// CPUs for each NUMA node, in node order
+	std::vector<std::vector<int> > node_cpus;
+
+	/// Where the topology came from (for reporting)
+	std::string source;
+
+	/// Total number of CPUs over all nodes
+	int ncpus() const;
+};
+
+/// The CPU set chosen for this process
+struct Placement {
+
+	Placement() : node(-1) {}
+
+	/// NUMA node the process is placed on, -1 if not placed
+	int node;
+
+	/// CPUs the process is allowed to run on
+	std::vector<int> cpus;
+};
+
+/// Parses a policy name ("none", "compact", "spread" or "node")
+/** \returns false if the name isn't recognised */
+bool parse_policy(const std::string& name, numapolicytype& policy);
+
+/// Name of a policy, as accepted by parse_policy
+const char* policy_name(numapolicytype policy);
+
+/// Parses a Linux style CPU list, e.g. "0-3,8,10-11"
+/** \returns false if the list is malformed */
+bool parse_cpulist(const std::string& list, std::vector<int>& cpus);
+
+/// Parses a user specified topology
+/** Nodes are separated by semicolons, each node is a CPU list,
+ *  e.g. "0-7,16-23;8-15,24-31" describes two nodes.
+ *
+ *  \returns false if the specification is malformed
+ */
+bool parse_topology(const std::string& spec, Topology& topology);
+
+/// Discovers the NUMA topology of the machine
+/** Reads /sys/devices/system/node on Linux. If no NUMA information is
+ *  available, a single node containing all online CPUs is returned.
+ */
+Topology discover_topology();
+
+/// Chooses CPUs for the process with rank local_rank among the
+/// local_size processes running on this node
+/** local_size decides how far apart the processes sharing a NUMA node are
+ *  placed with NUMA_SPREAD.
+ */
+Placement compute_placement(const Topology& topology, numapolicytype policy,
+                            int local_rank, int local_size);
+
+/// Binds the calling process to the CPUs of a placement
+/** \returns false if binding isn't supported or failed */
+bool apply_placement(const Placement& placement);
+
+/// Discovers the topology, places and binds this process
+/** Should be called before any large allocations are made, so that the
+ *  memory is first-touched on the chosen NUMA node. The result is kept
+ *  and written to the log file by report().
+ *
+ *  \param policy        Placement policy
+ *  \param topology_spec User specified topology (see parse_topology),
+ *                       empty to discover it
+ */
+void init(numapolicytype policy, const std::string& topology_spec);
+
+/// Writes the topology and placement used to the log file
+void report();
+
+}
+
+#endif // LPJ_GUESS_NUMA_PLACEMENT_H
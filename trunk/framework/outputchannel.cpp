@@ -66,6 +66,18 @@ TableDescriptor::TableDescriptor(const char* name,
 			 cols(columns) {
 }
 
+TableDescriptor::TableDescriptor(const char* name,
+                                 const ColumnDescriptors& columns,
+                                 const std::vector<bool>& selection)
+		  : n(name),
+			 cols(columns),
+			 sel(selection) {
+
+	 if (!sel.empty() && sel.size() != cols.size()) {
+		  fail("Column selection doesn't match the columns of table %s", name);
+	 }
+}
+
 const std::string& TableDescriptor::name() const {
 	 return n;
 }
@@ -74,6 +86,10 @@ const ColumnDescriptors& TableDescriptor::columns() const {
 	 return cols;
 }
 
+const std::vector<bool>& TableDescriptor::selection() const {
+	 return sel;
+}
+
 Table::Table()
 		  : identifier(-1) {
 }
@@ -93,8 +109,25 @@ bool Table::invalid() const {
 Table OutputChannel::create_table(const TableDescriptor& descriptor) {
 	 Table table((int) table_descriptors.size());
 
-	 table_descriptors.push_back(descriptor);
+	 const std::vector<bool>& selection = descriptor.selection();
+
+	 if (selection.empty()) {
+		  table_descriptors.push_back(descriptor);
+	 }
+	 else {
+		  // keep only the selected columns
+		  ColumnDescriptors columns;
+		  for (size_t i = 0; i < selection.size(); i++) {
+				if (selection[i]) {
+					 columns += descriptor.columns()[i];
+				}
+		  }
+		  table_descriptors.push_back(TableDescriptor(descriptor.name().c_str(), columns));
+	 }
+
 	 values.resize(table_descriptors.size());
+	 selections.push_back(selection);
+	 next_column.push_back(0);
 	 return table;
 }
 
@@ -104,8 +137,22 @@ void OutputChannel::add_value(const Table& table, double d) {
 		  return;
 	 }
 
-	 // make sure this row isn't already full
 	 const TableDescriptor& td = table_descriptors[table.id()];
+	 const std::vector<bool>& selection = selections[table.id()];
+
+	 if (!selection.empty()) {
+		  // skip values for columns which aren't selected
+		  size_t& column = next_column[table.id()];
+		  if (column == selection.size()) {
+				fail("Added too many values to a row in table %s!",
+				     td.name().c_str());
+		  }
+		  if (!selection[column++]) {
+				return;
+		  }
+	 }
+
+	 // make sure this row isn't already full
 	 if (values[table.id()].size() == td.columns().size()) {
 		  fail("Added too many values to a row in table %s!", 
 		       td.name().c_str());
@@ -127,6 +174,7 @@ OutputChannel::get_current_row(const Table& table) const {
 void OutputChannel::clear_current_row(const Table& table) {
 	 values[table.id()].clear();
 	 std::vector<double>().swap(values[table.id()]); // clear array memory
+	 next_column[table.id()] = 0;
 }
 
 FileOutputChannel::FileOutputChannel(const char* out_dir,
@@ -69,6 +69,9 @@ private:
 
 /// Describes an output table
 /** Each table is described by a name and a number of column descriptors.
+ *  Optionally only some of the columns are selected for output, values
+ *  are still added for all columns but the others are left out by the
+ *  output channel.
  */
 class TableDescriptor {
 public:
@@ -76,15 +79,25 @@ public:
 	 TableDescriptor(const char* name,
 	                 const ColumnDescriptors& columns);
 
+	 /// Creates a TableDescriptor where only some columns are selected
+	 /** \param selection One flag per column, empty if all are selected */
+	 TableDescriptor(const char* name,
+	                 const ColumnDescriptors& columns,
+	                 const std::vector<bool>& selection);
+
 	 /// Get the name of the table
 	 const std::string& name() const;
 
 	 /// Get the column descriptors
 	 const ColumnDescriptors& columns() const;
 
+	 /// Get the selected columns, empty if all columns are selected
+	 const std::vector<bool>& selection() const;
+
 private:
 	 std::string n;
 	 ColumnDescriptors cols;
+	 std::vector<bool> sel;
 };
 
 /// A handle to an output table
@@ -119,10 +132,14 @@ public:
 	 virtual ~OutputChannel() {}
 
 	 /// Creates an output table and returns a handle to it
+	 /** Only the selected columns of the descriptor are kept, so
+	  *  get_table_descriptor() and get_current_row() only see those.
+	  */
 	 virtual Table create_table(const TableDescriptor& descriptor);
 
 	 /// Adds a value to the next row of output for a given table
-	 /** If the table is invalid, no action is taken. */
+	 /** If the table is invalid, or the value belongs to a column which
+	  *  isn't selected, no action is taken. */
 	 virtual void add_value(const Table& table, double d);
 
 	 /// Finalizes the output of one row, annual output
@@ -149,6 +166,12 @@ protected:
 private:
 	 std::vector<TableDescriptor> table_descriptors;
 	 std::vector<std::vector<double> > values;
+
+	 /// Selected columns of each table, empty if all are selected
+	 std::vector<std::vector<bool> > selections;
+
+	 /// Column of the next value in the current row, for tables with a selection
+	 std::vector<size_t> next_column;
 };
 
 /// An output channel for regular text files with fixed width columns
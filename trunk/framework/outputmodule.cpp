@@ -9,9 +9,12 @@
 
 #include "config.h"
 #include "outputmodule.h"
+#include "shmoutputchannel.h"
 #include "parameters.h"
+#include "parallel.h"
 #include "guess.h"
 #include <iostream>
+#include <sstream>
 
 namespace GuessOutput {
 
@@ -22,7 +25,15 @@ OutputChannel* output_channel;
 ///
 
 void OutputModule::create_output_table(Table& table, const char* file, const ColumnDescriptors& columns) {
-	 table = output_channel->create_table(TableDescriptor(file, columns));
+	 OutputVariableRegistry& registry = OutputVariableRegistry::get_instance();
+
+	 if (!registry.table_selected(file)) {
+		  table = Table();
+		  return;
+	 }
+
+	 table = output_channel->create_table(TableDescriptor(file, columns,
+	                                                      registry.selected_columns(file, columns)));
 }
 
 void OutputModule::close_output_table(Table& table) {
@@ -35,8 +46,14 @@ void OutputModule::close_output_table(Table& table) {
 ///
 
 OutputModuleContainer::OutputModuleContainer()
-	: coordinates_precision(2), outdir{(char*) outputdirectory} {
+	: coordinates_precision(2), outdir{(char*) outputdirectory},
+	  shm_output_size(64), shm_output_drop(false), shm_output_files(true) {
 	declare_parameter("coordinates_precision", &coordinates_precision, 0, 10, "Digits after decimal point in coordinates in output");
+	declare_parameter("shm_output", &shm_output, 100, "Name of shared memory object to publish output in (e.g. \"/guess_output\"), empty for none");
+	declare_parameter("shm_output_size", &shm_output_size, 1, 4096, "Size of the shared memory output buffer [MB]");
+	declare_parameter("shm_output_drop", &shm_output_drop, "Whether to drop output when the shared memory buffer is full instead of waiting for the consumer (0,1)");
+	declare_parameter("shm_output_files", &shm_output_files, "Whether to also write output files when publishing in shared memory (0,1)");
+	declare_parameter("output_variables", &output_variables, 1000, "Output to produce, e.g. \"cmass.out lai.out:Total,BNE\", empty for all files given");
 }
 
 OutputModuleContainer::~OutputModuleContainer() {
@@ -59,12 +76,45 @@ void OutputModuleContainer::init() {
     }
 
 	// Create the output channel
-	output_channel = new FileOutputChannel(outdir.c_str(),
-	                                       coordinates_precision);
+	if (shm_output == "") {
+		output_channel = new FileOutputChannel(outdir.c_str(),
+		                                       coordinates_precision);
+	}
+	else {
+#ifdef _WIN32
+		fail("Shared memory output (shm_output) is not available on Windows");
+#else
+		OutputChannel* files = NULL;
+		if (shm_output_files) {
+			files = new FileOutputChannel(outdir.c_str(), coordinates_precision);
+		}
+
+		// One buffer per process in parallel runs
+		std::string name = shm_output;
+		if (GuessParallel::get_num_processes() > 1) {
+			xtring suffix;
+			suffix.printf(".%d", GuessParallel::get_rank());
+			name += (char*)suffix;
+		}
+
+		dprintf("Publishing output in shared memory object %s\n", name.c_str());
+
+		output_channel = new ShmOutputChannel(name.c_str(),
+		                                      (size_t)shm_output_size * 1024 * 1024,
+		                                      shm_output_drop,
+		                                      coordinates_precision,
+		                                      files);
+#endif
+	}
+
+	OutputVariableRegistry& registry = OutputVariableRegistry::get_instance();
+	registry.select(output_variables);
 
 	for (size_t i = 0; i < modules.size(); ++i) {
 		modules[i]->init();
 	}
+
+	registry.resolve();
 }
 
 void OutputModuleContainer::outannual(Gridcell& gridcell) {
@@ -91,6 +141,199 @@ void OutputModuleContainer::closelocalfiles(Gridcell& gridcell) {
 	}
 }
 
+///////////////////////////////////////////////////////////////////////////////////////
+/// OutputVariableRegistry
+///
+
+OutputVariableRegistry& OutputVariableRegistry::get_instance() {
+	static OutputVariableRegistry instance;
+	return instance;
+}
+
+void OutputVariableRegistry::select(const std::string& sel) {
+	selection.clear();
+	created.clear();
+
+	std::istringstream is(sel);
+	std::string entry;
+	while (is >> entry) {
+		std::string file = entry;
+		std::vector<std::string> columns;
+
+		const size_t colon = entry.find(':');
+		if (colon != std::string::npos) {
+			file = entry.substr(0, colon);
+
+			std::string list = entry.substr(colon + 1);
+			size_t start = 0;
+			while (start <= list.size()) {
+				size_t end = list.find(',', start);
+				if (end == std::string::npos) {
+					end = list.size();
+				}
+				if (end > start) {
+					columns.push_back(list.substr(start, end - start));
+				}
+				start = end + 1;
+			}
+
+			if (columns.empty()) {
+				fail("output_variables: no columns given for %s", file.c_str());
+			}
+		}
+
+		// Several entries for the same file add up, but a file
+		// given without columns means all of them
+		std::map<std::string, std::vector<std::string> >::iterator itr = selection.find(file);
+		if (itr == selection.end()) {
+			selection[file] = columns;
+		}
+		else if (!itr->second.empty()) {
+			if (columns.empty()) {
+				itr->second.clear();
+			}
+			else {
+				itr->second.insert(itr->second.end(), columns.begin(), columns.end());
+			}
+		}
+	}
+}
+
+bool OutputVariableRegistry::table_selected(const std::string& file) {
+	if (selection.empty()) {
+		return true;
+	}
+
+	if (file == "" || selection.find(file) == selection.end()) {
+		return false;
+	}
+
+	created[file] = true;
+	return true;
+}
+
+std::vector<bool> OutputVariableRegistry::selected_columns(const std::string& file,
+                                                         const ColumnDescriptors& columns) {
+	std::vector<bool> result;
+
+	std::map<std::string, std::vector<std::string> >::const_iterator itr = selection.find(file);
+	if (itr == selection.end() || itr->second.empty()) {
+		return result;
+	}
+
+	const std::vector<std::string>& titles = itr->second;
+	result.resize(columns.size(), false);
+
+	for (size_t t = 0; t < titles.size(); t++) {
+		bool found = false;
+		for (size_t c = 0; c < columns.size(); c++) {
+			if (columns[c].title() == titles[t]) {
+				result[c] = true;
+				found = true;
+			}
+		}
+		if (!found) {
+			dprintf("WARNING ! output_variables: there is no column %s in %s\n",
+			        titles[t].c_str(), file.c_str());
+		}
+	}
+
+	return result;
+}
+
+void OutputVariableRegistry::declare_computation(const std::string& name, OutputCost cost) {
+	Computation& computation = computations[name];
+	computation.cost = cost;
+	computation.used = false;
+	computation.needed = true;
+	computation.prerequisites.clear();
+}
+
+OutputVariableRegistry::Computation& OutputVariableRegistry::get_computation(const std::string& name) {
+	std::map<std::string, Computation>::iterator itr = computations.find(name);
+	if (itr == computations.end()) {
+		fail("Output computation %s hasn't been declared", name.c_str());
+	}
+	return itr->second;
+}
+
+void OutputVariableRegistry::depends(const Table& table, const std::string& computation) {
+	Computation& c = get_computation(computation);
+	if (!table.invalid()) {
+		c.used = true;
+	}
+}
+
+void OutputVariableRegistry::depends(const std::string& computation, const std::string& prerequisite) {
+	get_computation(computation).prerequisites.push_back(prerequisite);
+}
+
+void OutputVariableRegistry::require(const std::string& computation) {
+	get_computation(computation).used = true;
+}
+
+void OutputVariableRegistry::resolve() {
+	std::map<std::string, Computation>::iterator itr;
+
+	// Without a selection everything is computed as before, also for tables
+	// without a file name (some computations have other effects, like plots
+	// in the graphical shells)
+	for (itr = computations.begin(); itr != computations.end(); ++itr) {
+		itr->second.needed = selection.empty() || itr->second.used;
+	}
+
+	// Prerequisites of needed computations are needed, repeat until
+	// nothing changes to get the prerequisites' prerequisites too
+	bool changed = true;
+	while (changed) {
+		changed = false;
+		for (itr = computations.begin(); itr != computations.end(); ++itr) {
+			if (!itr->second.needed) {
+				continue;
+			}
+			const std::vector<std::string>& prerequisites = itr->second.prerequisites;
+			for (size_t i = 0; i < prerequisites.size(); i++) {
+				Computation& prerequisite = get_computation(prerequisites[i]);
+				if (!prerequisite.needed) {
+					prerequisite.needed = true;
+					changed = true;
+				}
+			}
+		}
+	}
+
+	std::map<std::string, std::vector<std::string> >::const_iterator sel_itr;
+	for (sel_itr = selection.begin(); sel_itr != selection.end(); ++sel_itr) {
+		if (created.find(sel_itr->first) == created.end()) {
+			dprintf("WARNING ! output_variables: %s isn't produced, check the output file names\n",
+			        sel_itr->first.c_str());
+		}
+	}
+
+	const char* cost_names[] = { "per gridcell", "per patch", "per individual" };
+
+	for (itr = computations.begin(); itr != computations.end(); ++itr) {
+		if (!itr->second.needed) {
+			dprintf("Output computation %s (%s) skipped, none of its output is selected\n",
+			        itr->first.c_str(), cost_names[itr->second.cost]);
+		}
+	}
+}
+
+bool OutputVariableRegistry::needed(const std::string& computation) const {
+	std::map<std::string, Computation>::const_iterator itr = computations.find(computation);
+	if (itr == computations.end()) {
+		fail("Output computation %s hasn't been declared", computation.c_str());
+	}
+	return itr->second.needed;
+}
+
+void OutputVariableRegistry::clear() {
+	selection.clear();
+	created.clear();
+	computations.clear();
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////
 /// OutputModuleRegistry
 ///
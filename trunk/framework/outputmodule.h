@@ -19,6 +19,110 @@ class Gridcell;
 
 namespace GuessOutput {
 
+/// Rough cost of a computation in an output module, per gridcell and year
+enum OutputCost {
+	/// Values taken more or less directly from the gridcell
+	OUTPUT_COST_GRIDCELL,
+	/// Sums over all patches
+	OUTPUT_COST_PATCH,
+	/// Sums over all individuals in all patches, often once per PFT
+	OUTPUT_COST_INDIVIDUAL
+};
+
+/// Keeps track of which output is requested and what it takes to compute it
+/** The instruction file parameter output_variables lists the output tables
+ *  (by file name), and optionally columns within them, to produce. If it's
+ *  empty all tables with a file name given are produced, as before. Tables
+ *  which aren't selected are never created, so their values aren't written
+ *  even if they are computed.
+ *
+ *  To also avoid the computations, output modules declare the expensive
+ *  parts of their outannual/outdaily functions as named computations,
+ *  declare which tables depend on which computations, and skip the
+ *  computations which aren't needed(). A computation may also depend on
+ *  another, for instance when one module relies on side effects of another
+ *  module's computation. Computations are only skipped when output_variables
+ *  is given.
+ *
+ *  Like OutputModuleRegistry this is a singleton.
+ */
+class OutputVariableRegistry {
+public:
+
+	/// Returns the one and only output variable registry
+	static OutputVariableRegistry& get_instance();
+
+	/// Sets the selected output, from the output_variables parameter
+	/** A whitespace separated list of entries "file" or "file:col1,col2,..." */
+	void select(const std::string& selection);
+
+	/// Whether an output table with this file name should be created
+	bool table_selected(const std::string& file);
+
+	/// Which columns of a table are selected, empty if all of them
+	std::vector<bool> selected_columns(const std::string& file,
+	                                   const ColumnDescriptors& columns);
+
+	/// Declares a computation in an output module
+	void declare_computation(const std::string& name, OutputCost cost);
+
+	/// Declares that the values of a table come from a computation
+	/** Calls for invalid tables are ignored. */
+	void depends(const Table& table, const std::string& computation);
+
+	/// Declares that a computation needs another one to be done first
+	void depends(const std::string& computation, const std::string& prerequisite);
+
+	/// Declares that a computation is needed regardless of the tables
+	void require(const std::string& computation);
+
+	/// Works out which computations are needed
+	/** Called when all output modules have created their tables, logs
+	 *  the computations which will be skipped. */
+	void resolve();
+
+	/// Whether a computation is needed
+	bool needed(const std::string& computation) const;
+
+	/// Forgets the selection and all computations (for tests)
+	void clear();
+
+private:
+
+	/// A named computation in an output module
+	struct Computation {
+		Computation() : cost(OUTPUT_COST_GRIDCELL), used(false), needed(true) {}
+
+		OutputCost cost;
+
+		/// Whether a valid table or a require() call depends on it
+		bool used;
+
+		/// Result of resolve()
+		bool needed;
+
+		/// Computations which this one depends on
+		std::vector<std::string> prerequisites;
+	};
+
+	/// Finds a declared computation, fails if there is none
+	Computation& get_computation(const std::string& name);
+
+	/// Private constructor to make sure we only have one instance
+	OutputVariableRegistry() {}
+
+	/// Also private to prevent copying
+	OutputVariableRegistry(const OutputVariableRegistry&);
+
+	/// The selected columns for each selected table, empty for all columns
+	std::map<std::string, std::vector<std::string> > selection;
+
+	/// Selected tables which have been created
+	std::map<std::string, bool> created;
+
+	std::map<std::string, Computation> computations;
+};
+
 /// Base class for output modules
 /**
  *  An output module should inherit from this class and implement
@@ -65,6 +169,8 @@ public:
 protected:
 
 	/// Help function to define_output_tables, creates one output table
+	/** The table is left invalid if it isn't among the selected output,
+	 *  \see OutputVariableRegistry */
 	void create_output_table(Table& table,
 	                         const char* file,
 	                         const ColumnDescriptors& columns);
@@ -117,6 +223,27 @@ private:
 	/// Instruction file parameter deciding precision of coordinates in output
 	/** The parameter controls the number of digits after the decimal point */
 	int coordinates_precision;
+
+	/// Instruction file parameter, shared memory object to publish output in
+	/** If empty (the default) output is only written to files.
+	 *  \see ShmOutputChannel
+	 */
+	std::string shm_output;
+
+	/// Instruction file parameter, size of the shared memory buffer in MB
+	int shm_output_size;
+
+	/// Instruction file parameter, whether to drop rows when the buffer is full
+	bool shm_output_drop;
+
+	/// Instruction file parameter, whether to also write the output files
+	bool shm_output_files;
+
+	/// Instruction file parameter, the output tables and columns to produce
+	/** If empty (the default) all output files given are produced.
+	 *  \see OutputVariableRegistry
+	 */
+	std::string output_variables;
 };
 
 
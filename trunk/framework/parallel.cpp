@@ -19,11 +19,66 @@
 #include "shell.h"
 #include <memory>
 #include <string>
+#include <vector>
+#include <stdlib.h>
 
 namespace GuessParallel {
 
 bool parallel = false;
 
+namespace {
+
+/// Reads a non-negative integer from an environment variable, -1 if not set
+int int_from_environment(const char* name) {
+	const char* value = getenv(name);
+	if (value == 0 || *value == '\0') {
+		return -1;
+	}
+	return atoi(value);
+}
+
+/// Local rank/size as given by the launcher (mpirun, srun), -1 if unknown
+int launcher_local_rank() {
+	const char* names[] = { "OMPI_COMM_WORLD_LOCAL_RANK", "MPI_LOCALRANKID", "SLURM_LOCALID" };
+	for (size_t i = 0; i < sizeof(names)/sizeof(names[0]); ++i) {
+		int value = int_from_environment(names[i]);
+		if (value >= 0) {
+			return value;
+		}
+	}
+	return -1;
+}
+
+int launcher_local_size() {
+	const char* names[] = { "OMPI_COMM_WORLD_LOCAL_SIZE", "MPI_LOCALNRANKS", "SLURM_NTASKS_PER_NODE" };
+	for (size_t i = 0; i < sizeof(names)/sizeof(names[0]); ++i) {
+		int value = int_from_environment(names[i]);
+		if (value > 0) {
+			return value;
+		}
+	}
+	return -1;
+}
+
+#ifdef HAVE_MPI
+/// Communicator for the processes sharing memory with this process
+MPI_Comm node_communicator() {
+	static MPI_Comm comm = MPI_COMM_NULL;
+	if (comm == MPI_COMM_NULL) {
+		MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &comm);
+	}
+	return comm;
+}
+
+/// The barrier started with start_barrier()
+MPI_Request barrier_request = MPI_REQUEST_NULL;
+#endif
+
+/// Whether a barrier has been started and not yet found completed
+bool in_barrier = false;
+
+}
+
 #ifdef HAVE_MPI
 
 /// A class whose only purpose is to terminate the MPI library when deleted
@@ -99,4 +154,118 @@ int get_num_processes() {
 #endif
 }
 
+int get_local_rank() {
+#ifdef HAVE_MPI
+	if (parallel) {
+		int rank;
+		MPI_Comm_rank(node_communicator(), &rank);
+		return rank;
+	}
+#endif
+	int rank = launcher_local_rank();
+	return rank >= 0 ? rank : 0;
+}
+
+int get_local_num_processes() {
+#ifdef HAVE_MPI
+	if (parallel) {
+		int size;
+		MPI_Comm_size(node_communicator(), &size);
+		return size;
+	}
+#endif
+	int size = launcher_local_size();
+	return size > 0 ? size : 1;
+}
+
+std::vector<int> get_node_processes() {
+	std::vector<int> ranks(get_local_num_processes());
+#ifdef HAVE_MPI
+	if (parallel) {
+		int rank = get_rank();
+		MPI_Allgather(&rank, 1, MPI_INT, &ranks.front(), 1, MPI_INT, node_communicator());
+		return ranks;
+	}
+#endif
+	ranks.assign(1, get_rank());
+	return ranks;
+}
+
+bool any(bool value) {
+#ifdef HAVE_MPI
+	if (parallel) {
+		int local = value ? 1 : 0;
+		int global = 0;
+		MPI_Allreduce(&local, &global, 1, MPI_INT, MPI_LOR, MPI_COMM_WORLD);
+		return global != 0;
+	}
+#endif
+	return value;
+}
+
+void send(int to, int tag, const std::string& data) {
+#ifdef HAVE_MPI
+	if (parallel) {
+		MPI_Send(const_cast<char*>(data.data()), (int)data.size(), MPI_CHAR, to, tag, MPI_COMM_WORLD);
+		return;
+	}
+#endif
+	fail("GuessParallel::send: no other processes in a serial run\n");
+}
+
+bool message_arrived(int& from, int tag) {
+#ifdef HAVE_MPI
+	if (parallel) {
+		int flag;
+		MPI_Status status;
+		MPI_Iprobe(from < 0 ? MPI_ANY_SOURCE : from, tag, MPI_COMM_WORLD, &flag, &status);
+		if (flag) {
+			from = status.MPI_SOURCE;
+		}
+		return flag != 0;
+	}
+#endif
+	return false;
+}
+
+std::string receive(int& from, int tag) {
+#ifdef HAVE_MPI
+	if (parallel) {
+		MPI_Status status;
+		MPI_Probe(from < 0 ? MPI_ANY_SOURCE : from, tag, MPI_COMM_WORLD, &status);
+		from = status.MPI_SOURCE;
+
+		int size;
+		MPI_Get_count(&status, MPI_CHAR, &size);
+
+		std::vector<char> buffer(size > 0 ? size : 1);
+		MPI_Recv(&buffer.front(), size, MPI_CHAR, from, tag, MPI_COMM_WORLD, &status);
+
+		return std::string(&buffer.front(), size);
+	}
+#endif
+	fail("GuessParallel::receive: no other processes in a serial run\n");
+	return std::string();
+}
+
+void start_barrier() {
+#ifdef HAVE_MPI
+	if (parallel) {
+		MPI_Ibarrier(MPI_COMM_WORLD, &barrier_request);
+		in_barrier = true;
+	}
+#endif
+}
+
+bool barrier_completed() {
+#ifdef HAVE_MPI
+	if (parallel && in_barrier) {
+		int flag;
+		MPI_Test(&barrier_request, &flag, MPI_STATUS_IGNORE);
+		in_barrier = flag == 0;
+	}
+#endif
+	return !in_barrier;
+}
+
 }
@@ -17,6 +17,9 @@
 #ifndef LPJ_GUESS_PARALLEL_H
 #define LPJ_GUESS_PARALLEL_H
 
+#include <string>
+#include <vector>
+
 namespace GuessParallel {
 
 /// Initializes the module
@@ -35,6 +38,57 @@ int get_rank();
 /** Returns 1 when no MPI library is available/used. */
 int get_num_processes();
 
+/// The rank of this process among the processes running on the same node
+/** Used for placing processes on the cores of a node. Without MPI, common
+ *  launcher environment variables are consulted, otherwise zero is returned.
+ */
+int get_local_rank();
+
+/// The number of processes running on the same node as this process
+/** Returns 1 if this can't be determined. */
+int get_local_num_processes();
+
+/// The ranks of the processes running on the same node, ordered by local rank
+/** Must be called by all processes. Without MPI only this process is listed. */
+std::vector<int> get_node_processes();
+
+/// Whether value is true in any process
+/** Must be called by all processes. Without MPI value is returned. */
+bool any(bool value);
+
+/// Sends a message to another process
+/** Returns when the message has been received or buffered, a large message
+ *  may have to wait until the receiving process calls receive().
+ *
+ *  \param to   Rank of the receiving process
+ *  \param tag  Tag identifying the kind of message
+ *  \param data Contents of the message, may be empty
+ */
+void send(int to, int tag, const std::string& data);
+
+/// Checks whether a message has arrived, without waiting for one
+/** \param from Rank of the sending process, or -1 for any process.
+ *              Set to the rank of the sender if a message has arrived.
+ *  \param tag  Tag identifying the kind of message
+ */
+bool message_arrived(int& from, int tag);
+
+/// Receives a message, waits for it if it hasn't arrived yet
+/** \param from Rank of the sending process, or -1 for any process.
+ *              Set to the rank of the sender.
+ *  \param tag  Tag identifying the kind of message
+ */
+std::string receive(int& from, int tag);
+
+/// Starts a barrier without waiting for the other processes
+/** The barrier is completed when all processes have started it,
+ *  see barrier_completed(). Only one barrier may be in progress at a time.
+ */
+void start_barrier();
+
+/// Whether all processes have started the barrier, without waiting
+bool barrier_completed();
+
 }
 
 #endif // LPJ_GUESS_PARALLEL_H
@@ -28,6 +28,14 @@ weathergeneratortype weathergenerator;
 
 int npatch;
 int npatch_secondarystand;
+bool ifadaptivenpatch;
+int npatch_min;
+double npatch_tol;
+bool ifanalogspinup;
+int analog_spinup_years;
+double analog_max_distance;
+double analog_spinup_tol;
+int analog_library_size;
 bool reduce_all_stands;
 int age_limit_reduce;
 double patcharea;
@@ -41,10 +49,19 @@ bool ifcalccton;
 int estinterval;
 double distinterval;
 bool ifcdebt;
+bool ifdormantfastpath;
+bool ifverifydaycache;
+bool ifreversepatchorder;
+bool ifmergecohorts;
+double merge_height_tol;
+double merge_dbh_tol;
+double merge_biomass_tol;
+int max_indiv_per_patch;
 
 bool ifcentury;
 bool ifnlim;
 int freenyears;
+int somdynam_step;
 double nrelocfrac;
 double nfix_a;
 double nfix_b;
@@ -228,8 +245,25 @@ void initsettings() {
 	ifcalcsla=false;
 	ifcalccton=true;
 	ifcdebt=false;
+	ifdormantfastpath=true;
+	ifverifydaycache=false;
+	ifreversepatchorder=false;
+	somdynam_step=1;
+	ifmergecohorts=false;
+	merge_height_tol=0.05;
+	merge_dbh_tol=0.05;
+	merge_biomass_tol=0.1;
+	max_indiv_per_patch=0;
 	distinterval=1.0e10;
 	npatch=1;
+	ifadaptivenpatch=false;
+	npatch_min=5;
+	npatch_tol=0.02;
+	ifanalogspinup=false;
+	analog_spinup_years=100;
+	analog_max_distance=1.0;
+	analog_spinup_tol=0.005;
+	analog_library_size=100;
 	vegmode=COHORT;
 	run_landcover = false;
 	printseparatestands = false;
@@ -459,10 +493,42 @@ void plib_declarations(int id,xtring setname) {
 			"Whether leaf C:N min calculated from leaf longevity");
 		declareitem("ifcdebt",&ifcdebt,1,CB_NONE,
 			"Whether to allow C storage");
+		declareitem("ifdormantfastpath",&ifdormantfastpath,1,CB_NONE,
+			"Whether photosynthesis is skipped on days when none is possible (0,1)");
+		declareitem("ifverifydaycache",&ifverifydaycache,1,CB_NONE,
+			"Whether cached daily values of individuals are checked against recalculation (0,1)");
+		declareitem("ifreversepatchorder",&ifreversepatchorder,1,CB_NONE,
+			"Whether the patches of each stand are simulated in reverse order, for debugging (0,1)");
+		declareitem("ifmergecohorts",&ifmergecohorts,1,CB_NONE,
+			"Whether similar cohorts of the same PFT are merged (0,1)");
+		declareitem("merge_height_tol",&merge_height_tol,1.0e-6,1.0,1,CB_NONE,
+			"Relative height tolerance for merging cohorts");
+		declareitem("merge_dbh_tol",&merge_dbh_tol,1.0e-6,1.0,1,CB_NONE,
+			"Relative stem diameter tolerance for merging cohorts");
+		declareitem("merge_biomass_tol",&merge_biomass_tol,1.0e-6,1.0,1,CB_NONE,
+			"Relative individual biomass tolerance for merging cohorts");
+		declareitem("max_indiv_per_patch",&max_indiv_per_patch,0,100000,1,CB_NONE,
+			"Maximum number of cohorts per patch, enforced by merging (0 = no limit)");
 		declareitem("npatch",&npatch,1,1000,1,CB_NONE,
 			"Number of patches simulated");
 		declareitem("npatch_secondarystand",&npatch_secondarystand,1,1000,1,CB_NONE,
 			"Number of patches simulated in secondary stands");
+		declareitem("ifadaptivenpatch",&ifadaptivenpatch,1,CB_NONE,
+			"Whether number of patches adapts to between-patch variation during spinup (0,1)");
+		declareitem("npatch_min",&npatch_min,2,1000,1,CB_NONE,
+			"Initial number of patches with adaptive patch count");
+		declareitem("npatch_tol",&npatch_tol,1.0e-4,1.0,1,CB_NONE,
+			"Tolerated relative standard error of patch means with adaptive patch count");
+		declareitem("ifanalogspinup",&ifanalogspinup,1,CB_NONE,
+			"Whether grid cells start the spinup from the state of a climate analog (0,1)");
+		declareitem("analog_spinup_years",&analog_spinup_years,20,10000,1,CB_NONE,
+			"Number of spinup years simulated after seeding from an analog");
+		declareitem("analog_max_distance",&analog_max_distance,0.0,100.0,1,CB_NONE,
+			"Largest climate and soil distance to an analog grid cell");
+		declareitem("analog_spinup_tol",&analog_spinup_tol,0.0,1.0,1,CB_NONE,
+			"Tolerated relative change in decadal mean C stocks at the end of an analog spinup");
+		declareitem("analog_library_size",&analog_library_size,1,100000,1,CB_NONE,
+			"Maximum number of spun-up grid cells kept as analogs per process");
 		declareitem("reduce_all_stands",&reduce_all_stands,1,CB_NONE,
 			"Whether to reduce equal percentage of all stands of a stand type at land cover change");
 		declareitem("age_limit_reduce",&age_limit_reduce,0,1000,1,CB_NONE,
@@ -490,6 +556,8 @@ void plib_declarations(int id,xtring setname) {
 			"Whether plant growth limited by available nitrogen");
 		declareitem("freenyears",&freenyears,0,1000,1,CB_NONE,
 			"Number of years to spinup without nitrogen limitation");
+		declareitem("somdynam_step",&somdynam_step,1,31,1,CB_NONE,
+			"Number of days over which litter and SOM decomposition is integrated (1 = daily)");
 		declareitem("ifntransform",&ifntransform,1,CB_NONE,
 			"Whether to calculate nitrification/denitrification (only if CENTURY SOM dynamics is on)");
 		declareitem("frac_labile_carbon",&frac_labile_carbon,0.0,1.0,1,CB_NONE,
@@ -1333,6 +1401,19 @@ void plib_callback(int callback) {
 			npatch=1;
 		}
 
+		if (ifadaptivenpatch) {
+			if (vegmode==POPULATION) {
+				sendmessage("Information",
+					"Adaptive patch count ignored in population mode");
+				ifadaptivenpatch=false;
+			}
+			else if (npatch_min >= npatch) {
+				sendmessage("Information",
+					"npatch_min not smaller than npatch, adaptive patch count disabled");
+				ifadaptivenpatch=false;
+			}
+		}
+
 		if (save_state && restart) {
 			sendmessage("Error",
 				"Can't save state and restart at the same time");
@@ -1343,6 +1424,29 @@ void plib_callback(int callback) {
 			state_year = nyear_spinup;
 		}
 
+		if (ifanalogspinup) {
+			if (run_landcover) {
+				sendmessage("Information",
+					"Analog spinup not possible with land cover change, disabled");
+				ifanalogspinup=false;
+			}
+			else if (restart) {
+				sendmessage("Information",
+					"Analog spinup ignored when restarting from state files");
+				ifanalogspinup=false;
+			}
+			else if (save_state && state_year < nyear_spinup) {
+				sendmessage("Information",
+					"Analog spinup not possible when saving state before the end of the spinup, disabled");
+				ifanalogspinup=false;
+			}
+			else if (nyear_spinup - analog_spinup_years <= freenyears) {
+				sendmessage("Information",
+					"analog_spinup_years leaves no years of spinup before freenyears to skip, analog spinup disabled");
+				ifanalogspinup=false;
+			}
+		}
+
 		if (state_path == "" && (save_state || restart)) {
 			badins("state_path");
 		}
@@ -1904,3 +2008,23 @@ void printhelp() {
 	plibhelp();
 	ifhelp=false;
 }
+
+std::string pft_parameters() {
+
+	// Items declared with these are only read for their callbacks
+	std::vector<const void*> skip;
+	skip.push_back(&strparam);
+	skip.push_back(&numparam);
+	skip.push_back(&includepft);
+
+	std::string result;
+
+	for (size_t p = 0; p < pftlist.nobj; ++p) {
+		xtring name = pftlist[(unsigned int)p].name;
+		result += (std::string)"pft \"" + (char*)name + "\" (\n";
+		result += plibdump(BLOCK_PFT, name, skip);
+		result += ")\n\n";
+	}
+
+	return result;
+}
@@ -118,6 +118,40 @@ extern int npatch;
 /// Number of patches in each stand for secondary stands
 extern int npatch_secondarystand;
 
+/// Whether the number of patches in stochastic stands adapts during spinup
+/** Such stands start with npatch_min patches. At the end of each spinup year
+ *  patches are added, by cloning existing ones, while the relative standard
+ *  error of the between-patch mean of C content or NPP exceeds npatch_tol,
+ *  up to npatch. The patch count is then kept for the rest of the run.
+ */
+extern bool ifadaptivenpatch;
+
+/// Initial number of patches in stands with adaptive patch count
+extern int npatch_min;
+
+/// Tolerated relative standard error of patch means with adaptive patch count
+extern double npatch_tol;
+
+/// Whether grid cells start the spinup from the state of a climate analog
+/** After the first spinup year a grid cell takes over the state of the most
+ *  similar grid cell (in climate and soil) already spun up by the same
+ *  process, and only simulates the last analog_spinup_years of the spinup.
+ *  \see analogspinup.h
+ */
+extern bool ifanalogspinup;
+
+/// Number of spinup years simulated after seeding a grid cell from an analog
+extern int analog_spinup_years;
+
+/// Largest distance in climate and soil space for a grid cell to be used as analog
+extern double analog_max_distance;
+
+/// Tolerated relative change between the last two decadal means of C stocks in an analog spinup
+extern double analog_spinup_tol;
+
+/// Maximum number of spun-up grid cells each process keeps as analogs
+extern int analog_library_size;
+
 /// Whether to reduce equal percentage of all stands of a stand type at land cover change
 extern bool reduce_all_stands;
 
@@ -163,6 +197,39 @@ extern int estinterval;
 /// Whether C debt (storage between years) permitted
 extern bool ifcdebt;
 
+/// Whether canopy exchange skips photosynthesis on days when none is possible
+/** The skipped calculations are those that provably give zero on such days,
+ *  output is identical with and without the fast path (checked by the
+ *  model_dormantfastpath test, see tests/model). \see dormant_day
+ */
+extern bool ifdormantfastpath;
+
+/// Whether cached daily quantities of individuals are checked against recalculation
+/** For debugging, see Individual::day_cache() */
+extern bool ifverifydaycache;
+
+/// Whether the patches of each stand are simulated in reverse order
+/** For debugging. Patches don't depend on the order they are simulated in,
+ *  output is identical in both orders (checked by the model_patchorder
+ *  test, see tests/model).
+ */
+extern bool ifreversepatchorder;
+
+/// Whether similar cohorts of the same PFT are merged (individual, cohort mode)
+extern bool ifmergecohorts;
+
+/// Relative tolerance in height for merging cohorts
+extern double merge_height_tol;
+
+/// Relative tolerance in stem diameter for merging cohorts
+extern double merge_dbh_tol;
+
+/// Relative tolerance in individual biomass for merging cohorts
+extern double merge_biomass_tol;
+
+/// Maximum number of cohorts/individuals per patch, enforced by merging (0 = no limit)
+extern int max_indiv_per_patch;
+
 /// Water uptake parameterisation
 extern wateruptaketype wateruptake;
 
@@ -178,6 +245,17 @@ extern bool ifnlim;
 /// number of years to allow spinup without nitrogen limitation
 extern int freenyears;
 
+/// Number of days over which litter and SOM decomposition is integrated
+/** With 1 (the default) litter and SOM decompose every day. With longer
+ *  steps the daily decay rates are accumulated and decomposition, with its
+ *  fluxes between pools, is done once at the end of each step: every
+ *  somdynam_step days counted from the first of the month, and on the last
+ *  day of the month. Nitrogen uptake, deposition, leaching and the nitrogen
+ *  transformations still act daily on the mineral pools. Peatlands always
+ *  decompose daily, their methane production follows daily respiration.
+ */
+extern int somdynam_step;
+
 /// fraction of nitrogen relocated by plants from roots and leaves
 extern double nrelocfrac;
 
@@ -426,6 +504,13 @@ void read_instruction_file(const char* insfilename);
 /// Displays documentation about the instruction file parameters to the user
 void printhelp();
 
+/// The parameters of the PFTs in pftlist as held by the model, in instruction file syntax
+/** Gives a pft block for each PFT with the values of its parameters after
+ *  reading the instruction file (with groups and repeated blocks resolved).
+ *  Parameters given as names (lifeform, phenology etc.) are left out.
+ */
+std::string pft_parameters();
+
 
 ///////////////////////////////////////////////////////////////////////////////////////
 // Interface for declaring parameters from other modules
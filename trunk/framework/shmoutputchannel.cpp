@@ -0,0 +1,213 @@
+///////////////////////////////////////////////////////////////////////////////////////
+/// \file shmoutputchannel.cpp
+/// \brief Output channel publishing the output in shared memory
+///
+/// $Date$
+///
+///////////////////////////////////////////////////////////////////////////////////////
+
+#include "config.h"
+#include "shmoutputchannel.h"
+#include "guess.h"
+
+#include <string.h>
+
+#ifndef _WIN32
+
+namespace GuessOutput {
+
+namespace {
+
+/// Longest time to wait for the consumer to make room for a control record
+/** Only when rows may be dropped, otherwise the model always waits (seconds) */
+const double CONTROL_RECORD_TIMEOUT = 1.0;
+
+}
+
+ShmOutputChannel::ShmOutputChannel(const char* name,
+                                   size_t capacity,
+                                   bool drop,
+                                   int coords_precision,
+                                   OutputChannel* next)
+	: drop(drop),
+	  consumer_stalled(false),
+	  coords_precision(coords_precision),
+	  next(next) {
+
+	if (!ring.create(name, capacity)) {
+		fail("Could not create shared memory output %s: %s\n", name, ring.error().c_str());
+	}
+}
+
+ShmOutputChannel::~ShmOutputChannel() {
+
+	if (reserve_control(SHM_END, 0)) {
+		ring.commit();
+	}
+	ring.finish();
+
+	if (ring.dropped() > 0) {
+		dprintf("WARNING ! %llu records of output dropped since the shared memory output was full\n",
+		        (unsigned long long)ring.dropped());
+	}
+
+	// The consumer may still be reading, let it finish before the buffer is
+	// removed (unless it's allowed to fall behind)
+	if (!drop) {
+		ring.wait_until_read();
+	}
+
+	delete next;
+}
+
+Table ShmOutputChannel::create_table(const TableDescriptor& descriptor) {
+
+	if (descriptor.name() == "") {
+		return Table();
+	}
+
+	Table table = OutputChannel::create_table(descriptor);
+
+	if (next) {
+		Table next_table = next->create_table(descriptor);
+		if (next_table.id() != table.id()) {
+			fail("ShmOutputChannel: output table %s got different ids in the channels",
+			     descriptor.name().c_str());
+		}
+	}
+
+	ShmOutputReader::Schema schema;
+	schema.name = descriptor.name();
+	schema.coords_precision = coords_precision;
+
+	// Only the selected columns
+	const ColumnDescriptors& columns = get_table_descriptor(table).columns();
+	for (size_t i = 0; i < columns.size(); i++) {
+		schema.titles.push_back(columns[i].title());
+		schema.widths.push_back(columns[i].width());
+		schema.precisions.push_back(columns[i].precision());
+	}
+
+	const std::string packed = pack_shm_schema(table.id(), schema);
+
+	const size_t row_size = sizeof(ShmRowHeader) + columns.size() * sizeof(double);
+	if (!ring.fits(packed.size()) || !ring.fits(row_size)) {
+		fail("Shared memory output buffer too small for output table %s",
+		     descriptor.name().c_str());
+	}
+
+	void* payload = reserve_control(SHM_SCHEMA, packed.size());
+	if (payload) {
+		memcpy(payload, packed.data(), packed.size());
+		ring.commit();
+	}
+
+	return table;
+}
+
+void ShmOutputChannel::add_value(const Table& table, double d) {
+	OutputChannel::add_value(table, d);
+	if (next) {
+		next->add_value(table, d);
+	}
+}
+
+void ShmOutputChannel::finish_row(const Table& table,
+                                  double lon,
+                                  double lat,
+                                  int year) {
+	publish_row(table, lon, lat, year, -1);
+	if (next) {
+		next->finish_row(table, lon, lat, year);
+	}
+}
+
+void ShmOutputChannel::finish_row(const Table& table,
+                                  double lon,
+                                  double lat,
+                                  int year,
+                                  int day) {
+	publish_row(table, lon, lat, year, day);
+	if (next) {
+		next->finish_row(table, lon, lat, year, day);
+	}
+}
+
+void ShmOutputChannel::close_table(Table& table) {
+
+	// do nothing for unused tables
+	if (table.invalid()) {
+		return;
+	}
+
+	int32_t id = table.id();
+	void* payload = reserve_control(SHM_CLOSE_TABLE, sizeof(id));
+	if (payload) {
+		memcpy(payload, &id, sizeof(id));
+		ring.commit();
+	}
+
+	if (next) {
+		next->close_table(table);
+	}
+}
+
+void* ShmOutputChannel::reserve_control(ShmRecordType type, size_t size) {
+
+	if (!drop) {
+		return ring.reserve(type, size, false);
+	}
+
+	// Give the consumer some time, but there may be no consumer at all.
+	// Once it has let a control record wait in vain, the following ones
+	// are only written if there is room right away.
+	if (!consumer_stalled) {
+		consumer_stalled = !ring.wait_for_space(size, CONTROL_RECORD_TIMEOUT);
+	}
+
+	void* payload = ring.reserve(type, size, true);
+	if (payload) {
+		consumer_stalled = false;
+	}
+	return payload;
+}
+
+void ShmOutputChannel::publish_row(const Table& table,
+                                   double lon,
+                                   double lat,
+                                   int year,
+                                   int day) {
+	// do nothing for unused tables
+	if (table.invalid()) {
+		return;
+	}
+
+	const std::vector<double>& row = get_current_row(table);
+	const TableDescriptor& td = get_table_descriptor(table);
+
+	if (row.size() < td.columns().size()) {
+		fail("Too few values in a row in table %s", td.name().c_str());
+	}
+
+	// The row is written straight into the shared memory
+	const size_t size = sizeof(ShmRowHeader) + row.size() * sizeof(double);
+	ShmRowHeader* header = (ShmRowHeader*)ring.reserve(SHM_ROW, size, drop);
+
+	if (header) {
+		header->table = table.id();
+		header->year = year;
+		header->day = day;
+		header->ncolumns = (int32_t)row.size();
+		header->lon = lon;
+		header->lat = lat;
+		std::copy(row.begin(), row.end(), (double*)(header + 1));
+		ring.commit();
+	}
+
+	// start on a new row
+	clear_current_row(table);
+}
+
+}
+
+#endif // !_WIN32
@@ -0,0 +1,83 @@
+///////////////////////////////////////////////////////////////////////////////////////
+/// \file shmoutputchannel.h
+/// \brief Output channel publishing the output in shared memory
+///
+/// ShmOutputChannel sends every row of every output table, and a schema
+/// describing each table, to a ring buffer in POSIX shared memory (see
+/// shmring.h), where a process running alongside the model can read it
+/// while the model runs, e.g. for coupling or monitoring. The rows can also
+/// be passed on to another output channel so the usual text files are
+/// written as well.
+///
+/// When the buffer is full the model either waits for the consumer, or
+/// drops rows (counted, and reported at the end). When dropping, the
+/// control records (schemas, closed tables and the end of the output) wait
+/// up to a second for the consumer to make room, and are dropped too if it
+/// doesn't, so the model can't hang on a consumer which has stopped or
+/// never started reading.
+///
+/// $Date$
+///
+///////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef LPJ_GUESS_SHM_OUTPUT_CHANNEL_H
+#define LPJ_GUESS_SHM_OUTPUT_CHANNEL_H
+
+#include "outputchannel.h"
+#include "shmring.h"
+
+namespace GuessOutput {
+
+/// An output channel writing to a shared memory ring buffer
+class ShmOutputChannel : public OutputChannel {
+public:
+	/// Creates the shared memory object
+	/** \param name              Name of the shared memory object, e.g. "/guess_output"
+	 *  \param capacity          Size of the ring buffer in bytes
+	 *  \param drop              Drop rows when the buffer is full instead of waiting
+	 *  \param coords_precision  Precision of coordinates, passed on to the consumer
+	 *  \param next              Channel to pass all output on to (owned by this
+	 *                           object), or NULL
+	 */
+	ShmOutputChannel(const char* name, size_t capacity, bool drop,
+	                 int coords_precision, OutputChannel* next);
+
+	/// Ends the output, waiting for the consumer unless records may be dropped
+	~ShmOutputChannel();
+
+	Table create_table(const TableDescriptor& descriptor);
+
+	void add_value(const Table& table, double d);
+
+	void finish_row(const Table& table, double lon, double lat,
+	                int year);
+
+	void finish_row(const Table& table, double lon, double lat,
+	                int year, int day);
+
+	void close_table(Table& table);
+
+private:
+	/// Publishes the current row of a table and starts on a new one
+	void publish_row(const Table& table, double lon, double lat,
+	                 int year, int day);
+
+	/// Reserves a record which isn't a row, \see ShmRingBuffer::reserve
+	/** Returns NULL if the record was dropped, only possible with drop set */
+	void* reserve_control(ShmRecordType type, size_t size);
+
+	ShmRingBuffer ring;
+
+	bool drop;
+
+	/// Whether the consumer failed to make room for the last control record in time
+	bool consumer_stalled;
+
+	int coords_precision;
+
+	OutputChannel* next;
+};
+
+}
+
+#endif // LPJ_GUESS_SHM_OUTPUT_CHANNEL_H
@@ -0,0 +1,509 @@
+///////////////////////////////////////////////////////////////////////////////////////
+/// \file shmring.cpp
+/// \brief Ring buffer in POSIX shared memory for streaming output to other processes
+///
+/// $Date$
+///
+///////////////////////////////////////////////////////////////////////////////////////
+
+#include "shmring.h"
+
+#ifndef _WIN32
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+namespace GuessOutput {
+
+namespace {
+
+const uint32_t SHM_RING_MAGIC = 0x47534852; // "GSHR"
+const uint32_t SHM_RING_VERSION = 1;
+
+/// Size of a record in the buffer, with header and padding
+uint64_t record_size(uint64_t payload) {
+	return sizeof(ShmRecordHeader) + ((payload + 7) & ~(uint64_t)7);
+}
+
+uint64_t load_acquire(const uint64_t* p) {
+	return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+void store_release(uint64_t* p, uint64_t value) {
+	__atomic_store_n(p, value, __ATOMIC_RELEASE);
+}
+
+/// Pause while waiting for the other side
+void wait_a_moment() {
+	usleep(100);
+}
+
+/// Seconds since some fixed point in time
+double now() {
+	timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+void append_int(std::string& s, int32_t i) {
+	s.append((const char*)&i, sizeof(i));
+}
+
+int32_t read_int(const char*& p) {
+	int32_t i;
+	memcpy(&i, p, sizeof(i));
+	p += sizeof(i);
+	return i;
+}
+
+std::string read_string(const char*& p) {
+	std::string s(p);
+	p += s.size() + 1;
+	return s;
+}
+
+/// Appends printf style formatted text to a string
+void append_format(std::string& s, const char* format, ...) {
+	char buf[128];
+
+	va_list args;
+	va_start(args, format);
+	int n = vsnprintf(buf, sizeof(buf), format, args);
+	va_end(args);
+
+	if (n < (int)sizeof(buf)) {
+		s += buf;
+	}
+	else {
+		std::vector<char> big(n + 1);
+		va_start(args, format);
+		vsnprintf(&big.front(), big.size(), format, args);
+		va_end(args);
+		s += &big.front();
+	}
+}
+
+}
+
+/// The control block at the start of the shared memory
+/** The positions count bytes since the start of the stream, the write and
+ *  read positions are kept on separate cache lines.
+ */
+struct ShmRingBuffer::Control {
+	uint32_t magic;
+	uint32_t version;
+	uint64_t capacity;
+	uint64_t dropped;
+	uint32_t finished;
+	uint32_t unused;
+	char pad1[32];
+
+	uint64_t write_pos;
+	char pad2[56];
+
+	uint64_t read_pos;
+	char pad3[56];
+};
+
+ShmRingBuffer::ShmRingBuffer()
+	: control(NULL),
+	  data(NULL),
+	  mapped_size(0),
+	  writer(false),
+	  pending_pos(0),
+	  pending_size(0) {
+}
+
+ShmRingBuffer::~ShmRingBuffer() {
+	close();
+}
+
+bool ShmRingBuffer::create(const char* name, size_t capacity) {
+
+	capacity = (capacity + 7) & ~(size_t)7;
+
+	// Replace whatever was left by an earlier run
+	shm_unlink(name);
+
+	int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+	if (fd == -1) {
+		error_message = std::string("shm_open failed: ") + strerror(errno);
+		return false;
+	}
+
+	const size_t size = sizeof(Control) + capacity;
+	if (ftruncate(fd, size) == -1) {
+		error_message = std::string("ftruncate failed: ") + strerror(errno);
+		::close(fd);
+		shm_unlink(name);
+		return false;
+	}
+
+	void* p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	::close(fd);
+	if (p == MAP_FAILED) {
+		error_message = std::string("mmap failed: ") + strerror(errno);
+		shm_unlink(name);
+		return false;
+	}
+
+	control = (Control*)p;
+	data = (char*)p + sizeof(Control);
+	mapped_size = size;
+	shm_name = name;
+	writer = true;
+
+	control->version = SHM_RING_VERSION;
+	control->capacity = capacity;
+	control->dropped = 0;
+	control->finished = 0;
+	control->write_pos = 0;
+	control->read_pos = 0;
+
+	// Readers check the magic number last
+	__atomic_store_n(&control->magic, SHM_RING_MAGIC, __ATOMIC_RELEASE);
+
+	return true;
+}
+
+bool ShmRingBuffer::attach(const char* name) {
+
+	int fd = shm_open(name, O_RDWR, 0);
+	if (fd == -1) {
+		error_message = std::string("shm_open failed: ") + strerror(errno);
+		return false;
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) == -1 || st.st_size < (off_t)sizeof(Control)) {
+		error_message = "shared memory object not initialised";
+		::close(fd);
+		return false;
+	}
+
+	void* p = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	::close(fd);
+	if (p == MAP_FAILED) {
+		error_message = std::string("mmap failed: ") + strerror(errno);
+		return false;
+	}
+
+	Control* c = (Control*)p;
+	if (__atomic_load_n(&c->magic, __ATOMIC_ACQUIRE) != SHM_RING_MAGIC ||
+	    c->version != SHM_RING_VERSION ||
+	    sizeof(Control) + c->capacity != (uint64_t)st.st_size) {
+		error_message = "not an LPJ-GUESS output ring buffer (or not initialised)";
+		munmap(p, st.st_size);
+		return false;
+	}
+
+	control = c;
+	data = (char*)p + sizeof(Control);
+	mapped_size = st.st_size;
+	shm_name = name;
+	writer = false;
+
+	return true;
+}
+
+void ShmRingBuffer::close() {
+	if (control) {
+		munmap(control, mapped_size);
+		if (writer) {
+			shm_unlink(shm_name.c_str());
+		}
+		control = NULL;
+		data = NULL;
+	}
+}
+
+char* ShmRingBuffer::data_at(uint64_t pos) {
+	return data + pos % control->capacity;
+}
+
+bool ShmRingBuffer::fits(size_t size) const {
+	// Leave room for a padding record before it
+	return record_size(size) <= control->capacity / 2;
+}
+
+bool ShmRingBuffer::has_room(uint64_t total) const {
+
+	const uint64_t capacity = control->capacity;
+	const uint64_t write_pos = control->write_pos;
+
+	// Room for a padding record up to the end of the buffer if needed
+	const uint64_t tail = capacity - write_pos % capacity;
+	const uint64_t padding = tail < total ? tail : 0;
+
+	return capacity - (write_pos - load_acquire(&control->read_pos)) >= padding + total;
+}
+
+void* ShmRingBuffer::reserve(ShmRecordType type, size_t size, bool may_drop) {
+
+	const uint64_t capacity = control->capacity;
+	const uint64_t total = record_size(size);
+
+	// Only the writer moves the write position
+	uint64_t write_pos = control->write_pos;
+
+	// Records don't wrap, skip the rest of the buffer if needed
+	const uint64_t tail = capacity - write_pos % capacity;
+	const uint64_t padding = tail < total ? tail : 0;
+
+	while (!has_room(total)) {
+		if (may_drop) {
+			__atomic_add_fetch(&control->dropped, 1, __ATOMIC_RELAXED);
+			return NULL;
+		}
+		wait_a_moment();
+	}
+
+	if (padding) {
+		ShmRecordHeader* pad = (ShmRecordHeader*)data_at(write_pos);
+		pad->size = (uint32_t)(padding - sizeof(ShmRecordHeader));
+		pad->type = SHM_PADDING;
+		write_pos += padding;
+		store_release(&control->write_pos, write_pos);
+	}
+
+	ShmRecordHeader* header = (ShmRecordHeader*)data_at(write_pos);
+	header->size = (uint32_t)size;
+	header->type = type;
+
+	pending_pos = write_pos;
+	pending_size = total;
+
+	return header + 1;
+}
+
+bool ShmRingBuffer::wait_for_space(size_t size, double timeout) {
+
+	const uint64_t total = record_size(size);
+	const double give_up = now() + timeout;
+
+	while (!has_room(total)) {
+		if (now() > give_up) {
+			return false;
+		}
+		wait_a_moment();
+	}
+	return true;
+}
+
+void ShmRingBuffer::commit() {
+	store_release(&control->write_pos, pending_pos + pending_size);
+}
+
+void ShmRingBuffer::finish() {
+	__atomic_store_n(&control->finished, 1, __ATOMIC_RELEASE);
+}
+
+void ShmRingBuffer::wait_until_read() {
+	while (load_acquire(&control->read_pos) != control->write_pos) {
+		wait_a_moment();
+	}
+}
+
+const ShmRecordHeader* ShmRingBuffer::peek() {
+
+	// Only the reader moves the read position
+	uint64_t read_pos = control->read_pos;
+
+	while (read_pos != load_acquire(&control->write_pos)) {
+
+		const ShmRecordHeader* header = (const ShmRecordHeader*)data_at(read_pos);
+
+		if (header->type == SHM_PADDING) {
+			read_pos += record_size(header->size);
+			store_release(&control->read_pos, read_pos);
+			continue;
+		}
+
+		pending_pos = read_pos;
+		pending_size = record_size(header->size);
+		return header;
+	}
+
+	return NULL;
+}
+
+void ShmRingBuffer::release() {
+	store_release(&control->read_pos, pending_pos + pending_size);
+}
+
+bool ShmRingBuffer::finished() {
+	return __atomic_load_n(&control->finished, __ATOMIC_ACQUIRE) &&
+		control->read_pos == load_acquire(&control->write_pos);
+}
+
+uint64_t ShmRingBuffer::dropped() const {
+	return __atomic_load_n(&control->dropped, __ATOMIC_RELAXED);
+}
+
+const std::string& ShmRingBuffer::error() const {
+	return error_message;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+// ShmOutputReader
+//
+
+ShmOutputReader::ShmOutputReader(ShmRingBuffer& ring)
+	: ring(ring),
+	  current_row(NULL),
+	  current_table(-1),
+	  holding(false) {
+}
+
+int ShmOutputReader::next() {
+
+	if (holding) {
+		ring.release();
+		holding = false;
+		current_row = NULL;
+	}
+
+	const ShmRecordHeader* header = ring.peek();
+	if (!header) {
+		return -1;
+	}
+	holding = true;
+
+	const char* payload = (const char*)(header + 1);
+
+	switch (header->type) {
+	case SHM_SCHEMA: {
+		const char* p = payload;
+		current_table = read_int(p);
+
+		Schema s;
+		s.coords_precision = read_int(p);
+		int ncolumns = read_int(p);
+		s.name = read_string(p);
+		for (int i = 0; i < ncolumns; i++) {
+			s.widths.push_back(read_int(p));
+			s.precisions.push_back(read_int(p));
+			s.titles.push_back(read_string(p));
+		}
+
+		if (current_table >= (int)schemas.size()) {
+			schemas.resize(current_table + 1);
+			known.resize(current_table + 1);
+		}
+		schemas[current_table] = s;
+		known[current_table] = true;
+		break;
+	}
+	case SHM_ROW:
+		current_row = (const ShmRowHeader*)payload;
+		current_table = current_row->table;
+		break;
+	case SHM_CLOSE_TABLE: {
+		const char* p = payload;
+		current_table = read_int(p);
+		break;
+	}
+	case SHM_END:
+		// Nothing to keep, and the writer may be waiting for this
+		ring.release();
+		holding = false;
+		break;
+	}
+
+	return header->type;
+}
+
+const ShmRowHeader& ShmOutputReader::row() const {
+	return *current_row;
+}
+
+const double* ShmOutputReader::values() const {
+	return (const double*)(current_row + 1);
+}
+
+int ShmOutputReader::table() const {
+	return current_table;
+}
+
+bool ShmOutputReader::has_schema(int table) const {
+	return table >= 0 && table < (int)known.size() && known[table];
+}
+
+const ShmOutputReader::Schema& ShmOutputReader::schema(int table) const {
+	return schemas[table];
+}
+
+// The formats below are the same as in FileOutputChannel
+
+std::string ShmOutputReader::format_header(int table, bool daily) const {
+
+	const Schema& s = schemas[table];
+	const int coords_width = 4 + 1 + s.coords_precision + 2;
+
+	std::string line;
+
+	append_format(line, "%*s%*s%8s", coords_width, "Lon", coords_width, "Lat", "Year");
+	if (daily) {
+		append_format(line, "%8s", "Day");
+	}
+
+	for (size_t i = 0; i < s.titles.size(); i++) {
+		append_format(line, "%*s", s.widths[i], s.titles[i].c_str());
+	}
+	line += "\n";
+
+	return line;
+}
+
+std::string ShmOutputReader::format_row() const {
+
+	const ShmRowHeader& r = *current_row;
+	const Schema& s = schemas[r.table];
+	const int coords_width = 4 + 1 + s.coords_precision + 2;
+
+	std::string line;
+
+	append_format(line, "%*.*f%*.*f%8d",
+	              coords_width, s.coords_precision, r.lon,
+	              coords_width, s.coords_precision, r.lat,
+	              r.year);
+	if (r.day >= 0) {
+		append_format(line, "%8d", r.day);
+	}
+
+	const double* v = values();
+	for (int i = 0; i < r.ncolumns; i++) {
+		append_format(line, "%*.*f", s.widths[i], s.precisions[i], v[i]);
+	}
+	line += "\n";
+
+	return line;
+}
+
+std::string pack_shm_schema(int table, const ShmOutputReader::Schema& schema) {
+
+	std::string s;
+	append_int(s, table);
+	append_int(s, schema.coords_precision);
+	append_int(s, (int32_t)schema.titles.size());
+	s.append(schema.name.c_str(), schema.name.size() + 1);
+
+	for (size_t i = 0; i < schema.titles.size(); i++) {
+		append_int(s, schema.widths[i]);
+		append_int(s, schema.precisions[i]);
+		s.append(schema.titles[i].c_str(), schema.titles[i].size() + 1);
+	}
+
+	return s;
+}
+
+}
+
+#endif // !_WIN32
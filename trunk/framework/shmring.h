@@ -0,0 +1,225 @@
+///////////////////////////////////////////////////////////////////////////////////////
+/// \file shmring.h
+/// \brief Ring buffer in POSIX shared memory for streaming output to other processes
+///
+/// The ring buffer has one writer (the model, see ShmOutputChannel) and one
+/// reader in another process on the same machine. Records are written
+/// directly into the shared memory and read from there, without copying
+/// through pipes or files. Each record starts with a ShmRecordHeader and is
+/// padded to a multiple of 8 bytes. A record never wraps around the end of
+/// the buffer, a padding record fills the rest of the buffer instead.
+///
+/// The records published by ShmOutputChannel are described by the
+/// ShmRecordType enum, and decoded by ShmOutputReader, which can also format
+/// them exactly as FileOutputChannel does. See command_line_version/shmconsumer.cpp
+/// for a reference consumer.
+///
+/// This file doesn't depend on the rest of the model, so consumers can be
+/// built from shmring.cpp alone. Only available on POSIX systems.
+///
+/// $Date$
+///
+///////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef LPJ_GUESS_SHM_RING_H
+#define LPJ_GUESS_SHM_RING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+namespace GuessOutput {
+
+/// Types of the records in the ring buffer
+enum ShmRecordType {
+	/// Fills the rest of the buffer up to the end, skipped by readers
+	SHM_PADDING = 0,
+	/// Describes a table, see ShmOutputReader::Schema
+	SHM_SCHEMA = 1,
+	/// One row of output, see ShmRowHeader
+	SHM_ROW = 2,
+	/// A table is closed, the payload is its id (int32_t)
+	SHM_CLOSE_TABLE = 3,
+	/// End of the output, no payload
+	SHM_END = 4
+};
+
+/// Header of each record in the ring buffer
+struct ShmRecordHeader {
+	/// Size of the payload in bytes, without header and padding
+	uint32_t size;
+	/// One of ShmRecordType
+	uint32_t type;
+};
+
+/// Start of the payload of a SHM_ROW record
+/** Followed by ncolumns doubles with the values of the row */
+struct ShmRowHeader {
+	int32_t table;
+	int32_t year;
+	/// Day of year for daily output, -1 for annual output
+	int32_t day;
+	int32_t ncolumns;
+	double lon;
+	double lat;
+};
+
+/// A ring buffer in POSIX shared memory with one writer and one reader
+class ShmRingBuffer {
+public:
+	ShmRingBuffer();
+
+	/// Unmaps the buffer, and removes it if this is the writer
+	~ShmRingBuffer();
+
+	/// Creates the shared memory object (writer side)
+	/** An existing object with the same name is replaced.
+	 *  \param name      Name of the shared memory object, e.g. "/guess_output"
+	 *  \param capacity  Size of the buffer in bytes, rounded up to a multiple of 8
+	 *  \returns false on failure, see error()
+	 */
+	bool create(const char* name, size_t capacity);
+
+	/// Attaches to an existing shared memory object (reader side)
+	/** \returns false if it doesn't exist (yet) or isn't a ring buffer, see error() */
+	bool attach(const char* name);
+
+	/// Whether a record with a payload of this size fits in the buffer
+	bool fits(size_t size) const;
+
+	/// Reserves space for the next record, to be filled in and then commit():ed
+	/** If the buffer is full, the writer either waits for the reader or,
+	 *  if may_drop is set, gives up and counts the record as dropped.
+	 *
+	 *  \returns pointer to the payload, or NULL if the record was dropped
+	 */
+	void* reserve(ShmRecordType type, size_t size, bool may_drop);
+
+	/// Waits until reserve() wouldn't have to wait for a record of this size
+	/** \param size     Size of the payload
+	 *  \param timeout  Longest time to wait, in seconds
+	 *  \returns false if there was still no room after the timeout
+	 */
+	bool wait_for_space(size_t size, double timeout);
+
+	/// Publishes the record from the last reserve() to the reader
+	void commit();
+
+	/// Sets the flag telling the reader that nothing more will be written
+	void finish();
+
+	/// Waits until the reader has read everything written so far
+	void wait_until_read();
+
+	/// Gets the next record (reader side)
+	/** The payload stays valid until release() is called.
+	 *  \returns pointer to the record header, NULL if there is no record
+	 *           right now
+	 */
+	const ShmRecordHeader* peek();
+
+	/// Hands the space of the record from the last peek() back to the writer
+	void release();
+
+	/// Whether the writer has called finish() and everything has been read
+	bool finished();
+
+	/// Number of records dropped by the writer because the buffer was full
+	uint64_t dropped() const;
+
+	/// Description of the last error from create() or attach()
+	const std::string& error() const;
+
+private:
+	struct Control;
+
+	/// Unmaps the buffer (and removes it if this is the writer)
+	void close();
+
+	/// Whether a record of this total size (with header and padding) can be written now
+	bool has_room(uint64_t total) const;
+
+	/// Pointer into the data area for a position in the stream
+	char* data_at(uint64_t pos);
+
+	Control* control;
+	char* data;
+	size_t mapped_size;
+	std::string shm_name;
+	bool writer;
+
+	/// Position and size of the record being written or read
+	uint64_t pending_pos;
+	uint64_t pending_size;
+
+	std::string error_message;
+
+	// Not copyable
+	ShmRingBuffer(const ShmRingBuffer&);
+	ShmRingBuffer& operator=(const ShmRingBuffer&);
+};
+
+/// Decodes the records published by ShmOutputChannel
+/** Keeps the table schemas, and formats headers and rows exactly like the
+ *  text files written by FileOutputChannel.
+ */
+class ShmOutputReader {
+public:
+
+	/// Description of one output table
+	struct Schema {
+		std::string name;
+		std::vector<std::string> titles;
+		std::vector<int> widths;
+		std::vector<int> precisions;
+		int coords_precision;
+	};
+
+	ShmOutputReader(ShmRingBuffer& ring);
+
+	/// Reads the next record, returns its type or -1 if there is none right now
+	/** A row is available through row() and values() until the next call.
+	 *  Schemas are stored and available through schema().
+	 */
+	int next();
+
+	/// The row from the last next() returning SHM_ROW
+	const ShmRowHeader& row() const;
+
+	/// The values of the row from the last next(), pointing into the buffer
+	const double* values() const;
+
+	/// Id of the table from the last SHM_SCHEMA or SHM_CLOSE_TABLE record
+	int table() const;
+
+	/// Whether a schema has been received for a table
+	bool has_schema(int table) const;
+
+	const Schema& schema(int table) const;
+
+	/// Formats the header line of the text file for a table
+	std::string format_header(int table, bool daily) const;
+
+	/// Formats the current row as a line in the text file
+	std::string format_row() const;
+
+private:
+	ShmRingBuffer& ring;
+
+	std::vector<Schema> schemas;
+	std::vector<bool> known;
+
+	const ShmRowHeader* current_row;
+	int current_table;
+
+	/// Whether the record from the last next() is still to be released
+	bool holding;
+};
+
+/// Packs the schema of a table as the payload of a SHM_SCHEMA record
+std::string pack_shm_schema(int table, const ShmOutputReader::Schema& schema);
+
+}
+
+#endif // LPJ_GUESS_SHM_RING_H
@@ -0,0 +1,119 @@
+///////////////////////////////////////////////////////////////////////////////////////
+/// \file solverstats.cpp
+/// \brief Iteration counters for the iterative solvers of the model
+///
+/// $Date$
+///
+///////////////////////////////////////////////////////////////////////////////////////
+
+#include "config.h"
+#include "solverstats.h"
+#include "shell.h"
+
+void SolverCounters::reset() {
+	calls = 0;
+	iterations = 0;
+	max_iterations = 0;
+	max_reached = 0;
+	not_converged = 0;
+	for (int i = 0; i < NSOLVERBINS; i++) {
+		histogram[i] = 0;
+	}
+}
+
+void SolverCounters::add(int niterations, bool reached_max, bool converged) {
+	calls++;
+	iterations += niterations;
+	max_iterations = max(max_iterations, niterations);
+	if (reached_max) {
+		max_reached++;
+	}
+	if (!converged) {
+		not_converged++;
+	}
+
+	int bin = 0;
+	while (niterations > 0 && bin < NSOLVERBINS - 1) {
+		niterations >>= 1;
+		bin++;
+	}
+	histogram[bin]++;
+}
+
+void SolverCounters::add(const SolverCounters& other) {
+	calls += other.calls;
+	iterations += other.iterations;
+	max_iterations = max(max_iterations, other.max_iterations);
+	max_reached += other.max_reached;
+	not_converged += other.not_converged;
+	for (int i = 0; i < NSOLVERBINS; i++) {
+		histogram[i] += other.histogram[i];
+	}
+}
+
+double SolverCounters::mean_iterations() const {
+	return calls ? (double)iterations / (double)calls : 0.0;
+}
+
+namespace SolverStats {
+
+namespace {
+
+SolverCounters year_counters[NSOLVERTYPES];
+
+SolverCounters run_counters[NSOLVERTYPES];
+
+}
+
+const char* name(solvertype solver) {
+	switch (solver) {
+	case SOLVER_ASSIMILATION:
+		return "Assim";
+	case SOLVER_ALLOCATION:
+		return "Alloc";
+	case SOLVER_GAS_DIFFUSION:
+		return "Gasdiff";
+	case SOLVER_NCOMPETE:
+		return "Ncomp";
+	default:
+		return "?";
+	}
+}
+
+int bin_lower_bound(int bin) {
+	return bin == 0 ? 0 : 1 << (bin - 1);
+}
+
+void record(solvertype solver, int niterations, bool reached_max, bool converged) {
+	year_counters[solver].add(niterations, reached_max, converged);
+}
+
+const SolverCounters& year(solvertype solver) {
+	return year_counters[solver];
+}
+
+const SolverCounters& run(solvertype solver) {
+	return run_counters[solver];
+}
+
+void end_of_year() {
+	for (int s = 0; s < NSOLVERTYPES; s++) {
+		run_counters[s].add(year_counters[s]);
+		year_counters[s].reset();
+	}
+}
+
+void report() {
+#ifdef SOLVER_STATISTICS
+	dprintf("\nSolver iterations for this run:\n");
+	dprintf("%-8s %12s %8s %6s %10s %10s\n", "Solver", "Calls", "Mean", "Max", "At max", "Not conv");
+	for (int s = 0; s < NSOLVERTYPES; s++) {
+		const SolverCounters& c = run_counters[s];
+		dprintf("%-8s %12lu %8.3f %6d %10lu %10lu\n", name((solvertype)s),
+		        c.calls, c.mean_iterations(), c.max_iterations, c.max_reached, c.not_converged);
+	}
+	dprintf("\n");
+#endif
+}
+
+}
@@ -0,0 +1,112 @@
+///////////////////////////////////////////////////////////////////////////////////////
+/// \file solverstats.h
+/// \brief Iteration counters for the iterative solvers of the model
+///
+/// Some of the most frequently called routines iterate until a condition is
+/// met, with a number of iterations which depends on the data: the bisection
+/// for lambda in assimilation_wstress(), the root finder in the allocation
+/// of new biomass, the Crank-Nicolson passes of gas diffusion in the soil
+/// and the redistribution passes of ncompete(). When the model is built
+/// with SOLVER_STATISTICS defined (see config.h), each call to these solvers
+/// is counted together with the number of iterations it took, whether it
+/// stopped because the maximum number of iterations was reached and
+/// whether it converged.
+///
+/// The counters are written per grid cell and year to the solver
+/// statistics output files (file_solverstats and file_solverhist in the
+/// misc output module), and the totals for the run are written to the log.
+/// Without SOLVER_STATISTICS the SOLVER_RECORD macro expands to nothing.
+///
+/// $Date$
+///
+///////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef LPJ_GUESS_SOLVER_STATS_H
+#define LPJ_GUESS_SOLVER_STATS_H
+
+/// The solvers with iteration counters
+typedef enum {
+	SOLVER_ASSIMILATION,	///< Bisection for lambda in assimilation_wstress()
+	SOLVER_ALLOCATION,		///< Root finder for the leaf mass increment in allocation()
+	SOLVER_GAS_DIFFUSION,	///< Crank-Nicolson passes in Soil::diffuse_gas()
+	SOLVER_NCOMPETE,		///< Redistribution passes in ncompete()
+	NSOLVERTYPES
+} solvertype;
+
+/// Number of bins in the iteration histograms
+/** Bin 0 counts calls without iterations, bin i calls with 2^(i-1) to 2^i-1
+ *  iterations, and the last bin everything above.
+ */
+const int NSOLVERBINS = 9;
+
+/// Counters for one solver
+struct SolverCounters {
+
+	SolverCounters() {
+		reset();
+	}
+
+	/// Number of calls
+	unsigned long calls;
+
+	/// Total number of iterations over all calls
+	unsigned long iterations;
+
+	/// Largest number of iterations of a single call
+	int max_iterations;
+
+	/// Number of calls which stopped at the maximum number of iterations
+	unsigned long max_reached;
+
+	/// Number of calls which ended without a converged solution
+	unsigned long not_converged;
+
+	/// Number of calls by number of iterations, see NSOLVERBINS
+	unsigned long histogram[NSOLVERBINS];
+
+	void reset();
+
+	/// Counts one call
+	void add(int niterations, bool reached_max, bool converged);
+
+	/// Adds the counts of another counter
+	void add(const SolverCounters& other);
+
+	/// Mean number of iterations per call, zero if there were no calls
+	double mean_iterations() const;
+};
+
+namespace SolverStats {
+
+/// Name of a solver, used in the log and as prefix of output columns
+const char* name(solvertype solver);
+
+/// Lowest number of iterations counted in a histogram bin
+int bin_lower_bound(int bin);
+
+/// Counts one call of a solver, use SOLVER_RECORD instead
+void record(solvertype solver, int niterations, bool reached_max, bool converged);
+
+/// Counters for the current year of the grid cell being simulated
+const SolverCounters& year(solvertype solver);
+
+/// Counters for the whole run in this process, up to the previous end_of_year()
+const SolverCounters& run(solvertype solver);
+
+/// Adds this year's counters to the run totals and resets them
+/** Called by the framework after the annual output */
+void end_of_year();
+
+/// Writes the run totals to the log (if compiled with SOLVER_STATISTICS)
+void report();
+
+}
+
+#ifdef SOLVER_STATISTICS
+#define SOLVER_RECORD(solver, niterations, reached_max, converged) \
+	SolverStats::record(solver, niterations, reached_max, converged)
+#else
+#define SOLVER_RECORD(solver, niterations, reached_max, converged) ((void)0)
+#endif
+
+#endif // LPJ_GUESS_SOLVER_STATS_H
@@ -0,0 +1,263 @@
+#ifdef HAVE_NETCDF
+
+#include "cfremap.h"
+#include "cf.h"
+#include <algorithm>
+#include <utility>
+#include <math.h>
+
+namespace GuessNC {
+
+namespace CF {
+
+namespace {
+
+const double DEGREES_TO_RADIANS = 3.14159265358979323846 / 180;
+
+/// Tolerance for a location to count as on the grid without remapping
+const double COORDINATE_EPSILON = 1e-5;
+
+}
+
+RemapMethod parse_remap_method(const std::string& method) {
+	if (method == "" || method == "none") {
+		return REMAP_NONE;
+	}
+	else if (method == "nearest") {
+		return REMAP_NEAREST;
+	}
+	else if (method == "bilinear") {
+		return REMAP_BILINEAR;
+	}
+	else if (method == "conservative") {
+		return REMAP_CONSERVATIVE;
+	}
+	else {
+		throw CFError("Unknown remapping method: " + method);
+	}
+}
+
+void GridRemapper::Axis::init(const std::vector<double>& coordinates, bool may_be_periodic) {
+
+	if (coordinates.size() < 2) {
+		throw CFError("Remapping needs at least two coordinate values along each axis");
+	}
+
+	std::vector<std::pair<double, size_t> > sorted;
+	for (size_t i = 0; i < coordinates.size(); ++i) {
+		sorted.push_back(std::make_pair(coordinates[i], i));
+	}
+	std::sort(sorted.begin(), sorted.end());
+
+	const size_t n = sorted.size();
+
+	values.resize(n);
+	index.resize(n);
+	for (size_t i = 0; i < n; ++i) {
+		values[i] = sorted[i].first;
+		index[i] = sorted[i].second;
+	}
+
+	// A global axis continues from the last value to the first, with a gap
+	// like the spacing at its ends
+	const double gap = values[0] + 360 - values[n-1];
+	periodic = may_be_periodic && gap > COORDINATE_EPSILON &&
+		gap <= std::max(values[1] - values[0], values[n-1] - values[n-2]) + COORDINATE_EPSILON;
+
+	bounds.resize(n + 1);
+	for (size_t i = 1; i < n; ++i) {
+		bounds[i] = (values[i-1] + values[i]) / 2;
+	}
+	if (periodic) {
+		bounds[0] = values[0] - gap / 2;
+		bounds[n] = bounds[0] + 360;
+	}
+	else {
+		bounds[0] = values[0] - (values[1] - values[0]) / 2;
+		bounds[n] = values[n-1] + (values[n-1] - values[n-2]) / 2;
+	}
+}
+
+bool GridRemapper::Axis::contains(double c) const {
+	return c >= bounds.front() && c <= bounds.back();
+}
+
+size_t GridRemapper::Axis::nearest(double c) const {
+	size_t upper = std::lower_bound(values.begin(), values.end(), c) - values.begin();
+
+	if (upper == 0) {
+		return 0;
+	}
+	else if (upper == values.size()) {
+		return values.size() - 1;
+	}
+	else if (c - values[upper-1] <= values[upper] - c) {
+		return upper - 1;
+	}
+	else {
+		return upper;
+	}
+}
+
+void GridRemapper::Axis::bracket(double c, size_t& lower, size_t& upper, double& t) const {
+	if (periodic && (c < values.front() || c > values.back())) {
+		// Between the last value and the first, across the edge of the grid
+		lower = values.size() - 1;
+		upper = 0;
+		const double after_last = c < values.front() ? c + 360 : c;
+		t = (after_last - values.back()) / (values.front() + 360 - values.back());
+	}
+	else if (c <= values.front()) {
+		lower = upper = 0;
+		t = 0;
+	}
+	else if (c >= values.back()) {
+		lower = upper = values.size() - 1;
+		t = 0;
+	}
+	else {
+		upper = std::upper_bound(values.begin(), values.end(), c) - values.begin();
+		lower = upper - 1;
+		t = (c - values[lower]) / (values[upper] - values[lower]);
+	}
+}
+
+GridRemapper::GridRemapper(const std::vector<double>& lons,
+                           const std::vector<double>& lats,
+                           RemapMethod method,
+                           double target_size)
+	: method(method),
+	  target_size(target_size) {
+
+	lon_axis.init(lons, true);
+	lat_axis.init(lats, false);
+
+	// Latitude cells at the edges end at the poles
+	lat_axis.bounds.front() = std::max(lat_axis.bounds.front(), -90.0);
+	lat_axis.bounds.back() = std::min(lat_axis.bounds.back(), 90.0);
+
+	if (method == REMAP_CONSERVATIVE && target_size <= 0) {
+		throw CFError("Conservative remapping needs the size of the target cells");
+	}
+}
+
+double GridRemapper::wrap_lon(double lon) const {
+	if (lon_axis.periodic) {
+		// Into the turn starting at the first cell
+		const double west = lon_axis.bounds.front();
+		lon = west + fmod(fmod(lon - west, 360) + 360, 360);
+	}
+	else if (!lon_axis.contains(lon)) {
+		if (lon_axis.contains(lon + 360)) {
+			return lon + 360;
+		}
+		else if (lon_axis.contains(lon - 360)) {
+			return lon - 360;
+		}
+	}
+	return lon;
+}
+
+bool GridRemapper::get_weights(double lon, double lat, std::vector<RemapWeight>& weights) const {
+
+	weights.clear();
+
+	lon = wrap_lon(lon);
+
+	if (!lon_axis.contains(lon) || !lat_axis.contains(lat)) {
+		return false;
+	}
+
+	switch (method) {
+
+	case REMAP_NONE:
+	case REMAP_NEAREST: {
+		const size_t i = lon_axis.nearest(lon);
+		const size_t j = lat_axis.nearest(lat);
+
+		if (method == REMAP_NONE &&
+		    (fabs(lon_axis.values[i] - lon) > COORDINATE_EPSILON ||
+		     fabs(lat_axis.values[j] - lat) > COORDINATE_EPSILON)) {
+			return false;
+		}
+
+		weights.push_back(RemapWeight(lon_axis.index[i], lat_axis.index[j], 1));
+		break;
+	}
+
+	case REMAP_BILINEAR: {
+		size_t i[2], j[2];
+		double t, u;
+		lon_axis.bracket(lon, i[0], i[1], t);
+		lat_axis.bracket(lat, j[0], j[1], u);
+
+		const double wx[2] = { 1 - t, t };
+		const double wy[2] = { 1 - u, u };
+
+		// At the edges of the grid the upper point has weight 0
+		for (int b = 0; b < 2; ++b) {
+			for (int a = 0; a < 2; ++a) {
+				const double weight = wx[a] * wy[b];
+				if (weight > 0) {
+					weights.push_back(RemapWeight(lon_axis.index[i[a]], lat_axis.index[j[b]], weight));
+				}
+			}
+		}
+		break;
+	}
+
+	case REMAP_CONSERVATIVE: {
+		const double half = target_size / 2;
+		const double south = std::max(lat - half, -90.0) * DEGREES_TO_RADIANS;
+		const double north = std::min(lat + half, 90.0) * DEGREES_TO_RADIANS;
+
+		double sum = 0;
+
+		for (size_t j = 0; j < lat_axis.values.size(); ++j) {
+
+			// Area on the sphere is proportional to the difference in sine of latitude
+			const double lat_lo = std::max(lat_axis.bounds[j] * DEGREES_TO_RADIANS, south);
+			const double lat_hi = std::min(lat_axis.bounds[j+1] * DEGREES_TO_RADIANS, north);
+			if (lat_hi <= lat_lo) {
+				continue;
+			}
+			const double lat_overlap = sin(lat_hi) - sin(lat_lo);
+
+			for (size_t i = 0; i < lon_axis.values.size(); ++i) {
+
+				// The target cell may cross the edge of a global grid
+				double lon_overlap = 0;
+				for (int turn = -1; turn <= 1; ++turn) {
+					const double lon_lo = std::max(lon_axis.bounds[i], lon - half + turn * 360);
+					const double lon_hi = std::min(lon_axis.bounds[i+1], lon + half + turn * 360);
+					lon_overlap += std::max(lon_hi - lon_lo, 0.0);
+				}
+
+				if (lon_overlap > 0) {
+					const double weight = lon_overlap * lat_overlap;
+					weights.push_back(RemapWeight(lon_axis.index[i], lat_axis.index[j], weight));
+					sum += weight;
+				}
+			}
+		}
+
+		if (sum <= 0) {
+			weights.clear();
+			return false;
+		}
+
+		for (size_t w = 0; w < weights.size(); ++w) {
+			weights[w].weight /= sum;
+		}
+		break;
+	}
+	}
+
+	return true;
+}
+
+}
+
+}
+
+#endif // HAVE_NETCDF
@@ -0,0 +1,126 @@
+#ifndef LPJGUESS_GUESSNC_CFREMAP_H
+#define LPJGUESS_GUESSNC_CFREMAP_H
+
+#ifdef HAVE_NETCDF
+
+#include <string>
+#include <vector>
+#include <stddef.h>
+
+namespace GuessNC {
+
+namespace CF {
+
+/// Ways of getting values for a location which isn't on the grid of a data set
+enum RemapMethod {
+	/// No remapping, locations must be on the grid
+	REMAP_NONE,
+	/// Value of the closest grid point
+	REMAP_NEAREST,
+	/// Bilinear interpolation between the four surrounding grid points
+	REMAP_BILINEAR,
+	/// Mean of the grid cells overlapping a target cell, weighted by overlapping area
+	REMAP_CONSERVATIVE
+};
+
+/// Parses a remapping method ("none", "nearest", "bilinear" or "conservative")
+/** Throws CFError for unknown methods */
+RemapMethod parse_remap_method(const std::string& method);
+
+/// A location in a data set and its weight in a remapped value
+struct RemapWeight {
+	RemapWeight(size_t x, size_t y, double weight)
+		: x(x), y(y), weight(weight) {}
+
+	/// The x coordinate in the data set's coordinate system
+	size_t x;
+
+	/// The y coordinate in the data set's coordinate system
+	size_t y;
+
+	/// Weight of the location's values, the weights of a remapped value sum to 1
+	double weight;
+};
+
+/// Computes remapping weights from a rectilinear grid to arbitrary locations
+/** The source grid is given by its longitude and latitude coordinate values,
+ *  which may be irregularly spaced but must be monotonic, in either
+ *  direction. The grid cells are taken to extend halfway to the neighbouring
+ *  coordinate values (and as far on the outer side for cells at the edge).
+ *
+ *  The weights are computed once per location and applied to the whole time
+ *  series, see GridcellOrderedVariable::load_data_for.
+ *
+ *  Target longitudes are shifted by whole turns if needed to fall on the
+ *  source grid, so grids and locations may use either 0-360 or -180-180.
+ *  A longitude axis going all the way round (the gap between its last and
+ *  first value is no larger than the spacing at its ends) is periodic:
+ *  the cells at its ends are then neighbours across the edge of the grid.
+ */
+class GridRemapper {
+public:
+	/// Constructor
+	/** \param lons        Longitudes of the source grid (degrees east)
+	 *  \param lats        Latitudes of the source grid (degrees north)
+	 *  \param method      How to remap
+	 *  \param target_size Size of the target cells in degrees, only used by
+	 *                     conservative remapping, where the target location
+	 *                     is the centre of a square cell of this size
+	 */
+	GridRemapper(const std::vector<double>& lons,
+	             const std::vector<double>& lats,
+	             RemapMethod method,
+	             double target_size = 0);
+
+	/// Computes the weights for a target location
+	/** \returns false if the location is outside the source grid, the
+	 *           weights are then empty.
+	 */
+	bool get_weights(double lon, double lat, std::vector<RemapWeight>& weights) const;
+
+private:
+	/// Coordinate values along one axis of the source grid, in increasing order
+	struct Axis {
+		/// The coordinate values
+		std::vector<double> values;
+
+		/// Index in the data set of each coordinate value
+		std::vector<size_t> index;
+
+		/// Cell bounds, bounds[i] and bounds[i+1] enclose values[i]
+		std::vector<double> bounds;
+
+		/// Whether the last value is followed by the first, a turn further on
+		bool periodic;
+
+		void init(const std::vector<double>& coordinates, bool may_be_periodic);
+
+		/// Whether a coordinate is within the grid cells along the axis
+		bool contains(double c) const;
+
+		/// Position of the value closest to c
+		size_t nearest(double c) const;
+
+		/// Positions of the values either side of c, and the weight of the upper one
+		/** On a periodic axis c may lie between the last and the first value */
+		void bracket(double c, size_t& lower, size_t& upper, double& t) const;
+	};
+
+	/// Shifts a longitude by whole turns to the source grid if possible
+	double wrap_lon(double lon) const;
+
+	Axis lon_axis;
+	Axis lat_axis;
+
+	RemapMethod method;
+
+	double target_size;
+};
+
+}
+
+}
+
+#endif // HAVE_NETCDF
+
+#endif // LPJGUESS_GUESSNC_CFREMAP_H
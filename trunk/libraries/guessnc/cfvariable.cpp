@@ -30,14 +30,71 @@ bool classic_numeric_type(nc_type type) {
 
 namespace CF {
 
+namespace {
+
+/// Checks whether a DateTime is strictly earlier than another
+bool earlier(const DateTime& dt1, const DateTime& dt2) {
+	if (dt1.get_year() != dt2.get_year()) {
+		return dt1.get_year() < dt2.get_year();
+	}
+	if (dt1.get_month() != dt2.get_month()) {
+		return dt1.get_month() < dt2.get_month();
+	}
+	if (dt1.get_day() != dt2.get_day()) {
+		return dt1.get_day() < dt2.get_day();
+	}
+	return dt1.get_seconds_after_midnight() < dt2.get_seconds_after_midnight();
+}
+
+/// Orders indices of files by the first date in each file
+struct EarlierStart {
+	EarlierStart(const std::vector<DateTime>& starts) : starts(starts) {}
+
+	bool operator()(size_t i, size_t j) const {
+		return earlier(starts[i], starts[j]);
+	}
+
+	const std::vector<DateTime>& starts;
+};
+
+}
+
 GridcellOrderedVariable::
 GridcellOrderedVariable(const char* filename,
-                        const char* variable) {
+                        const char* variable,
+                        size_t max_open_files,
+                        bool allow_static)
+	: max_open_files(std::max(max_open_files, (size_t)1)),
+	  location_chunk_cache(0),
+	  current_segment(0),
+	  use_counter(0),
+	  current_x(0),
+	  current_y(0),
+	  current_landid(0),
+	  static_data(false) {
+
+	// Constructor - opens the file(s) and figures out how time works
+
+	std::vector<std::string> files = expand_file_set(filename);
+
+	open_primary(files.front(), variable, allow_static);
+
+	if (files.size() > 1) {
+		if (static_data) {
+			throw CFError(variable, "A variable without a time dimension can't be split over several files");
+		}
+		add_time_segments(files, variable);
+	}
+}
 
-	// Constructor - opens the file and figures out how time works
+void GridcellOrderedVariable::open_primary(const std::string& filename,
+                                           const std::string& variable_str,
+                                           bool allow_static) {
+
+	const char* variable = variable_str.c_str();
 
 	// Open the file
-	ncid_file = open_ncdf(filename);
+	ncid_file = open_ncdf(filename.c_str());
 
 	// Get a handle to the main variable
 	int status = nc_inq_varid(ncid_file, variable, &ncid_var);
@@ -60,7 +117,7 @@ GridcellOrderedVariable(const char* filename,
 	}
 
 	// Figure out how time works in this file
-	find_time_dimension();
+	find_time_dimension(allow_static);
 
 	// Figure out how the horizontal coordinate system works in this file
 	find_spatial_dimensions();
@@ -105,9 +162,142 @@ GridcellOrderedVariable(const char* filename,
 	if (!reduced) {
 		cache_lonlats();
 	}
+
+	segments.resize(1);
+	segments.front().filename = filename;
+	segments.front().first = 0;
+	segments.front().count = time.size();
 }
 
-void GridcellOrderedVariable::find_time_dimension() {
+void GridcellOrderedVariable::add_time_segments(const std::vector<std::string>& files,
+                                                const std::string& variable) {
+
+	// The first file in the list is open, check the others against it
+	// and collect their time axes
+	std::vector<TimeSegment> found(files.size());
+	std::vector<std::vector<double> > times(files.size());
+	std::vector<DateTime> starts(files.size());
+
+	found.front() = segments.front();
+	times.front() = time;
+
+	for (size_t i = 1; i < files.size(); ++i) {
+		found[i].filename = files[i];
+
+		int ncid = open_ncdf(files[i].c_str());
+		try {
+			read_segment_time(ncid, variable, found[i], times[i]);
+		}
+		catch (...) {
+			nc_close(ncid);
+			throw;
+		}
+		close_ncdf(ncid);
+	}
+
+	for (size_t i = 0; i < files.size(); ++i) {
+		if (times[i].empty()) {
+			throw CFError(variable_name, "No timesteps in " + files[i]);
+		}
+		starts[i] = found[i].time_spec.get_date_time(times[i].front(), calendar);
+	}
+
+	std::vector<size_t> order(files.size());
+	for (size_t i = 0; i < order.size(); ++i) {
+		order[i] = i;
+	}
+	std::stable_sort(order.begin(), order.end(), EarlierStart(starts));
+
+	// The earliest file is kept open for metadata and the first years
+	if (order.front() != 0) {
+		close_ncdf(ncid_file);
+		open_primary(files[order.front()], variable, false);
+	}
+
+	// Merge the time axes
+	time.clear();
+	segments.clear();
+
+	for (size_t k = 0; k < order.size(); ++k) {
+		TimeSegment segment = found[order[k]];
+		const std::vector<double>& segment_times = times[order[k]];
+
+		if (k > 0) {
+			const TimeSegment& previous = segments.back();
+			DateTime previous_end =
+				previous.time_spec.get_date_time(time.back(), calendar);
+
+			if (!earlier(previous_end, starts[order[k]])) {
+				throw CFError(variable_name, "Time periods in " + previous.filename +
+				              " and " + segment.filename + " overlap");
+			}
+		}
+
+		segment.first = time.size();
+		segment.count = segment_times.size();
+		time.insert(time.end(), segment_times.begin(), segment_times.end());
+		segments.push_back(segment);
+	}
+}
+
+void GridcellOrderedVariable::read_segment_time(int ncid,
+                                                const std::string& variable,
+                                                TimeSegment& segment,
+                                                std::vector<double>& times) const {
+
+	int varid;
+	int status = nc_inq_varid(ncid, variable.c_str(), &varid);
+	handle_error(status, "Failed to get variable " + variable + " in " + segment.filename);
+
+	nc_type type;
+	status = nc_inq_vartype(ncid, varid, &type);
+	handle_error(status, "Failed to get type of main variable in " + segment.filename);
+
+	if (!classic_numeric_type(type)) {
+		throw CFError(variable, "Main variable must be a NetCDF classic numeric type");
+	}
+
+	// Same dimensions, in the same order, as in the first file. Only the
+	// length of the time dimension may differ.
+	std::vector<int> mydims, dims;
+	get_dimensions(ncid_file, ncid_var, mydims);
+	get_dimensions(ncid, varid, dims);
+
+	if (dims.size() != mydims.size()) {
+		throw CFError(variable_name, "Different dimensions in " + segment.filename);
+	}
+
+	for (size_t d = 0; d < dims.size(); ++d) {
+		char myname[NC_MAX_NAME+1], name[NC_MAX_NAME+1];
+		size_t mylen, len;
+
+		status = nc_inq_dim(ncid_file, mydims[d], myname, &mylen);
+		handle_error(status, "Failed to get dimension of " + variable_name);
+
+		status = nc_inq_dim(ncid, dims[d], name, &len);
+		handle_error(status, "Failed to get dimension of " + variable_name +
+		             " in " + segment.filename);
+
+		if (strcmp(myname, name) != 0 || (d != t_dimension_index && mylen != len)) {
+			throw CFError(variable_name, "Different dimensions in " + segment.filename);
+		}
+	}
+
+	int ncid_timecoord;
+	if (!get_coordinate_variable(ncid, dims[t_dimension_index], ncid_timecoord)) {
+		throw CFError(variable_name, "No time coordinate variable in " + segment.filename);
+	}
+
+	CalendarType cal;
+	read_time_coordinate(ncid, dims[t_dimension_index], ncid_timecoord,
+	                     times, segment.time_spec, cal);
+
+	if (cal != calendar) {
+		throw CFError(variable_name, "Different calendar in " + segment.filename);
+	}
+}
+
+void GridcellOrderedVariable::find_time_dimension(bool allow_static) {
 	// Get the dimensions of the main variable
 	std::vector<int> ncid_dims;
 	get_dimensions(ncid_file, ncid_var, ncid_dims);
@@ -166,41 +356,64 @@ void GridcellOrderedVariable::find_time_dimension() {
 	}
 
 	if (!foundit) {
-		throw CFError(variable_name, "No proper time dimension found");
+		if (!allow_static) {
+			throw CFError(variable_name, "No proper time dimension found");
+		}
+
+		// Static data, a single timestep. The time dimension index is
+		// set past the variable's dimensions so it can't match any of them.
+		static_data = true;
+		ncid_t_dimension = -1;
+		t_dimension_index = ncid_dims.size();
+		calendar = STANDARD;
+		segments.resize(1);
+		time.assign(1, 0.0);
+		return;
 	}
 
 	// We've now found the time dimension and coordinate variable
 	// read in time data and store the time unit specification
 
+	segments.resize(1);
+	read_time_coordinate(ncid_file, ncid_t_dimension, ncid_timecoord,
+	                     time, segments.front().time_spec, calendar);
+}
+
+void GridcellOrderedVariable::read_time_coordinate(int ncid, int ncid_dim, int ncid_timecoord,
+                                                   std::vector<double>& times,
+                                                   TimeUnitSpecification& spec,
+                                                   CalendarType& cal) const {
 	size_t nbr_timesteps;
-	status = nc_inq_dimlen(ncid_file, ncid_t_dimension, &nbr_timesteps);
+	int status = nc_inq_dimlen(ncid, ncid_dim, &nbr_timesteps);
+	handle_error(status, "Failed to get length of time dimension for " + variable_name);
 
 	// Read in the time variable
-	time.resize(nbr_timesteps);
+	times.resize(nbr_timesteps);
 
-	status = nc_get_var_double(ncid_file, ncid_timecoord, &time.front());
+	status = nc_get_var_double(ncid, ncid_timecoord, &times.front());
+	handle_error(status, "Failed to read time coordinates for " + variable_name);
 
 	// Get information about calendar and time unit
 	std::string calendar_attribute;
-	if (!get_attribute(ncid_file, ncid_timecoord, "calendar", calendar_attribute)) {
+	if (!get_attribute(ncid, ncid_timecoord, "calendar", calendar_attribute)) {
 		throw CFError(variable_name, "Time coordinate variable didn't have a proper calendar attribute");
 	}
 
-	calendar = parse_calendar(calendar_attribute.c_str());
+	cal = parse_calendar(calendar_attribute.c_str());
 
 	std::string units_attribute;
-	if (!get_attribute(ncid_file, ncid_timecoord, "units", units_attribute)) {
+	if (!get_attribute(ncid, ncid_timecoord, "units", units_attribute)) {
 		throw CFError(variable_name, "Time coordinate variable didn't have a proper units attribute");
 	}
 
-	time_spec = TimeUnitSpecification(units_attribute.c_str());
+	spec = TimeUnitSpecification(units_attribute.c_str());
 
 	// Try getting the reference time with the given calendar.
 	// If the standard/gregorian calendar is used, we only allow dates
 	// after the Julian/Gregorian switch, time_spec will throw an
 	// exception if a year before 1583 is used with a standard/gregorian
 	// calendar.
-	time_spec.get_date_time(0, calendar);
+	spec.get_date_time(0, cal);
 }
 
 
@@ -421,26 +634,142 @@ void GridcellOrderedVariable::find_extra_dimension() {
 
 
 bool GridcellOrderedVariable::load_data_for(size_t x, size_t y) {
-	data.resize(get_timesteps() * extra_dimension_size);
+	data.resize(segments.front().count * extra_dimension_size);
 
 	if (!location_exists(x, y)) {
 		return false;
 	}
 
-	size_t start[4];
-	start[x_dimension_index] = x;
-	start[y_dimension_index] = y;
-	start[t_dimension_index] = 0;
+	current_x = x;
+	current_y = y;
+	current_weights.clear();
 
-	size_t count[4];
-	count[x_dimension_index] = 1;
-	count[y_dimension_index] = 1;
-	count[t_dimension_index] = get_timesteps();
+	for (size_t i = 0; i < open_files.size(); ++i) {
+		open_files[i].loaded = false;
+	}
+
+	return read_location(ncid_file, ncid_var, segments.front().count, data) &&
+		load_later_segments();
+}
+
+
+bool GridcellOrderedVariable::load_data_for(size_t landid) {
+	data.resize(segments.front().count * extra_dimension_size);
+
+	if (!location_exists(landid)) {
+		return false;
+	}
+
+	current_landid = landid;
+	current_weights.clear();
+
+	for (size_t i = 0; i < open_files.size(); ++i) {
+		open_files[i].loaded = false;
+	}
+
+	return read_location(ncid_file, ncid_var, segments.front().count, data) &&
+		load_later_segments();
+}
+
+bool GridcellOrderedVariable::load_data_for(const std::vector<RemapWeight>& weights) {
+	if (reduced) {
+		throw CFError(variable_name, "Remapping is not supported for reduced grids");
+	}
+
+	const size_t timesteps = segments.front().count;
+
+	data.assign(timesteps * extra_dimension_size, 0);
+	current_weights.clear();
+
+	for (size_t i = 0; i < open_files.size(); ++i) {
+		open_files[i].loaded = false;
+	}
+
+	// Sum up the locations with valid data in all files, leaving out the others
+	double sum = 0;
+	for (size_t w = 0; w < weights.size(); ++w) {
+		const RemapWeight& weight = weights[w];
+
+		if (!location_exists(weight.x, weight.y) ||
+		    !valid_in_later_segments(weight.x, weight.y) ||
+		    !read_point(ncid_file, ncid_var, timesteps, weight.x, weight.y, point_buffer)) {
+			continue;
+		}
+
+		for (size_t i = 0; i < data.size(); ++i) {
+			data[i] += weight.weight * point_buffer[i];
+		}
+		sum += weight.weight;
+		current_weights.push_back(weight);
+	}
+
+	if (current_weights.empty() || sum <= 0) {
+		current_weights.clear();
+		return false;
+	}
+
+	for (size_t i = 0; i < data.size(); ++i) {
+		data[i] /= sum;
+	}
+	for (size_t w = 0; w < current_weights.size(); ++w) {
+		current_weights[w].weight /= sum;
+	}
+
+	return true;
+}
 
+bool GridcellOrderedVariable::read_location(int ncid, int varid, size_t timesteps,
+                                            std::vector<double>& buffer) const {
+	if (current_weights.empty()) {
+		return read_point(ncid, varid, timesteps,
+		                  reduced ? current_landid : current_x, current_y, buffer);
+	}
+
+	buffer.assign(timesteps * extra_dimension_size, 0);
+
+	for (size_t w = 0; w < current_weights.size(); ++w) {
+		const RemapWeight& weight = current_weights[w];
+
+		if (!read_point(ncid, varid, timesteps, weight.x, weight.y, point_buffer)) {
+			return false;
+		}
+
+		for (size_t i = 0; i < buffer.size(); ++i) {
+			buffer[i] += weight.weight * point_buffer[i];
+		}
+	}
+
+	return true;
+}
+
+bool GridcellOrderedVariable::read_point(int ncid, int varid, size_t timesteps,
+                                         size_t x, size_t y,
+                                         std::vector<double>& buffer) const {
+	buffer.resize(timesteps * extra_dimension_size);
+
+	size_t start[4];
+	size_t count[4];
 	ptrdiff_t imap[4];
-	imap[x_dimension_index] = 1;
-	imap[y_dimension_index] = 1;
-	imap[t_dimension_index] = extra_dimension_size;
+
+	if (reduced) {
+		start[landid_dimension_index] = x;
+		count[landid_dimension_index] = 1;
+		imap[landid_dimension_index] = 1;
+	}
+	else {
+		start[x_dimension_index] = x;
+		start[y_dimension_index] = y;
+		count[x_dimension_index] = 1;
+		count[y_dimension_index] = 1;
+		imap[x_dimension_index] = 1;
+		imap[y_dimension_index] = 1;
+	}
+
+	if (!static_data) {
+		start[t_dimension_index] = 0;
+		count[t_dimension_index] = timesteps;
+		imap[t_dimension_index] = extra_dimension_size;
+	}
 
 	if (ncid_extra_dimension != -1) {
 		start[extra_dimension_index] = 0;
@@ -448,71 +777,155 @@ bool GridcellOrderedVariable::load_data_for(size_t x, size_t y) {
 		imap[extra_dimension_index] = 1;
 	}
 
-	int status = nc_get_varm_double(ncid_file, ncid_var, start, count, 0, imap, &data.front());
+	int status = nc_get_varm_double(ncid, varid, start, count, 0, imap, &buffer.front());
 	handle_error(status,
 	             std::string("Failed to read data from variable ") + variable_name);
 
 	// Check if the data for this location contains a missing value
 	double missing_value;
-	if (get_attribute(ncid_file, ncid_var, "missing_value", missing_value)) {
-		if (std::find(data.begin(), data.end(), missing_value) != data.end()) {
+	if (get_attribute(ncid, varid, "missing_value", missing_value)) {
+		if (std::find(buffer.begin(), buffer.end(), missing_value) != buffer.end()) {
 			return false;
 		}
 	}
 
-	unpack_data();
+	unpack_data(ncid, varid, buffer);
 
 	return true;
 }
 
+size_t GridcellOrderedVariable::find_segment(int timestep) const {
+	if (segments.size() == 1) {
+		return 0;
+	}
 
-bool GridcellOrderedVariable::load_data_for(size_t landid) {
-	data.resize(get_timesteps());
+	// Timesteps are mostly requested in order, try the last segment used first
+	const size_t t = (size_t)timestep;
+	const TimeSegment& current = segments[current_segment];
 
-	if (!location_exists(landid)) {
-		return false;
+	if (t >= current.first && t < current.first + current.count) {
+		return current_segment;
+	}
+
+	size_t low = 0, high = segments.size();
+	while (high - low > 1) {
+		size_t middle = (low + high) / 2;
+		if (segments[middle].first <= t) {
+			low = middle;
+		}
+		else {
+			high = middle;
+		}
 	}
 
-	size_t start[3];
-	start[landid_dimension_index] = landid;
-	start[t_dimension_index] = 0;
+	current_segment = low;
+	return low;
+}
 
-	size_t count[3];
-	count[landid_dimension_index] = 1;
-	count[t_dimension_index] = get_timesteps();
+GridcellOrderedVariable::OpenFile& GridcellOrderedVariable::segment_file(size_t segment) const {
+	++use_counter;
 
-	ptrdiff_t imap[3];
-	imap[landid_dimension_index] = 1;
-	imap[t_dimension_index] = extra_dimension_size;
+	OpenFile* file = 0;
+	for (size_t i = 0; i < open_files.size(); ++i) {
+		if (open_files[i].segment == segment) {
+			file = &open_files[i];
+			break;
+		}
+	}
 
-	if (ncid_extra_dimension != -1) {
-		start[extra_dimension_index] = 0;
-		count[extra_dimension_index] = extra_dimension_size;
-		imap[extra_dimension_index] = 1;
+	if (!file) {
+		if (open_files.size() >= max_open_files) {
+			size_t lru = 0;
+			for (size_t i = 1; i < open_files.size(); ++i) {
+				if (open_files[i].last_used < open_files[lru].last_used) {
+					lru = i;
+				}
+			}
+			close_ncdf(open_files[lru].ncid_file);
+			open_files.erase(open_files.begin() + lru);
+		}
+
+		OpenFile new_file;
+		new_file.segment = segment;
+		new_file.ncid_file = open_ncdf(segments[segment].filename.c_str());
+		new_file.loaded = false;
+
+		int status = nc_inq_varid(new_file.ncid_file, variable_name.c_str(), &new_file.ncid_var);
+		if (status != NC_NOERR) {
+			nc_close(new_file.ncid_file);
+		}
+		handle_error(status, "Failed to get variable " + variable_name +
+		             " in " + segments[segment].filename);
+
+		if (location_chunk_cache) {
+			apply_location_chunk_cache(new_file.ncid_file, new_file.ncid_var,
+			                           segments[segment].count);
+		}
+
+		open_files.push_back(new_file);
+		file = &open_files.back();
 	}
 
-	int status = nc_get_varm_double(ncid_file, ncid_var, start, count, 0, imap, &data.front());
-	handle_error(status,
-	             std::string("Failed to read data from variable ") + variable_name);
+	file->last_used = use_counter;
+	return *file;
+}
 
-	// Check if the data for this location contains a missing value
-	double missing_value;
-	if (get_attribute(ncid_file, ncid_var, "missing_value", missing_value)) {
-		if (std::find(data.begin(), data.end(), missing_value) != data.end()) {
+bool GridcellOrderedVariable::load_later_segments() const {
+	for (size_t segment = 1; segment < segments.size(); ++segment) {
+		OpenFile& file = segment_file(segment);
+		if (!read_location(file.ncid_file, file.ncid_var, segments[segment].count, file.data)) {
 			return false;
 		}
+		file.loaded = true;
 	}
+	return true;
+}
 
-	unpack_data();
-
+bool GridcellOrderedVariable::valid_in_later_segments(size_t x, size_t y) const {
+	for (size_t segment = 1; segment < segments.size(); ++segment) {
+		OpenFile& file = segment_file(segment);
+		if (!read_point(file.ncid_file, file.ncid_var, segments[segment].count, x, y, point_buffer)) {
+			return false;
+		}
+	}
 	return true;
 }
 
+const std::vector<double>& GridcellOrderedVariable::segment_data(size_t segment) const {
+	OpenFile& file = segment_file(segment);
+
+	if (!file.loaded) {
+		// The location was checked for missing values in all files when
+		// it was loaded, so they can only be found here if a file changed
+		if (!read_location(file.ncid_file, file.ncid_var, segments[segment].count, file.data)) {
+			throw CFError(variable_name, "Missing values for the current location in " +
+			              segments[segment].filename);
+		}
+		file.loaded = true;
+	}
+
+	return file.data;
+}
+
+const double* GridcellOrderedVariable::timestep_data(int timestep) const {
+	size_t segment = find_segment(timestep);
+	const std::vector<double>& values = segment == 0 ? data : segment_data(segment);
+	return &values[(timestep - segments[segment].first) * extra_dimension_size];
+}
+
+void GridcellOrderedVariable::close_segment_files() {
+	for (size_t i = 0; i < open_files.size(); ++i) {
+		nc_close(open_files[i].ncid_file);
+	}
+	open_files.clear();
+}
+
 bool GridcellOrderedVariable::is_reduced() const {
 	return reduced;
 }
 
 GridcellOrderedVariable::~GridcellOrderedVariable() {
+	close_segment_files();
 	close_ncdf(ncid_file);
 }
 
@@ -605,6 +1018,17 @@ void GridcellOrderedVariable::cache_lonlats() {
 	handle_error(status, "Failed to read values from y dimension variable");
 }
 
+bool GridcellOrderedVariable::get_grid_coordinates(std::vector<double>& lon_values,
+                                                   std::vector<double>& lat_values) const {
+	if (reduced || lons.empty() || lats.empty()) {
+		return false;
+	}
+
+	lon_values = lons;
+	lat_values = lats;
+	return true;
+}
+
 void GridcellOrderedVariable::get_index_for_coords(double lon, double lat,
                                                    size_t& x, size_t& y) {
 	// Due to varying order and precision simple "brut"-forcing of lons and
@@ -662,8 +1086,12 @@ int GridcellOrderedVariable::get_timesteps() const {
 	return (int)time.size();
 }
 
+bool GridcellOrderedVariable::is_static() const {
+	return static_data;
+}
+
 double GridcellOrderedVariable::get_value(int timestep) const {
-	return data[timestep * extra_dimension_size];
+	return *timestep_data(timestep);
 }
 
 void GridcellOrderedVariable::get_values(int timestep, std::vector<double>& values) const {
@@ -671,13 +1099,40 @@ void GridcellOrderedVariable::get_values(int timestep, std::vector<double>& valu
 		values.resize(extra_dimension_size);
 	}
 
+	const double* timestep_values = timestep_data(timestep);
+
 	for (size_t i = 0; i < extra_dimension_size; ++i) {
-		values[i] = data[timestep * extra_dimension_size + i];
+		values[i] = timestep_values[i];
 	}
 }
 
 DateTime GridcellOrderedVariable::get_date_time(int timestep) const {
-	return time_spec.get_date_time(time[timestep], calendar);
+	if (static_data) {
+		throw CFError(variable_name, "A variable without a time dimension has no dates");
+	}
+	return segments[find_segment(timestep)].time_spec.get_date_time(time[timestep], calendar);
+}
+
+int GridcellOrderedVariable::get_timesteps_per_day() const {
+
+	if (get_timesteps() < 2) {
+		return 0;
+	}
+
+	const DateTime first = get_date_time(0);
+	const DateTime second = get_date_time(1);
+
+	for (int hours = 1; hours <= 24; ++hours) {
+		if (24 % hours == 0) {
+			DateTime dt = first;
+			dt.add_time(hours, HOURS, calendar);
+			if (dt == second) {
+				return 24 / hours;
+			}
+		}
+	}
+
+	return 0;
 }
 
 bool GridcellOrderedVariable::location_exists(size_t x, size_t y) const {
@@ -847,31 +1302,79 @@ bool GridcellOrderedVariable::same_spatial_domain(const GridcellOrderedVariable&
 		same_spatial_coordinates(ncid_lon, other, other.ncid_lon);
 }
 
+bool GridcellOrderedVariable::set_location_chunk_cache(size_t max_bytes) {
+	location_chunk_cache = max_bytes;
+
+	return apply_location_chunk_cache(ncid_file, ncid_var, segments.front().count);
+}
+
+bool GridcellOrderedVariable::apply_location_chunk_cache(int ncid, int varid,
+                                                         size_t timesteps) const {
+#ifdef NC_NETCDF4
+	std::vector<int> dims;
+	get_dimensions(ncid, varid, dims);
+
+	int storage;
+	std::vector<size_t> chunks(dims.size());
+	int status = nc_inq_var_chunking(ncid, varid, &storage, &chunks.front());
+
+	// Classic format files and contiguous variables have no chunks
+	if (status != NC_NOERR || storage != NC_CHUNKED) {
+		return true;
+	}
+
+	nc_type type;
+	size_t type_size;
+	status = nc_inq_vartype(ncid, varid, &type);
+	handle_error(status, "Failed to get type of main variable: " + variable_name);
+	status = nc_inq_type(ncid, type, 0, &type_size);
+	handle_error(status, "Failed to get size of type of main variable: " + variable_name);
+
+	size_t chunk_bytes = type_size;
+	for (size_t d = 0; d < chunks.size(); ++d) {
+		chunk_bytes *= chunks[d];
+	}
+
+	const size_t time_chunk = static_data ? 1 : std::max(chunks[t_dimension_index], (size_t)1);
+	const size_t nchunks = (timesteps + time_chunk - 1) / time_chunk;
+
+	if (nchunks * chunk_bytes > location_chunk_cache) {
+		return false;
+	}
+
+	// The cache hash table should have more slots than chunks
+	status = nc_set_var_chunk_cache(ncid, varid, nchunks * chunk_bytes, 4 * nchunks + 1, 0.75);
+	handle_error(status, "Failed to set chunk cache for variable: " + variable_name);
+#endif
+	return true;
+}
+
 #ifdef NC_STRING
 void GridcellOrderedVariable::
 get_extra_dimension(std::vector<std::string>& coordinate_values) const {
 }
 #endif
 
-void GridcellOrderedVariable::unpack_data() {
+void GridcellOrderedVariable::unpack_data(int ncid, int varid,
+                                          std::vector<double>& buffer) const {
 
 	// First, multiply all data by scale_factor (if present)
 
 	double factor;
-	if (get_attribute(ncid_file, ncid_var, "scale_factor", factor)) {
+	if (get_attribute(ncid, varid, "scale_factor", factor)) {
 
-		for (size_t i = 0; i < data.size(); ++i) {
-			data[i] *= factor;
+		for (size_t i = 0; i < buffer.size(); ++i) {
+			buffer[i] *= factor;
 		}
 	}
 
 	// Then add add_offset (if present)
 
 	double offset;
-	if (get_attribute(ncid_file, ncid_var, "add_offset", offset)) {
+	if (get_attribute(ncid, varid, "add_offset", offset)) {
 
-		for (size_t i = 0; i < data.size(); ++i) {
-			data[i] += offset;
+		for (size_t i = 0; i < buffer.size(); ++i) {
+			buffer[i] += offset;
 		}
 	}
 }
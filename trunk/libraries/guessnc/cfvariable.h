@@ -6,6 +6,7 @@
 #include <vector>
 #include <string>
 #include "cftime.h"
+#include "cfremap.h"
 
 namespace GuessNC {
 
@@ -16,6 +17,16 @@ namespace CF {
 /** Expected to be used for dealing with one gridcell at a time, so the NetCDF
  *  file should also be stored in that order to get acceptable performance.
  *
+ *  The variable may also be split over several files along the time axis,
+ *  as is common for ISIMIP or CMIP datasets with one file per decade. The
+ *  files are then ordered by their first time step and presented as one
+ *  variable with a merged time index. The first file is always kept open
+ *  (it is used for all metadata), the others are opened when a location is
+ *  loaded, to check them for missing values, and when a time step within
+ *  them is requested. At most max_open_files of those are open at a time,
+ *  each with the data for the current location, and the least recently used
+ *  one is closed when another is needed.
+ *
  *  Limitations on top of CF:
  *
  *   * Main variable and time coordinate must be numeric NetCDF classic data types.
@@ -23,21 +34,41 @@ namespace CF {
  *   * Time and 2D space dimensions are understood by the class. The main variable
  *     may also have an additional extra dimension (for instance for height), which
  *     this class simply treats as 'the extra dimension' if available.
+ *
+ *   * In a split variable, all files must have the same dimensions apart from
+ *     the length of the time dimension, the same calendar, and cover periods
+ *     which don't overlap.
+ *
+ *   * A variable without a time dimension (static data, one value per
+ *     location) is only accepted if asked for, see the constructor. It
+ *     then has a single timestep without a date, and can't be split.
  */
 class GridcellOrderedVariable {
 public:
 
 	/// Constructor
-	/** \param filename The NetCDF file to open
-	 *  \param variable The name of the variable to read from
+	/** \param filename       The NetCDF file to open, or a file set (a list of
+	 *                        files and/or glob patterns), see expand_file_set
+	 *  \param variable       The name of the variable to read from
+	 *  \param max_open_files Maximum number of files of a file set to keep
+	 *                        open in addition to the first one
+	 *  \param allow_static   Whether to accept a variable without a time
+	 *                        dimension, \see is_static
 	 */
-	GridcellOrderedVariable(const char* filename, const char* variable);
+	GridcellOrderedVariable(const char* filename, const char* variable,
+	                        size_t max_open_files = 2,
+	                        bool allow_static = false);
 
 	/// Destructor, releases resources
 	~GridcellOrderedVariable();
 
 	/// Loads data for all timesteps for a given location
 	/**
+	 *  For a variable split over several files, all files are checked for
+	 *  missing values here, so a location either has data for the whole
+	 *  period or isn't loaded. The data of the files closed again (see
+	 *  max_open_files) is read again when needed.
+	 *
 	 *  This version of the function is to be used for datasets where
 	 *  locations are identified with an x- and a y-coordinate.
 	 *
@@ -63,6 +94,21 @@ public:
 	 */
 	bool load_data_for(size_t landid);
 
+	/// Loads data for all timesteps as a weighted mean of several locations
+	/**
+	 *  This version of the function is used for remapping to a location
+	 *  which isn't on the grid, with weights from a GridRemapper. Only
+	 *  for datasets where locations are identified with (x,y)-pairs.
+	 *
+	 *  Source locations with missing values in any file of a file set are
+	 *  left out and the weights of the others scaled up.
+	 *
+	 *  \param weights Locations and their weights, summing to 1
+	 *  
+eturns whether any of the locations exist and have only valid values.
+	 */
+	bool load_data_for(const std::vector<RemapWeight>& weights);
+
 	/// Are locations identified with one or two indices?
 	/** In a variable with a reduced horizontal grid, the locations are
 	 *  identified with a simple land id. Otherwise an (x,y)-pair is used.
@@ -80,9 +126,24 @@ public:
 	/// Retrieves actual (lon,lat)-coordinates for a given location
 	void get_coords_for(size_t landid, double& lon, double& lat) const;
 
+	/// Gets the coordinate values of a rectilinear grid
+	/** 
+eturns false if the longitudes and latitudes aren't one
+	 *           dimensional coordinate variables (e.g. a reduced grid)
+	 */
+	bool get_grid_coordinates(std::vector<double>& lon_values,
+	                          std::vector<double>& lat_values) const;
+
 	/// Gets the number of timesteps for the variable
+	/** 1 for a static variable. */
 	int get_timesteps() const;
 
+	/// Is this a variable without a time dimension?
+	/** A static variable has one value per location, read with
+	 *  get_value(0). It has no dates, get_date_time throws.
+	 */
+	bool is_static() const;
+
 	/// Gets variable's value for currently loaded location in a certain timestep
 	/** Use this function to retrieve values in a 3 dimensional data set,
 	 *  where each (lat,lon,time) triple corresponds to a single scalar value.
@@ -105,6 +166,16 @@ public:
 	/// Gets a DateTime corresponding to a timestep
 	DateTime get_date_time(int timestep) const;
 
+	/// Gets the number of timesteps per day
+	/** Found from the first two timesteps, which for sub-daily data must be
+	 *  a whole number of hours apart, dividing the day evenly (e.g. 1-, 3-
+	 *  or 6-hourly data).
+	 *
+	 *  \returns 1 for daily data, more for sub-daily data and 0 if the
+	 *           timesteps are longer than a day (e.g. monthly data)
+	 */
+	int get_timesteps_per_day() const;
+
 	/// Checks if data exists for a given location
 	bool location_exists(size_t x, size_t y) const;
 
@@ -146,16 +217,132 @@ public:
 	/// Checks if another GridcellOrderedVariable has the same spatial domain as this one
 	bool same_spatial_domain(const GridcellOrderedVariable& other) const;
 
+	/// Sizes the NetCDF chunk cache for reading one location at a time
+	/** For a chunked (NetCDF-4) variable, load_data_for() touches every chunk
+	 *  along the time axis at the location. If those chunks fit within
+	 *  max_bytes, the chunk cache is made large enough to hold them all, so
+	 *  that the next locations within the same chunks are read without
+	 *  reading and decompressing the chunks again.
+	 *
+	 *  \returns false if the variable is chunked and the chunks along the
+	 *           time axis don't fit within max_bytes
+	 */
+	bool set_location_chunk_cache(size_t max_bytes);
+
 private:
 
+	/// A file holding a consecutive part of the time series
+	struct TimeSegment {
+		/// Name of the file
+		std::string filename;
+
+		/// Index of the segment's first timestep in the merged time index
+		size_t first;
+
+		/// Number of timesteps in the file
+		size_t count;
+
+		/// Reference time specification for the file's time offsets
+		TimeUnitSpecification time_spec;
+	};
+
+	/// A file of a file set which is currently open
+	struct OpenFile {
+		/// Index of the file in segments
+		size_t segment;
+
+		/// NC handles to the file and the main variable
+		int ncid_file;
+		int ncid_var;
+
+		/// Whether data holds the values for the current location
+		bool loaded;
+
+		/// The values for the current location in this file
+		std::vector<double> data;
+
+		/// When the file was last used, for choosing which file to close
+		unsigned long last_used;
+	};
+
+	/** Called by constructor to open the first file in time and find out
+	 *  everything about the variable there.
+	 */
+	void open_primary(const std::string& filename, const std::string& variable,
+	                  bool allow_static);
+
+	/** Called by constructor if there is more than one file, reads the time
+	 *  axes of the other files and merges them into one time index.
+	 */
+	void add_time_segments(const std::vector<std::string>& files,
+	                       const std::string& variable);
+
+	/** Checks that a file in a file set has the same layout as the primary
+	 *  file and reads its time axis.
+	 */
+	void read_segment_time(int ncid, const std::string& variable,
+	                       TimeSegment& segment, std::vector<double>& times) const;
+
+	/// Reads time offsets, time unit and calendar of a time coordinate variable
+	void read_time_coordinate(int ncid, int ncid_dim, int ncid_timecoord,
+	                          std::vector<double>& times,
+	                          TimeUnitSpecification& spec,
+	                          CalendarType& cal) const;
+
+	/// Reads the values for the current location from one file
+	/** For a remapped location this is the weighted mean of current_weights.
+	 *  \returns false if there were missing values
+	 */
+	bool read_location(int ncid, int varid, size_t timesteps,
+	                   std::vector<double>& buffer) const;
+
+	/// Reads the values for one location in the file's own grid
+	/** x is the land id in a reduced grid, y is then ignored.
+	 *  \returns false if there were missing values
+	 */
+	bool read_point(int ncid, int varid, size_t timesteps,
+	                size_t x, size_t y, std::vector<double>& buffer) const;
+
+	/// Finds the segment containing a timestep in the merged time index
+	size_t find_segment(int timestep) const;
+
+	/// Gets an open file of a file set, opening it if needed
+	/** Closes the least recently used file if max_open_files are open. */
+	OpenFile& segment_file(size_t segment) const;
+
+	/// Reads the values for the current location from the files after the first
+	/** Called when a location is loaded, so that missing values are found
+	 *  then rather than in the middle of the simulation. The values stay
+	 *  loaded in the files which are still open afterwards.
+	 *  \returns false if there were missing values in any of the files
+	 */
+	bool load_later_segments() const;
+
+	/// Checks a location in the files after the first for missing values
+	bool valid_in_later_segments(size_t x, size_t y) const;
+
+	/// Gets the values for the current location in a segment other than the first
+	/** Opens the file if needed, closing the least recently used one. */
+	const std::vector<double>& segment_data(size_t segment) const;
+
+	/// Gets a pointer to the values of a timestep for the current location
+	const double* timestep_data(int timestep) const;
+
+	/// Closes all files of a file set except the first one
+	void close_segment_files();
+
+	/// Sizes the chunk cache of a variable, see set_location_chunk_cache
+	bool apply_location_chunk_cache(int ncid, int varid, size_t timesteps) const;
+
 	void cache_lonlats();
 	
 	/** Called by constructor to figure out all we need to know about
 	 *  the time dimension and how to interpret time.
 	 *
-	 *  Assumes ncid_file and ncid_var already set.
+	 *  Assumes ncid_file and ncid_var already set. If allow_static is
+	 *  set and there is no time dimension, the variable is static.
 	 */
-	void find_time_dimension();
+	void find_time_dimension(bool allow_static);
 
 	/** Called by constructor to figure out all we need to know about
 	 *  the spatial dimensions.
@@ -174,7 +361,7 @@ private:
 	/** Unpacks the raw data according to scale_factor and add_offset
 	 *  arguments, if present.
 	 */
-	void unpack_data();
+	void unpack_data(int ncid, int varid, std::vector<double>& buffer) const;
 
 	/// Help function for same_spatial_domain, compares either the lat coordinate variable or lon
 	bool same_spatial_coordinates(int ncid_my_coordvar,
@@ -190,26 +377,58 @@ private:
 	/// Name of main variable (for error messages)
 	std::string variable_name;
 
-	/// Data for all timesteps for current location
+	/// Data for all timesteps in the first file for current location
 	std::vector<double> data;
 
 	/// Time offsets for all timesteps
-	/** The times are relative to a starting time given in time_spec.
-	 *  This follows how times are represented in CF, see CF spec
-	 *  for overview.
+	/** The times are relative to a starting time given in the time_spec
+	 *  of the segment the timestep belongs to. This follows how times
+	 *  are represented in CF, see CF spec for overview.
 	 */
 	std::vector<double> time;
 	std::vector<double> lons, lats;
 
-	/// Reference time specification
-	/** Defines how the time offsets in the time vector are to be
-	 *  interpreted, \see TimeUnitSpecification for more information.
+	/// The files making up the variable, in time order
+	/** The first segment is the file opened as ncid_file. Defines how the
+	 *  time offsets in the time vector are to be interpreted, \see
+	 *  TimeUnitSpecification for more information.
 	 */
-	TimeUnitSpecification time_spec;
+	std::vector<TimeSegment> segments;
+
+	/// Files other than the first one which are currently open
+	mutable std::vector<OpenFile> open_files;
+
+	/// Maximum size of open_files
+	size_t max_open_files;
+
+	/// Chunk cache limit set with set_location_chunk_cache, 0 if not set
+	size_t location_chunk_cache;
+
+	/// Segment of the most recently requested timestep
+	mutable size_t current_segment;
+
+	/// Counter for the least recently used bookkeeping of open_files
+	mutable unsigned long use_counter;
+
+	// The currently loaded location
+
+	size_t current_x;
+	size_t current_y;
+	size_t current_landid;
+
+	/// Locations and weights of the currently loaded location if remapped
+	/** Empty if the location was loaded without remapping */
+	std::vector<RemapWeight> current_weights;
+
+	/// Scratch space for reading the locations of a remapped location
+	mutable std::vector<double> point_buffer;
 
 	/// The calendar used by the variable
 	CalendarType calendar;
 
+	/// Whether the variable has no time dimension
+	bool static_data;
+
 	// The order of the dimensions in the main variable
 
 	size_t t_dimension_index;
@@ -2,6 +2,13 @@
 
 #include "guessnc.h"
 #include <netcdf.h>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#ifndef _WIN32
+#include <glob.h>
+#endif
 
 namespace GuessNC {
 
@@ -110,6 +117,86 @@ std::string get_variable_name(int ncid_file, int ncid_var) {
 	return name;
 }
 
+std::vector<std::string> get_data_variables(int ncid_file) {
+	int nvars;
+	int status = nc_inq_nvars(ncid_file, &nvars);
+	handle_error(status, "Failed to get number of variables");
+
+	std::vector<std::string> names;
+
+	for (int v = 0; v < nvars; ++v) {
+		std::string name = get_variable_name(ncid_file, v);
+
+		// A coordinate variable has a single dimension with the same name
+		int ndims;
+		status = nc_inq_varndims(ncid_file, v, &ndims);
+		handle_error(status, "Failed to get number of dimensions of variable " + name);
+
+		if (ndims == 1) {
+			int dim;
+			status = nc_inq_vardimid(ncid_file, v, &dim);
+			handle_error(status, "Failed to get dimensions for variable " + name);
+
+			char dimname[NC_MAX_NAME+1];
+			status = nc_inq_dimname(ncid_file, dim, dimname);
+			handle_error(status, "Failed to get name of a dimension");
+
+			if (name == dimname) {
+				continue;
+			}
+		}
+
+		names.push_back(name);
+	}
+
+	return names;
+}
+
+std::vector<std::string> expand_file_set(const std::string& specification) {
+	std::vector<std::string> files;
+
+	// The name of an existing file is used as it is, even if it
+	// happens to contain white space or glob characters
+	std::ifstream in(specification.c_str());
+	if (in.good()) {
+		files.push_back(specification);
+		return files;
+	}
+
+	std::istringstream is(specification);
+	std::string item;
+
+	while (is >> item) {
+#ifndef _WIN32
+		if (item.find_first_of("*?[") != std::string::npos) {
+			glob_t matches;
+			int status = glob(item.c_str(), 0, 0, &matches);
+			if (status != 0) {
+				globfree(&matches);
+				throw GuessNCError("No files match " + item);
+			}
+			for (size_t i = 0; i < matches.gl_pathc; ++i) {
+				if (std::find(files.begin(), files.end(), matches.gl_pathv[i]) == files.end()) {
+					files.push_back(matches.gl_pathv[i]);
+				}
+			}
+			globfree(&matches);
+			continue;
+		}
+#endif
+		if (std::find(files.begin(), files.end(), item) == files.end()) {
+			files.push_back(item);
+		}
+	}
+
+	// Let the caller report a missing file by trying to open it
+	if (files.empty()) {
+		files.push_back(specification);
+	}
+
+	return files;
+}
+
 } // namespace GuessNC 
 
 #endif // HAVE_NETCDF
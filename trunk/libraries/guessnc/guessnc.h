@@ -8,6 +8,7 @@
 
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 namespace GuessNC {
 
@@ -52,6 +53,19 @@ bool get_coordinate_variable(int ncid_file, int ncid_dim, int& ncid_coord_var);
 /// Gets the name of a variable with a given id
 std::string get_variable_name(int ncid_file, int ncid_var);
 
+/// Gets the names of all variables in a file which aren't coordinate variables
+std::vector<std::string> get_data_variables(int ncid_file);
+
+/// Expands a file set specification to a list of file names
+/** The specification is either the name of an existing file, or a white
+ *  space separated list of file names and glob patterns, for instance
+ *  "tas_1901_1910.nc tas_1911_1920.nc" or "tas_*.nc". Matches for a
+ *  pattern are sorted by name, duplicates are removed.
+ *
+ *  Throws GuessNCError if a pattern doesn't match any file.
+ */
+std::vector<std::string> expand_file_set(const std::string& specification);
+
 }
 
 #endif // HAVE_NETCDF
@@ -996,3 +996,136 @@ void plibhelp() {
 
 	ishelp=false;
 }
+
+bool plibflatten(xtring filename, std::string& script) {
+
+	RecursiveFileReader in;
+	if (!in.addfile(filename)) {
+		return false;
+	}
+
+	script.clear();
+	std::string line;
+	bool more = true;
+
+	while (more) {
+
+		// Read the next line, an imported file may end without a newline
+		line.clear();
+		int depth = in.depth();
+		int ch;
+		while ((ch = in.Fgetc()) != EOF) {
+			if (ch == '\n') {
+				break;
+			}
+			if (in.depth() < depth && !line.empty()) {
+				script += line + "\n";
+				line.clear();
+			}
+			depth = in.depth();
+			line += (char)ch;
+		}
+		more = ch != EOF;
+
+		// Is it an import statement?
+		size_t start = line.find_first_not_of(" \t\r");
+		if (start != std::string::npos && line.compare(start, 6, "import") == 0) {
+			size_t open = line.find_first_not_of(" \t", start + 6);
+			if (open != std::string::npos && open > start + 6 &&
+			    (line[open] == '"' || line[open] == '\'')) {
+				size_t close = line.find(line[open], open + 1);
+				if (close != std::string::npos) {
+					script += "!" + line + "\n";
+					if (!in.addfile(line.substr(open + 1, close - open - 1).c_str())) {
+						return false;
+					}
+					more = true;
+					continue;
+				}
+			}
+		}
+
+		if (more || !line.empty()) {
+			script += line + "\n";
+		}
+	}
+
+	return true;
+}
+
+std::string plibdump(int id, xtring setname, const std::vector<const void*>& skip) {
+
+	Pliblist pliblist;
+	Pliblist* plist = pthislist;
+	pthislist = &pliblist;
+	pliblist.callback = 0;
+	plib_declarations(id, setname);
+	pthislist = plist;
+
+	// Items are kept in reverse order of declaration
+	std::vector<Plibitem*> items;
+	Plibitem* pitem = pliblist.getfirstitem();
+	while (pitem) {
+		items.push_back(pitem);
+		pitem = pliblist.getnextitem();
+	}
+
+	std::string result;
+	xtring value;
+
+	for (int i = (int)items.size() - 1; i >= 0; i--) {
+
+		pitem = items[i];
+
+		bool skipped = pitem->type == PLIB_SET;
+		for (size_t s = 0; s < skip.size(); s++) {
+			if (pitem->param == skip[s]) {
+				skipped = true;
+			}
+		}
+		if (skipped) {
+			continue;
+		}
+
+		std::string line((char*)pitem->identifier);
+
+		switch (pitem->type) {
+		case PLIB_XTRING:
+			line += (std::string)" \"" + (char*)*(xtring*)pitem->param + "\"";
+			break;
+		case PLIB_STDSTRING:
+			line += " \"" + *(std::string*)pitem->param + "\"";
+			break;
+		case PLIB_INT:
+			for (int p = 0; p < pitem->nparam; p++) {
+				value.printf(" %d", ((int*)pitem->param)[p]);
+				line += (char*)value;
+			}
+			break;
+		case PLIB_DOUBLE:
+			for (int p = 0; p < pitem->nparam; p++) {
+				value.printf(" %.17g", ((double*)pitem->param)[p]);
+				line += (char*)value;
+			}
+			break;
+		case PLIB_BOOLEAN:
+			for (int p = 0; p < pitem->nparam; p++) {
+				line += ((bool*)pitem->param)[p] ? " 1" : " 0";
+			}
+			break;
+		case PLIB_FLAG:
+			if (!*(bool*)pitem->param) {
+				continue;
+			}
+			break;
+		default:
+			break;
+		}
+
+		result += line + "\n";
+	}
+
+	killpliblist(&pliblist);
+
+	return result;
+}
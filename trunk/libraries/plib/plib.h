@@ -109,6 +109,7 @@
 
 #include <gutil.h>
 #include <string>
+#include <vector>
 
 // PLIB LIBRARY FUNCTIONS
 
@@ -254,6 +255,24 @@ void plibhelp();
  */
 void plibabort();
 
+/// Reads a script with imported scripts in place of the import statements
+/** Gives the script as a single file, e.g. to keep a copy of the settings
+ *  of a run. Imported scripts are found relative to the importing script, as
+ *  when the script is processed. Import statements must be on lines of their
+ *  own (optionally followed by a comment), they are kept as comments.
+ *
+ *  \returns false if the script or an imported script can't be read
+ */
+bool plibflatten(xtring filename, std::string& script);
+
+/// Writes the current values of the items declared for a set
+/** Calls plib_declarations for the set, as when the set is processed, and
+ *  writes one line per item in script syntax with the value now held by the
+ *  item's parameter. Sets are left out, as are items whose parameters are in
+ *  'skip' (typically variables only used for callbacks).
+ */
+std::string plibdump(int id, xtring setname, const std::vector<const void*>& skip);
+
 
 
 
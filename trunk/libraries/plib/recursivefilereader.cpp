@@ -190,6 +190,10 @@ int RecursiveFileReader::currentlineno() const {
 	return files.top().lineno;
 }
 
+int RecursiveFileReader::depth() const {
+	return (int)files.size();
+}
+
 void RecursiveFileReader::closeandpop() {
 	fclose(currentstream());
 	files.pop();
@@ -80,6 +80,9 @@ public:
 	/// The line number we're at in the current file.
 	int currentlineno() const;
 
+	/// The number of open files, the current file and the files including it
+	int depth() const;
+
 private:
 	/// Closes the current file and pops it from the stack
 	void closeandpop();
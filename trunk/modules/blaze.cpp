@@ -508,8 +508,11 @@ bool blaze(Patch& patch, Climate& climate) {
 	// Correction fractions burned earlier in the same year (vegmode = POPULATION only)
 	double accumulated_fraction_burned= 1.  / (1. - gridcell.annual_burned_area / flammable_area);
 
+	// Random numbers for this patch and day
+	RandomStream random(patch, RANDOM_BLAZE);
+
 	// Check whether it burns
-	if (!( randfrac(patch.stand.seed) <= area_burned || vegmode == POPULATION)) {
+	if (!( randfrac(random) <= area_burned || vegmode == POPULATION)) {
 		return false;
 	}
 	
@@ -644,7 +647,7 @@ bool blaze(Patch& patch, Climate& climate) {
 					int nindiv=(int)(indiv.densindiv*patcharea+0.5);
 					int nindiv_prev=nindiv;
 					for (int i=0;i<nindiv_prev;i++) {
-						if (randfrac(patch.stand.seed) > survival_probability(patch, indiv)) {
+						if (randfrac(random) > survival_probability(patch, indiv)) {
 							nindiv--;
 						}
 					}
@@ -765,6 +768,8 @@ bool blaze(Patch& patch, Climate& climate) {
  */
 void Individual::blaze_reduce_biomass(Patch& patch, double frac_survive) {
 
+	invalidate_day_cache();
+
 	// When a fire doesn't provide enough heat to burn a tree
 	// and it still stochastically dies, use these flux parameters
 	double const DEFAULT_WOOD_TO_ATM = 0.10;
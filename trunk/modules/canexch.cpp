@@ -37,6 +37,7 @@
 #include "bvoc.h"
 #include "ncompete.h"
 #include "somdynam.h"
+#include "solverstats.h"
 #include <assert.h>
 
 
@@ -534,6 +535,10 @@ void vmax(double b, double c1, double c2, double apar, double tscal,
 	}
 }
 
+bool no_photosynthesis(const Pft& pft, double temp, double daylength) {
+	return negligible(daylength) || temp > pft.pstemp_max || temp < pft.pstemp_min;
+}
+
 /// Total daily gross photosynthesis
 /** Calculation of total daily gross photosynthesis and leaf-level net daytime
  *  photosynthesis given degree of stomatal closure (as parameter lambda).
@@ -628,7 +633,7 @@ void photosynthesis(const PhotosynthesisEnvironment& ps_env,
 	bool ifnlimvmax = ps_stresses.get_ifnlimvmax();
 
 	// No photosynthesis during polar night, outside of temperature range or no RuBisCO activity
-	if (negligible(daylength) || negligible(fpar) || temp > pft.pstemp_max || temp < pft.pstemp_min || !vm) {
+	if (no_photosynthesis(pft, temp, daylength) || negligible(fpar) || !vm) {
 		ps_result.clear();
 		return;
 	}
@@ -835,43 +840,97 @@ double get_moss_wtp_limit(Patch& p, Pft& pft) {
 }
 
 
-/// Pre-calculate Vmax and no-stress assimilation and canopy conductance
-/**
- * Vmax is calculated on a daily scale (w/ daily averages of temperature and par)
- * Subdaily values calculated if needed
- */
-void photosynthesis_nostress(Patch& patch, Climate& climate) {
+bool dormant_day(Patch& patch, const Climate& climate) {
 
-	PhotosynthesisEnvironment ps_env;					
-	PhotosynthesisStresses ps_stress;
-	ps_stress.no_stress();
+	if (!ifdormantfastpath) {
+		return false;
+	}
 
-	// If this is the first patch, calculate no-stress assimilation for
-	// each Standpft, assuming FPAR=1. This is then later used in
-	// forest_floor_conditions.
+	// In diurnal mode the sub-daily no-stress photosynthesis reuses the daily
+	// Vmax, which is zero if the daily call gives nothing. Canopy conductance
+	// assuming full leaf cover is calculated with the sub-daily temperatures
+	// however, so those must be outside the range too.
+	for (int p=0; p<npft; p++) {
+		Standpft& spft = patch.stand.pft[p];
+		if (spft.active && !no_photosynthesis(spft.pft, climate.temp, climate.daylength)) {
+			return false;
+		}
+	}
 
-	double pftco2 = climate.co2; // will override for peat mosses
+	bool dormant = true;
 
-	if (!patch.id) {
+	Vegetation& vegetation = patch.vegetation;
+	vegetation.firstobj();
+	while (vegetation.isobj && dormant) {
+		const Pft& pft = vegetation.getobj().pft;
 
-		for (int p=0; p<npft; p++) {
-			Standpft& spft = patch.stand.pft[p];
-			Patchpft& ppft = patch.pft[p];
+		dormant = no_photosynthesis(pft, climate.temp, climate.daylength);
 
-			if (spft.active) {
+		if (date.diurnal()) {
+			for (int i=0; i<date.subdaily && dormant; i++) {
+				dormant = no_photosynthesis(pft, climate.temps[i], 24);
+			}
+		}
 
-				pftco2 = get_co2(patch, climate, spft.pft);
-				ps_env.set(pftco2, climate.temp, climate.par, 1.0, climate.daylength);
+		vegetation.nextobj();
+	}
 
-				ps_stress.set(false, get_moss_wtp_limit(patch, spft.pft), get_graminoid_wtp_limit(patch, spft.pft), get_inund_stress(patch, ppft));
+	return dormant;
+}
 
-				// Call photosynthesis assuming stomates fully open (lambda = lambda_max)
-				photosynthesis(ps_env, ps_stress, spft.pft, 
-							   spft.pft.lambda_max, 1.0, -1, 
-							   spft.photosynthesis);
-			}
+void forest_floor_photosynthesis(Stand& stand, Climate& climate) {
+
+	if (!stand.npatch()) {
+		return;
+	}
+
+	PhotosynthesisEnvironment ps_env;
+	PhotosynthesisStresses ps_stress;
+	ps_stress.no_stress();
+
+	// The stresses on peatlands are taken from the first patch, as they
+	// were at the end of yesterday
+	Patch& patch = stand[0];
+
+	for (int p=0; p<npft; p++) {
+		Standpft& spft = stand.pft[p];
+		Patchpft& ppft = patch.pft[p];
+
+		if (!spft.active) {
+			continue;
 		}
+
+		if (ifdormantfastpath && no_photosynthesis(spft.pft, climate.temp, climate.daylength)) {
+			spft.photosynthesis.clear();
+			continue;
+		}
+
+		double pftco2 = get_co2(patch, climate, spft.pft);
+		ps_env.set(pftco2, climate.temp, climate.par, 1.0, climate.daylength);
+
+		ps_stress.set(false, get_moss_wtp_limit(patch, spft.pft), get_graminoid_wtp_limit(patch, spft.pft), get_inund_stress(patch, ppft));
+
+		// Call photosynthesis assuming stomates fully open (lambda = lambda_max)
+		photosynthesis(ps_env, ps_stress, spft.pft,
+		               spft.pft.lambda_max, 1.0, -1,
+		               spft.photosynthesis);
 	}
+}
+
+/// Pre-calculate Vmax and no-stress assimilation and canopy conductance
+/**
+ * Vmax is calculated on a daily scale (w/ daily averages of temperature and par)
+ * Subdaily values calculated if needed
+ *
+ * On dormant days (\see dormant_day) all results are cleared directly.
+ */
+void photosynthesis_nostress(Patch& patch, Climate& climate, bool dormant) {
+
+	PhotosynthesisEnvironment ps_env;					
+	PhotosynthesisStresses ps_stress;
+	ps_stress.no_stress();
+
+	double pftco2 = climate.co2; // will override for peat mosses
 
 	// Pre-calculation of no-stress assimilation for each individual
 	Vegetation& vegetation = patch.vegetation;
@@ -882,6 +941,17 @@ void photosynthesis_nostress(Patch& patch, Climate& climate) {
 		Pft& pft = indiv.pft;
 		Patchpft& ppft = patch.pft[indiv.pft.id];
 
+		if (dormant) {
+			indiv.photosynthesis.clear();
+			indiv.gpterm = 0.0;
+			if (date.diurnal()) {
+				indiv.gpterms.assign(date.subdaily, 0);
+				indiv.phots.assign(date.subdaily, PhotosynthesisResult());
+			}
+			vegetation.nextobj();
+			continue;
+		}
+
 		pftco2 = get_co2(patch, climate, pft);
 		ps_env.set(pftco2, climate.temp, climate.par, indiv.fpar, climate.daylength);
 
@@ -1188,7 +1258,7 @@ void ndemand(Patch& patch, Vegetation& vegetation) {
 /** If nitrogen supply is not able to meet demand it will lead
  *  to down-regulation of vmax resulting in lower photosynthesis
  */
-void vmax_nitrogen_stress(Patch& patch, Climate& climate, Vegetation& vegetation) {
+void vmax_nitrogen_stress(Patch& patch, Climate& climate, Vegetation& vegetation, bool dormant) {
 
 	// Supply function for nitrogen and determination of nitrogen stress leading
 	// to down-regulation of vmax.
@@ -1232,7 +1302,8 @@ void vmax_nitrogen_stress(Patch& patch, Climate& climate, Vegetation& vegetation
 		}
 
 		// Individuals photosynthesis is nitrogen stressed
-		if (indiv.nstress) {
+		// (on dormant days it stays zero, as from photosynthesis_nostress)
+		if (indiv.nstress && !dormant) {
 
 			double pftco2 = get_co2(patch, climate, pft);
 			PhotosynthesisEnvironment ps_env;
@@ -1288,7 +1359,7 @@ void vmax_nitrogen_stress(Patch& patch, Climate& climate, Vegetation& vegetation
  *      AET_MONTEITH_HYPERBOLIC and AET_MONTEITH_EXPONENTIAL
  *  \see canexch.h
  */
-void wdemand(Patch& patch, Climate& climate, Vegetation& vegetation, const Day& day) {
+void wdemand(Patch& patch, Climate& climate, Vegetation& vegetation, const Day& day, bool dormant) {
 
 	// Determination of transpirative demand based on a Monteith parameterisation of
 	// boundary layer dynamics, i.e. demand = f(EET, conductance)
@@ -1314,7 +1385,13 @@ void wdemand(Patch& patch, Climate& climate, Vegetation& vegetation, const Day&
 		// Call photosynthesis for individual assuming stomates fully open
 		// (lambda = lambda_max)
 
-		if (indiv.growingseason()) {
+		if (indiv.growingseason() && dormant) {
+
+			// No photosynthesis, only the conductance not linked to it
+			gp_patch += pft.gmin * indiv.fpc_today();
+			gp_leafon_patch += pft.gmin * indiv.fpc;
+		}
+		else if (indiv.growingseason()) {
 
 			PhotosynthesisResult leafon_photosynthesis;
 
@@ -2196,6 +2273,8 @@ void assimilation_wstress(const Pft& pft, double co2, double temp, double par,
 		}
 	}
 
+	SOLVER_RECORD(SOLVER_ASSIMILATION, b, b > MAXTRIES, fabs(fmid) <= EPS);
+
 	// bvoc
 	lambda=xmid;
 }
@@ -2352,7 +2431,7 @@ void respiration(double gtemp_air, double gtemp_soil, lifeformtype lifeform,
 /// Net Primary Productivity
 /** Includes BVOC calculations \see bvoc.cpp
  */
-void npp(Patch& patch, Climate& climate, Vegetation& vegetation, const Day& day) {
+void npp(Patch& patch, Climate& climate, Vegetation& vegetation, const Day& day, bool dormant) {
 
 	// Determination of daily NPP. Leaf level net assimilation calculated for non-
 	// water-stressed individuals (i.e. with fully-open stomata) using base value
@@ -2405,7 +2484,8 @@ void npp(Patch& patch, Climate& climate, Vegetation& vegetation, const Day& day)
 
 		PhotosynthesisResult phot = date.diurnal() ? indiv.phots[day.period] : indiv.photosynthesis;
 
-		if (indiv.wstress) {
+		// Assimilation stays zero on dormant days
+		if (indiv.wstress && !dormant) {
 
 			// Water stress - derive assimilation by simultaneous solution
 			// of light- and conductance-based equations of photosynthesis
@@ -2519,7 +2599,7 @@ void leaf_senescence(Vegetation& vegetation) {
  *  Calculates net assimilation at top of grass canopy (or at soil surface if
  *  there is none).
  */
-void forest_floor_conditions(Patch& patch) {
+void forest_floor_conditions(Patch& patch, bool dormant) {
 
 	const Climate& climate = patch.get_climate();
 	double lambda;			// not used here
@@ -2547,7 +2627,10 @@ void forest_floor_conditions(Patch& patch) {
 		if (patch.stand.landcover != CROPLAND || pft.phenology != CROPGREEN && ppft.cropphen->growingseason) {
 			double assim = 0;
 
-			if (ppft.wstress_day) {
+			if (dormant) {
+				assim = 0.0;
+			}
+			else if (ppft.wstress_day) {
 
 				//PhotosynthesisStresses ps_stress;
 				//ps_stress.set(false, get_moss_wtp_limit(patch, pft), get_graminoid_wtp_limit(patch, pft), get_inund_stress(patch, ppft));
@@ -2639,6 +2722,11 @@ void canopy_exchange(Patch& patch, Climate& climate) {
 	// Retrieve Vegetation and Climate objects for this patch
 	Vegetation& vegetation = patch.vegetation;
 
+	// On dormant days (polar night, or too cold or hot for every PFT) the
+	// photosynthesis calculations are skipped since they would all return zero.
+	// Everything else, including respiration and water uptake, still runs.
+	bool dormant = dormant_day(patch, climate);
+
 	// Initial no-stress canopy exchange processes
 	init_canexch(patch, climate, vegetation);
 
@@ -2646,26 +2734,26 @@ void canopy_exchange(Patch& patch, Climate& climate) {
 	fpar(patch);
 
 	// Calculates no-stress daily values of photosynthesis and gpterm
-	photosynthesis_nostress(patch, climate);
+	photosynthesis_nostress(patch, climate, dormant);
 
 	// Nitrogen demand
 	ndemand(patch, vegetation);
 
 	// Nitrogen stress
-	vmax_nitrogen_stress(patch, climate, vegetation);
+	vmax_nitrogen_stress(patch, climate, vegetation, dormant);
 
 	// Only these processes are affected in diurnal mode
 	for (Day day; day.period != date.subdaily; day.next()) {
 
-		wdemand(patch, climate, vegetation, day);
+		wdemand(patch, climate, vegetation, day, dormant);
 		aet_water_stress(patch, vegetation, day);
 		water_scalar(patch, vegetation, day);
-		npp(patch, climate, vegetation, day);
+		npp(patch, climate, vegetation, day, dormant);
 	}
 	leaf_senescence(vegetation);
 
 	// Forest-floor conditions
-	forest_floor_conditions(patch);
+	forest_floor_conditions(patch, dormant);
 
 	// Total potential evapotranspiration for patch (mm, patch basis)
 	// is a sum of: (1) potential transpirative demand of the vegetation;
@@ -29,6 +29,26 @@ void photosynthesis(const PhotosynthesisEnvironment& ps_env,
 					double vm,
 					PhotosynthesisResult& result);
 
+/// Whether photosynthesis is zero for a PFT regardless of light, nitrogen and stomata
+/** True during polar night and outside the PFT's temperature range for
+ *  photosynthesis. photosynthesis() then returns a cleared result for any
+ *  fpar, lambda, nactive and vm.
+ */
+bool no_photosynthesis(const Pft& pft, double temp, double daylength);
+
+/// Whether no vegetation in a patch can photosynthesise at any time today
+/** Checks every individual in the patch and every active PFT of the stand
+ *  against no_photosynthesis(), using the daily and, in diurnal mode, all
+ *  sub-daily temperatures. Always false unless ifdormantfastpath is set.
+ */
+bool dormant_day(Patch& patch, const Climate& climate);
+
+/// No-stress assimilation for each Standpft assuming FPAR=1
+/** Used by every patch of the stand for its forest-floor conditions, so it
+ *  is calculated once a day before the patches are simulated, and the
+ *  patches can be simulated in any order.
+ */
+void forest_floor_photosynthesis(Stand& stand, Climate& climate);
 
 /// Nitrogen- and landuse specific alpha a
 double alphaa(const Pft& pft);
@@ -105,25 +105,29 @@ bool later_day(const Date& date,
 	return d1 > d2;
 }
 
-// Checks if the variable contains daily data
-bool is_daily(const GuessNC::CF::GridcellOrderedVariable* cf_var) {
-
-	// Check if first and second timestep is one day apart
-
-	DateTime dt1 = cf_var->get_date_time(0);
-	DateTime dt2 = cf_var->get_date_time(1);
+// Checks if the variable contains daily or sub-daily data (rather than monthly)
+bool has_daily_timesteps(const GuessNC::CF::GridcellOrderedVariable* cf_var) {
+	return cf_var->get_timesteps_per_day() > 0;
+}
 
-	dt1.add_time(1, GuessNC::CF::DAYS, cf_var->get_calendar_type());
+// Checks that sub-daily data starts with the first timestep of a day, so
+// that the timesteps can be taken a day at a time
+void check_subdaily_start(const GuessNC::CF::GridcellOrderedVariable* cf_var) {
+	const int steps = cf_var->get_timesteps_per_day();
 
-	return dt1 == dt2;
+	if (steps > 1 &&
+	    cf_var->get_date_time(0).get_seconds_after_midnight() >= SECONDS_PER_DAY / steps) {
+		fail("%s: sub-daily data must start with the first timestep of a day",
+		     cf_var->get_variable_name().c_str());
+	}
 }
 
 // Returns a DateTime in the last day for which the variable has data.
-// For daily data, this is simply the day of the last timestep, for monthly data
-// we need to find the last day of the last timestep's month.
+// For daily and sub-daily data, this is simply the day of the last timestep,
+// for monthly data we need to find the last day of the last timestep's month.
 GuessNC::CF::DateTime last_day_to_simulate(const GuessNC::CF::GridcellOrderedVariable* cf_var) {
 	GuessNC::CF::DateTime last = cf_var->get_date_time(cf_var->get_timesteps()-1);
-	if (is_daily(cf_var)) {
+	if (has_daily_timesteps(cf_var)) {
 		return last;
 	}
 	else {
@@ -245,7 +249,7 @@ void check_wind_variable(const GuessNC::CF::GridcellOrderedVariable* cf_var) {
 // Checks if two variables contain data for the same time period
 //
 // Compares start and end of time series, the day numbers are only compared if
-// both variables are daily.
+// both variables are daily or sub-daily.
 void check_compatible_timeseries(const GuessNC::CF::GridcellOrderedVariable* var1,
                                  const GuessNC::CF::GridcellOrderedVariable* var2) {
 	GuessNC::CF::DateTime start1, start2, end1, end2;
@@ -269,7 +273,7 @@ void check_compatible_timeseries(const GuessNC::CF::GridcellOrderedVariable* var
 		fail("end");
 	}
 
-	if (is_daily(var1) && is_daily(var2)) {
+	if (has_daily_timesteps(var1) && has_daily_timesteps(var2)) {
 		if (start1.get_day() != start2.get_day() ||
 			end1.get_day() != end2.get_day()) {
 			fail(error_message.c_str());
@@ -325,8 +329,57 @@ double calc_relative_humidity(double temp, double specific_humidity, double pres
 
 }
 
+namespace CFSubdaily {
+
+void daily_means(const std::vector<double>& data, int steps, double* daily) {
+	const size_t days = data.size() / steps;
+
+	for (size_t d = 0; d < days; ++d) {
+		double sum = 0;
+		for (int i = 0; i < steps; ++i) {
+			sum += data[d*steps + i];
+		}
+		daily[d] = sum / steps;
+	}
+}
+
+void daily_precipitation(const std::vector<double>& data, int steps, bool extensive, double* dprec) {
+	const size_t days = data.size() / steps;
+
+	// Sum up the amounts of each day's timesteps, or if given as a
+	// precipitation rate, convert the day's mean rate to an amount
+	for (size_t d = 0; d < days; ++d) {
+		double sum = 0;
+		for (int i = 0; i < steps; ++i) {
+			sum += data[d*steps + i];
+		}
+
+		if (extensive) {
+			dprec[d] = sum;
+		}
+		else {
+			dprec[d] = sum / steps * SECONDS_PER_DAY;
+		}
+	}
+}
+
+void set_subdaily_climate(Climate& climate,
+                          const std::vector<double>& temps,
+                          const std::vector<double>& insols,
+                          int day, int steps) {
+	std::vector<double>::const_iterator day_temps = temps.begin() + day * steps;
+	std::vector<double>::const_iterator day_insols = insols.begin() + day * steps;
+	climate.temps.assign(day_temps, day_temps + steps);
+	climate.insols.assign(day_insols, day_insols + steps);
+}
+
+}
+
+using namespace CFSubdaily;
+
 CFInput::CFInput()
-	: cf_temp(0),
+	: climate_replay(false),
+	  cf_temp(0),
 	  cf_prec(0),
 	  cf_insol(0),
 	  cf_wetdays(0),
@@ -336,10 +389,16 @@ CFInput::CFInput()
 	  cf_specifichum(0),
 	  cf_relhum(0),
 	  cf_wind(0),
+	  diurnal(false),
+	  remap("none"),
+	  remap_cellsize(0),
 	  ndep_timeseries("historic") {
 
 	// Declare instruction file parameters
 	declare_parameter("ndep_timeseries", &ndep_timeseries, 10, "Nitrogen deposition time series to use (historic, rcp26, rcp45, rcp60 or rcp85");
+	declare_parameter("diurnal", &diurnal, "Whether to run in diurnal mode with sub-daily temperature and insolation (0,1)");
+	declare_parameter("remap", &remap, 20, "How to remap the forcing to the grid list locations (none, nearest, bilinear or conservative)");
+	declare_parameter("remap_cellsize", &remap_cellsize, 0, 360, "Size of the grid cells in degrees, for conservative remapping");
 //todo this makes no sense here, does it?
     //	 SoilInput soilinput;
 }
@@ -450,8 +509,55 @@ void CFInput::init() {
 
 	check_same_spatial_domains(all_variables());
 
+	std::vector<GridcellOrderedVariable*> variables = all_variables();
+	for (size_t i = 0; i < variables.size(); ++i) {
+		check_subdaily_start(variables[i]);
+	}
+
+	// In diurnal mode the sub-daily temperature and insolation go to the
+	// model as they are, other sub-daily variables are always averaged
+	// (or summed) over the day
+	if (diurnal) {
+		const int steps = cf_temp->get_timesteps_per_day();
+
+		if (steps < 2 || cf_insol->get_timesteps_per_day() != steps) {
+			fail("Diurnal mode needs sub-daily temperature and insolation with the same timestep");
+		}
+
+		if (cf_standard_name_to_insoltype(cf_insol->get_standard_name()) == SUNSHINE) {
+			fail("Diurnal mode needs insolation given as radiation, not cloud cover");
+		}
+
+		date.subdaily = steps;
+	}
+
 	extensive_precipitation = cf_prec->get_standard_name() == "precipitation_amount";
 
+	// With remapping, the weights of each grid cell are computed here once,
+	// all variables share the spatial domain of the temperature
+	std::auto_ptr<GuessNC::CF::GridRemapper> remapper;
+
+	try {
+		const GuessNC::CF::RemapMethod remap_method = GuessNC::CF::parse_remap_method(remap);
+
+		if (remap_method != GuessNC::CF::REMAP_NONE) {
+			std::vector<double> grid_lons, grid_lats;
+			if (!cf_temp->get_grid_coordinates(grid_lons, grid_lats)) {
+				fail("Remapping needs forcing on a grid with one dimensional longitude and latitude coordinates");
+			}
+
+			if (remap_method == GuessNC::CF::REMAP_CONSERVATIVE && remap_cellsize <= 0) {
+				fail("Conservative remapping needs remap_cellsize");
+			}
+
+			remapper.reset(new GuessNC::CF::GridRemapper(grid_lons, grid_lats,
+			                                             remap_method, remap_cellsize));
+		}
+	}
+	catch (const std::runtime_error& e) {
+		fail(e.what());
+	}
+
 	// Read list of localities and store in gridlist member variable
 
 	// Retrieve name of grid list file as read from ins file
@@ -472,7 +578,22 @@ void CFInput::init() {
 
 		std::istringstream iss(line);
 
-		if (cf_temp->is_reduced()) {
+		if (remapper.get()) {
+			if (iss >> c.lon >> c.lat) {
+				getline(iss, descrip);
+
+				c.rlon = c.rlat = 0;
+
+				if (!remapper->get_weights(c.lon, c.lat, c.weights)) {
+					dprintf("WARNING ! (%g,%g) is outside the forcing grid, skipping.\n", c.lon, c.lat);
+					continue;
+				}
+			}
+			else {
+				fail("The gridlist for remapped netCDF input must be in lon,lat coordinates");
+			}
+		}
+		else if (cf_temp->is_reduced()) {
 			if (iss >> landid) {
 				getline(iss, descrip);
 
@@ -528,17 +649,38 @@ void CFInput::init() {
 
 }
 
+bool CFInput::next_gridcell_coordinates(double& lon, double& lat) {
+
+	if (current_gridcell == gridlist.end()) {
+		return false;
+	}
+
+	lon = current_gridcell->lon;
+	lat = current_gridcell->lat;
+	return true;
+}
+
 bool CFInput::getgridcell(Gridcell& gridcell) {
 
 	double lon, lat;
 	double cru_lon, cru_lat;
 	int soilstatus = 1;
 
-	// Load data for next gridcell, or if that fails, skip ahead until
-	// we find one that works.
-	while (current_gridcell != gridlist.end() &&
-	       !load_data_from_files(lon, lat)){
-		++current_gridcell;
+	if (climate_replay) {
+		// The forcing cache has the climate of the next grid cell in the
+		// gridlist (see next_gridcell_coordinates), so it had data when it
+		// was recorded. Its coordinates in the gridlist are those of the
+		// forcing grid, so the files needn't be read at all.
+		lon = current_gridcell->lon;
+		lat = current_gridcell->lat;
+	}
+	else {
+		// Load data for next gridcell, or if that fails, skip ahead until
+		// we find one that works.
+		while (current_gridcell != gridlist.end() &&
+		       !load_data_from_files(lon, lat)){
+			++current_gridcell;
+		}
 	}
 
 	cru_lon = floor(lon * 2.0) / 2.0 + 0.25;
@@ -562,49 +704,8 @@ bool CFInput::getgridcell(Gridcell& gridcell) {
 
 	gridcell.set_coordinates(lon, lat);
 
-	// Load spinup data for all variables
-
-	load_spinup_data(cf_temp, spinup_temp);
-	load_spinup_data(cf_prec, spinup_prec);
-	load_spinup_data(cf_insol, spinup_insol);
-
-	if (cf_wetdays) {
-		load_spinup_data(cf_wetdays, spinup_wetdays);
-	}
-
-	if (cf_min_temp) {
-		load_spinup_data(cf_min_temp, spinup_min_temp);
-	}
-
-	if (cf_max_temp) {
-		load_spinup_data(cf_max_temp, spinup_max_temp);
-	}
-
-	if (cf_pres) {
-		load_spinup_data(cf_pres, spinup_pres);
-	}
-
-	if (cf_specifichum) {
-		load_spinup_data(cf_specifichum, spinup_specifichum);
-	}
-
-	if (cf_relhum) {
-		load_spinup_data(cf_relhum, spinup_relhum);
-	}
-
-	if (cf_wind) {
-		load_spinup_data(cf_wind, spinup_wind);
-	}
-	
-	spinup_temp.detrend_data();
-
 	gridcell.climate.instype = cf_standard_name_to_insoltype(cf_insol->get_standard_name());
 
-	// Get nitrogen deposition, using the found CRU coordinates
-	/* Since the historic data set does not reach decade 2010-2019,
-	* we need to use the RCP data for the last decade. */
-	ndep.getndep(param["file_ndep"].str, cru_lon, cru_lat, Lamarque::RCP60);
-
 	soilinput.get_soil(lon, lat, gridcell);
 
 	historic_timestep_temp = -1;
@@ -623,6 +724,58 @@ bool CFInput::getgridcell(Gridcell& gridcell) {
 	if (current_gridcell->descrip != "") {
 		dprintf("Description: %s\n", (char*)current_gridcell->descrip);
 	}
+
+	if (climate_replay) {
+		// Climate comes from the forcing cache, nothing more to prepare
+		return true;
+	}
+
+	// Load spinup data for all variables
+	// (variables split over several files may need to open another file)
+	try {
+		load_spinup_data(cf_temp, spinup_temp);
+		load_spinup_data(cf_prec, spinup_prec);
+		load_spinup_data(cf_insol, spinup_insol);
+
+		if (cf_wetdays) {
+			load_spinup_data(cf_wetdays, spinup_wetdays);
+		}
+
+		if (cf_min_temp) {
+			load_spinup_data(cf_min_temp, spinup_min_temp);
+		}
+
+		if (cf_max_temp) {
+			load_spinup_data(cf_max_temp, spinup_max_temp);
+		}
+
+		if (cf_pres) {
+			load_spinup_data(cf_pres, spinup_pres);
+		}
+
+		if (cf_specifichum) {
+			load_spinup_data(cf_specifichum, spinup_specifichum);
+		}
+
+		if (cf_relhum) {
+			load_spinup_data(cf_relhum, spinup_relhum);
+		}
+
+		if (cf_wind) {
+			load_spinup_data(cf_wind, spinup_wind);
+		}
+	}
+	catch (const std::runtime_error& e) {
+		fail(e.what());
+	}
+	
+	spinup_temp.detrend_data();
+
+	// Get nitrogen deposition, using the found CRU coordinates
+	/* Since the historic data set does not reach decade 2010-2019,
+	* we need to use the RCP data for the last decade. */
+	ndep.getndep(param["file_ndep"].str, cru_lon, cru_lat, Lamarque::RCP60);
+
     // todo make the statement about soil where the soil is taken from really.
 	dprintf("Using Nitrogen deposition for (%3.3f,%3.3f)\n", cru_lon, cru_lat);
 
@@ -637,7 +790,31 @@ bool CFInput::load_data_from_files(double& lon, double& lat){
 
 	// Try to load the data from the NetCDF files
 
-	if (cf_temp->is_reduced()) {
+	if (!current_gridcell->weights.empty()) {
+		const std::vector<GuessNC::CF::RemapWeight>& weights = current_gridcell->weights;
+
+		if (!cf_temp->load_data_for(weights) ||
+		    !cf_prec->load_data_for(weights) ||
+		    !cf_insol->load_data_for(weights) ||
+		    (cf_wetdays && !cf_wetdays->load_data_for(weights)) ||
+		    (cf_min_temp && !cf_min_temp->load_data_for(weights)) ||
+		    (cf_max_temp && !cf_max_temp->load_data_for(weights)) ||
+		    (cf_pres && !cf_pres->load_data_for(weights)) ||
+		    (cf_specifichum && !cf_specifichum->load_data_for(weights)) ||
+		    (cf_relhum && !cf_relhum->load_data_for(weights)) ||
+		    (cf_wind && !cf_wind->load_data_for(weights))) {
+			dprintf("Failed to load data for (%g, %g) from NetCDF files, skipping.\n",
+			        current_gridcell->lon, current_gridcell->lat);
+			return false;
+		}
+
+		lon = current_gridcell->lon;
+		lat = current_gridcell->lat;
+
+		dprintf("Successfully loaded climate data remapped to %g, %g\n", lon, lat);
+		return true;
+	}
+	else if (cf_temp->is_reduced()) {
 		if (!cf_temp->load_data_for(landid) ||
 		    !cf_prec->load_data_for(landid) ||
 		    !cf_insol->load_data_for(landid) ||
@@ -694,9 +871,15 @@ void CFInput::get_yearly_data(std::vector<double>& data,
 
 	int calendar_year = date.get_calendar_year();
 
-	if (is_daily(cf_historic)) {
+	const int steps = cf_historic->get_timesteps_per_day();
+
+	if (steps > 0) {
 
-		data.resize(date.year_length());
+		// Daily or sub-daily data, historic_timestep counts days in the data
+		// and a day's values are its timesteps (only one for daily data)
+		const int historic_days = cf_historic->get_timesteps() / steps;
+
+		data.resize(date.year_length() * steps);
 
 		// This function is called at the first day of the year, so current_day
 		// starts at Jan 1, then we step through the whole year, getting data
@@ -705,6 +888,8 @@ void CFInput::get_yearly_data(std::vector<double>& data,
 
 		while (current_day.year == date.year) {
 
+			double* day_data = &data[current_day.day * steps];
+
 			// In the spinup?
 			if (earlier_day(current_day, calendar_year, cf_historic->get_date_time(0))) {
 
@@ -713,15 +898,17 @@ void CFInput::get_yearly_data(std::vector<double>& data,
 				if (current_day.ndaymonth[1] == 29 && current_day.month > 1) {
 					--spinup_day;
 				}
-				data[current_day.day]  = spinup[spinup_day];
+				for (int i = 0; i < steps; ++i) {
+					day_data[i] = spinup[spinup_day * steps + i];
+				}
 			}
 			else {
 				// Historical period
 
-				if (historic_timestep + 1 < cf_historic->get_timesteps()) {
+				if (historic_timestep + 1 < historic_days) {
 
 					++historic_timestep;
-					GuessNC::CF::DateTime dt = cf_historic->get_date_time(historic_timestep);
+					GuessNC::CF::DateTime dt = cf_historic->get_date_time(historic_timestep * steps);
 
 					// Deal with calendar mismatch
 
@@ -737,12 +924,16 @@ void CFInput::get_yearly_data(std::vector<double>& data,
 					}
 				}
 
-				if (historic_timestep < cf_historic->get_timesteps()) {
-					data[current_day.day]  = cf_historic->get_value(max(0, historic_timestep));
+				if (historic_timestep < historic_days) {
+					const int first = max(0, historic_timestep) * steps;
+					for (int i = 0; i < steps; ++i) {
+						day_data[i] = cf_historic->get_value(first + i);
+					}
 				}
 				else {
 					// Past the end of the historical period, these days wont be simulated.
-					data[current_day.day] = data[max(0, current_day.day-1)];
+					const double* previous_day = &data[max(0, current_day.day-1) * steps];
+					std::copy(previous_day, previous_day + steps, day_data);
 				}
 			}
 
@@ -794,10 +985,12 @@ void CFInput::populate_daily_array(double* daily,
 	std::vector<double> data;
 	get_yearly_data(data, spinup, cf_historic, historic_timestep);
 
-	if (is_daily(cf_historic)) {
-		// Simply copy from data to daily
+	const int steps = cf_historic->get_timesteps_per_day();
 
-		std::copy(data.begin(), data.end(), daily);
+	if (steps > 0) {
+		// Copy from data to daily, averaging sub-daily values
+
+		daily_means(data, steps, daily);
 	}
 	else {
 		// for now, assume that data set must be monthly since it isn't daily
@@ -819,17 +1012,10 @@ void CFInput::populate_daily_prec_array(long& seed) {
 		get_yearly_data(wetdays_data, spinup_wetdays, cf_wetdays, historic_timestep_wetdays);
 	}
 
-	if (is_daily(cf_prec)) {
-		// Simply copy from data to daily, and if needed convert from
-		// precipitation rate to precipitation amount
-
-		for (size_t i = 0; i < prec_data.size(); ++i) {
-			dprec[i] = prec_data[i];
+	const int steps = cf_prec->get_timesteps_per_day();
 
-			if (!extensive_precipitation) {
-				dprec[i] *= SECONDS_PER_DAY;
-			}
-		}
+	if (steps > 0) {
+		daily_precipitation(prec_data, steps, extensive_precipitation, dprec);
 	}
 	else {
 		// for now, assume that data set must be monthly since it isn't daily
@@ -855,7 +1041,7 @@ void CFInput::populate_daily_arrays(Gridcell& gridcell) {
 	// Extract daily values for all days in this year, either from
 	// spinup dataset or historical dataset
 
-	if ( !is_daily(cf_temp) && weathergenerator == GWGEN ) {
+	if ( !has_daily_timesteps(cf_temp) && weathergenerator == GWGEN ) {
 
 		int instype = cf_standard_name_to_insoltype(cf_insol->get_standard_name());
 		
@@ -963,10 +1149,24 @@ void CFInput::populate_daily_arrays(Gridcell& gridcell) {
 	}
 	else {
 		
-		populate_daily_array(dtemp, spinup_temp, cf_temp, historic_timestep_temp, 0);
+		if (diurnal) {
+			get_yearly_data(stemp, spinup_temp, cf_temp, historic_timestep_temp);
+			daily_means(stemp, date.subdaily, dtemp);
+		}
+		else {
+			populate_daily_array(dtemp, spinup_temp, cf_temp, historic_timestep_temp, 0);
+		}
+
 		populate_daily_prec_array(gridcell.seed);
-		populate_daily_array(dinsol, spinup_insol, cf_insol, historic_timestep_insol, 0,
-				     max_insolation(cf_standard_name_to_insoltype(cf_insol->get_standard_name())));
+
+		if (diurnal) {
+			get_yearly_data(sinsol, spinup_insol, cf_insol, historic_timestep_insol);
+			daily_means(sinsol, date.subdaily, dinsol);
+		}
+		else {
+			populate_daily_array(dinsol, spinup_insol, cf_insol, historic_timestep_insol, 0,
+			                     max_insolation(cf_standard_name_to_insoltype(cf_insol->get_standard_name())));
+		}
 		
 		if (cf_min_temp) {
 			populate_daily_array(dmin_temp, spinup_min_temp, cf_min_temp, historic_timestep_min_temp, 0);
@@ -993,6 +1193,10 @@ void CFInput::populate_daily_arrays(Gridcell& gridcell) {
 		}
 	}
 	// Convert to units the model expects
+	for (size_t i = 0; i < stemp.size(); ++i) {
+		stemp[i] -= K2degC;
+	}
+
 	bool cloud_fraction_to_sunshine = (cf_standard_name_to_insoltype(cf_insol->get_standard_name()) == SUNSHINE);
 	for (int i = 0; i < date.year_length(); ++i) {
 		
@@ -1089,30 +1293,44 @@ bool CFInput::getclimate(Gridcell& gridcell) {
 	climate.co2 = co2[date.get_calendar_year()];
     climate.distprob = distprob[date.get_calendar_year()];
 
-	if (date.day == 0) {
-		populate_daily_arrays(gridcell);
-	}
+	// When replaying from the forcing cache the remaining drivers are set by the cache
+	if (!climate_replay) {
 
-	climate.temp   = dtemp[date.day];
-	climate.prec   = dprec[date.day];
-	climate.insol  = dinsol[date.day];
-	climate.relhum = drelhum[date.day];
-	climate.u10    = dwind[date.day];
-	climate.tmax   = dmax_temp[date.day];
-	climate.tmin   = dmin_temp[date.day];
-	climate.dtr    = ddtr[date.day];
-
-	// Nitrogen deposition
-	gridcell.dNH4dep = dNH4dep[date.day];
-	gridcell.dNO3dep = dNO3dep[date.day];
+		if (date.day == 0) {
+			// Data in later files of a split variable is read here
+			try {
+				populate_daily_arrays(gridcell);
+			}
+			catch (const std::runtime_error& e) {
+				fail(e.what());
+			}
+		}
 
-	// bvoc
-	if(ifbvoc){
-		if (cf_min_temp && cf_max_temp) {
-			climate.dtr = dmax_temp[date.day] - dmin_temp[date.day];
+		climate.temp   = dtemp[date.day];
+		climate.prec   = dprec[date.day];
+		climate.insol  = dinsol[date.day];
+		climate.relhum = drelhum[date.day];
+		climate.u10    = dwind[date.day];
+		climate.tmax   = dmax_temp[date.day];
+		climate.tmin   = dmin_temp[date.day];
+		climate.dtr    = ddtr[date.day];
+
+		if (diurnal) {
+			set_subdaily_climate(climate, stemp, sinsol, date.day, date.subdaily);
 		}
-		else {
-			fail("When BVOC is switched on, valid paths for minimum and maximum temperature must be given.");
+
+		// Nitrogen deposition
+		gridcell.dNH4dep = dNH4dep[date.day];
+		gridcell.dNO3dep = dNO3dep[date.day];
+
+		// bvoc
+		if(ifbvoc){
+			if (cf_min_temp && cf_max_temp) {
+				climate.dtr = dmax_temp[date.day] - dmin_temp[date.day];
+			}
+			else {
+				fail("When BVOC is switched on, valid paths for minimum and maximum temperature must be given.");
+			}
 		}
 	}
 
@@ -1156,8 +1374,9 @@ void CFInput::load_spinup_data(const GuessNC::CF::GridcellOrderedVariable* cf_va
 
 	int timestep = 0;
 
-	bool daily = is_daily(cf_var);
-	// for now, assume that each data set is either daily or monthly
+	// for now, assume that each data set is either (sub-)daily or monthly
+	const int steps = cf_var->get_timesteps_per_day();
+	bool daily = steps > 0;
 	bool monthly = !daily;
 
 	// Skip the first year if data doesn't start at the beginning of the year
@@ -1173,14 +1392,15 @@ void CFInput::load_spinup_data(const GuessNC::CF::GridcellOrderedVariable* cf_va
 	// Get all the values for the first NYEAR_SPINUP_DATA years,
 	// and put them into source
 	for (int i = 0; i < NYEAR_SPINUP_DATA; ++i) {
-		std::vector<double> year(daily ? GenericSpinupData::DAYS_PER_YEAR : 12);
+		std::vector<double> year(daily ? GenericSpinupData::DAYS_PER_YEAR * steps : 12);
 
 		for (size_t i = 0; i < year.size(); ++i) {
-			if (timestep < cf_var->get_timesteps()) {
+			// Skip leap days, checked at the first timestep of each day
+			if (daily && i % steps == 0 && timestep < cf_var->get_timesteps()) {
 				GuessNC::CF::DateTime dt = cf_var->get_date_time(timestep);
 
-				if (daily && dt.get_month() == 2 && dt.get_day() == 29) {
-					++timestep;
+				if (dt.get_month() == 2 && dt.get_day() == 29) {
+					timestep += steps;
 				}
 			}
 
@@ -18,6 +18,27 @@
 #include <memory>
 #include <limits>
 
+/// Mapping of daily and sub-daily CF data to the model's forcing, used by CFInput
+/** The data for a year holds the values of all timesteps of each day in
+ *  turn, steps values per day (1 for daily data). */
+namespace CFSubdaily {
+
+/// Averages the timesteps of each day
+void daily_means(const std::vector<double>& data, int steps, double* daily);
+
+/// Daily precipitation amounts (mm) from the timesteps of each day
+/** \param extensive  Whether data are amounts per timestep (kg m-2), or
+ *                    else mean rates over the timestep (kg m-2 s-1) */
+void daily_precipitation(const std::vector<double>& data, int steps, bool extensive, double* dprec);
+
+/// Sets Climate::temps and Climate::insols to the timesteps of a day
+void set_subdaily_climate(Climate& climate,
+                          const std::vector<double>& temps,
+                          const std::vector<double>& insols,
+                          int day, int steps);
+
+}
+
 class CFInput : public InputModule {
 public:
 	CFInput();
@@ -38,6 +59,12 @@ public:
 	/// Obtains land management data for one day
 	void getmanagement(Gridcell& gridcell) {management_input.getmanagement(gridcell);}
 
+	/// See base class for documentation about this function's responsibilities
+	void set_climate_replay(bool replay) {climate_replay = replay;}
+
+	/// See base class for documentation about this function's responsibilities
+	bool next_gridcell_coordinates(double& lon, double& lat);
+
 	static const int NYEAR_SPINUP_DATA=30;
 
 private:
@@ -52,6 +79,9 @@ private:
 
 		int rlon;
 		int rlat;
+
+		/// Forcing grid locations and weights if the grid cell is remapped
+		std::vector<GuessNC::CF::RemapWeight> weights;
 	};
 
 	/// The grid cells to simulate
@@ -60,6 +90,12 @@ private:
 	/// The current grid cell to simulate
 	std::vector<CfCoord>::iterator current_gridcell;
 
+	/// Whether the climate of the current grid cell is replayed from the forcing cache
+	/** If so, the climate isn't read from the files, and spinup data, nitrogen
+	 *  deposition and the daily arrays aren't prepared
+	 */
+	bool climate_replay;
+
 	/// Loads data from NetCDF files for current grid cell
 	/** Returns the coordinates for the current grid cell*/
 	bool load_data_from_files(double& lon, double& lat);
@@ -70,13 +106,15 @@ private:
 
 	/// Gets data for one year, for one variable.
 	/** Returns either 12 or 365/366 values (depending on LPJ-GUESS year length, not
-	 *  data set year length). Gets the values from spinup and/or historic period. */
+	 *  data set year length), or for sub-daily data the values of all timesteps
+	 *  of the 365/366 days. Gets the values from spinup and/or historic period. */
 	void get_yearly_data(std::vector<double>& data,
 	                     const GenericSpinupData& spinup,
 	                     GuessNC::CF::GridcellOrderedVariable* cf_historic,
 	                     int& historic_timestep);
 
 	/// Fills one array of daily values with forcing data for the current year
+	/** Sub-daily data is averaged over each day */
 	void populate_daily_array(double* daily,
 	                          const GenericSpinupData& spinup,
 	                          GuessNC::CF::GridcellOrderedVariable* cf_historic,
@@ -170,6 +208,12 @@ private:
 	/// Daily N deposition for one year
 	double dNH4dep[Date::MAX_YEAR_LENGTH],dNO3dep[Date::MAX_YEAR_LENGTH];
 
+	/// Sub-daily temperature for current gridcell and current year in diurnal mode (deg C)
+	std::vector<double> stemp;
+
+	/// Sub-daily insolation for current gridcell and current year in diurnal mode (\see instype)
+	std::vector<double> sinsol;
+
 	/// Minimum temperature for current gridcell and current year (deg C)
 	double dmin_temp[Date::MAX_YEAR_LENGTH];
 
@@ -184,7 +228,25 @@ private:
 	 *  given as a mean rate (kg m-2 s-1) it is an intensive quantity */
 	bool extensive_precipitation;
 
-	// Current timestep in CF files
+	/// Whether to run in diurnal mode, with sub-daily temperature and insolation
+	/** The number of timesteps per day in the temperature and insolation
+	 *  data gives the number of sub-daily periods (date.subdaily). Other
+	 *  variables may be daily, sub-daily (averaged or summed over the day)
+	 *  or monthly. Without diurnal mode sub-daily data is used as daily
+	 *  means too. */
+	bool diurnal;
+
+	/// How to remap the forcing to the grid cells (none, nearest, bilinear or conservative)
+	/** With remapping, the grid list gives longitude and latitude instead
+	 *  of indices in the forcing grid. The weights of each grid cell are
+	 *  computed once in init and used for all variables. */
+	std::string remap;
+
+	/// Size of the grid cells in degrees, for conservative remapping
+	double remap_cellsize;
+
+	// Current timestep in CF files (for daily and sub-daily data, the
+	// current day in the data)
 
 	int historic_timestep_temp;
 
@@ -489,6 +489,41 @@ void CommonOutput::define_output_tables() {
 	create_output_table(out_msoiltempdepth125, file_msoiltempdepth125, month_columns);
 	create_output_table(out_msoiltempdepth135, file_msoiltempdepth135, month_columns);
 	create_output_table(out_msoiltempdepth145, file_msoiltempdepth145, month_columns);
+
+	// The expensive parts of outannual, and the tables depending on them
+	OutputVariableRegistry& registry = OutputVariableRegistry::get_instance();
+
+	registry.declare_computation("common/pft_vegetation", OUTPUT_COST_INDIVIDUAL);
+	Table* pft_tables[] = { &out_cmass, &out_anpp, &out_agpp, &out_fpc, &out_aaet,
+	                        &out_clitter, &out_dens, &out_lai, &out_aiso, &out_amon,
+	                        &out_amon_mt1, &out_amon_mt2, &out_nmass, &out_cton_leaf,
+	                        &out_vmaxnlim, &out_nuptake, &out_nlitter,
+	                        &out_speciesheights, &out_cpool, &out_npool };
+	for (size_t i = 0; i < sizeof(pft_tables) / sizeof(pft_tables[0]); i++) {
+		registry.depends(*pft_tables[i], "common/pft_vegetation");
+	}
+
+	registry.declare_computation("common/monthly", OUTPUT_COST_PATCH);
+	Table* monthly_tables[] = { &out_mnpp, &out_mgpp, &out_mra, &out_maet, &out_mpet,
+	                            &out_mevap, &out_mrunoff, &out_mintercep, &out_mrh,
+	                            &out_mnee, &out_mwcont_upper, &out_mwcont_lower,
+	                            &out_miso, &out_mmon, &out_mmon_mt1, &out_mmon_mt2,
+	                            &out_mch4, &out_mch4diff, &out_mch4plan, &out_mch4ebull,
+	                            &out_msnow, &out_mwtp, &out_mald,
+	                            &out_msoiltempdepth5, &out_msoiltempdepth15,
+	                            &out_msoiltempdepth25, &out_msoiltempdepth35,
+	                            &out_msoiltempdepth45, &out_msoiltempdepth55,
+	                            &out_msoiltempdepth65, &out_msoiltempdepth75,
+	                            &out_msoiltempdepth85, &out_msoiltempdepth95,
+	                            &out_msoiltempdepth105, &out_msoiltempdepth115,
+	                            &out_msoiltempdepth125, &out_msoiltempdepth135,
+	                            &out_msoiltempdepth145 };
+	for (size_t i = 0; i < sizeof(monthly_tables) / sizeof(monthly_tables[0]); i++) {
+		registry.depends(*monthly_tables[i], "common/monthly");
+	}
+
+	registry.declare_computation("common/monthly_lai", OUTPUT_COST_INDIVIDUAL);
+	registry.depends(out_mlai, "common/monthly_lai");
 }
 
 /// Function for producing data file used to communicate information on stand structure
@@ -752,6 +787,12 @@ void CommonOutput::outannual(Gridcell& gridcell) {
 	// output table
 	OutputRows out(output_channel, lon, lat, date.get_calendar_year());
 
+	// Computations which can be skipped if their output isn't selected
+	const OutputVariableRegistry& registry = OutputVariableRegistry::get_instance();
+	const bool pft_vegetation = registry.needed("common/pft_vegetation");
+	const bool monthly = registry.needed("common/monthly");
+	const bool monthly_lai = registry.needed("common/monthly_lai");
+
 	// guess2008 - reset monthly and annual sums across patches each year
 	for (m = 0; m < 12; m++) {
 		mnpp[m] = mlai[m] = mgpp[m] = mra[m] = maet[m] = mpet[m] = mevap[m] = mintercep[m] = mrunoff[m] = mrh[m] = mnee[m] = mwcont_upper[m] = mwcont_lower[m] = miso[m] = mmon[m] = mmon_mt1[m] = mmon_mt2[m] = 0.0;
@@ -888,9 +929,10 @@ void CommonOutput::outannual(Gridcell& gridcell) {
     double standpft_mortdc=0.0; //MORTC outputs - TP 13.11.15
 
 	// *** Loop through PFTs ***
+	// (not at all if none of its output is selected)
 
 	pftlist.firstobj();
-	while (pftlist.isobj) {
+	while (pft_vegetation && pftlist.isobj) {
 
 		Pft& pft=pftlist.getobj();
 		Gridcellpft& gridcellpft=gridcell.pft[pft.id];
@@ -1404,77 +1446,81 @@ void CommonOutput::outannual(Gridcell& gridcell) {
 
 			// Monthly output variables
 
-			for (m=0;m<12;m++) {
-				maet[m] += patch.maet[m]*to_gridcell_average;
-				mpet[m] += patch.mpet[m]*to_gridcell_average;
-				mevap[m] += patch.mevap[m]*to_gridcell_average;
-				mintercep[m] += patch.mintercep[m]*to_gridcell_average;
-				mrunoff[m] += patch.mrunoff[m]*to_gridcell_average;
-				mrh[m] += patch.fluxes.get_monthly_flux(Fluxes::SOILC, m)*to_gridcell_average;
-				mwcont_upper[m] += patch.soil.mwcont[m][0]*to_gridcell_average;
-				mwcont_lower[m] += patch.soil.mwcont[m][1]*to_gridcell_average;
-
-				mgpp[m] += patch.fluxes.get_monthly_flux(Fluxes::GPP, m)*to_gridcell_average;
-				mra[m] += patch.fluxes.get_monthly_flux(Fluxes::RA, m)*to_gridcell_average;
-
-				miso[m]+=patch.fluxes.get_monthly_flux(Fluxes::ISO, m)*to_gridcell_average;
-				mmon[m]+=patch.fluxes.get_monthly_flux(Fluxes::MT_APIN, m)*to_gridcell_average;
-				mmon[m]+=patch.fluxes.get_monthly_flux(Fluxes::MT_LIMO, m)*to_gridcell_average;
-				mmon[m]+=patch.fluxes.get_monthly_flux(Fluxes::MT_TRIC, m)*to_gridcell_average;
-				mmon[m]+=patch.fluxes.get_monthly_flux(Fluxes::MT_BPIN, m)*to_gridcell_average;
-				mmon[m]+=patch.fluxes.get_monthly_flux(Fluxes::MT_MYRC, m)*to_gridcell_average;
-				mmon[m]+=patch.fluxes.get_monthly_flux(Fluxes::MT_SABI, m)*to_gridcell_average;
-				mmon[m]+=patch.fluxes.get_monthly_flux(Fluxes::MT_CAMP, m)*to_gridcell_average;
-				mmon[m]+=patch.fluxes.get_monthly_flux(Fluxes::MT_TBOC, m)*to_gridcell_average;
-				mmon[m]+=patch.fluxes.get_monthly_flux(Fluxes::MT_OTHR, m)*to_gridcell_average;
-
-				mmon_mt1[m]+=patch.fluxes.get_monthly_flux(Fluxes::MT_APIN, m)*to_gridcell_average;
-				mmon_mt1[m]+=patch.fluxes.get_monthly_flux(Fluxes::MT_LIMO, m)*to_gridcell_average;
-				mmon_mt1[m]+=patch.fluxes.get_monthly_flux(Fluxes::MT_TRIC, m)*to_gridcell_average;
-				mmon_mt2[m]+=patch.fluxes.get_monthly_flux(Fluxes::MT_BPIN, m)*to_gridcell_average;
-				mmon_mt2[m]+=patch.fluxes.get_monthly_flux(Fluxes::MT_MYRC, m)*to_gridcell_average;
-				mmon_mt2[m]+=patch.fluxes.get_monthly_flux(Fluxes::MT_SABI, m)*to_gridcell_average;
-				mmon_mt2[m]+=patch.fluxes.get_monthly_flux(Fluxes::MT_CAMP, m)*to_gridcell_average;
-				mmon_mt2[m]+=patch.fluxes.get_monthly_flux(Fluxes::MT_TBOC, m)*to_gridcell_average;
-				mmon_mt2[m]+=patch.fluxes.get_monthly_flux(Fluxes::MT_OTHR, m)*to_gridcell_average;
+			if (monthly) {
+				for (m=0;m<12;m++) {
+					maet[m] += patch.maet[m]*to_gridcell_average;
+					mpet[m] += patch.mpet[m]*to_gridcell_average;
+					mevap[m] += patch.mevap[m]*to_gridcell_average;
+					mintercep[m] += patch.mintercep[m]*to_gridcell_average;
+					mrunoff[m] += patch.mrunoff[m]*to_gridcell_average;
+					mrh[m] += patch.fluxes.get_monthly_flux(Fluxes::SOILC, m)*to_gridcell_average;
+					mwcont_upper[m] += patch.soil.mwcont[m][0]*to_gridcell_average;
+					mwcont_lower[m] += patch.soil.mwcont[m][1]*to_gridcell_average;
+
+					mgpp[m] += patch.fluxes.get_monthly_flux(Fluxes::GPP, m)*to_gridcell_average;
+					mra[m] += patch.fluxes.get_monthly_flux(Fluxes::RA, m)*to_gridcell_average;
+
+					miso[m]+=patch.fluxes.get_monthly_flux(Fluxes::ISO, m)*to_gridcell_average;
+					mmon[m]+=patch.fluxes.get_monthly_flux(Fluxes::MT_APIN, m)*to_gridcell_average;
+					mmon[m]+=patch.fluxes.get_monthly_flux(Fluxes::MT_LIMO, m)*to_gridcell_average;
+					mmon[m]+=patch.fluxes.get_monthly_flux(Fluxes::MT_TRIC, m)*to_gridcell_average;
+					mmon[m]+=patch.fluxes.get_monthly_flux(Fluxes::MT_BPIN, m)*to_gridcell_average;
+					mmon[m]+=patch.fluxes.get_monthly_flux(Fluxes::MT_MYRC, m)*to_gridcell_average;
+					mmon[m]+=patch.fluxes.get_monthly_flux(Fluxes::MT_SABI, m)*to_gridcell_average;
+					mmon[m]+=patch.fluxes.get_monthly_flux(Fluxes::MT_CAMP, m)*to_gridcell_average;
+					mmon[m]+=patch.fluxes.get_monthly_flux(Fluxes::MT_TBOC, m)*to_gridcell_average;
+					mmon[m]+=patch.fluxes.get_monthly_flux(Fluxes::MT_OTHR, m)*to_gridcell_average;
+
+					mmon_mt1[m]+=patch.fluxes.get_monthly_flux(Fluxes::MT_APIN, m)*to_gridcell_average;
+					mmon_mt1[m]+=patch.fluxes.get_monthly_flux(Fluxes::MT_LIMO, m)*to_gridcell_average;
+					mmon_mt1[m]+=patch.fluxes.get_monthly_flux(Fluxes::MT_TRIC, m)*to_gridcell_average;
+					mmon_mt2[m]+=patch.fluxes.get_monthly_flux(Fluxes::MT_BPIN, m)*to_gridcell_average;
+					mmon_mt2[m]+=patch.fluxes.get_monthly_flux(Fluxes::MT_MYRC, m)*to_gridcell_average;
+					mmon_mt2[m]+=patch.fluxes.get_monthly_flux(Fluxes::MT_SABI, m)*to_gridcell_average;
+					mmon_mt2[m]+=patch.fluxes.get_monthly_flux(Fluxes::MT_CAMP, m)*to_gridcell_average;
+					mmon_mt2[m]+=patch.fluxes.get_monthly_flux(Fluxes::MT_TBOC, m)*to_gridcell_average;
+					mmon_mt2[m]+=patch.fluxes.get_monthly_flux(Fluxes::MT_OTHR, m)*to_gridcell_average;
 				
-				msnowdepth[m] += patch.soil.msnowdepth[m]*M_PER_MM*to_gridcell_average;
-				mald[m] += patch.soil.mthaw[m]*M_PER_MM*to_gridcell_average;			// mm to m
-				mwtp[m] += patch.soil.mwtp[m]*M_PER_MM*to_gridcell_average;				// mm to m
+					msnowdepth[m] += patch.soil.msnowdepth[m]*M_PER_MM*to_gridcell_average;
+					mald[m] += patch.soil.mthaw[m]*M_PER_MM*to_gridcell_average;			// mm to m
+					mwtp[m] += patch.soil.mwtp[m]*M_PER_MM*to_gridcell_average;				// mm to m
 				
-				mch4[m] += patch.fluxes.get_monthly_flux(Fluxes::CH4C, m)*to_gridcell_average;				// g CH4-C/m2 - as CH4 is in gC, but CO2 fluxes are kgC
-				mch4_diff[m] += patch.fluxes.get_monthly_flux(Fluxes::CH4C_DIFF, m)*to_gridcell_average;	// g CH4-C/m2
-				mch4_plant[m] += patch.fluxes.get_monthly_flux(Fluxes::CH4C_PLAN, m)*to_gridcell_average;	// g CH4-C/m2
-				mch4_ebull[m] += patch.fluxes.get_monthly_flux(Fluxes::CH4C_EBUL, m)*to_gridcell_average;	// g CH4-C/m2
+					mch4[m] += patch.fluxes.get_monthly_flux(Fluxes::CH4C, m)*to_gridcell_average;				// g CH4-C/m2 - as CH4 is in gC, but CO2 fluxes are kgC
+					mch4_diff[m] += patch.fluxes.get_monthly_flux(Fluxes::CH4C_DIFF, m)*to_gridcell_average;	// g CH4-C/m2
+					mch4_plant[m] += patch.fluxes.get_monthly_flux(Fluxes::CH4C_PLAN, m)*to_gridcell_average;	// g CH4-C/m2
+					mch4_ebull[m] += patch.fluxes.get_monthly_flux(Fluxes::CH4C_EBUL, m)*to_gridcell_average;	// g CH4-C/m2
 				
-				for (int sl = 0; sl < SOILTEMPOUT; sl++) {
-					msoilt[m][sl] += patch.soil.T_soil_monthly[m][sl] * to_gridcell_average;
-				}
+					for (int sl = 0; sl < SOILTEMPOUT; sl++) {
+						msoilt[m][sl] += patch.soil.T_soil_monthly[m][sl] * to_gridcell_average;
+					}
 
+				}
 			}
 
 			maxald_gridcell += patch.soil.maxthawdepththisyear*M_PER_MM*to_gridcell_average;	// mm to m
 			
-			// Calculate monthly NPP and LAI
+			// Calculate monthly LAI
 
-			Vegetation& vegetation = patch.vegetation;
+			if (monthly_lai) {
+				Vegetation& vegetation = patch.vegetation;
 
-			vegetation.firstobj();
-			while (vegetation.isobj) {
-				Individual& indiv = vegetation.getobj();
+				vegetation.firstobj();
+				while (vegetation.isobj) {
+					Individual& indiv = vegetation.getobj();
 
-				// guess2008 - alive check added
-				if (indiv.id != -1 && indiv.alive) {
+					// guess2008 - alive check added
+					if (indiv.id != -1 && indiv.alive) {
 
-					for (m=0;m<12;m++) {
-						mlai[m] += indiv.mlai[m] * to_gridcell_average;
-					}
+						for (m=0;m<12;m++) {
+							mlai[m] += indiv.mlai[m] * to_gridcell_average;
+						}
 
-				} // alive?
+					} // alive?
 
-				vegetation.nextobj();
+					vegetation.nextobj();
 
-			} // while/vegetation loop
+				} // while/vegetation loop
+			}
 			stand.nextobj();
 		} // patch loop
 		++gc_itr;
@@ -74,6 +74,7 @@ void lai_crop(Patch& patch) {
 				indiv.lai_indiv_daily = 0.0;
 				indiv.fpc_daily = 0.0;
 			}
+			indiv.invalidate_day_cache();
 		}
 		vegetation.nextobj();
 	}
@@ -768,7 +769,9 @@ void growth_daily(Patch& patch) {
  *  If grass pft not present or found in other stands, pft laimax is used.
  */
 void allometry_crop(Individual& indiv) {
- 
+
+	indiv.invalidate_day_cache();
+
 	// crop grass compatible with natural grass
 	if(indiv.pft.phenology == ANY) {
 
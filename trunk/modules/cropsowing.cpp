@@ -412,38 +412,38 @@ void calc_m_climate_20y_mean(Climate& climate) {
 	for(int m=0; m<12; m++) {
 
 		// 1) this year
-		climate.mtemp20[m] = climate.hmtemp_20[m].lastadd();
-		climate.mprec20[m] = climate.hmprec_20[m].lastadd();
-		climate.aprec += climate.hmprec_20[m].lastadd();
-		climate.mpet_year[m] = climate.hmeet_20[m].lastadd()*PRIESTLEY_TAYLOR;
+		climate.mtemp20[m] = climate.history->hmtemp_20[m].lastadd();
+		climate.mprec20[m] = climate.history->hmprec_20[m].lastadd();
+		climate.aprec += climate.history->hmprec_20[m].lastadd();
+		climate.mpet_year[m] = climate.history->hmeet_20[m].lastadd()*PRIESTLEY_TAYLOR;
 		//
 		climate.mpet20[m] = climate.mpet_year[m];
 		if (climate.mpet_year[m] > 0.0) {
-			climate.mprec_pet20[m] = climate.hmprec_20[m].lastadd() / climate.mpet_year[m];
+			climate.mprec_pet20[m] = climate.history->hmprec_20[m].lastadd() / climate.mpet_year[m];
 		} else {
 			climate.mprec_pet20[m] = 0.0;
 		}
 
-		if (climate.hmprec_20[m].lastadd() / climate.mpet_year[m] < mprec_petmin_thisyear) {
-			mprec_petmin_thisyear = climate.hmprec_20[m].lastadd() / climate.mpet_year[m];
+		if (climate.history->hmprec_20[m].lastadd() / climate.mpet_year[m] < mprec_petmin_thisyear) {
+			mprec_petmin_thisyear = climate.history->hmprec_20[m].lastadd() / climate.mpet_year[m];
 		}
-		if (climate.hmprec_20[m].lastadd() / climate.mpet_year[m] > mprec_petmax_thisyear) {
-			mprec_petmax_thisyear = climate.hmprec_20[m].lastadd() / climate.mpet_year[m];
+		if (climate.history->hmprec_20[m].lastadd() / climate.mpet_year[m] > mprec_petmax_thisyear) {
+			mprec_petmax_thisyear = climate.history->hmprec_20[m].lastadd() / climate.mpet_year[m];
 		}
 
 		// 2) past 20 years or less
 		for (int y=startyear; y<20; y++) {
-			climate.mtemp_20[y-1][m] = climate.mtemp_20[y][m];
-			climate.mtemp20[m] += climate.mtemp_20[y][m];
+			climate.history->mtemp_20[y-1][m] = climate.history->mtemp_20[y][m];
+			climate.mtemp20[m] += climate.history->mtemp_20[y][m];
 
-			climate.mprec_20[y-1][m] = climate.mprec_20[y][m];
-			climate.mprec20[m] += climate.mprec_20[y][m];
+			climate.history->mprec_20[y-1][m] = climate.history->mprec_20[y][m];
+			climate.mprec20[m] += climate.history->mprec_20[y][m];
 
-			climate.mpet_20[y-1][m] = climate.mpet_20[y][m];
-			climate.mpet20[m] += climate.mpet_20[y][m];
+			climate.history->mpet_20[y-1][m] = climate.history->mpet_20[y][m];
+			climate.mpet20[m] += climate.history->mpet_20[y][m];
 
-			climate.mprec_pet_20[y-1][m] = climate.mprec_pet_20[y][m];
-			climate.mprec_pet20[m] += climate.mprec_pet_20[y][m];
+			climate.history->mprec_pet_20[y-1][m] = climate.history->mprec_pet_20[y][m];
+			climate.mprec_pet20[m] += climate.history->mprec_pet_20[y][m];
 		}
 		// 3) 20 years average means:
 		climate.mtemp20[m] /= min(20, date.year + 1);
@@ -451,29 +451,29 @@ void calc_m_climate_20y_mean(Climate& climate) {
 		climate.mpet20[m] /= min(20, date.year + 1);
 		climate.mprec_pet20[m] /= min(20, date.year + 1);
 
-		climate.mtemp_20[19][m] = climate.hmtemp_20[m].lastadd();
-		climate.mprec_20[19][m] = climate.hmprec_20[m].lastadd();
+		climate.history->mtemp_20[19][m] = climate.history->hmtemp_20[m].lastadd();
+		climate.history->mprec_20[19][m] = climate.history->hmprec_20[m].lastadd();
 
-		climate.mpet_20[19][m] = climate.mpet_year[m];
+		climate.history->mpet_20[19][m] = climate.mpet_year[m];
 		if (climate.mpet_year[m] > 0.0) {
-			climate.mprec_pet_20[19][m] = climate.hmprec_20[m].lastadd() / climate.mpet_year[m];
+			climate.history->mprec_pet_20[19][m] = climate.history->hmprec_20[m].lastadd() / climate.mpet_year[m];
 		} else {
-			climate.mprec_pet_20[19][m] = 0.0;
+			climate.history->mprec_pet_20[19][m] = 0.0;
 		}
 	}
 
 	climate.mprec_petmin20 = mprec_petmin_thisyear;
 	climate.mprec_petmax20 = mprec_petmax_thisyear;
 	for (int y=startyear; y<20; y++) {
-		climate.mprec_petmin_20[y-1] = climate.mprec_petmin_20[y];
-		climate.mprec_petmin20 += climate.mprec_petmin_20[y];
-		climate.mprec_petmax_20[y-1] = climate.mprec_petmax_20[y];
-		climate.mprec_petmax20 += climate.mprec_petmax_20[y];
+		climate.history->mprec_petmin_20[y-1] = climate.history->mprec_petmin_20[y];
+		climate.mprec_petmin20 += climate.history->mprec_petmin_20[y];
+		climate.history->mprec_petmax_20[y-1] = climate.history->mprec_petmax_20[y];
+		climate.mprec_petmax20 += climate.history->mprec_petmax_20[y];
 	}
 	climate.mprec_petmin20 /= min(20, date.year + 1);
-	climate.mprec_petmin_20[19] = mprec_petmin_thisyear;
+	climate.history->mprec_petmin_20[19] = mprec_petmin_thisyear;
 	climate.mprec_petmax20 /= min(20, date.year + 1);
-	climate.mprec_petmax_20[19] = mprec_petmax_thisyear;
+	climate.history->mprec_petmax_20[19] = mprec_petmax_thisyear;
 }
 
 /// Determines climate seasonality of gridcell
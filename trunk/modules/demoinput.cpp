@@ -13,7 +13,10 @@
 #include "soilinput.h"
 #include "driver.h"
 #include "outputchannel.h"
+#include "ioforwarding.h"
+#include "archive.h"
 #include <stdio.h>
+#include <sstream>
 
 REGISTER_INPUT_MODULE("demo", DemoInput)
 
@@ -132,13 +135,21 @@ bool DemoInput::readenv(Coord coord, long& seed) {
 		}
 	}
 
-	bool gridfound = read_from_file(coord, file_temp, "f6.2,f5.2,i4,12f4.1", mtemp);
-	if(gridfound)
-		gridfound = read_from_file(coord, file_prec, "f6.2,f5.2,i4,12f4", mprec);
-	if(gridfound)
-		gridfound = read_from_file(coord, file_sun, "f6.2,f5.2,i4,12f3", msun);
-	if(gridfound)
-		gridfound = read_from_file(coord, file_soil, "f,f,i", msun, true);	// msun is not used here: just dummy
+	bool gridfound;
+
+	if (IOForwarding::active()) {
+		// The files have been read by the I/O process, see read_forcing
+		std::string buffer;
+		gridfound = IOForwarding::fetch(coord.lon, coord.lat, buffer);
+		if (gridfound) {
+			std::istringstream is(buffer);
+			ArchiveInStream arch(is);
+			arch & mtemp & mprec & msun & soilcode;
+		}
+	}
+	else {
+		gridfound = read_monthly(coord, mtemp, mprec, msun);
+	}
 
 	if(gridfound) {
 		// Interpolate monthly values for environmental drivers to daily values
@@ -154,6 +165,40 @@ bool DemoInput::readenv(Coord coord, long& seed) {
 	return gridfound;
 }
 
+bool DemoInput::read_monthly(Coord coord, double mtemp[12], double mprec[12], double msun[12]) {
+
+	bool gridfound = read_from_file(coord, file_temp, "f6.2,f5.2,i4,12f4.1", mtemp);
+	if(gridfound)
+		gridfound = read_from_file(coord, file_prec, "f6.2,f5.2,i4,12f4", mprec);
+	if(gridfound)
+		gridfound = read_from_file(coord, file_sun, "f6.2,f5.2,i4,12f3", msun);
+	if(gridfound)
+		gridfound = read_from_file(coord, file_soil, "f,f,i", msun, true);	// msun is not used here: just dummy
+
+	return gridfound;
+}
+
+bool DemoInput::read_forcing(double lon, double lat, std::string& buffer) {
+
+	// See base class for documentation about this function's responsibilities
+
+	Coord c;
+	c.lon = lon;
+	c.lat = lat;
+
+	double mtemp[12], mprec[12], msun[12];
+	if (!read_monthly(c, mtemp, mprec, msun)) {
+		return false;
+	}
+
+	std::ostringstream os;
+	ArchiveOutStream arch(os);
+	arch & mtemp & mprec & msun & soilcode;
+	buffer = os.str();
+
+	return true;
+}
+
 void DemoInput::init() {
 
 	// DESCRIPTION
@@ -183,6 +228,7 @@ void DemoInput::init() {
 
 	gridlist.killall();
 	first_call = true;
+	migrated_gridcell = false;
 
 	while (!eof) {
 
@@ -238,6 +284,8 @@ bool DemoInput::getgridcell(Gridcell& gridcell) {
 
 	bool LUerror = false;
 
+	migrated_gridcell = false;
+
 	// Make sure we use the first gridcell in the first call to this function,
 	// and then step through the gridlist in subsequent calls.
 
@@ -300,6 +348,29 @@ bool DemoInput::getgridcell(Gridcell& gridcell) {
 	return false; // no more stands
 }
 
+bool DemoInput::getmigratedgridcell(Gridcell& gridcell, double lon, double lat) {
+
+	// See base class for documentation about this function's responsibilities
+
+	Coord c;
+	c.lon = lon;
+	c.lat = lat;
+
+	// A new Gridcell starts from the same seed as in the sending process, so
+	// the weather generator gives the same daily precipitation
+	if (!readenv(c, gridcell.seed)) {
+		return false;
+	}
+
+	migrated_gridcell = true;
+
+	gridcell.set_coordinates(lon, lat);
+	gridcell.climate.instype = SUNSHINE;
+	soil_parameters(gridcell.soiltype, soilcode);
+
+	return true;
+}
+
 
 void DemoInput::getlandcover(Gridcell& gridcell) {
 
@@ -341,7 +412,7 @@ bool DemoInput::getclimate(Gridcell& gridcell) {
 
 		// Progress report to user and update timer
 
-		if (tmute.getprogress()>=1.0) {
+		if (tmute.getprogress()>=1.0 && !migrated_gridcell) {
 			progress=(double)(gridlist.getobj().id*(nyear_spinup+nyear)
 				+date.year)/(double)(gridlist.nobj*(nyear_spinup+nyear));
 
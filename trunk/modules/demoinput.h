@@ -51,6 +51,23 @@ public:
 	/// Obtains land management data for one day
 	void getmanagement(Gridcell& gridcell) {management_input.getmanagement(gridcell);}
 
+	/// Migration is supported unless land cover input is used
+	bool allows_migration() const { return !run_landcover; }
+
+	/// See base class for documentation about this function's responsibilities
+	bool getmigratedgridcell(Gridcell& gridcell, double lon, double lat);
+
+	/// The spinup and the simulation years after it
+	int get_simulation_years() const { return nyear_spinup + nyear; }
+
+	/// The monthly climate and soil code are forwarded, landcover is read locally
+	bool allows_forwarding() const { return true; }
+
+	/// See base class for documentation about this function's responsibilities
+	bool read_forcing(double lon, double lat, std::string& buffer);
+
+	int get_gridlist_size() const { return (int)gridlist.nobj; }
+
 private:
 
 	/// Land cover input module
@@ -65,6 +82,9 @@ private:
 	/// Reads in environmental data for a location
 	bool readenv(Coord coord, long& seed);
 
+	/// Reads monthly climate and the soil code for a location from the files
+	bool read_monthly(Coord coord, double mtemp[12], double mprec[12], double msun[12]);
+
 	/// number of simulation years to run after spinup
 	int nyear;
 
@@ -74,6 +94,9 @@ private:
 	/// Flag for getgridcell(). True indicates that the first gridcell has not been read yet by getgridcell()
 	bool first_call;
 
+	/// True while simulating a grid cell received from another process (not in the gridlist)
+	bool migrated_gridcell;
+
 	// Timers for keeping track of progress through the simulation
 	Timer tprogress,tmute;
 	static const int MUTESEC=20; // minimum number of sec to wait between progress messages
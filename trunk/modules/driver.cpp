@@ -55,6 +55,65 @@ double randfrac(long& seed) {
 	return (double)seed / fmodulus;
 }
 
+namespace {
+
+/// Mixes the bits of a 64 bit integer (the finalizer of SplitMix64)
+inline uint64_t mix64(uint64_t x) {
+	x ^= x >> 30;
+	x *= 0xbf58476d1ce4e5b9ULL;
+	x ^= x >> 27;
+	x *= 0x94d049bb133111ebULL;
+	x ^= x >> 31;
+	return x;
+}
+
+/// Adds a value to a hash key
+inline uint64_t hash_combine(uint64_t key, uint64_t value) {
+	return mix64(key ^ (value + 0x9e3779b97f4a7c15ULL + (key << 6) + (key >> 2)));
+}
+
+/// The bits of a double, so coordinates can be part of a key
+inline uint64_t double_bits(double d) {
+	uint64_t bits;
+	memcpy(&bits, &d, sizeof(bits));
+	return bits;
+}
+
+}
+
+RandomStream::RandomStream(const Patch& patch, RandomProcess process) {
+	const Stand& stand = patch.stand;
+	const Gridcell& gridcell = stand.get_gridcell();
+
+	init(gridcell.get_lon(), gridcell.get_lat(), stand.id, patch.id,
+	     date.year, date.day, process);
+}
+
+RandomStream::RandomStream(double lon, double lat, int stand, int patch,
+                           int year, int day, RandomProcess process) {
+	init(lon, lat, stand, patch, year, day, process);
+}
+
+void RandomStream::init(double lon, double lat, int stand, int patch,
+                        int year, int day, RandomProcess process) {
+	key = mix64((uint64_t)randomseed);
+	key = hash_combine(key, double_bits(lon));
+	key = hash_combine(key, double_bits(lat));
+	key = hash_combine(key, (uint64_t)stand);
+	key = hash_combine(key, (uint64_t)patch);
+	key = hash_combine(key, (uint64_t)year);
+	key = hash_combine(key, (uint64_t)day);
+	key = hash_combine(key, (uint64_t)process);
+	counter = 0;
+}
+
+double RandomStream::randfrac() {
+	const uint64_t x = mix64(key + mix64(++counter));
+
+	// the upper 53 bits, shifted half a step to exclude 0 and 1
+	return ((double)(x >> 11) + 0.5) / 9007199254740992.0;
+}
+
 /// Generates quasi-daily values for a single month, based on monthly means
 /**
  *  The generated daily values will conserve the monthly mean.
@@ -614,22 +673,22 @@ void dailyaccounting_gridcell(Gridcell& gridcell) {
 			climate.mtemp_max20 = climate.mtemp_max;
 
 			for (y=startyear; y<20; y++) {
-				climate.mtemp_min_20[y-1] = climate.mtemp_min_20[y];
-				climate.mtemp_min20 += climate.mtemp_min_20[y];
-				climate.mtemp_max_20[y-1] = climate.mtemp_max_20[y];
-				climate.mtemp_max20 += climate.mtemp_max_20[y];
+				climate.history->mtemp_min_20[y-1] = climate.history->mtemp_min_20[y];
+				climate.mtemp_min20 += climate.history->mtemp_min_20[y];
+				climate.history->mtemp_max_20[y-1] = climate.history->mtemp_max_20[y];
+				climate.mtemp_max20 += climate.history->mtemp_max_20[y];
 			}
 
 			climate.mtemp_min20 /= (double)(21 - startyear);
 			climate.mtemp_max20 /= (double)(21 - startyear);
-			climate.mtemp_min_20[19] = climate.mtemp_min;
-			climate.mtemp_max_20[19] = climate.mtemp_max;
+			climate.history->mtemp_min_20[19] = climate.mtemp_min;
+			climate.history->mtemp_max_20[19] = climate.mtemp_max;
 			climate.agdd0_20.add(climate.agdd0);
 		}
 
-		climate.hmtemp_20[date.month].add(climate.dtemp_31.periodicmean(date.ndaymonth[date.month]));
-		climate.hmprec_20[date.month].add(climate.dprec_31.periodicsum(date.ndaymonth[date.month]));
-		climate.hmeet_20[date.month].add(climate.deet_31.periodicsum(date.ndaymonth[date.month]));
+		climate.history->hmtemp_20[date.month].add(climate.dtemp_31.periodicmean(date.ndaymonth[date.month]));
+		climate.history->hmprec_20[date.month].add(climate.dprec_31.periodicsum(date.ndaymonth[date.month]));
+		climate.history->hmeet_20[date.month].add(climate.deet_31.periodicsum(date.ndaymonth[date.month]));
 	}
 }
 
@@ -707,21 +766,21 @@ void dailyaccounting_patch(Patch& patch) {
 		dailyaccounting_patch_lc(patch);
 
 	// Store daily soil water in both layers
-	soil.dwcontupper[date.day] = soil.get_soil_water_upper();
-	soil.dwcontlower[date.day] = soil.get_soil_water_lower();
+	soil.history->dwcontupper[date.day] = soil.get_soil_water_upper();
+	soil.history->dwcontlower[date.day] = soil.get_soil_water_lower();
 
-	soil.mwcontupper += soil.dwcontupper[date.day];
-	soil.mwcontlower += soil.dwcontlower[date.day];
+	soil.mwcontupper += soil.history->dwcontupper[date.day];
+	soil.mwcontlower += soil.history->dwcontlower[date.day];
 
 	// On last day of month, calculate mean content of upper and lower soil layers
 
 	if (date.islastday) {
 
-		soil.mwcontupper = mean(soil.dwcontupper + date.day - date.ndaymonth[date.month] + 1,
+		soil.mwcontupper = mean(soil.history->dwcontupper + date.day - date.ndaymonth[date.month] + 1,
 			date.ndaymonth[date.month]);
 
 		// guess2008 - record water in lower layer too, and then update mwcont
-		soil.mwcontlower = mean(soil.dwcontlower + date.day - date.ndaymonth[date.month] + 1,
+		soil.mwcontlower = mean(soil.history->dwcontlower + date.day - date.ndaymonth[date.month] + 1,
 			date.ndaymonth[date.month]);
 
 		soil.mwcont[date.month][0] = soil.mwcontupper;
@@ -792,7 +851,7 @@ void dailyaccounting_patch(Patch& patch) {
 	soil.mthaw[date.month] += soil.thaw / mdays;
 
 	// needed for fire
-	soil.dthaw[date.day] = soil.thaw;
+	soil.history->dthaw[date.day] = soil.thaw;
 
 	patch.is_litter_day = false;
 	patch.isharvestday = false;
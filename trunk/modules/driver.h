@@ -17,8 +17,58 @@
 #include "guess.h"
 #include <limits>
 #include <map>
+#include <stdint.h>
+
 double randfrac(long& seed);
 
+/// Stochastic processes drawing random numbers from a RandomStream
+/** Part of the key of the stream, so each process gets its own numbers */
+enum RandomProcess {
+	RANDOM_ESTABLISHMENT,
+	RANDOM_MORTALITY,
+	RANDOM_FIRE,
+	RANDOM_DISTURBANCE,
+	RANDOM_BLAZE
+};
+
+/// Counter-based random numbers for one process in one patch on one day
+/** The numbers are a hash of a key (random seed, grid cell coordinates,
+ *  stand, patch, simulation year, day and process) and the number of values
+ *  drawn so far from the stream, rather than the next state of a generator
+ *  shared with other patches. What a patch draws therefore doesn't depend on
+ *  how many numbers were drawn before by other patches, or by other
+ *  processes, so patches can be simulated in any order and give the same
+ *  results. The streams have no state to save in state files either.
+ *
+ *  Create a stream where a process starts drawing numbers for a patch and
+ *  draw all numbers for that patch and day from it (creating a new stream
+ *  with the same key would give the same numbers again).
+ */
+class RandomStream {
+public:
+	/// Creates the stream of a process for a patch on the current day
+	RandomStream(const Patch& patch, RandomProcess process);
+
+	/// Creates a stream with an explicit key
+	RandomStream(double lon, double lat, int stand, int patch,
+	             int year, int day, RandomProcess process);
+
+	/// Returns the next random number, in the range 0-1 (exclusive)
+	double randfrac();
+
+private:
+	void init(double lon, double lat, int stand, int patch,
+	          int year, int day, RandomProcess process);
+
+	uint64_t key;
+	uint64_t counter;
+};
+
+/// Returns the next random number from a stream, \see RandomStream::randfrac()
+inline double randfrac(RandomStream& stream) {
+	return stream.randfrac();
+}
+
 void interp_monthly_means_conserve(const double* mvals, double* dvals,
 	double minimum = -std::numeric_limits<double>::max(),
 	double maximum = std::numeric_limits<double>::max());
@@ -37,6 +37,7 @@
 #include "growth.h"
 #include "canexch.h"
 #include "landcover.h"
+#include "solverstats.h"
 #include <assert.h>
 
 
@@ -163,6 +164,7 @@ void leaf_phenology(Patch& patch, Climate& climate) {
 
 		// For this individual ...
 		indiv.phen = patch.pft[indiv.pft.id].phen;
+		indiv.invalidate_day_cache();
 
 		// Update annual leaf-day sum (raingreen PFTs)
 		if (date.day == 0) indiv.aphen_raingreen = 0;
@@ -570,12 +572,19 @@ void allocation(double bminc,double cmass_leaf,double cmass_root,double cmass_sa
 
 			xmid = x1;
 
+			int nscan = 0; // number of segments searched
+
 			while (fmid * fx1 > 0.0 && xmid < x2) {
 
 				xmid += dx;
 				fmid = f(xmid);
+				nscan++;
 			}
 
+#ifdef SOLVER_STATISTICS
+			const bool bracketed = fmid * fx1 <= 0.0;
+#endif
+
 			x1 = xmid - dx;
 			x2 = xmid;
 
@@ -605,6 +614,9 @@ void allocation(double bminc,double cmass_leaf,double cmass_root,double cmass_sa
 				j++;
 			}
 
+			SOLVER_RECORD(SOLVER_ALLOCATION, nscan + j, j > JMAX,
+			              bracketed && (dx < XACC || fabs(fmid) <= YACC));
+
 			// Now rtbis contains numerical solution for cmass_leaf_inc given Eqn (13)
 
 			cmass_leaf_inc = rtbis;
@@ -921,6 +933,7 @@ bool allometry(Individual& indiv) {
 	// guess2008 - max tree height allowed (metre).
 	const double HEIGHT_MAX = 150.0;
 
+	indiv.invalidate_day_cache();
 
 	if (indiv.pft.lifeform == TREE) {
 
@@ -1145,12 +1158,11 @@ void growth(Stand& stand, Patch& patch) {
 	Vegetation& vegetation = patch.vegetation;
 	Gridcell& gridcell = vegetation.patch.stand.get_gridcell();
 
-	// On first call to function growth this year (patch #0), initialise stand-PFT
-	// record of summed allocation to reproduction
+	// Initialise patch-PFT record of allocation to reproduction, summed for
+	// the stand by stand_reproduction
 
-	if (!patch.id)
-		for (p=0; p<npft; p++)
-			stand.pft[p].cmass_repr = 0.0;
+	for (p=0; p<npft; p++)
+		patch.pft[p].cmass_repr = 0.0;
 
 	// Loop through individuals
 
@@ -1271,8 +1283,8 @@ void growth(Stand& stand, Patch& patch) {
 						indiv.nstore_longterm,indiv.max_n_storage,
 						indiv.alive);
 				}
-				// Update stand record of reproduction by this PFT
-				stand.pft[indiv.pft.id].cmass_repr += cmass_repr / (double)stand.npatch();
+				// Update patch record of reproduction by this PFT
+				patch.pft[indiv.pft.id].cmass_repr += cmass_repr;
 
 				// Transfer reproduction straight to litter
 				// only for 'alive' individuals
@@ -1540,6 +1552,24 @@ void growth(Stand& stand, Patch& patch) {
 }
 
 
+/// Sums the allocation to reproduction of all patches for each Standpft
+/** Should be called by framework at the end of each simulation year after
+ *  growth for every patch of the stand, prior to vegetation dynamics.
+ *  Summing in patch order once all patches are done keeps the result the same
+ *  whatever order the patches are simulated in.
+ */
+void stand_reproduction(Stand& stand) {
+
+	for (int p=0; p<npft; p++) {
+		double cmass_repr = 0.0;
+		for (unsigned int i=0; i<stand.npatch(); i++) {
+			cmass_repr += stand[i].pft[p].cmass_repr;
+		}
+		stand.pft[p].cmass_repr = cmass_repr / (double)stand.npatch();
+	}
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////////////
 // REFERENCES
 //
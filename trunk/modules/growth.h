@@ -24,6 +24,7 @@ void leaf_phenology(Patch& patch,Climate& climate);
 bool allometry(Individual& indiv); // guess2008 - now returns bool instead of void
 void allocation_init(double bminit,double ltor,Individual& indiv);
 void growth(Stand& stand,Patch& patch);
+void stand_reproduction(Stand& stand);
 void turnover(double turnover_leaf, double turnover_root, double turnover_sap,
 	lifeformtype lifeform, landcovertype landcover, double& cmass_leaf, double& cmass_root, double& cmass_sap,
 	double& cmass_heart, double& nmass_leaf, double& nmass_root, double& nmass_sap,
@@ -256,6 +256,7 @@ struct landcover_change_transfer {
 		transfer_wcont_evap = from.transfer_wcont_evap;
 		transfer_decomp_litter_mean = from.transfer_decomp_litter_mean;
 		transfer_k_soilfast_mean = from.transfer_k_soilfast_mean;
+		transfer_k_soilslow_mean = from.transfer_k_soilslow_mean;
 		for(int i=0; i<NSOMPOOL; i++) {
 			transfer_sompool[i].cmass = from.transfer_sompool[i].cmass;
 			transfer_sompool[i].fireresist = from.transfer_sompool[i].fireresist;
@@ -328,6 +329,7 @@ struct landcover_change_transfer {
 		transfer_wcont_evap += from.transfer_wcont_evap * multiplier;
 		transfer_decomp_litter_mean += from.transfer_decomp_litter_mean * multiplier;
 		transfer_k_soilfast_mean += from.transfer_k_soilfast_mean * multiplier;
+		transfer_k_soilslow_mean += from.transfer_k_soilslow_mean * multiplier;
 		for(int i=0; i<NSOMPOOL; i++) {
 			transfer_sompool[i].cmass += from.transfer_sompool[i].cmass * multiplier;
 			transfer_sompool[i].fireresist += from.transfer_sompool[i].fireresist * multiplier;
@@ -11,6 +11,7 @@
 #include "miscoutput.h"
 #include "parameters.h"
 #include "guess.h"
+#include "solverstats.h"
 
 namespace GuessOutput {
 
@@ -50,6 +51,9 @@ MiscOutput::MiscOutput() {
 	declare_parameter("file_cflux_peatland", &file_cflux_peatland, 300, "C fluxes output file");
 	declare_parameter("file_dens_natural", &file_dens_natural, 300, "Natural vegetation tree density output file");
 	declare_parameter("file_dens_forest", &file_dens_forest, 300, "Managed forest tree density output file");
+	declare_parameter("file_cohort_merges", &file_cohort_merges, 300, "Annual cohort merges output file");
+	declare_parameter("file_solverstats", &file_solverstats, 300, "Annual solver iteration counts output file");
+	declare_parameter("file_solverhist", &file_solverhist, 300, "Annual solver iteration histogram output file");
 	declare_parameter("file_cpool_cropland", &file_cpool_cropland, 300, "Soil C output file");
 	declare_parameter("file_cpool_pasture", &file_cpool_pasture, 300, "Soil C output file");
 	declare_parameter("file_cpool_natural", &file_cpool_natural, 300, "Soil C output file");
@@ -117,7 +121,15 @@ MiscOutput::~MiscOutput() {
 
 /// Define all output tables and their formats
 void MiscOutput::init() {
-	
+
+#ifndef SOLVER_STATISTICS
+	if (file_solverstats != "" || file_solverhist != "") {
+		dprintf("WARNING ! Solver statistics output requires a build with SOLVER_STATISTICS defined (see config.h), no output written\n");
+		file_solverstats = "";
+		file_solverhist = "";
+	}
+#endif
+
 	define_output_tables();
 }
 
@@ -186,6 +198,29 @@ void MiscOutput::define_output_tables() {
 	dens_columns += ColumnDescriptor("Total",              8, 4);
 	ColumnDescriptors dens_columns_lc = dens_columns;
 
+	// COHORT MERGES
+	ColumnDescriptors cohort_merges_columns;
+	cohort_merges_columns += ColumnDescriptors(pfts,       8, 2);
+	cohort_merges_columns += ColumnDescriptor("Total",     8, 2);
+	cohort_merges_columns += ColumnDescriptor("Cohorts",   8, 1);
+
+	// SOLVER STATISTICS
+	ColumnDescriptors solverstats_columns;
+	ColumnDescriptors solverhist_columns;
+	for (int s = 0; s < NSOLVERTYPES; s++) {
+		std::string name = SolverStats::name((solvertype)s);
+		solverstats_columns += ColumnDescriptor((name + "N").c_str(),     13, 0);
+		solverstats_columns += ColumnDescriptor((name + "Mean").c_str(),  13, 3);
+		solverstats_columns += ColumnDescriptor((name + "Max").c_str(),   13, 0);
+		solverstats_columns += ColumnDescriptor((name + "Atmax").c_str(), 13, 0);
+		solverstats_columns += ColumnDescriptor((name + "Nconv").c_str(), 13, 0);
+		for (int i = 0; i < NSOLVERBINS; i++) {
+			xtring title;
+			title.printf("%s_%d", name.c_str(), SolverStats::bin_lower_bound(i));
+			solverhist_columns += ColumnDescriptor((char*)title, 12, 0);
+		}
+	}
+
 	// CFLUX
 	ColumnDescriptors cflux_columns;
 	cflux_columns += ColumnDescriptor("Veg",               8, 3);
@@ -302,6 +337,9 @@ void MiscOutput::define_output_tables() {
 	create_output_table(out_anpp_peatland, file_anpp_peatland, anpp_columns_lc);
 	create_output_table(out_dens_natural,   file_dens_natural,   dens_columns_lc);
 	create_output_table(out_dens_forest,    file_dens_forest,    dens_columns_lc);
+	create_output_table(out_cohort_merges,  file_cohort_merges,  cohort_merges_columns);
+	create_output_table(out_solverstats,    file_solverstats,    solverstats_columns);
+	create_output_table(out_solverhist,     file_solverhist,     solverhist_columns);
 	create_output_table(out_cflux_cropland, file_cflux_cropland, cflux_columns);
 	create_output_table(out_cflux_pasture,  file_cflux_pasture,  cflux_columns);
 	create_output_table(out_cflux_natural,  file_cflux_natural,  cflux_columns);
@@ -389,6 +427,28 @@ void MiscOutput::define_output_tables() {
 		create_output_table(out_daily_storage,			file_daily_storage,				daily_columns);
 	}
 
+	// The expensive parts of outannual, and the tables depending on them
+	OutputVariableRegistry& registry = OutputVariableRegistry::get_instance();
+
+	registry.declare_computation("misc/pft_vegetation", OUTPUT_COST_INDIVIDUAL);
+	Table* pft_tables[] = { &out_cmass_pasture, &out_cmass_natural, &out_cmass_forest,
+	                        &out_cmass_peatland, &out_anpp_pasture, &out_anpp_natural,
+	                        &out_anpp_forest, &out_anpp_peatland, &out_dens_natural,
+	                        &out_dens_forest, &out_yield, &out_yield1, &out_yield2,
+	                        &out_sdate1, &out_sdate2, &out_hdate1, &out_hdate2,
+	                        &out_lgp, &out_phu, &out_fphu, &out_fhi };
+	for (size_t i = 0; i < sizeof(pft_tables) / sizeof(pft_tables[0]); i++) {
+		registry.depends(*pft_tables[i], "misc/pft_vegetation");
+	}
+
+	// The per-stand output is written in the PFT loop, and uses the
+	// stand totals summed up in both CommonOutput's and our PFT loop
+	registry.declare_computation("misc/stand_totals", OUTPUT_COST_GRIDCELL);
+	registry.depends("misc/stand_totals", "misc/pft_vegetation");
+	registry.depends("misc/stand_totals", "common/pft_vegetation");
+	if (printseparatestands) {
+		registry.require("misc/stand_totals");
+	}
 }
 
 /// Local analogue of OutputRows::add_value for restricting output
@@ -447,8 +507,11 @@ void MiscOutput::outannual(Gridcell& gridcell) {
 	double standpft_yield2=0.0;
 	double standpft_densindiv_total=0.0;
 
+	// Not at all if none of its output is selected
+	const bool pft_vegetation = OutputVariableRegistry::get_instance().needed("misc/pft_vegetation");
+
 	pftlist.firstobj();
-	while (pftlist.isobj) {
+	while (pft_vegetation && pftlist.isobj) {
 
 		Pft& pft=pftlist.getobj();
 
@@ -1099,6 +1162,58 @@ void MiscOutput::outannual(Gridcell& gridcell) {
 	outlimit_misc(out, out_seasonality,   gridcell.climate.prec_range);
 	outlimit_misc(out, out_seasonality,   gridcell.climate.co2);
 	outlimit_misc(out, out_seasonality,   gridcell.climate.rad);
+
+	// Output of cohort merges (mean per patch) and mean number of cohorts per patch
+	if (!out_cohort_merges.invalid()) {
+
+		std::vector<double> merges(npft, 0.0);
+		double merges_total = 0.0;
+		double ncohorts = 0.0;
+
+		Gridcell::iterator gc_itr = gridcell.begin();
+		while (gc_itr != gridcell.end()) {
+			Stand& stand = *gc_itr;
+			double weight = stand.get_gridcell_fraction() / (double)stand.npatch();
+
+			stand.firstobj();
+			while (stand.isobj) {
+				Patch& patch = stand.getobj();
+
+				patch.pft.firstobj();
+				while (patch.pft.isobj) {
+					Patchpft& patchpft = patch.pft.getobj();
+					merges[patchpft.id] += patchpft.cohort_merges * weight;
+					merges_total += patchpft.cohort_merges * weight;
+					patch.pft.nextobj();
+				}
+
+				ncohorts += patch.vegetation.nobj * weight;
+				stand.nextobj();
+			}
+			++gc_itr;
+		}
+
+		for (int p = 0; p < npft; p++) {
+			outlimit_misc(out, out_cohort_merges, merges[p]);
+		}
+		outlimit_misc(out, out_cohort_merges, merges_total);
+		outlimit_misc(out, out_cohort_merges, ncohorts);
+	}
+
+	// Solver iteration counts for this year, also during the spinup
+	for (int s = 0; s < NSOLVERTYPES; s++) {
+		const SolverCounters& counters = SolverStats::year((solvertype)s);
+
+		out.add_value(out_solverstats, counters.calls);
+		out.add_value(out_solverstats, counters.mean_iterations());
+		out.add_value(out_solverstats, counters.max_iterations);
+		out.add_value(out_solverstats, counters.max_reached);
+		out.add_value(out_solverstats, counters.not_converged);
+
+		for (int i = 0; i < NSOLVERBINS; i++) {
+			out.add_value(out_solverhist, counters.histogram[i]);
+		}
+	}
 }
 
 /// Output of simulation results at the end of each day
@@ -69,7 +69,8 @@ private:
 		   file_soil_nflux_natural, file_soil_nflux_forest,
 		   file_cmass_peatland, file_cflux_peatland,
 		   file_cpool_peatland, file_nflux_peatland, file_npool_peatland,
-		   file_anpp_peatland;
+		   file_anpp_peatland, file_cohort_merges,
+		   file_solverstats, file_solverhist;
 
 	// daily
 	xtring file_daily_lai, file_daily_npp, file_daily_nmass, file_daily_cmass,
@@ -102,7 +103,8 @@ private:
 		  out_soil_nflux_natural, out_soil_nflux_forest,
 		  out_cflux_peatland, out_cpool_peatland,
 		  out_nflux_peatland, out_npool_peatland, out_cmass_peatland,
-		  out_anpp_peatland;
+		  out_anpp_peatland, out_cohort_merges,
+		  out_solverstats, out_solverhist;
 
 	Table* out_anpp_stand[MAXNUMBER_STANDS];
 	Table* out_cmass_stand[MAXNUMBER_STANDS];
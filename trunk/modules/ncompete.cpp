@@ -13,6 +13,7 @@
 #include "guessmath.h"
 #include <assert.h>
 #include "driver.h"
+#include "solverstats.h"
 
 void ncompete(std::vector<NCompetingIndividual>& individuals, double nmass_avail) {
 	double nsupply = nmass_avail;		// Nitrogen available for uptake
@@ -31,8 +32,11 @@ void ncompete(std::vector<NCompetingIndividual>& individuals, double nmass_avail
 										// could be taken up per unit strength (starts with true to
 										// get into while loop)
 
+	int npasses = 0;					// for the solver statistics
+
 	while (full_uptake) {
 		full_uptake = false;
+		npasses++;
 
 		double ratio_uptake;				// Nitrogen per uptake strength
 
@@ -79,4 +83,26 @@ void ncompete(std::vector<NCompetingIndividual>& individuals, double nmass_avail
 			}
 		}
 	}
+
+#ifdef SOLVER_STATISTICS
+	// The distribution has converged if no individual gets more than its
+	// demand and the individuals together don't take up more than is
+	// available (the supply left over can go negative by rounding)
+	double nuptake = 0.0;
+	bool converged = true;
+	for (size_t i = 0; i < individuals.size(); ++i) {
+		const NCompetingIndividual& indiv = individuals[i];
+		if (indiv.fnuptake < 0.0 || indiv.fnuptake > 1.0) {
+			converged = false;
+		}
+		nuptake += indiv.fnuptake * indiv.ndemand;
+	}
+	if (nuptake > nmass_avail && !negligible((nuptake - nmass_avail) / nmass_avail, -9)) {
+		converged = false;
+	}
+#endif
+
+	// Each pass but the last satisfies the demand of one more individual,
+	// so the number of passes can't exceed the number of individuals + 1
+	SOLVER_RECORD(SOLVER_NCOMPETE, npasses, npasses > (int)individuals.size() + 1, converged);
 }
@@ -43,24 +43,173 @@
 #include "ntransform.h"
 #include <assert.h>
 #include <numeric>
+#include <vector>
+
+// The transformations of all patches of a stand are done together, after the
+// stand's patches have been simulated for the day (see ntransform.h). The
+// temperature and moisture response functions are evaluated for all queued
+// patches in one pass, from drivers stored when a patch was queued, before
+// the nitrogen pools are updated patch by patch. Each response function is
+// evaluated once per patch and day, and the result is the same as with the
+// transformations done patch by patch.
+
+namespace {
+
+/// Patches queued for today's nitrogen transformations, with their drivers and response functions
+struct NTransformBatch {
+
+	std::vector<Patch*> patches;
+
+	// Drivers, stored by ntransform_add()
+
+	/// Soil temperature at 25 cm (deg C)
+	std::vector<double> soil_T;
+	/// Water content of the upper soil layer (fraction of available water holding capacity)
+	std::vector<double> wcont;
+	/// Water filled pore space of the upper soil layer
+	std::vector<double> wfps;
+	/// Water content of the upper soil layer (m3), removes the per m3 from the constants KC and KN
+	std::vector<double> water_cont_m3;
+
+	// Response functions, evaluated by ntransform_run()
+
+	/// Temperature limiting factor for volatilization and gas emission, 25 deg C == 1
+	std::vector<double> f_temp_25;
+	/// pH effect on NH3 volatilization
+	std::vector<double> f_nh3_pH;
+	/// Wet (anaerobic) fraction of the soil substrates
+	std::vector<double> wet;
+	/// Moisture limiting factor for nitrification
+	std::vector<double> nit_act;
+	/// Temperature limiting factor for nitrification, 38 deg C == 1
+	std::vector<double> f_nit_T;
+	/// Fraction of nitrification gases emitted as NO
+	std::vector<double> f_no;
+	/// Temperature limiting factor for denitrification, 22 deg C == 1
+	std::vector<double> f_den_T;
+	/// Moisture limiting factor for denitrification
+	std::vector<double> f_den_w;
+	/// Temperature effect on the N2 to N2O ratio from denitrification
+	std::vector<double> f_n2_n2o_T;
+	/// Moisture effect on the N2O to N2 ratio from denitrification
+	std::vector<double> f_n2o_n2_w;
+
+	void resize(size_t n) {
+		f_temp_25.resize(n);
+		f_nh3_pH.resize(n);
+		wet.resize(n);
+		nit_act.resize(n);
+		f_nit_T.resize(n);
+		f_no.resize(n);
+		f_den_T.resize(n);
+		f_den_w.resize(n);
+		f_n2_n2o_T.resize(n);
+		f_n2o_n2_w.resize(n);
+	}
+
+	void clear() {
+		patches.clear();
+		soil_T.clear();
+		wcont.clear();
+		wfps.clear();
+		water_cont_m3.clear();
+	}
+};
+
+/// The patches queued since the last ntransform_run(), the buffers are kept between days
+NTransformBatch batch;
+
+/// Evaluates the temperature and moisture response functions for all queued patches
+void response_functions(NTransformBatch& b) {
+
+	const size_t n = b.patches.size();
+	b.resize(n);
+
+	// Constants of the moisture limitation of nitrification
+	const double nit_b = log(3.0) * 5.0;
+	const double nit_a = exp(-nit_b*6.0/10.0);
+
+	for (size_t i = 0; i < n; i++) {
+
+		const double soil_T = b.soil_T[i];
+		const double wcont = b.wcont[i];
+		const double wfps = b.wfps[i];
+
+		// temperature limiting factor for volatilization and gas emission, 25 degree C == 1
+		// (table 5, eqn 7 and table 10, eqn 1, Xu-Ri 2008)
+		if (soil_T >= -40.0) {
+			b.f_temp_25[i] = min(1.0, exp(308.56 * (1.0 / 71.02 - 1.0 / (soil_T + 46.02))));
+		}
+		else {
+			b.f_temp_25[i] = 0.0;
+		}
+
+		// pH effect on volatilization (table 5, eqn 6, Xu-Ri 2008), the same for
+		// all patches of a stand unless the soil type gives the pH
+		const double pH = b.patches[i]->soil.pH;
+		if (i > 0 && pH == b.patches[i-1]->soil.pH) {
+			b.f_nh3_pH[i] = b.f_nh3_pH[i-1];
+		}
+		else {
+			b.f_nh3_pH[i] = exp(2.0 * (pH - 10.0));
+		}
+
+		// An S-curve fitted to the linear increase in
+		// denitrifier activity above roughly 50% WFPS with the steepest
+		// change around 66% ending up at 100% around 75%.
+		// Meaning that there is no nitrification at that WFPS.
+		// Derived from Pilegaard 2013
+		b.wet[i] = richards_curve(0.05,0.95,7.5,0.5,wcont);
+
+		double act_dry = nit_a*exp(wcont*nit_b);
+		double act_wet = max(0.0,4.0-5.0*wcont);
+		b.nit_act[i] = min(act_dry,act_wet);
+
+		// f_nit_T, temperature limiting factor for nitrification, 38 deg C == 1 (table 8, eqn 2, Xu-Ri 2008)
+		if (soil_T < 70.0) {
+			b.f_nit_T[i] = min(1.0, pow((70.0 - soil_T) / (70.0 - 38.0), 12.0) * exp(12.0 * (soil_T - 38.0) / (70.0 - 38.0)));
+		}
+		else {
+			b.f_nit_T[i] = 0.0;
+		}
+
+		// Pilegaard 2013
+		// only NO and N2O in nitrification
+		b.f_no[i] = richards_curve(1.0, 0.5, 20.0, 0.375, wfps);
+
+		// Denitrification only in wet soils
+		if (b.water_cont_m3[i] > 0.0 && wfps > 0.4) {
+
+			// temperature limiting factor for denitrification, 22 deg C == 1 (table 9, eqn 1, Xu-Ri 2008)
+			if (soil_T >= -40.0) {
+				b.f_den_T[i] = min(1.0, exp(308.56 * (1.0 / 68.02 - 1.0 / (soil_T + 46.02))));
+			}
+			else {
+				b.f_den_T[i] = 0.0;
+			}
+
+			// Denitrification rate dependence on moisture, Weier et al. 1993
+			b.f_den_w[i] = min(1.0, exp(13.0360 * wfps - 11.6219));
+
+			b.f_n2_n2o_T[i] = 1.0 / (1.0 + exp(-(soil_T - 5.0) / 10.0));
+
+			b.f_n2o_n2_w[i] = richards_curve(1.0, 0.0, 62.0, 0.875, wfps); // Decimals added to be consistent with other richards_curve calls
+		}
+	}
+}
 
 /// Soil NH3 volatilization
 /** Daily calculation of NH3 volatilization from soil
  *
  */
-void nh3_volatilization(Patch& patch, Soil& soil, Climate& climate, double& n_budget_check){
+void nh3_volatilization(const NTransformBatch& b, size_t i, double& n_budget_check){
 
-	double nh3_max = 0.0, f_nit_T = 0.0, nh3_inc = 0.0;
-	double soil_T = soil.get_soil_temp_25();
-	double wcont = soil.get_soil_water_upper();
+	Patch& patch = *b.patches[i];
+	Soil& soil = patch.soil;
 
-	// calculating soil pH value, aprec = daily mean precip, based on annual average
-	if (soil.soiltype.pH > 0.0) {
-		soil.pH = soil.soiltype.pH;
-	} 
-	else {
-		soil.pH = 3810 / (762 + (climate.aprec_lastyear)) + 3.5; // Dawson -77
-	}
+	double nh3_max = 0.0, nh3_inc = 0.0;
+	double wcont = b.wcont[i];
+	double f_nit_T = b.f_temp_25[i];
 
 	if (soil.pH > 6.0) { 
 		nh3_max = 0.001; // Maximum conversion ratio from NH4_mass to NH3 gas
@@ -73,16 +222,8 @@ void nh3_volatilization(Patch& patch, Soil& soil, Climate& climate, double& n_bu
 	// Total budget before N transformations
 	n_budget_check = soil.NH4_mass + soil.NO3_mass + soil.NO2_mass + soil.NO_mass + soil.N2O_mass + soil.N2_mass;
 
-	// temperature limiting factor for volatilization, 25 degree C == 1 (table 5, eqn 7, Xu-Ri 2008)
-	if (soil_T >= -40.0) {
-		f_nit_T = min(1.0, exp(308.56 * (1.0 / 71.02 - 1.0 / (soil_T + 46.02))));
-	}
-	else {
-		f_nit_T = 0.0;
-	}
-
 	// NH3 increment (table 5, eqn 2, 3, 4, 6, Xu-Ri 2008)
-	nh3_inc = min(soil.NH4_mass, nh3_max * (min(1.0, wcont) * (1.0 - min(1.0, wcont))) * f_nit_T * f_nit_T * exp(2.0 * (soil.pH - 10.0)) * soil.NH4_mass);
+	nh3_inc = min(soil.NH4_mass, nh3_max * (min(1.0, wcont) * (1.0 - min(1.0, wcont))) * f_nit_T * f_nit_T * b.f_nh3_pH[i] * soil.NH4_mass);
 
 	soil.NH4_mass -= nh3_inc;
 
@@ -98,16 +239,11 @@ void nh3_volatilization(Patch& patch, Soil& soil, Climate& climate, double& n_bu
 /** Daily calculation of nitrogen substrate partition 
  *  between aerobic and anaerobic soil fractions
  */
-void substrate_partition(Soil& soil){
+void substrate_partition(const NTransformBatch& b, size_t i){
 
-	// An S-curve fitted to the linear increase in
-	// denitrifier activity above roughly 50% WFPS with the steepest
-	// change around 66% ending up at 100% around 75%.
-	// Meaning that there is no nitrification at that WFPS.
-	// Derived from Pilegaard 2013
+	Soil& soil = b.patches[i]->soil;
 
-	double wcont = soil.get_soil_water_upper();
-	double wet = richards_curve(0.05,0.95,7.5,0.5,wcont);
+	double wet = b.wet[i];
 
 	soil.NH4_mass_w = soil.NH4_mass * wet;
 	soil.NO3_mass_w = soil.NO3_mass * wet;
@@ -129,39 +265,21 @@ void substrate_partition(Soil& soil){
 /** Daily calculation of nitrification, and nitrification
  *  induced trace gas emissions 
  */
-void nitrification(Patch& patch, Soil& soil) {
+void nitrification(const NTransformBatch& b, size_t i) {
 
-	double b = log(3.0) * 5.0;
-	double a = exp(-b*6.0/10.0);
-	double wcont = soil.get_soil_water_upper();
-	double act_dry = a*exp(wcont*b);
-	double act_wet = max(0.0,4.0-5.0*wcont);
-	double nit_act = min(act_dry,act_wet);
+	Patch& patch = *b.patches[i];
+	Soil& soil = patch.soil;
 
-	double f_nit_T, no3_inc, no_inc, n2o_inc, gross_nitrif;
-	double soil_T = soil.get_soil_temp_25();
+	double no3_inc, no_inc, n2o_inc, gross_nitrif;
 
-	// f_nit_T, temperature limiting factor for nitrification, 38 deg C == 1 (table 8, eqn 2, Xu-Ri 2008)
-	if (soil_T < 70.0) {
-		f_nit_T = min(1.0, pow((70.0 - soil_T) / (70.0 - 38.0), 12.0) * exp(12.0 * (soil_T - 38.0) / (70.0 - 38.0)));
-	}
-	else {
-		f_nit_T = 0.0;
-	}
 	// gross nitrification rate, NH4_mass converted to NO3_mass (table 8, eqn 1, Xu-Ri 2008)
-	no3_inc          = f_nitri_max * nit_act * f_nit_T * soil.NH4_mass_d;
+	no3_inc          = f_nitri_max * b.nit_act[i] * b.f_nit_T[i] * soil.NH4_mass_d;
 	gross_nitrif     = no3_inc;
 	soil.NH4_mass_d -= no3_inc;
 
 	double ngas_inc = f_denitri_gas_max * no3_inc;
 
-	double wfps = soil.wfps(0);
-
-	// Pilegaard 2013
-	// only NO and N2O in nitrification 
-	double f_no = richards_curve(1.0, 0.5, 20.0, 0.375, wfps);
-
-	no_inc          = f_no * ngas_inc;
+	no_inc          = b.f_no[i] * ngas_inc;
 	no3_inc        -= no_inc;
 	soil.NO_mass_d += no_inc;
 
@@ -183,23 +301,18 @@ void nitrification(Patch& patch, Soil& soil) {
 /** Daily calculation of denitrification rate, and denitrification
  *  induced trace gas emissions 
  */
-void denitrification(Patch& patch,Soil& soil) {
-	double soil_T = soil.get_soil_temp_25();
-	double wcont = soil.get_soil_water_upper();
-	// used to remove the per m3 from the constants KC and KN.
-	double water_cont_m3 = wcont * soil.soiltype.gawc[0] / 1000.0;
+void denitrification(const NTransformBatch& b, size_t i) {
 
-	double wfps_upper = soil.wfps(0);
+	Patch& patch = *b.patches[i];
+	Soil& soil = patch.soil;
 
-	double f_den_T, d_N_max, no2_inc, no_inc, n2o_inc, ngas_inc, gross_denitrif, n2_inc;
+	double water_cont_m3 = b.water_cont_m3[i];
+	double wfps_upper = b.wfps[i];
+
+	double d_N_max, no2_inc, no_inc, n2o_inc, ngas_inc, gross_denitrif, n2_inc;
 	if (water_cont_m3 > 0.0 && wfps_upper>0.4) {
-		// temperature limiting factor for denitrification, 22 deg C == 1 (table 9, eqn 1, Xu-Ri 2008)
-		if (soil_T >= -40.0) {
-			f_den_T = min(1.0, exp(308.56 * (1.0 / 68.02 - 1.0 / (soil_T + 46.02))));
-		}
-		else {
-			f_den_T = 0.0;
-		}
+		double f_den_T = b.f_den_T[i];
+
 		// Effect of labile carbon availability on denitrification (table 9, eqn 2, Xu-Ri 2008)
 		d_N_max = soil.labile_carbon_w / (k_C * water_cont_m3 + soil.labile_carbon_w);
 
@@ -211,20 +324,12 @@ void denitrification(Patch& patch,Soil& soil) {
 		soil.NO2_mass_w += no2_inc;
 
 		// Gross transformation of NO2 to N2 (table 9, eqn 4, Xu-Ri 2008)
-
-		// Denitrification rate dependence on moisture, Weier et al. 1993
-		double f_den_w = min(1.0, exp(13.0360 * wfps_upper - 11.6219));
-
-		ngas_inc = min(soil.NO2_mass_w, soil.NO2_mass_w * f_nitri_gas_max * d_N_max * f_den_w * f_den_T * soil.NO2_mass_w / (k_N * water_cont_m3 + soil.NO2_mass_w));
+		ngas_inc = min(soil.NO2_mass_w, soil.NO2_mass_w * f_nitri_gas_max * d_N_max * b.f_den_w[i] * f_den_T * soil.NO2_mass_w / (k_N * water_cont_m3 + soil.NO2_mass_w));
 
 		soil.NO2_mass_w -= ngas_inc;
 
 		double f_n2o_no_w = max(0.0, min(1.0, 3.2092 * wfps_upper - 0.9210));
 
-		double f_n2_n2o_T = 1.0 / (1.0 + exp(-(soil_T - 5.0) / 10.0));
-
-		double f_n2o_n2_w = richards_curve(1.0, 0.0, 62.0, 0.875, wfps_upper); // Decimals added to be consistent with other richards_curve calls
-
 		// Above 0.7 WFPS, no NO is produced and below the same threshold no N2 production. Pilegaard 2013
 		if (wfps_upper < 0.7){
 			n2_inc = 0.0;
@@ -233,7 +338,7 @@ void denitrification(Patch& patch,Soil& soil) {
 		} 
 		else {
 			no_inc = 0.0;
-			n2o_inc = ngas_inc * f_n2o_n2_w * f_n2_n2o_T;
+			n2o_inc = ngas_inc * b.f_n2o_n2_w[i] * b.f_n2_n2o_T[i];
 			n2_inc = ngas_inc - n2o_inc;
 		}
 
@@ -251,25 +356,20 @@ void denitrification(Patch& patch,Soil& soil) {
 /// Soil N gas emissions
 /** Daily calculation of soil N gas emissions. 
  */
-void n_gas_emission(Patch& patch, Fluxes& fluxes, Soil& soil, double& n_budget_check) {
+void n_gas_emission(const NTransformBatch& b, size_t i, double& n_budget_check) {
+
+	Patch& patch = *b.patches[i];
+	Soil& soil = patch.soil;
 
 	//for book keeping
 	soil.labile_carbon = soil.labile_carbon_w  + soil.labile_carbon_d;
 
-	double soil_T = soil.get_soil_temp_25();
-	double wcont = soil.get_soil_water_upper();
-	double ftemp, no_d_flux_inc, n2o_d_flux_inc, no_w_flux_inc, n2o_w_flux_inc, n2_flux_inc;
+	double wcont = b.wcont[i];
+	double ftemp = b.f_temp_25[i];
+	double no_d_flux_inc, n2o_d_flux_inc, no_w_flux_inc, n2o_w_flux_inc, n2_flux_inc;
 	double net_nitrif = 0.0;
 	double net_denitrif = 0.0;
 
-	// ftemp, temperature limiting factor for gas emission, 25 degree C == 1 (table 10, eqn 1, Xu-Ri 2008)
-	if (soil_T >= -40.0) {
-		ftemp = min(1.0, exp(308.56 * (1.0 / 71.02 - 1.0 / (soil_T + 46.02))));
-	}
-	else {
-		ftemp = 0.0;
-	}
-
 	// Nitrification fluxes
 	// Daily NO gas released from aerobic soil to atmosphere (table 10, eqn 2, Xu-Ri 2008)
 	no_d_flux_inc   = ftemp * (1.0 - min(1.0, wcont)) * soil.NO_mass_d;
@@ -316,41 +416,66 @@ void n_gas_emission(Patch& patch, Fluxes& fluxes, Soil& soil, double& n_budget_c
 	                   soil.NH4_mass + soil.NO3_mass + soil.NO2_mass + soil.NO_mass + soil.N2O_mass + soil.N2_mass);
 }
 
+}
 
-/// N transformation processes in soil
-/** Daily calculation of nitrification, denitrification, and trace gases emissions. 
- *  To be called each simulation day for each modelled area or patch, following update
- *  of soil organic matter dynamic submodel.
- */
-void ntransform(Patch& patch, Climate& climate) {
+void ntransform_add(Patch& patch, const Climate& climate) {
 	if (ifntransform) {
-		const double EPS = 1.0e-14;
-		double n_budget_check;
 
 		// Obtain reference to Soil object
 		Soil& soil = patch.soil;
 
-		// Obtain referenc to flux object
-		Fluxes& fluxes = patch.fluxes;
+		// calculating soil pH value, aprec = daily mean precip, based on annual average
+		if (soil.soiltype.pH > 0.0) {
+			soil.pH = soil.soiltype.pH;
+		} 
+		else {
+			soil.pH = 3810 / (762 + (climate.aprec_lastyear)) + 3.5; // Dawson -77
+		}
+
+		double wcont = soil.get_soil_water_upper();
+
+		batch.patches.push_back(&patch);
+		batch.soil_T.push_back(soil.get_soil_temp_25());
+		batch.wcont.push_back(wcont);
+		batch.wfps.push_back(soil.wfps(0));
+		batch.water_cont_m3.push_back(wcont * soil.soiltype.gawc[0] / 1000.0);
+	}
+}
+
+void ntransform_run() {
+
+	if (batch.patches.empty()) {
+		return;
+	}
+
+	const double EPS = 1.0e-14;
+
+	response_functions(batch);
+
+	for (size_t i = 0; i < batch.patches.size(); i++) {
+
+		double n_budget_check;
 
 		// NH3 volatilization
-		nh3_volatilization(patch, soil, climate, n_budget_check);
+		nh3_volatilization(batch, i, n_budget_check);
 
 		// N substrate partition
-		substrate_partition(soil);
+		substrate_partition(batch, i);
 
 		// Nitrification
-		nitrification(patch, soil);
+		nitrification(batch, i);
 
 		// Denitrification
-		denitrification(patch, soil);
+		denitrification(batch, i);
 
 		// N gas emission
-		n_gas_emission(patch, fluxes, soil, n_budget_check);
+		n_gas_emission(batch, i, n_budget_check);
 
 		// Warning if soil N transform does not hold mass balance
 		assert(fabs(n_budget_check) < EPS);
 	}
+
+	batch.clear();
 }
 
 
@@ -36,6 +36,21 @@
 
 #include "guess.h"
 
-void ntransform(Patch& patch, Climate& climate);
+/// Queues a patch for today's N transformation processes in soil
+/** Daily calculation of nitrification, denitrification, and trace gases emissions.
+ *  To be called each simulation day for each modelled area or patch, following update
+ *  of soil organic matter dynamic submodel. The drivers (soil temperature and water)
+ *  are taken from the patch when it is queued, the transformations are done by
+ *  ntransform_run() for all queued patches together. Until then, the mineral
+ *  nitrogen pools of the patch must not be changed.
+ */
+void ntransform_add(Patch& patch, const Climate& climate);
+
+/// Does the N transformation processes in soil for all queued patches
+/** To be called after the last patch of a stand has been simulated for the day,
+ *  and before anything else depends on the mineral nitrogen pools of the queued
+ *  patches. The results are the same as with each patch transformed when queued.
+ */
+void ntransform_run();
 
 #endif // LPJ_GUESS_NTRANSFORM_H
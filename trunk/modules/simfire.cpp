@@ -354,7 +354,7 @@ void simfire_accounting_gridcell(Gridcell& gridcell) {
 
 	// Check if it is first day of simulation
 	bool is_first_day = ( date.day == 0 && ( date.year == 0 || 
-			       ( restart && date.year == state_year ) ) );
+			       date.year == gridcell.resume_year ) );
 
 	if ( is_first_day ) {
 		// Read monthly climatology and Hyde population-data from file 
@@ -30,6 +30,11 @@ void Soil::init_states() {
 	decomp_litter_mean = 0.0;
 	k_soilfast_mean = 0.0;
 	k_soilslow_mean = 0.0;
+	decomp_ndays = 0;
+	fr_litter_step = 1.0;
+	fr_soilfast_step = 1.0;
+	fr_soilslow_step = 1.0;
+	orgleachfrac_step = 0.0;
 	wcont_evap = 0.0;
 	snowpack = 0.0;
 	orgleachfrac = 0.0;
@@ -53,10 +58,10 @@ void Soil::init_states() {
 		mminleach_mean[mth] = 0.0;
 	}
 
-	std::fill_n(dwcontupper, Date::MAX_YEAR_LENGTH, 0.0);
-	std::fill_n(dwcontlower, Date::MAX_YEAR_LENGTH, 0.0);
+	std::fill_n(history->dwcontupper, Date::MAX_YEAR_LENGTH, 0.0);
+	std::fill_n(history->dwcontlower, Date::MAX_YEAR_LENGTH, 0.0);
 	// for fire
-	std::fill_n(dthaw, Date::MAX_YEAR_LENGTH, 0.0);
+	std::fill_n(history->dthaw, Date::MAX_YEAR_LENGTH, 0.0);
 
 
 	/////////////////////////////////////////////////////
@@ -184,7 +189,7 @@ void Soil::init_states() {
 
 	for (int d = 0; d<365; d++) {
 
-		wtp[d] = 0.0;
+		history->wtp[d] = 0.0;
 
 		for (int ly = 0; ly<NLAYERS; ly++) {
 
@@ -1541,16 +1546,16 @@ void Soil::hydrology_peat(const Climate& climate, double fevap) {
 		
 		// Saturated acrotelm
 
-		wtp[daynum] = Wtot - acro_depth * acro_por; 
+		history->wtp[daynum] = Wtot - acro_depth * acro_por; 
 		// i.e. wtp[daynum] > 0 above the surface
 		
-		if (wtp[daynum] > maxh) {
-			runoff_surf += wtp[daynum] - maxh; 
+		if (history->wtp[daynum] > maxh) {
+			runoff_surf += history->wtp[daynum] - maxh; 
 			// Update runoff from the surface
-			wtp[daynum] = maxh;
+			history->wtp[daynum] = maxh;
 		}
 
-		wtd = -wtp[daynum]; // i.e. wtd defined as < 0 above the surface
+		wtd = -history->wtp[daynum]; // i.e. wtd defined as < 0 above the surface
 		Wtot = acro_depth * acro_por; 
 		// I.e. Wtot does NOT include standing water
 		stand_water = 0.0; // = wtp[daynum]; // we assume no standing water 
@@ -1566,7 +1571,7 @@ void Soil::hydrology_peat(const Climate& climate, double fevap) {
 		if (wtd > acro_depth) 
 			wtd = acro_depth; 
 
-		wtp[daynum] = -wtd;
+		history->wtp[daynum] = -wtd;
 		stand_water = 0.0;
 	}
 
@@ -1709,10 +1714,10 @@ void Soil::hydrology_peat(const Climate& climate, double fevap) {
 	double wtp_moss_lower = -280.0; // Wania et al. 2009b
 	double moss_wtp_limit_lowerlimit = 0.3; 
 
-	if (wtp[daynum] > wtp_moss_upper)
+	if (history->wtp[daynum] > wtp_moss_upper)
 		dmoss_wtp_limit = 1.0; // No limit
-	else if (wtp[daynum] > wtp_moss_lower)
-		dmoss_wtp_limit = 1.0 - (-wtp[daynum] + wtp_moss_upper) * (1.0 - moss_wtp_limit_lowerlimit)/(wtp_moss_upper - wtp_moss_lower);
+	else if (history->wtp[daynum] > wtp_moss_lower)
+		dmoss_wtp_limit = 1.0 - (-history->wtp[daynum] + wtp_moss_upper) * (1.0 - moss_wtp_limit_lowerlimit)/(wtp_moss_upper - wtp_moss_lower);
 	else 
 		dmoss_wtp_limit = moss_wtp_limit_lowerlimit; // between -300mm and -280mm
 	
@@ -1741,10 +1746,10 @@ void Soil::hydrology_peat(const Climate& climate, double fevap) {
 
 	// More restrictive than Wania et al., otherwise graminoids become too dominant as they never suffer from inundation stress
 	// The cap drops from 1 as soon as wtp goes below wtp_graminoid_upper
-	if (wtp[daynum] >= wtp_graminoid_upper)
+	if (history->wtp[daynum] >= wtp_graminoid_upper)
 		dgraminoid_wtp_limit = 1.0; // i.e. no limit!
-	else if (wtp[daynum] > wtp_graminoid_lower)
-		dgraminoid_wtp_limit = 1.0 - (-wtp[daynum] + wtp_graminoid_upper) * (1.0 - graminoid_wtp_limit_lowerlimit)/(wtp_graminoid_upper - wtp_graminoid_lower);
+	else if (history->wtp[daynum] > wtp_graminoid_lower)
+		dgraminoid_wtp_limit = 1.0 - (-history->wtp[daynum] + wtp_graminoid_upper) * (1.0 - graminoid_wtp_limit_lowerlimit)/(wtp_graminoid_upper - wtp_graminoid_lower);
 	else 
 		dgraminoid_wtp_limit = graminoid_wtp_limit_lowerlimit; // between -300mm and -200mm
 
@@ -1759,7 +1764,7 @@ void Soil::hydrology_peat(const Climate& climate, double fevap) {
 	}
 
 	int mdays = date.ndaymonth[date.month];
-	mwtp[date.month] += wtp[date.day] / (double)mdays;
+	mwtp[date.month] += history->wtp[date.day] / (double)mdays;
 
 	if (firstHydrologyCalc) 
 		firstHydrologyCalc = false;
@@ -1769,7 +1774,7 @@ void Soil::hydrology_peat(const Climate& climate, double fevap) {
 		// Calculate annual average WTP. Needed in update_acrotelm_co2
 		awtp = 0.0;
 		for (int d = 0; d < 365; d++)
-			awtp += wtp[d]/365.0; 
+			awtp += history->wtp[d]/365.0; 
 	}
 
 	return; // ...if no problems
@@ -2691,6 +2696,27 @@ void Soil::init_hydrology_variables() {
 }
 
 
+void Soil::reset_water_capacity() {
+
+	// The active layers and their depths as set in soil_temp_multilayer()
+	// and update_layer_fractions()
+	const bool peatland = patch.stand.is_highlatitude_peatland_stand();
+	ngroundl = peatland ? NACROTELM + NCATOTELM : NSOILLAYER;
+	IDX = NLAYERS - ngroundl;
+
+	for (int ly = IDX; ly < NLAYERS; ly++) {
+		if (peatland) {
+			Dz[ly] = ly < IDX + NACROTELM ? Dz_acro : Dz_cato;
+		}
+		else {
+			Dz[ly] = Dz_soil;
+		}
+	}
+
+	init_hydrology_variables();
+}
+
+
 void Soil::update_acrotelm_co2(double atmo_co2) {
 
 	// DESCRIPTION
@@ -3302,7 +3328,7 @@ void Soil::update_layer_fractions(const int& daynum, const int& mixedl, const in
 				Frac_peat[ii] = 0.0;
 			}
 		} 
-		else if (firstTempCalc && (restart || patch.stand.clone_year == date.year)) {
+		else if (firstTempCalc && (restart || patch.stand.clone_year == date.year || patch.cloned)) {
 			// initialize after restarts
 			for (int ii = IDX; ii<NLAYERS; ii++) {
 
@@ -3454,7 +3480,7 @@ bool Soil::soil_temp_multilayer(const double &dailyairtemp) {
 			ngroundl = NSOILLAYER;
 
 	} // firstTempCalc
-	else if (firstTempCalc && (restart || patch.stand.clone_year == date.year)) {
+	else if (firstTempCalc && (restart || patch.stand.clone_year == date.year || patch.cloned)) {
 
 		// The log is used to speed things up. Without the log you need
 		// to use an exponential, with it you just multiply.
@@ -3488,7 +3514,7 @@ bool Soil::soil_temp_multilayer(const double &dailyairtemp) {
 	// Allocate yesterday's temperature and ice fraction to today's 
 	// ------------------------------------------
 
-	if (!firstTempCalc || restart || patch.stand.clone_year == date.year) update_from_yesterday();
+	if (!firstTempCalc || restart || patch.stand.clone_year == date.year || patch.cloned) update_from_yesterday();
 
 	// SNOW DENSITY and THERMAL PROPRTIES
 	// ------------------------------------------
@@ -3859,95 +3885,95 @@ void Soil::nmass_multiplic_inc(double inc, int pref) {
 
 // serialize new soil variables, when finalised
 void Soil::serialize(ArchiveStream& arch) {
-	arch & wcont
-		& wcont_evap
-		& awcont_upper
-		& dwcontupper
-		& dwcontlower
-		& mwcontupper
-		& mwcontlower
-		& mwcont
-		& snowpack
-		& snow_active
-		& snow_days
-		& snow_days_prev
-		& snow_active_layers
-		& snow_water
-		& snow_ice
-		& msnowdepth
-		& dsnowdepth
-		& thaw
-		& runoff
-		& temp25
-		& Dz // optimise through init after restart?
-		& T_old
-		& T_soil_yesterday
-		& T_soil_monthly
-		& dtemp
-		& mtemp
-		& gtemp
-		& pad_temp
-		& pad_dz
-		& cpool_slow
-		& cpool_fast
-		& decomp_litter_mean
-		& k_soilfast_mean
-		& k_soilslow_mean
-		& alag
-		& exp_alag
-		& Frac_ice_yesterday
-		& Frac_water_belowpwp
-		& Frac_water
-		& Frac_air
-		& whc
-		& alwhc
-		& aw_max // optimise through init after restart?
+	arch & STATE_FIELD(wcont)
+		& STATE_FIELD(wcont_evap)
+		& STATE_FIELD(awcont_upper)
+		& STATE_FIELD(history->dwcontupper)
+		& STATE_FIELD(history->dwcontlower)
+		& STATE_FIELD(mwcontupper)
+		& STATE_FIELD(mwcontlower)
+		& STATE_FIELD(mwcont)
+		& STATE_FIELD(snowpack)
+		& STATE_FIELD(snow_active)
+		& STATE_FIELD(snow_days)
+		& STATE_FIELD(snow_days_prev)
+		& STATE_FIELD(snow_active_layers)
+		& STATE_FIELD(snow_water)
+		& STATE_FIELD(snow_ice)
+		& STATE_FIELD(msnowdepth)
+		& STATE_FIELD(dsnowdepth)
+		& STATE_FIELD(thaw)
+		& STATE_FIELD(runoff)
+		& STATE_FIELD(temp25)
+		& STATE_FIELD(Dz) // optimise through init after restart?
+		& STATE_FIELD(T_old)
+		& STATE_FIELD(T_soil_yesterday)
+		& STATE_FIELD(T_soil_monthly)
+		& STATE_FIELD(dtemp)
+		& STATE_FIELD(mtemp)
+		& STATE_FIELD(gtemp)
+		& STATE_FIELD(pad_temp)
+		& STATE_FIELD(pad_dz)
+		& STATE_FIELD(cpool_slow)
+		& STATE_FIELD(cpool_fast)
+		& STATE_FIELD(decomp_litter_mean)
+		& STATE_FIELD(k_soilfast_mean)
+		& STATE_FIELD(k_soilslow_mean)
+		& STATE_FIELD(alag)
+		& STATE_FIELD(exp_alag)
+		& STATE_FIELD(Frac_ice_yesterday)
+		& STATE_FIELD(Frac_water_belowpwp)
+		& STATE_FIELD(Frac_water)
+		& STATE_FIELD(Frac_air)
+		& STATE_FIELD(whc)
+		& STATE_FIELD(alwhc)
+		& STATE_FIELD(aw_max) // optimise through init after restart?
 		// Methane parameters
 		// Some of these could possibly be removed to 
 		// optimise for memory in state files
-		& awtp
-		& wtp
-		& ch4_store
-		& co2_store
-		& CO2_soil_yesterday
-		& CH4_yesterday
-		& CH4_diss_yesterday
-		& CH4_gas_yesterday
-		& CH4_gas_vol
-		& O2;
+		& STATE_FIELD(awtp)
+		& STATE_FIELD(history->wtp)
+		& STATE_FIELD(ch4_store)
+		& STATE_FIELD(co2_store)
+		& STATE_FIELD(CO2_soil_yesterday)
+		& STATE_FIELD(CH4_yesterday)
+		& STATE_FIELD(CH4_diss_yesterday)
+		& STATE_FIELD(CH4_gas_yesterday)
+		& STATE_FIELD(CH4_gas_vol)
+		& STATE_FIELD(O2);
 		
 	for (int i = 0; i<NSOMPOOL; i++) {
-		arch & sompool[i];
-	}
-
-	arch & dperc
-		& orgleachfrac
-		& NO2_mass
-		& NO_mass
-		& N2O_mass
-		& N2_mass
-		& NH4_mass
-		& NO3_mass
-		& NH4_input
-		& NO3_input
-		& anmin
-		& animmob
-		& aminleach
-		& aorgNleach
-		& aorgCleach
-		& anfix
-		& anfix_calc
-		& anfix_mean
-		& snowpack_NH4_mass
-		& snowpack_NO3_mass
-		& solvesomcent_beginyr
-		& solvesomcent_endyr
-		& solvesom
-		& fnuptake_mean
-		& morgleach_mean
-		& mminleach_mean
-		& labile_carbon
-		& pH;
+		arch & STATE_FIELD(sompool[i]);
+	}
+
+	arch & STATE_FIELD(dperc)
+		& STATE_FIELD(orgleachfrac)
+		& STATE_FIELD(NO2_mass)
+		& STATE_FIELD(NO_mass)
+		& STATE_FIELD(N2O_mass)
+		& STATE_FIELD(N2_mass)
+		& STATE_FIELD(NH4_mass)
+		& STATE_FIELD(NO3_mass)
+		& STATE_FIELD(NH4_input)
+		& STATE_FIELD(NO3_input)
+		& STATE_FIELD(anmin)
+		& STATE_FIELD(animmob)
+		& STATE_FIELD(aminleach)
+		& STATE_FIELD(aorgNleach)
+		& STATE_FIELD(aorgCleach)
+		& STATE_FIELD(anfix)
+		& STATE_FIELD(anfix_calc)
+		& STATE_FIELD(anfix_mean)
+		& STATE_FIELD(snowpack_NH4_mass)
+		& STATE_FIELD(snowpack_NO3_mass)
+		& STATE_FIELD(solvesomcent_beginyr)
+		& STATE_FIELD(solvesomcent_endyr)
+		& STATE_FIELD(solvesom)
+		& STATE_FIELD(fnuptake_mean)
+		& STATE_FIELD(morgleach_mean)
+		& STATE_FIELD(mminleach_mean)
+		& STATE_FIELD(labile_carbon)
+		& STATE_FIELD(pH);
 }
 
 
@@ -9,11 +9,13 @@
 ///
 ///////////////////////////////////////////////////////////////////////////////////////
 
+#include "config.h"
 #include <stdio.h>
 #include <math.h>
 #include "soilmethane.h"
 #include "guess.h"
 #include "soil.h"
+#include "solverstats.h"
 
 
 //////////////////////////////////////////////////////////////////////////////////////////////////
@@ -536,6 +538,8 @@ double Soil::diffuse_gas(double Cgas[NLAYERS], double D[NLAYERS], gastype thisga
 				stable = true;
 
 		} while (cncount < gasdiffix && !stable); // until max 1% variation between iterations, or 100 loops
+
+		SOLVER_RECORD(SOLVER_GAS_DIFFUSION, cncount, !stable, stable);
 	}
 
 	// Unit conversions - allocate concentrations to g layer-1 or mole layer-1
@@ -684,7 +688,7 @@ bool Soil::calculate_gas_ebullition(double& ebull_today) {
 	double waterheight = 0.0;
 	ebull_today = 0.0;
 
-	double wtpp = wtp[date.day];	// Today's water table position (-300 to +100) mm
+	double wtpp = history->wtp[date.day];	// Today's water table position (-300 to +100) mm
 	bool emitToAtmosphere = true;	// Whether to emit CH4 directly to the atmosphere (true by default)
 	int bubbleToLayer = IDX;		// The soil layer to bubble to.
 
@@ -952,11 +956,11 @@ bool Soil::methane(bool generatemethane) {
 		}
 
 		// If we have standing water...
-		if (wtp[daynum] > 0.0) {
+		if (history->wtp[daynum] > 0.0) {
 			// wtp in mm
-			Dz_metre[IDX] += wtp[daynum] / MM_PER_M;
-			volume_liquid_water[IDX] += (Frac_water[MIDX] + Frac_water_belowpwp[MIDX]) * wtp[daynum] / MM_PER_M;
-			total_volume_water[IDX] += (Frac_water[MIDX] + Fpwp_ref[MIDX] + Frac_ice[MIDX]) * wtp[daynum] / MM_PER_M;
+			Dz_metre[IDX] += history->wtp[daynum] / MM_PER_M;
+			volume_liquid_water[IDX] += (Frac_water[MIDX] + Frac_water_belowpwp[MIDX]) * history->wtp[daynum] / MM_PER_M;
+			total_volume_water[IDX] += (Frac_water[MIDX] + Fpwp_ref[MIDX] + Frac_ice[MIDX]) * history->wtp[daynum] / MM_PER_M;
 		}
 
 		// Update the temperature-dependent gas parameters
@@ -484,7 +484,7 @@ void soilwater(Patch& patch, Climate& climate) {
 		// Update inundation stress variables for this patch
 		for (int p=0;p<npft;p++) {
 
-			double wtpp = patch.soil.wtp[date.day]; // [-300,100] mm
+			double wtpp = patch.soil.history->wtp[date.day]; // [-300,100] mm
 			double wtpm = patch.pft[p].pft.wtp_max; // mm
 
 			if (date.day == 0) 
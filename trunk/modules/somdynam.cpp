@@ -177,6 +177,25 @@ void equilsom_lpj(Soil& soil) {
 }
 
 
+///////////////////////////////////////////////////////////////////////////////////////
+// DECOMPOSITION_DUE
+// Internal function (do not call directly from framework)
+
+bool decomposition_due(const Patch& patch) {
+
+	// DESCRIPTION
+	// Whether litter and SOM decompose today, after the days since the last
+	// decomposition (see somdynam_step). Steps always end on the last day of
+	// the month, so monthly output and saved states never see an open step.
+
+	if (somdynam_step <= 1 || patch.stand.landcover == PEATLAND) {
+		return true;
+	}
+
+	return date.islastday || (date.dayofmonth + 1) % somdynam_step == 0;
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////////////
 // SOM DYNAMICS
 // To be called each simulation day for each modelled area or patch, following update
@@ -217,6 +236,25 @@ void som_dynamics_lpj(Patch& patch, bool tillage) {
 		soil.k_soilslow_mean+=k_soilslow;
 	}
 
+	// Decompose with the fractions remaining after all days since the last
+	// decomposition
+
+	soil.fr_litter_step*=fr_litter;
+	soil.fr_soilfast_step*=fr_soilfast;
+	soil.fr_soilslow_step*=fr_soilslow;
+	soil.decomp_ndays++;
+
+	if (!decomposition_due(patch)) return;
+
+	fr_litter=soil.fr_litter_step;
+	fr_soilfast=soil.fr_soilfast_step;
+	fr_soilslow=soil.fr_soilslow_step;
+
+	soil.fr_litter_step=1.0;
+	soil.fr_soilfast_step=1.0;
+	soil.fr_soilslow_step=1.0;
+	soil.decomp_ndays=0;
+
 	// Reduce litter and SOM pools, sum C flux to atmosphere from decomposition
 	// and transfer correct proportions of litter decomposition to fast and slow
 	// SOM pools
@@ -536,13 +574,33 @@ void transferdecomp(Soil& soil, pooltype donor, pooltype receiver,
 	respsum += cdec * respfrac;
 }
 
+/// Sets soil available nitrogen to its saturation level when not limiting
+/** Without nitrogen limitation, or during the free nitrogen years, plants
+ *  never run out of mineral nitrogen.
+ */
+void saturate_mineral_nitrogen(Soil& soil) {
+
+	if (!ifnlim || date.year <= freenyears) {
+		if(ifntransform) {
+			soil.NH4_mass = NMASS_SAT / 2.0;
+			soil.NO3_mass = NMASS_SAT / 2.0;
+		} 
+		else {
+			soil.NH4_mass = NMASS_SAT;
+		}
+	}
+}
+
 /// Fluxes between the CENTURY pools, and CO2 release to the atmosphere
 /** Daily or monthly fluxes between the ten CENTURY pools, and CO2 release to the atmosphere
  *  Parton et al 1993, Fig 1; Comins & McMurtrie 1993, Appendix A
  *
+ *  The fraction of each pool remaining (Sompool::fracremain) must be set by the caller,
+ *  for the days decomposed.
+ *
  *  \param ifequilsom Whether the function is called during calculation om SOM pool equilibrium,
- *                    \see equilsom(). During this stage, somfluxes shouldn't calculate decayrates
- *                    itself, and shouldn't produce output like fluxes etc.
+ *                    \see equilsom(). During this stage, somfluxes shouldn't produce output
+ *                    like fluxes etc.
  */
 void somfluxes(Patch& patch, bool ifequilsom, bool tillage) {
 
@@ -557,10 +615,6 @@ void somfluxes(Patch& patch, bool ifequilsom, bool tillage) {
 
 	// mineral nitrogen mass available
 	const double nmin_mass = soil.nmass_avail(NH4);// + soil.NO3_mass;
-	if (date.day == 0) {
-		soil.anmin = 0.0;
-		soil.animmob = 0.0;
-	}
 
 	// Warning if soil available nitrogen is negative (if happens once or so no problem, but if it propagates through time then it is)
 	if (ifnlim) {
@@ -577,14 +631,6 @@ void somfluxes(Patch& patch, bool ifequilsom, bool tillage) {
 
 	setntoc(soil, nmin_mass, SURFHUMUS, 30.0, 15.0, 0.0, NMASS_SAT);
 
-	if (!ifequilsom) {
-
-		// Calculate potential fraction remaining following decay today for all pools
-		// (assumes no nitrogen limitation)
-		decayrates_century(soil, soil.get_soil_temp_25(), soil.get_soil_water_upper(), tillage);
-
-	}
-
 	// Calculate decomposition in all pools assuming these decay rates
 
 	// Save delta carbon and nitrogen mass
@@ -821,17 +867,7 @@ void somfluxes(Patch& patch, bool ifequilsom, bool tillage) {
 	}
 	soil.nmass_inc(nmin_inc,NH4);
 
-	// If no nitrogen limitation or during free nitrogen years set soil
-	// available nitrogen to its saturation level.
-	if (!ifnlim || date.year <= freenyears) {
-		if(ifntransform) {
-			soil.NH4_mass = NMASS_SAT / 2.0;
-			soil.NO3_mass = NMASS_SAT / 2.0;
-		} 
-		else {
-			soil.NH4_mass = NMASS_SAT;
-		}
-	}
+	saturate_mineral_nitrogen(soil);
 }
 
 /// Litter lignin to N ratio (for leaf and root litter)
@@ -1333,6 +1369,11 @@ void add_litter(Soil& soil, int year, int pool) {
 	soil.sompool[pool].nmass += soil.solvesom[year].get_nlitter(pool);
 }
 
+/// Whether equilsom() solves the SOM pool sizes today
+bool equilsom_due(const Soil& soil) {
+	return date.year == soil.solvesomcent_endyr && date.islastmonth && date.islastday;
+}
+
 /// Iteratively solving differential flux equations for century SOM pools
 /** Iteratively solving differential flux equations for century SOM pools
  *  assuming annual litter inputs, nitrogen uptake and leaching is close
@@ -1340,7 +1381,7 @@ void add_litter(Soil& soil, int year, int pool) {
  */
 void equilsom(Soil& soil) {
 
-	if (!(date.year == soil.solvesomcent_endyr && date.islastmonth && date.islastday))
+	if (!equilsom_due(soil))
 		return;
 
 	// Number of years to run SOM pools, value chosen to get cold climates to equilibrium
@@ -1466,6 +1507,14 @@ void equilsom(Soil& soil) {
  */
 void som_dynamics_century(Patch& patch, Climate& climate, bool tillage) {
 
+	Soil& soil = patch.soil;
+
+	// Reset annual sums of mineralisation and immobilisation
+	if (date.day == 0) {
+		soil.anmin = 0.0;
+		soil.animmob = 0.0;
+	}
+
 	// Transfer litter to SOM pools
 	transfer_litter(patch);
 
@@ -1476,16 +1525,51 @@ void som_dynamics_century(Patch& patch, Climate& climate, bool tillage) {
 	soilnadd(patch);
 
 	// Daily mineral and organic nitrogen leaching
-	leaching(patch.soil);
+	leaching(soil);
 
-	// Daily or monthly decomposition and fluxes between SOM pools
-	somfluxes(patch, false, tillage);
+	// Calculate potential fraction remaining following decay today for all pools
+	// (assumes no nitrogen limitation)
+	decayrates_century(soil, soil.get_soil_temp_25(), soil.get_soil_water_upper(), tillage);
 
-	// Nitrogen transformation in soil
-	ntransform(patch, climate);
+	for (int p = 0; p < NSOMPOOL; p++) {
+		soil.sompool[p].fracremain_step *= soil.sompool[p].fracremain;
+	}
+	soil.orgleachfrac_step += soil.orgleachfrac;
+	soil.decomp_ndays++;
+
+	if (decomposition_due(patch)) {
+
+		// Decomposition and fluxes between SOM pools over the days since
+		// the last decomposition, usually just today
+		for (int p = 0; p < NSOMPOOL; p++) {
+			soil.sompool[p].fracremain = soil.sompool[p].fracremain_step;
+			soil.sompool[p].fracremain_step = 1.0;
+		}
+		soil.orgleachfrac = soil.orgleachfrac_step / soil.decomp_ndays;
+
+		somfluxes(patch, false, tillage);
+
+		// Labile carbon is a daily supply for denitrification, which lasts
+		// until the next decomposition
+		soil.labile_carbon /= soil.decomp_ndays;
+
+		soil.orgleachfrac_step = 0.0;
+		soil.decomp_ndays = 0;
+	}
+	else {
+		saturate_mineral_nitrogen(soil);
+	}
+
+	// Nitrogen transformation in soil, done for all patches of the stand
+	// together after the last one, see ntransform.h
+	ntransform_add(patch, climate);
 
 	// Solve SOM pool sizes at end of year given by soil.solvesomcent_endyr
-	equilsom(patch.soil);
+	if (equilsom_due(soil)) {
+		// The solution starts from today's mineral nitrogen
+		ntransform_run();
+		equilsom(soil);
+	}
 }
 
 /// Choose between CENTURY or standard LPJ SOM dynamics
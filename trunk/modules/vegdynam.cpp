@@ -50,7 +50,7 @@ void report_fire_nfluxes(Patch& patch, double nflux_fire) {
 // RANDPOISSON
 // Internal functions for generating random numbers
 
-int randpoisson(double expectation, long& seed) {
+int randpoisson(double expectation, RandomStream& random) {
 
 	// DESCRIPTION
 	// Returns a random integer drawn from the Poisson distribution with specified
@@ -66,7 +66,7 @@ int randpoisson(double expectation, long& seed) {
 
 		p = exp(-expectation);
 		q = p;
-		r=randfrac(seed);
+		r=randfrac(random);
 
 		n = 0;
 		while (q < r) {
@@ -82,9 +82,9 @@ int randpoisson(double expectation, long& seed) {
 	// and standard deviation the square root of this value
 
 	do {
-		r=randfrac(seed)*8.0-4.0;
+		r=randfrac(random)*8.0-4.0;
 		p = exp(-r * r / 2.0);
-	} while (randfrac(seed)>p);
+	} while (randfrac(random)>p);
 
 	return max(0, (int)(r * sqrt(expectation) + expectation + 0.5));
 }
@@ -416,6 +416,9 @@ void establishment_guess(Stand& stand,Patch& patch, Gridcell& gridcell) {
 	double bminit; // initial sapling biomass (kgC) or new grass biomass (kgC/m2)
 	double ltor; // leaf to fine root mass ratio for new saplings or grass
 	int newindiv; // number of new Individual objects to add to vegetation for this PFT
+
+	// random numbers for the stochastic establishment in this patch
+	RandomStream random(patch, RANDOM_ESTABLISHMENT);
 	double kest_bg;
 	int i;
 
@@ -600,7 +603,7 @@ void establishment_guess(Stand& stand,Patch& patch, Gridcell& gridcell) {
 					// Actual number of new saplings drawn from the Poisson distribution
 					// (except cohort mode with stochastic establishment disabled)
 
-					if (ifstochestab && !force_planting || vegmode==INDIVIDUAL) nsapling=randpoisson(est, gridcell.seed);
+					if (ifstochestab && !force_planting || vegmode==INDIVIDUAL) nsapling=randpoisson(est, random);
 					else nsapling=est;
 
 					if (vegmode==COHORT) {
@@ -994,6 +997,10 @@ void mortality_guess(Stand& stand, Patch& patch, const Climate& climate, double
 
 	Vegetation& vegetation=patch.vegetation;
 
+	// Random numbers for fire and stochastic mortality in this patch
+	RandomStream random_fire(patch, RANDOM_FIRE);
+	RandomStream random_mortality(patch, RANDOM_MORTALITY);
+
 	// FPC on peatlands
 	double fpc_grass = 0.0;
 	double fpc_moss = 0.0;
@@ -1024,7 +1031,7 @@ void mortality_guess(Stand& stand, Patch& patch, const Climate& climate, double
 
 		// Impose fire in this patch with probability 'fireprob'
 
-		if (randfrac(gridcell.seed)<fireprob) {
+		if (randfrac(random_fire)<fireprob) {
 
 			// Loop through individuals
 
@@ -1067,7 +1074,7 @@ void mortality_guess(Stand& stand, Patch& patch, const Climate& climate, double
 						nindiv_prev=nindiv;
 
 						for (i=0;i<nindiv_prev;i++)
-							if (randfrac(gridcell.seed)>indiv.pft.fireresist) nindiv--;
+							if (randfrac(random_fire)>indiv.pft.fireresist) nindiv--;
 
 						if (nindiv_prev)
 							frac_survive=(double)nindiv/(double)nindiv_prev;
@@ -1224,7 +1231,7 @@ void mortality_guess(Stand& stand, Patch& patch, const Climate& climate, double
 					nindiv_prev=nindiv;
 
 					for (i=0;i<nindiv_prev;i++)
-						if (randfrac(gridcell.seed)<mort) nindiv--;
+						if (randfrac(random_mortality)<mort) nindiv--;
 
 					if (nindiv_prev)
 						frac_survive=(double)nindiv/(double)nindiv_prev;
@@ -1386,8 +1393,8 @@ void fire(Patch& patch,double& fireprob) {
 	for (int day = 0; day < date.year_length(); day++) {
 
 		// No fires unless there is some soil melt.
-		if (iftwolayersoil || (patch.soil.dthaw[day] > 0.0 && date.year > FIRST_FREEZE_YEAR + 10)) {
-			pm = exp(-PI*patch.soil.dwcontupper[day] / me_mean*patch.soil.dwcontupper[day] /
+		if (iftwolayersoil || (patch.soil.history->dthaw[day] > 0.0 && date.year > FIRST_FREEZE_YEAR + 10)) {
+			pm = exp(-PI*patch.soil.history->dwcontupper[day] / me_mean*patch.soil.history->dwcontupper[day] /
 				me_mean);		// Eqn 2
 		}
 		else {
@@ -1488,7 +1495,9 @@ void disturbance(Patch& patch, double disturb_prob, Gridcell& gridcell) {
 	// INPUT PARAMETER
 	// disturb_prob = the probability of a disturbance this year
 
-	if (randfrac(gridcell.seed)<disturb_prob) {
+	RandomStream random(patch, RANDOM_DISTURBANCE);
+
+	if (randfrac(random)<disturb_prob) {
 
 		Vegetation& vegetation = patch.vegetation;
 
@@ -1512,6 +1521,244 @@ void disturbance(Patch& patch, double disturb_prob, Gridcell& gridcell) {
 }
 
 
+///////////////////////////////////////////////////////////////////////////////////////
+// COHORT MERGING
+// Internal functions (do not call directly from framework)
+
+/// Relative difference between two non-negative quantities (0 if both are zero)
+double reldiff(double a, double b) {
+	double scale = max(fabs(a), fabs(b));
+	if (negligible(scale)) {
+		return 0.0;
+	}
+	return fabs(a - b) / scale;
+}
+
+/// Stem diameter (m) of an average individual from its height (Eqn 5 in allometry)
+double stem_diameter(const Individual& indiv) {
+	return pow(indiv.height / indiv.pft.k_allom2, 1.0 / indiv.pft.k_allom3);
+}
+
+/// Biomass of an average individual (kgC/indiv)
+double indiv_biomass(const Individual& indiv) {
+	return indiv.ccont() / indiv.densindiv;
+}
+
+/// Whether an individual/cohort may take part in merging
+bool mergeable(const Individual& indiv) {
+	return indiv.alive && indiv.pft.lifeform == TREE &&
+		indiv.pft.landcover != CROPLAND && !negligible(indiv.densindiv);
+}
+
+/// Largest relative difference in height, diameter and biomass, divided by tolerance
+/** Values <= 1 mean that the two cohorts are within all merging tolerances. */
+double cohort_distance(const Individual& a, const Individual& b) {
+	return max(reldiff(a.height, b.height) / merge_height_tol,
+	       max(reldiff(stem_diameter(a), stem_diameter(b)) / merge_dbh_tol,
+	           reldiff(indiv_biomass(a), indiv_biomass(b)) / merge_biomass_tol));
+}
+
+/// Whether allometry() would accept the combined biomass of two cohorts
+/** Mirrors the checks in allometry(), so that a merge can be rejected before
+ *  any of the two cohorts has been modified.
+ */
+bool merged_allometry_ok(const Individual& a, const Individual& b) {
+
+	const double HEIGHT_MAX = 150.0;
+
+	double cmass_leaf = a.cmass_leaf + b.cmass_leaf;
+	double cmass_wood = a.cmass_sap + b.cmass_sap + a.cmass_heart + b.cmass_heart;
+	double densindiv = a.densindiv + b.densindiv;
+
+	if (negligible(cmass_leaf)) {
+		return false;
+	}
+
+	double height = (a.cmass_sap + b.cmass_sap) / cmass_leaf / a.pft.sla *
+		a.pft.k_latosa / a.pft.wooddens;
+	if (height > HEIGHT_MAX) {
+		return false;
+	}
+
+	double diam = pow(height / a.pft.k_allom2, 1.0 / a.pft.k_allom3);
+	double vol = height * PI * diam * diam * 0.25;
+
+	return !(cmass_wood / densindiv / vol < a.pft.wooddens * 0.9);
+}
+
+/// Combines cohort b into cohort a
+/** All quantities expressed on a patch area basis are summed, so that C and N
+ *  (and establishment, LUC and BVOC bookkeeping) are conserved exactly. Quantities
+ *  describing the average individual are weighted by density. Allometry must
+ *  be updated by the caller. Cohort b must be removed from the vegetation
+ *  afterwards without transfer to litter.
+ */
+void merge_into(Individual& a, const Individual& b) {
+
+	const double wa = a.densindiv / (a.densindiv + b.densindiv);
+	const double wb = 1.0 - wa;
+
+	// Average individual properties
+
+	a.age = wa * a.age + wb * b.age;
+	a.scale_n_storage = wa * a.scale_n_storage + wb * b.scale_n_storage;
+	a.avmaxnlim = wa * a.avmaxnlim + wb * b.avmaxnlim;
+	a.cton_leaf_aopt = min(a.cton_leaf_aopt, b.cton_leaf_aopt);
+	a.cton_leaf_aavr = wa * a.cton_leaf_aavr + wb * b.cton_leaf_aavr;
+
+	// Patch area basis
+
+	a.densindiv += b.densindiv;
+
+	a.cmass_leaf += b.cmass_leaf;
+	a.cmass_root += b.cmass_root;
+	a.cmass_sap += b.cmass_sap;
+	a.cmass_heart += b.cmass_heart;
+	a.cmass_debt += b.cmass_debt;
+	a.cmass_leaf_post_turnover += b.cmass_leaf_post_turnover;
+	a.cmass_root_post_turnover += b.cmass_root_post_turnover;
+	a.cmass_tot_luc += b.cmass_tot_luc;
+	a.cmass_veg += b.cmass_veg;
+
+	a.nmass_leaf += b.nmass_leaf;
+	a.nmass_root += b.nmass_root;
+	a.nmass_sap += b.nmass_sap;
+	a.nmass_heart += b.nmass_heart;
+	a.nstore_longterm += b.nstore_longterm;
+	a.nstore_labile += b.nstore_labile;
+	a.max_n_storage += b.max_n_storage;
+	a.nmass_veg += b.nmass_veg;
+
+	a.nmass_leaf_luc += b.nmass_leaf_luc;
+	a.nmass_root_luc += b.nmass_root_luc;
+	a.nmass_sap_luc += b.nmass_sap_luc;
+	a.nmass_heart_luc += b.nmass_heart_luc;
+	a.nstore_longterm_luc += b.nstore_longterm_luc;
+	a.nstore_labile_luc += b.nstore_labile_luc;
+	a.nmass_tot_luc += b.nmass_tot_luc;
+
+	a.fpc += b.fpc;
+	a.deltafpc += b.deltafpc;
+	a.anpp += b.anpp;
+	a.aaet += b.aaet;
+	a.anuptake += b.anuptake;
+
+	for (int m = 0; m < 12; m++) {
+		a.mlai[m] += b.mlai[m];
+		a.mlai_max[m] += b.mlai_max[m];
+	}
+
+	for (int i = 0; i < NMTCOMPOUNDS; i++) {
+		a.monstor[i] += b.monstor[i];
+	}
+
+	// Wood increments are per patch area, add them year by year
+	if (a.cmass_wood_inc_5.size() == b.cmass_wood_inc_5.size()) {
+		Historic<double, 10> wood_inc;
+		for (size_t i = 0; i < a.cmass_wood_inc_5.size(); i++) {
+			wood_inc.add(a.cmass_wood_inc_5[i] + b.cmass_wood_inc_5[i]);
+		}
+		a.cmass_wood_inc_5 = wood_inc;
+	}
+}
+
+/// Merges similar cohorts of the same PFT in a patch
+/** Cohorts are merged if their height, stem diameter and individual biomass
+ *  are all within the relative tolerances merge_height_tol, merge_dbh_tol and
+ *  merge_biomass_tol. If max_indiv_per_patch > 0, the most similar pairs are
+ *  then merged regardless of tolerance until the cap is met (or no eligible
+ *  pairs remain). Only living tree cohorts take part; saplings established
+ *  this year are merged at the earliest in the next year. The number of merges
+ *  is counted per PFT in Patchpft::cohort_merges.
+ */
+void merge_cohorts(Patch& patch) {
+
+	Vegetation& vegetation = patch.vegetation;
+
+	// Cohorts absorbed by another cohort, removed from the vegetation at the end
+	std::vector<bool> absorbed(vegetation.nobj, false);
+	unsigned int nremaining = vegetation.nobj;
+
+	// Merge all pairs within tolerance, oldest (first created) cohort absorbing
+	for (unsigned int i = 0; i < vegetation.nobj; i++) {
+		Individual& a = vegetation[i];
+		if (absorbed[i] || !mergeable(a)) continue;
+
+		for (unsigned int j = i + 1; j < vegetation.nobj; j++) {
+			Individual& b = vegetation[j];
+			if (absorbed[j] || !mergeable(b) || b.pft.id != a.pft.id) continue;
+
+			if (cohort_distance(a, b) <= 1.0 && merged_allometry_ok(a, b)) {
+				merge_into(a, b);
+				if (!allometry(a)) {
+					fail("merge_cohorts: bad allometry after merging cohorts of %s\n",
+						(char*)a.pft.name);
+				}
+				absorbed[j] = true;
+				nremaining--;
+				patch.pft[a.pft.id].cohort_merges++;
+			}
+		}
+	}
+
+	// Impose hard cap by merging the most similar pairs
+	while (max_indiv_per_patch > 0 && nremaining > (unsigned int)max_indiv_per_patch) {
+
+		int best_i = -1, best_j = -1;
+		double best_distance = 0.0;
+
+		for (unsigned int i = 0; i < vegetation.nobj; i++) {
+			Individual& a = vegetation[i];
+			if (absorbed[i] || !mergeable(a)) continue;
+
+			for (unsigned int j = i + 1; j < vegetation.nobj; j++) {
+				Individual& b = vegetation[j];
+				if (absorbed[j] || !mergeable(b) || b.pft.id != a.pft.id) continue;
+
+				double distance = cohort_distance(a, b);
+				if ((best_i < 0 || distance < best_distance) && merged_allometry_ok(a, b)) {
+					best_i = i;
+					best_j = j;
+					best_distance = distance;
+				}
+			}
+		}
+
+		if (best_i < 0) {
+			// No eligible pairs left, cap can't be met this year
+			break;
+		}
+
+		Individual& a = vegetation[best_i];
+		merge_into(a, vegetation[best_j]);
+		if (!allometry(a)) {
+			fail("merge_cohorts: bad allometry after merging cohorts of %s\n",
+				(char*)a.pft.name);
+		}
+		absorbed[best_j] = true;
+		nremaining--;
+		patch.pft[a.pft.id].cohort_merges++;
+	}
+
+	// Remove absorbed cohorts, their C and N now belongs to the absorbing cohorts
+
+	if (nremaining == vegetation.nobj) {
+		return;
+	}
+
+	unsigned int i = 0;
+	vegetation.firstobj();
+	while (vegetation.isobj) {
+		if (absorbed[i++]) {
+			vegetation.killobj();
+		}
+		else {
+			vegetation.nextobj();
+		}
+	}
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////////////
 // VEGETATION DYNAMICS
 // Should be called by framework at the end of each simulation year, after vegetation,
@@ -1535,6 +1782,12 @@ void vegetation_dynamics(Stand& stand,Patch& patch, Gridcell& gridcell) {
 	}
 	patch.fireprob = fireprob;
 
+	patch.pft.firstobj();
+	while (patch.pft.isobj) {
+		patch.pft.getobj().cohort_merges = 0;
+		patch.pft.nextobj();
+	}
+
 	if (vegmode == POPULATION) {
 
 		// POPULATION MODE
@@ -1583,6 +1836,11 @@ void vegetation_dynamics(Stand& stand,Patch& patch, Gridcell& gridcell) {
 
 		// Establishment
 		establishment_guess(stand,patch, gridcell);
+
+		// Merging of similar cohorts
+		if (ifmergecohorts) {
+			merge_cohorts(patch);
+		}
 	}
 
 	patch.age++;
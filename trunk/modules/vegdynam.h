@@ -18,4 +18,7 @@
 
 void vegetation_dynamics(Stand& stand,Patch& patch, Gridcell& gridcell);
 
+/// Merges similar cohorts of the same PFT in a patch, see ifmergecohorts
+void merge_cohorts(Patch& patch);
+
 #endif // LPJ_GUESS_VEGDYNAM_H
@@ -2292,7 +2292,7 @@ void weathergen_get_met(Gridcell& gridcell, double* in_mtemp, double* in_mprec,
 		   double* out_dwind, double* out_drhum) {
 
 	bool is_first_day = ( date.day == 0 && ( date.year == 0 || 
-		( restart && date.year == state_year ) ) );
+		date.year == gridcell.resume_year ) );
 
 	WeatherGenState& rndst = gridcell.climate.weathergenstate;
 
@@ -2365,7 +2365,7 @@ void weathergen_get_met(Gridcell& gridcell, double* in_mtemp, double* in_mprec,
 			calc_cloud_params(metvars);
 
 			// Set initial vals if spinning up
-			if ( ! restart ) {
+			if ( date.year != gridcell.resume_year ) {
 				init_weathergen(metvars, rndst);
 				get_seed_by_location(lat,lon ,rndst);
 				i_count = 0;
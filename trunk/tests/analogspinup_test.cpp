@@ -0,0 +1,92 @@
+///////////////////////////////////////////////////////////////////////////////////////
+/// \file analogspinup_test.cpp
+/// \brief Unit tests for seeding grid cells from climate analogs
+///
+/// $Date$
+///
+///////////////////////////////////////////////////////////////////////////////////////
+
+#include "config.h"
+#include "catch.hpp"
+
+#include "analogspinup.h"
+#include "driver.h"
+#include "archive.h"
+
+#include <sstream>
+#include <vector>
+
+namespace {
+
+/// The soils of all patches in a grid cell
+std::vector<Soil*> soils(Gridcell& gridcell) {
+
+	std::vector<Soil*> result;
+	for (Gridcell::iterator gc_itr = gridcell.begin(); gc_itr != gridcell.end(); ++gc_itr) {
+		Stand& stand = *gc_itr;
+		for (unsigned int p = 0; p < stand.nobj; p++) {
+			result.push_back(&stand[p].soil);
+		}
+	}
+	return result;
+}
+
+/// Sets up a grid cell with a natural stand on a soil of uniform available water capacity
+void create_gridcell(Gridcell& gridcell, double awc) {
+
+	gridcell.set_coordinates(12.25, 55.75);
+	for (int ly = 0; ly < NSOILLAYER; ly++) {
+		gridcell.soiltype.awc[ly] = awc;
+	}
+	gridcell.create_stand(NATURAL, 1);
+
+	std::vector<Soil*> patch_soils = soils(gridcell);
+	for (size_t p = 0; p < patch_soils.size(); p++) {
+		patch_soils[p]->reset_water_capacity();
+		for (int ly = 0; ly < NSOILLAYER; ly++) {
+			patch_soils[p]->set_layer_soil_water(ly, 0.5);
+		}
+	}
+}
+
+}
+
+TEST_CASE("analogspinup/soil", "A seeded grid cell keeps the water holding capacity of its own soil") {
+
+	date.init(1);
+
+	Gridcell analog;
+	create_gridcell(analog, 20.0);
+
+	std::ostringstream state;
+	{
+		ArchiveOutStream arch(state);
+		analog.serialize(arch);
+	}
+
+	Gridcell gridcell;
+	create_gridcell(gridcell, 10.0);
+
+	AnalogSpinup::seed(gridcell, state.str());
+
+	const std::vector<Soil*> analog_soils = soils(analog);
+	const std::vector<Soil*> seeded_soils = soils(gridcell);
+	REQUIRE(seeded_soils.size() == analog_soils.size());
+	REQUIRE(!seeded_soils.empty());
+
+	for (size_t p = 0; p < seeded_soils.size(); p++) {
+		const Soil& soil = *seeded_soils[p];
+		REQUIRE(soil.patch.cloned);
+
+		for (int ly = 0; ly < NSOILLAYER; ly++) {
+			// 10 mm in a 100 mm layer
+			REQUIRE(soil.aw_max[ly] == Approx(10.0));
+			REQUIRE(soil.whc[ly] == Approx(10.0));
+			REQUIRE(soil.alwhc[ly] == Approx(0.1));
+			REQUIRE(analog_soils[p]->aw_max[ly] == Approx(20.0));
+
+			// The water content, relative to capacity, is the analog's
+			REQUIRE(soil.get_layer_soil_water(ly) == Approx(0.5));
+		}
+	}
+}
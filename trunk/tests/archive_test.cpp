@@ -0,0 +1,225 @@
+///////////////////////////////////////////////////////////////////////////////////////
+/// \file archive_test.cpp
+/// \brief Unit tests for tagged and versioned archives
+///
+/// $Date$
+///
+///////////////////////////////////////////////////////////////////////////////////////
+
+#include "config.h"
+#include "catch.hpp"
+
+#include "archive.h"
+
+#include <sstream>
+
+/// A serializable class with a field added in version 3
+struct ArchiveTestInner : public Serializable {
+	ArchiveTestInner() : a(1), b(2), added(3) {}
+
+	void serialize(ArchiveStream& arch) {
+		arch & STATE_FIELD(a) & STATE_FIELD(b);
+		if (arch.version() >= 3) {
+			arch & STATE_FIELD(added);
+		}
+	}
+
+	const char* state_tag() const { return "ArchiveTestInner"; }
+
+	int a;
+	double b;
+	double added;
+};
+
+struct ArchiveTestOuter : public Serializable {
+	ArchiveTestOuter() : n(4) {}
+
+	void serialize(ArchiveStream& arch) {
+		arch & STATE_FIELD(n) & STATE_FIELD(inner);
+	}
+
+	const char* state_tag() const { return "ArchiveTestOuter"; }
+
+	int n;
+	ArchiveTestInner inner;
+};
+
+/// Reads ArchiveTestInner as if its second field had been changed to a float
+struct ArchiveTestChanged : public Serializable {
+	ArchiveTestChanged() : a(0), b(0) {}
+
+	void serialize(ArchiveStream& arch) {
+		arch.begin_object("ArchiveTestInner");
+		arch & STATE_FIELD(a) & STATE_FIELD(b);
+		arch.end_object();
+	}
+
+	const char* state_tag() const { return "ArchiveTestInner"; }
+
+	int a;
+	float b;
+};
+
+/// Reads ArchiveTestInner as if its second field had been renamed
+struct ArchiveTestRenamed : public Serializable {
+	ArchiveTestRenamed() : a(0), c(0) {}
+
+	void serialize(ArchiveStream& arch) {
+		arch & STATE_FIELD(a) & STATE_FIELD(c);
+	}
+
+	const char* state_tag() const { return "ArchiveTestInner"; }
+
+	int a;
+	double c;
+};
+
+namespace {
+
+std::string write(ArchiveTestOuter& outer, int version, bool tagged) {
+	std::ostringstream os;
+	ArchiveOutStream arch(os);
+	arch.set_format(version, tagged);
+	arch & outer.inner;
+	return os.str();
+}
+
+}
+
+TEST_CASE("archive/tagged", "Reading tagged data") {
+
+	ArchiveTestOuter outer;
+	outer.inner.a = 10;
+	outer.inner.b = 20;
+	outer.inner.added = 30;
+
+	SECTION("untagged", "Untagged data has no overhead") {
+		REQUIRE(write(outer, 3, false).size() == sizeof(int) + 2 * sizeof(double));
+	}
+
+	SECTION("roundtrip", "Tagged data is read back") {
+		std::istringstream is(write(outer, ARCHIVE_VERSION, true));
+		ArchiveInStream arch(is);
+		arch.set_format(ARCHIVE_VERSION, true);
+
+		ArchiveTestInner inner;
+		arch & inner;
+		REQUIRE(inner.a == 10);
+		REQUIRE(inner.b == 20);
+		REQUIRE(inner.added == 30);
+	}
+
+	SECTION("unnamed", "Version 3 tags have no field names") {
+		const std::string unnamed = write(outer, 3, true);
+		REQUIRE(unnamed.size() < write(outer, ARCHIVE_VERSION, true).size());
+
+		std::istringstream is(unnamed);
+		ArchiveInStream arch(is);
+		arch.set_format(3, true);
+
+		ArchiveTestInner inner;
+		arch & inner;
+		REQUIRE(inner.a == 10);
+		REQUIRE(inner.b == 20);
+		REQUIRE(inner.added == 30);
+	}
+
+	SECTION("renamed", "A field with a different name is reported") {
+		std::istringstream is(write(outer, ARCHIVE_VERSION, true));
+		ArchiveInStream arch(is);
+		arch.set_format(ARCHIVE_VERSION, true);
+
+		ArchiveTestRenamed renamed;
+		std::string error;
+		try {
+			arch & renamed;
+		}
+		catch (const ArchiveError& e) {
+			error = e.what();
+		}
+		REQUIRE(error.find("ArchiveTestInner, field 2 (c)") != std::string::npos);
+		REQUIRE(error.find("expected c, the state file has b") != std::string::npos);
+	}
+
+	SECTION("version", "Fields added in a later version keep their initial value") {
+		std::istringstream is(write(outer, 2, true));
+		ArchiveInStream arch(is);
+		arch.set_format(2, true);
+
+		ArchiveTestInner inner;
+		arch & inner;
+		REQUIRE(inner.a == 10);
+		REQUIRE(inner.added == 3);
+	}
+
+	SECTION("missing", "A field missing in the data is reported") {
+		std::istringstream is(write(outer, 2, true));
+		ArchiveInStream arch(is);
+		arch.set_format(3, true);
+
+		ArchiveTestInner inner;
+		std::string error;
+		try {
+			arch & inner;
+		}
+		catch (const ArchiveError& e) {
+			error = e.what();
+		}
+		REQUIRE(error.find("ArchiveTestInner, field 3") != std::string::npos);
+		REQUIRE(error.find("end of the object") != std::string::npos);
+	}
+
+	SECTION("changed", "A field with a different size is reported") {
+		std::istringstream is(write(outer, ARCHIVE_VERSION, true));
+		ArchiveInStream arch(is);
+		arch.set_format(ARCHIVE_VERSION, true);
+
+		ArchiveTestChanged changed;
+		std::string error;
+		try {
+			changed.serialize(arch);
+		}
+		catch (const ArchiveError& e) {
+			error = e.what();
+		}
+		REQUIRE(error.find("ArchiveTestInner, field 2") != std::string::npos);
+		REQUIRE(error.find("expected a field of 4 bytes") != std::string::npos);
+	}
+}
+
+TEST_CASE("archive/skip", "Skipping objects and mapping PFTs in tagged data") {
+
+	// With and without field names in the tags
+	const int versions[] = { 3, ARCHIVE_VERSION };
+
+	for (int v = 0; v < 2; v++) {
+		ArchiveTestOuter first, second;
+		first.n = 1;
+		second.n = 2;
+
+		std::ostringstream os;
+		ArchiveOutStream out(os);
+		out.set_format(versions[v], true);
+		out & first & second;
+
+		std::istringstream is(os.str());
+		ArchiveInStream in(is);
+		in.set_format(versions[v], true);
+
+		std::vector<int> pft_map;
+		pft_map.push_back(-1);
+		pft_map.push_back(0);
+		in.set_pft_map(pft_map);
+
+		REQUIRE(in.stored_npft(1) == 2);
+		REQUIRE(in.current_pft(0) == -1);
+		REQUIRE(in.current_pft(1) == 0);
+
+		REQUIRE(in.can_skip());
+		in.skip_object();
+
+		ArchiveTestOuter read;
+		in & read;
+		REQUIRE(read.n == 2);
+	}
+}
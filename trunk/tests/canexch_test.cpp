@@ -0,0 +1,95 @@
+///////////////////////////////////////////////////////////////////////////////////////
+/// \file canexch_test.cpp
+/// \brief Unit tests for the dormant day fast path in canopy exchange
+///
+/// $Date$
+///
+///////////////////////////////////////////////////////////////////////////////////////
+
+#include "config.h"
+#include "catch.hpp"
+
+#include "canexch.h"
+
+namespace {
+
+/// A C3 tree PFT with the photosynthesis parameters of a boreal needleleaved tree
+void init_pft(Pft& pft) {
+	pft.pathway = C3;
+	pft.lifeform = TREE;
+	pft.phenology = EVERGREEN;
+	pft.lambda_max = 0.8;
+	pft.pstemp_min = -4;
+	pft.pstemp_low = 10;
+	pft.pstemp_high = 25;
+	pft.pstemp_max = 38;
+}
+
+/// Whether a photosynthesis result is identical to a cleared one
+bool is_cleared(const PhotosynthesisResult& result) {
+	PhotosynthesisResult cleared;
+	return result.agd_g == cleared.agd_g &&
+		result.adtmm == cleared.adtmm &&
+		result.rd_g == cleared.rd_g &&
+		result.vm == cleared.vm &&
+		result.je == cleared.je &&
+		result.nactive_opt == cleared.nactive_opt &&
+		result.vmaxnlim == cleared.vmaxnlim;
+}
+
+}
+
+TEST_CASE("canexch/dormant", "Photosynthesis is zero whenever the fast path skips it") {
+
+	Pft pft;
+	init_pft(pft);
+
+	const double temps[] = { -30, -4.0001, -4, 0, 15, 38, 38.0001, 45 };
+	const double daylengths[] = { 0, 1e-31, 0.5, 12, 24 };
+	const double fpars[] = { 0.1, 1.0 };
+	const double lambdas[] = { 0.3, 0.8 };
+	const double vms[] = { -1, 0.5 };
+
+	int nskipped = 0;
+
+	for (size_t t = 0; t < sizeof(temps)/sizeof(double); t++) {
+		for (size_t d = 0; d < sizeof(daylengths)/sizeof(double); d++) {
+
+			bool skipped = no_photosynthesis(pft, temps[t], daylengths[d]);
+			nskipped += skipped;
+
+			for (size_t f = 0; f < sizeof(fpars)/sizeof(double); f++) {
+				for (size_t l = 0; l < sizeof(lambdas)/sizeof(double); l++) {
+					for (size_t v = 0; v < sizeof(vms)/sizeof(double); v++) {
+
+						// Vmax is only calculated with stomates fully open
+						if (vms[v] < 0 && lambdas[l] != pft.lambda_max) {
+							continue;
+						}
+
+						PhotosynthesisEnvironment ps_env;
+						ps_env.set(350, temps[t], 1e7, fpars[f], daylengths[d]);
+
+						PhotosynthesisStresses ps_stress;
+						ps_stress.set(true, 1.0, 1.0, 1.0);
+
+						PhotosynthesisResult result;
+						result.vm = 123;
+
+						photosynthesis(ps_env, ps_stress, pft, lambdas[l], 1.0, vms[v], result);
+
+						if (skipped) {
+							REQUIRE(is_cleared(result));
+						}
+						else {
+							REQUIRE(!is_cleared(result));
+						}
+					}
+				}
+			}
+		}
+	}
+
+	// Polar night and both temperature limits must have been exercised
+	REQUIRE(nskipped == 2 * 8 + 3 * 4);
+}
@@ -0,0 +1,60 @@
+///////////////////////////////////////////////////////////////////////////////////////
+/// \file capture_test.cpp
+/// \brief Unit tests for capture bundles
+///
+/// $Date$
+///
+///////////////////////////////////////////////////////////////////////////////////////
+
+#include "config.h"
+#include "catch.hpp"
+
+#include "plib.h"
+
+#include <stdio.h>
+#include <fstream>
+
+namespace {
+
+void write_file(const char* filename, const char* content) {
+	std::ofstream out(filename);
+	out << content;
+}
+
+}
+
+TEST_CASE("capture/flatten", "Flattening an instruction file with imports") {
+
+	write_file("capture_test_main.ins",
+	           "nyear 10\n"
+	           "import \"capture_test_common.ins\"\n"
+	           "title 'main'\n");
+	write_file("capture_test_common.ins",
+	           "npatch 5\n"
+	           "import 'capture_test_pfts.ins'\n"
+	           "ifcentury 1");
+	write_file("capture_test_pfts.ins",
+	           "pft \"TeBS\" (\n"
+	           "\tinclude 1\n"
+	           ")\n");
+
+	std::string script;
+	REQUIRE(plibflatten("capture_test_main.ins", script));
+
+	REQUIRE(script ==
+	        "nyear 10\n"
+	        "!import \"capture_test_common.ins\"\n"
+	        "npatch 5\n"
+	        "!import 'capture_test_pfts.ins'\n"
+	        "pft \"TeBS\" (\n"
+	        "\tinclude 1\n"
+	        ")\n"
+	        "ifcentury 1\n"
+	        "title 'main'\n");
+
+	REQUIRE(!plibflatten("capture_test_missing.ins", script));
+
+	remove("capture_test_main.ins");
+	remove("capture_test_common.ins");
+	remove("capture_test_pfts.ins");
+}
@@ -0,0 +1,320 @@
+///////////////////////////////////////////////////////////////////////////////////////
+/// \file cfremap_test.cpp
+/// \brief Unit tests for remapping CF forcing to grid cells off the forcing grid
+///
+/// $Date$
+///
+///////////////////////////////////////////////////////////////////////////////////////
+
+#include "config.h"
+#include "catch.hpp"
+
+#ifdef HAVE_NETCDF
+
+#include "cfremap.h"
+#include "cfvariable.h"
+#include <netcdf.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <fstream>
+#include <sstream>
+
+using namespace GuessNC::CF;
+
+namespace {
+
+const char* TEST_FILE = "cfremap_test.nc";
+
+/// The source grid, 1 degree cells with centres at 0.5 ... 9.5 in both directions
+const int GRID_SIZE = 10;
+
+const double MISSING = -9999;
+
+/// A linear field on the source grid
+double field(double lon, double lat) {
+	return 2 * lon + 3 * lat + 1;
+}
+
+std::vector<double> grid_coordinates() {
+	std::vector<double> coordinates;
+	for (int i = 0; i < GRID_SIZE; ++i) {
+		coordinates.push_back(i + 0.5);
+	}
+	return coordinates;
+}
+
+/// Applies remapping weights to the field
+double remap_field(const std::vector<RemapWeight>& weights) {
+	const std::vector<double> coordinates = grid_coordinates();
+	double result = 0;
+	for (size_t i = 0; i < weights.size(); ++i) {
+		result += weights[i].weight * field(coordinates[weights[i].x], coordinates[weights[i].y]);
+	}
+	return result;
+}
+
+/// A field on a global grid of 10 degree cells, periodic in longitude
+double global_field(double lon, double lat) {
+	const double lon_rad = lon * 3.14159265358979323846 / 180;
+	const double lat_rad = lat * 3.14159265358979323846 / 180;
+	return 280 + 20 * cos(lat_rad) + 5 * sin(lon_rad) + 3 * cos(2 * lon_rad) * sin(lat_rad);
+}
+
+/// Applies remapping weights to the global field
+double remap_global_field(const std::vector<RemapWeight>& weights) {
+	double result = 0;
+	for (size_t i = 0; i < weights.size(); ++i) {
+		result += weights[i].weight * global_field(5 + 10.0 * weights[i].x, -85 + 10.0 * weights[i].y);
+	}
+	return result;
+}
+
+/// The reference file, in the data directory next to this file
+std::string reference_file() {
+	std::string path = __FILE__;
+	const size_t slash = path.find_last_of("/\\");
+	path = slash == std::string::npos ? std::string(".") : path.substr(0, slash);
+	return path + "/data/cfremap_reference.txt";
+}
+
+void put_text(int ncid, int varid, const char* name, const char* value) {
+	REQUIRE(nc_put_att_text(ncid, varid, name, strlen(value), value) == NC_NOERR);
+}
+
+/// Writes the field to a CF file, plus the timestep in each timestep
+/** The value at lon 3.5, lat 4.5 is missing. */
+void write_file(int timesteps) {
+
+	int ncid;
+	REQUIRE(nc_create(TEST_FILE, NC_CLOBBER, &ncid) == NC_NOERR);
+
+	int time_dim, lat_dim, lon_dim;
+	REQUIRE(nc_def_dim(ncid, "time", timesteps, &time_dim) == NC_NOERR);
+	REQUIRE(nc_def_dim(ncid, "lat", GRID_SIZE, &lat_dim) == NC_NOERR);
+	REQUIRE(nc_def_dim(ncid, "lon", GRID_SIZE, &lon_dim) == NC_NOERR);
+
+	int time_var, lat_var, lon_var, tas_var;
+	REQUIRE(nc_def_var(ncid, "time", NC_DOUBLE, 1, &time_dim, &time_var) == NC_NOERR);
+	REQUIRE(nc_def_var(ncid, "lat", NC_DOUBLE, 1, &lat_dim, &lat_var) == NC_NOERR);
+	REQUIRE(nc_def_var(ncid, "lon", NC_DOUBLE, 1, &lon_dim, &lon_var) == NC_NOERR);
+
+	int dims[] = { time_dim, lat_dim, lon_dim };
+	REQUIRE(nc_def_var(ncid, "tas", NC_DOUBLE, 3, dims, &tas_var) == NC_NOERR);
+
+	put_text(ncid, time_var, "units", "days since 2000-01-01 00:00:00");
+	put_text(ncid, time_var, "calendar", "standard");
+	put_text(ncid, lat_var, "units", "degrees_north");
+	put_text(ncid, lat_var, "standard_name", "latitude");
+	put_text(ncid, lon_var, "units", "degrees_east");
+	put_text(ncid, lon_var, "standard_name", "longitude");
+	put_text(ncid, tas_var, "units", "K");
+	put_text(ncid, tas_var, "standard_name", "air_temperature");
+	REQUIRE(nc_put_att_double(ncid, tas_var, "missing_value", NC_DOUBLE, 1, &MISSING) == NC_NOERR);
+
+	REQUIRE(nc_enddef(ncid) == NC_NOERR);
+
+	const std::vector<double> coordinates = grid_coordinates();
+
+	std::vector<double> time(timesteps), tas;
+	for (int t = 0; t < timesteps; ++t) {
+		time[t] = t;
+		for (int y = 0; y < GRID_SIZE; ++y) {
+			for (int x = 0; x < GRID_SIZE; ++x) {
+				if (x == 3 && y == 4) {
+					tas.push_back(MISSING);
+				}
+				else {
+					tas.push_back(field(coordinates[x], coordinates[y]) + t);
+				}
+			}
+		}
+	}
+
+	REQUIRE(nc_put_var_double(ncid, time_var, &time.front()) == NC_NOERR);
+	REQUIRE(nc_put_var_double(ncid, lat_var, &coordinates.front()) == NC_NOERR);
+	REQUIRE(nc_put_var_double(ncid, lon_var, &coordinates.front()) == NC_NOERR);
+	REQUIRE(nc_put_var_double(ncid, tas_var, &tas.front()) == NC_NOERR);
+
+	REQUIRE(nc_close(ncid) == NC_NOERR);
+}
+
+}
+
+TEST_CASE("cfremap/weights", "Remapped values of a linear field") {
+
+	const std::vector<double> coordinates = grid_coordinates();
+	std::vector<RemapWeight> weights;
+
+	SECTION("none", "Without remapping only grid points are found") {
+		GridRemapper remapper(coordinates, coordinates, REMAP_NONE);
+		REQUIRE(remapper.get_weights(3.5, 4.5, weights));
+		REQUIRE(weights.size() == 1);
+		REQUIRE(remap_field(weights) == Approx(field(3.5, 4.5)));
+		REQUIRE(!remapper.get_weights(3.2, 4.9, weights));
+	}
+
+	SECTION("nearest", "The value of the closest grid point") {
+		GridRemapper remapper(coordinates, coordinates, REMAP_NEAREST);
+		REQUIRE(remapper.get_weights(3.2, 4.9, weights));
+		REQUIRE(weights.size() == 1);
+		REQUIRE(remap_field(weights) == Approx(field(3.5, 4.5)));
+
+		// Longitudes are shifted by whole turns to the grid
+		REQUIRE(remapper.get_weights(363.2, 4.9, weights));
+		REQUIRE(remap_field(weights) == Approx(field(3.5, 4.5)));
+
+		REQUIRE(!remapper.get_weights(-5, 4.9, weights));
+		REQUIRE(!remapper.get_weights(3.2, 20, weights));
+	}
+
+	SECTION("bilinear", "A linear field is reproduced exactly within the grid") {
+		GridRemapper remapper(coordinates, coordinates, REMAP_BILINEAR);
+		REQUIRE(remapper.get_weights(3.2, 4.9, weights));
+		REQUIRE(weights.size() == 4);
+		REQUIRE(remap_field(weights) == Approx(field(3.2, 4.9)));
+
+		REQUIRE(remapper.get_weights(7.75, 1.5, weights));
+		REQUIRE(weights.size() == 2);
+		REQUIRE(remap_field(weights) == Approx(field(7.75, 1.5)));
+	}
+
+	SECTION("conservative", "Area weighted means of the overlapping cells") {
+		// The values are compared with cfremap_reference.txt in cfremap/reference
+
+		GridRemapper two_degrees(coordinates, coordinates, REMAP_CONSERVATIVE, 2);
+		REQUIRE(two_degrees.get_weights(4, 6, weights));
+		REQUIRE(weights.size() == 4);
+
+		GridRemapper one_degree(coordinates, coordinates, REMAP_CONSERVATIVE, 1);
+		REQUIRE(one_degree.get_weights(3, 5, weights));
+		REQUIRE(weights.size() == 4);
+
+		// A cell on the source grid maps to itself
+		REQUIRE(one_degree.get_weights(3.5, 4.5, weights));
+		REQUIRE(weights.size() == 1);
+		REQUIRE(remap_field(weights) == Approx(field(3.5, 4.5)));
+	}
+}
+
+TEST_CASE("cfremap/dateline", "Remapping across the edge of a periodic longitude axis") {
+
+	std::vector<double> lons, lats;
+	for (int i = 0; i < 36; ++i) {
+		lons.push_back(5 + 10 * i);
+	}
+	for (int j = 0; j < 18; ++j) {
+		lats.push_back(-85 + 10 * j);
+	}
+
+	std::vector<RemapWeight> weights;
+
+	SECTION("bilinear", "Between the last and the first longitude") {
+		GridRemapper remapper(lons, lats, REMAP_BILINEAR);
+
+		// 359 lies 4/10 of the way from 355 to 365 (5)
+		REQUIRE(remapper.get_weights(359, 15, weights));
+		REQUIRE(weights.size() == 2);
+		for (size_t w = 0; w < weights.size(); ++w) {
+			REQUIRE(weights[w].weight == Approx(weights[w].x == 0 ? 0.4 : 0.6));
+			REQUIRE((weights[w].x == 0 || weights[w].x == 35));
+		}
+
+		// The same location in -180-180
+		std::vector<RemapWeight> west;
+		REQUIRE(remapper.get_weights(-1, 15, west));
+		REQUIRE(remap_global_field(west) == Approx(remap_global_field(weights)));
+	}
+
+	SECTION("regional", "An axis that doesn't go round isn't wrapped") {
+		std::vector<double> regional(lons.begin(), lons.begin() + 30);
+		GridRemapper remapper(regional, lats, REMAP_BILINEAR);
+		REQUIRE(!remapper.get_weights(330, 15, weights));
+	}
+}
+
+TEST_CASE("cfremap/reference", "Remapped values compared with a reference remapped offline") {
+
+	std::ifstream file(reference_file().c_str());
+	REQUIRE(file.good());
+
+	std::vector<double> regional = grid_coordinates();
+
+	std::vector<double> global_lons, global_lats;
+	for (int i = 0; i < 36; ++i) {
+		global_lons.push_back(5 + 10 * i);
+	}
+	for (int j = 0; j < 18; ++j) {
+		global_lats.push_back(-85 + 10 * j);
+	}
+
+	int compared = 0;
+	std::string line;
+	while (std::getline(file, line)) {
+		if (line.empty() || line[0] == '#') {
+			continue;
+		}
+
+		std::istringstream fields(line);
+		std::string grid, method;
+		double size, lon, lat, reference;
+		fields >> grid >> method >> size >> lon >> lat >> reference;
+		REQUIRE(!fields.fail());
+
+		INFO(line);
+
+		const bool global = grid == "global";
+		GridRemapper remapper(global ? global_lons : regional,
+		                      global ? global_lats : regional,
+		                      parse_remap_method(method), size);
+
+		std::vector<RemapWeight> weights;
+		REQUIRE(remapper.get_weights(lon, lat, weights));
+
+		const double value = global ? remap_global_field(weights) : remap_field(weights);
+		REQUIRE(value == Approx(reference).epsilon(1e-7));
+		++compared;
+	}
+
+	REQUIRE(compared > 0);
+}
+
+TEST_CASE("cfremap/variable", "Loading remapped time series from a CF file") {
+
+	const int TIMESTEPS = 3;
+	write_file(TIMESTEPS);
+
+	GridcellOrderedVariable cf_var(TEST_FILE, "tas");
+
+	std::vector<double> lons, lats;
+	REQUIRE(cf_var.get_grid_coordinates(lons, lats));
+
+	std::vector<RemapWeight> weights;
+
+	SECTION("valid", "Weights apply to all timesteps") {
+		GridRemapper remapper(lons, lats, REMAP_BILINEAR);
+		REQUIRE(remapper.get_weights(6.2, 7.9, weights));
+		REQUIRE(cf_var.load_data_for(weights));
+
+		for (int t = 0; t < TIMESTEPS; ++t) {
+			REQUIRE(cf_var.get_value(t) == Approx(field(6.2, 7.9) + t));
+		}
+	}
+
+	SECTION("missing", "Locations with missing values are left out") {
+		GridRemapper nearest(lons, lats, REMAP_NEAREST);
+		REQUIRE(nearest.get_weights(3.2, 4.9, weights));
+		REQUIRE(!cf_var.load_data_for(weights));
+
+		// The remaining three points, with weights 0.18, 0.12 and 0.28
+		GridRemapper bilinear(lons, lats, REMAP_BILINEAR);
+		REQUIRE(bilinear.get_weights(3.2, 4.9, weights));
+		REQUIRE(cf_var.load_data_for(weights));
+		const double remaining = 0.18 * field(2.5, 4.5) + 0.12 * field(2.5, 5.5) + 0.28 * field(3.5, 5.5);
+		REQUIRE(cf_var.get_value(0) == Approx(remaining / 0.58));
+	}
+
+	remove(TEST_FILE);
+}
+
+#endif // HAVE_NETCDF
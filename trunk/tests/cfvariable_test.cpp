@@ -0,0 +1,301 @@
+///////////////////////////////////////////////////////////////////////////////////////
+/// \file cfvariable_test.cpp
+/// \brief Unit tests for reading sub-daily and split data from CF files
+///
+/// $Date$
+///
+///////////////////////////////////////////////////////////////////////////////////////
+
+#include "config.h"
+#include "catch.hpp"
+
+#ifdef HAVE_NETCDF
+
+#include "cfvariable.h"
+#include "cfinput.h"
+#include "guess.h"
+#include <netcdf.h>
+#include <stdio.h>
+#include <string.h>
+
+using namespace GuessNC::CF;
+
+namespace {
+
+const char* TEST_FILE = "cfvariable_test_subdaily.nc";
+
+void put_text(int ncid, int varid, const char* name, const char* value) {
+	REQUIRE(nc_put_att_text(ncid, varid, name, strlen(value), value) == NC_NOERR);
+}
+
+/// Writes a synthetic CF file with air temperature for one grid cell
+/** The temperature in timestep t is 250+t K. */
+void write_file(int steps_per_day, int days) {
+
+	const int timesteps = steps_per_day * days;
+
+	int ncid;
+	REQUIRE(nc_create(TEST_FILE, NC_CLOBBER, &ncid) == NC_NOERR);
+
+	int time_dim, lat_dim, lon_dim;
+	REQUIRE(nc_def_dim(ncid, "time", timesteps, &time_dim) == NC_NOERR);
+	REQUIRE(nc_def_dim(ncid, "lat", 1, &lat_dim) == NC_NOERR);
+	REQUIRE(nc_def_dim(ncid, "lon", 1, &lon_dim) == NC_NOERR);
+
+	int time_var, lat_var, lon_var, tas_var;
+	REQUIRE(nc_def_var(ncid, "time", NC_DOUBLE, 1, &time_dim, &time_var) == NC_NOERR);
+	REQUIRE(nc_def_var(ncid, "lat", NC_DOUBLE, 1, &lat_dim, &lat_var) == NC_NOERR);
+	REQUIRE(nc_def_var(ncid, "lon", NC_DOUBLE, 1, &lon_dim, &lon_var) == NC_NOERR);
+
+	int dims[] = { time_dim, lat_dim, lon_dim };
+	REQUIRE(nc_def_var(ncid, "tas", NC_DOUBLE, 3, dims, &tas_var) == NC_NOERR);
+
+	put_text(ncid, time_var, "units", "hours since 2000-12-31 00:00:00");
+	put_text(ncid, time_var, "calendar", "standard");
+	put_text(ncid, lat_var, "units", "degrees_north");
+	put_text(ncid, lat_var, "standard_name", "latitude");
+	put_text(ncid, lon_var, "units", "degrees_east");
+	put_text(ncid, lon_var, "standard_name", "longitude");
+	put_text(ncid, tas_var, "units", "K");
+	put_text(ncid, tas_var, "standard_name", "air_temperature");
+
+	REQUIRE(nc_enddef(ncid) == NC_NOERR);
+
+	std::vector<double> time(timesteps), tas(timesteps);
+	for (int t = 0; t < timesteps; ++t) {
+		time[t] = t * 24.0 / steps_per_day;
+		tas[t] = 250 + t;
+	}
+	const double lat = 55.75, lon = 12.25;
+
+	REQUIRE(nc_put_var_double(ncid, time_var, &time.front()) == NC_NOERR);
+	REQUIRE(nc_put_var_double(ncid, lat_var, &lat) == NC_NOERR);
+	REQUIRE(nc_put_var_double(ncid, lon_var, &lon) == NC_NOERR);
+	REQUIRE(nc_put_var_double(ncid, tas_var, &tas.front()) == NC_NOERR);
+
+	REQUIRE(nc_close(ncid) == NC_NOERR);
+}
+
+/// Writes one file of a variable split over several files, with daily data for two locations
+/** The temperature on day d of the whole period is 250+d K at the first
+ *  location and 350+d K at the second.
+ *
+ *  \param missing Location with missing values in this file, -1 for none
+ */
+void write_split_file(const char* filename, int first_day, int days, int missing) {
+
+	const double MISSING_VALUE = -9999;
+
+	int ncid;
+	REQUIRE(nc_create(filename, NC_CLOBBER, &ncid) == NC_NOERR);
+
+	int time_dim, lat_dim, lon_dim;
+	REQUIRE(nc_def_dim(ncid, "time", days, &time_dim) == NC_NOERR);
+	REQUIRE(nc_def_dim(ncid, "lat", 1, &lat_dim) == NC_NOERR);
+	REQUIRE(nc_def_dim(ncid, "lon", 2, &lon_dim) == NC_NOERR);
+
+	int time_var, lat_var, lon_var, tas_var;
+	REQUIRE(nc_def_var(ncid, "time", NC_DOUBLE, 1, &time_dim, &time_var) == NC_NOERR);
+	REQUIRE(nc_def_var(ncid, "lat", NC_DOUBLE, 1, &lat_dim, &lat_var) == NC_NOERR);
+	REQUIRE(nc_def_var(ncid, "lon", NC_DOUBLE, 1, &lon_dim, &lon_var) == NC_NOERR);
+
+	int dims[] = { time_dim, lat_dim, lon_dim };
+	REQUIRE(nc_def_var(ncid, "tas", NC_DOUBLE, 3, dims, &tas_var) == NC_NOERR);
+
+	put_text(ncid, time_var, "units", "days since 2001-01-01 00:00:00");
+	put_text(ncid, time_var, "calendar", "noleap");
+	put_text(ncid, lat_var, "units", "degrees_north");
+	put_text(ncid, lat_var, "standard_name", "latitude");
+	put_text(ncid, lon_var, "units", "degrees_east");
+	put_text(ncid, lon_var, "standard_name", "longitude");
+	put_text(ncid, tas_var, "units", "K");
+	put_text(ncid, tas_var, "standard_name", "air_temperature");
+	REQUIRE(nc_put_att_double(ncid, tas_var, "missing_value", NC_DOUBLE, 1, &MISSING_VALUE) == NC_NOERR);
+
+	REQUIRE(nc_enddef(ncid) == NC_NOERR);
+
+	std::vector<double> time(days), tas(days * 2);
+	for (int d = 0; d < days; ++d) {
+		time[d] = first_day + d;
+		for (int x = 0; x < 2; ++x) {
+			tas[d * 2 + x] = x == missing ? MISSING_VALUE : 250 + 100 * x + first_day + d;
+		}
+	}
+	const double lat = 55.75;
+	const double lon[] = { 12.25, 12.75 };
+
+	REQUIRE(nc_put_var_double(ncid, time_var, &time.front()) == NC_NOERR);
+	REQUIRE(nc_put_var_double(ncid, lat_var, &lat) == NC_NOERR);
+	REQUIRE(nc_put_var_double(ncid, lon_var, lon) == NC_NOERR);
+	REQUIRE(nc_put_var_double(ncid, tas_var, &tas.front()) == NC_NOERR);
+
+	REQUIRE(nc_close(ncid) == NC_NOERR);
+}
+
+/// Checks the timesteps and values read from a file written by write_file
+void check_file(int steps_per_day, int days) {
+
+	GridcellOrderedVariable cf_var(TEST_FILE, "tas");
+
+	REQUIRE(cf_var.get_timesteps() == steps_per_day * days);
+	REQUIRE(cf_var.get_timesteps_per_day() == steps_per_day);
+
+	REQUIRE(cf_var.load_data_for(0, 0));
+
+	for (int t = 0; t < cf_var.get_timesteps(); ++t) {
+		REQUIRE(cf_var.get_value(t) == 250 + t);
+	}
+
+	// The last timestep of the first day, and the first of the second
+	DateTime last = cf_var.get_date_time(steps_per_day - 1);
+	REQUIRE(last.get_year() == 2000);
+	REQUIRE(last.get_day() == 31);
+	REQUIRE(last.get_hour() == 24 - 24 / steps_per_day);
+
+	DateTime next = cf_var.get_date_time(steps_per_day);
+	REQUIRE(next.get_year() == 2001);
+	REQUIRE(next.get_month() == 1);
+	REQUIRE(next.get_day() == 1);
+	REQUIRE(next.get_hour() == 0);
+}
+
+}
+
+TEST_CASE("cfvariable/subdaily", "Timesteps per day of daily and sub-daily data") {
+
+	SECTION("hourly", "1-hourly data") {
+		write_file(24, 3);
+		check_file(24, 3);
+	}
+
+	SECTION("3-hourly", "3-hourly data") {
+		write_file(8, 3);
+		check_file(8, 3);
+	}
+
+	SECTION("6-hourly", "6-hourly data") {
+		write_file(4, 3);
+		check_file(4, 3);
+	}
+
+	SECTION("daily", "Daily data has one timestep per day") {
+		write_file(1, 3);
+		check_file(1, 3);
+	}
+
+	remove(TEST_FILE);
+}
+
+TEST_CASE("cfvariable/subdaily_mapping", "Sub-daily data mapped to the model's forcing by CFInput") {
+
+	// 3-hourly temperature, 250+t K in timestep t
+	const int steps = 8;
+	const int days = 3;
+	write_file(steps, days);
+
+	GridcellOrderedVariable cf_var(TEST_FILE, "tas");
+	REQUIRE(cf_var.load_data_for(0, 0));
+
+	std::vector<double> data(steps * days);
+	for (int t = 0; t < steps * days; ++t) {
+		data[t] = cf_var.get_value(t);
+	}
+
+	SECTION("means", "Daily means of the timesteps of each day") {
+		double daily[days];
+		CFSubdaily::daily_means(data, steps, daily);
+
+		// Mean of 250+8d ... 250+8d+7
+		for (int d = 0; d < days; ++d) {
+			REQUIRE(daily[d] == Approx(250 + steps * d + 3.5));
+		}
+
+		// Daily data is copied
+		std::vector<double> daily_data(data.begin(), data.begin() + days);
+		CFSubdaily::daily_means(daily_data, 1, daily);
+		for (int d = 0; d < days; ++d) {
+			REQUIRE(daily[d] == daily_data[d]);
+		}
+	}
+
+	SECTION("precipitation", "Daily precipitation from amounts and rates") {
+		double dprec[days];
+
+		// Amounts are summed over the day
+		CFSubdaily::daily_precipitation(data, steps, true, dprec);
+		for (int d = 0; d < days; ++d) {
+			const double sum = steps * (250 + steps * d + 3.5);
+			REQUIRE(dprec[d] == Approx(sum));
+		}
+
+		// Rates are averaged and turned into the amount of the day
+		CFSubdaily::daily_precipitation(data, steps, false, dprec);
+		for (int d = 0; d < days; ++d) {
+			const double amount = (250 + steps * d + 3.5) * 24 * 60 * 60;
+			REQUIRE(dprec[d] == Approx(amount));
+		}
+	}
+
+	SECTION("climate", "Climate::temps and Climate::insols of a day") {
+		Gridcell gridcell;
+		Climate& climate = gridcell.climate;
+
+		std::vector<double> insols(data.size());
+		for (size_t t = 0; t < insols.size(); ++t) {
+			insols[t] = 10 * t;
+		}
+
+		for (int d = 0; d < days; ++d) {
+			CFSubdaily::set_subdaily_climate(climate, data, insols, d, steps);
+
+			REQUIRE(climate.temps.size() == (size_t)steps);
+			REQUIRE(climate.insols.size() == (size_t)steps);
+
+			for (int i = 0; i < steps; ++i) {
+				const int t = steps * d + i;
+				REQUIRE(climate.temps[i] == 250 + t);
+				REQUIRE(climate.insols[i] == 10 * t);
+			}
+		}
+	}
+
+	remove(TEST_FILE);
+}
+
+TEST_CASE("cfvariable/split_missing", "Missing values in a later file of a split variable") {
+
+	// The second location has missing values in the second file only
+	const char* FILES[] = { "cfvariable_test_split_1.nc", "cfvariable_test_split_2.nc" };
+	write_split_file(FILES[0], 0, 3, -1);
+	write_split_file(FILES[1], 3, 3, 1);
+
+	GridcellOrderedVariable cf_var((std::string(FILES[0]) + " " + FILES[1]).c_str(), "tas");
+	REQUIRE(cf_var.get_timesteps() == 6);
+
+	SECTION("point", "The location is skipped when it is loaded") {
+		REQUIRE(!cf_var.load_data_for(1, 0));
+
+		REQUIRE(cf_var.load_data_for(0, 0));
+		for (int t = 0; t < cf_var.get_timesteps(); ++t) {
+			REQUIRE(cf_var.get_value(t) == 250 + t);
+		}
+	}
+
+	SECTION("remapped", "The location is left out of the weighted mean for the whole period") {
+		std::vector<RemapWeight> weights;
+		weights.push_back(RemapWeight(0, 0, 0.25));
+		weights.push_back(RemapWeight(1, 0, 0.75));
+		REQUIRE(cf_var.load_data_for(weights));
+		for (int t = 0; t < cf_var.get_timesteps(); ++t) {
+			REQUIRE(cf_var.get_value(t) == Approx(250 + t));
+		}
+
+		std::vector<RemapWeight> missing(1, RemapWeight(1, 0, 1.0));
+		REQUIRE(!cf_var.load_data_for(missing));
+	}
+
+	remove(FILES[0]);
+	remove(FILES[1]);
+}
+
+#endif // HAVE_NETCDF
@@ -0,0 +1,165 @@
+///////////////////////////////////////////////////////////////////////////////////////
+/// \file forcingcache_test.cpp
+/// \brief Unit tests for the forcing replay cache
+///
+/// $Date$
+///
+///////////////////////////////////////////////////////////////////////////////////////
+
+#include "config.h"
+#include "catch.hpp"
+
+#include "forcingcache.h"
+#include "guess.h"
+#include "driver.h"
+#include "guessstring.h"
+
+#include <stdio.h>
+#include <map>
+
+namespace {
+
+const int NYEAR = 2;
+
+const int NCELL = 2;
+
+/// Input module producing two years of pseudo random climate for two grid cells
+class FakeInput : public InputModule {
+public:
+	/** \param reverse  Whether to go through the grid cells in reverse order
+	 *  \param peek     Whether to tell the coordinates of the next grid cell
+	 */
+	FakeInput(bool reverse = false, bool peek = true)
+		: reverse(reverse), peek(peek), cell(0), replay(false), nreplayed(0) {}
+
+	void init() {}
+
+	bool getgridcell(Gridcell& gridcell) {
+		double lon, lat;
+		if (!coordinates(lon, lat)) {
+			return false;
+		}
+		gridcell.set_coordinates(lon, lat);
+		if (replay) {
+			nreplayed++;
+		}
+		cell++;
+		return true;
+	}
+
+	bool getclimate(Gridcell& gridcell) {
+		if (date.year == NYEAR) {
+			return false;
+		}
+		if (!replay) {
+			Climate& climate = gridcell.climate;
+			climate.temp = 10.0 * randfrac(gridcell.seed);
+			climate.prec = 5.0 * randfrac(gridcell.seed);
+			climate.insol = 200.0 + date.day;
+			climate.co2 = 350.0 + date.year;
+			gridcell.dNH4dep = 1e-6 * gridcell.get_lon();
+		}
+		return true;
+	}
+
+	void getlandcover(Gridcell& gridcell) {}
+
+	void getmanagement(Gridcell& gridcell) {}
+
+	void set_climate_replay(bool r) { replay = r; }
+
+	bool next_gridcell_coordinates(double& lon, double& lat) {
+		return peek && coordinates(lon, lat);
+	}
+
+	bool reverse;
+	bool peek;
+	int cell;
+	bool replay;
+	int nreplayed;
+
+private:
+
+	bool coordinates(double& lon, double& lat) const {
+		if (cell == NCELL) {
+			return false;
+		}
+		lon = 10.25 + (reverse ? NCELL - 1 - cell : cell);
+		lat = 55.75;
+		return true;
+	}
+};
+
+/// Runs all grid cells through input, returns a checksum of the climate and seeds for each grid cell
+std::map<double, double> simulate_forcing(InputModule& input) {
+	std::map<double, double> sums;
+	input.init();
+	while (true) {
+		date.init(1);
+		Gridcell gridcell;
+		gridcell.seed = 12345;
+		if (!input.getgridcell(gridcell)) {
+			break;
+		}
+		double& sum = sums[gridcell.get_lon()];
+		while (input.getclimate(gridcell)) {
+			const Climate& climate = gridcell.climate;
+			sum += climate.temp + 2*climate.prec + 3*climate.insol + 4*climate.co2 +
+				1e6*gridcell.dNH4dep + 1e-9*gridcell.seed;
+			// Draws done by the model itself between days
+			randfrac(gridcell.seed);
+			date.next();
+		}
+	}
+	return sums;
+}
+
+void remove_cache_files(const ForcingCacheInput& cache, const std::string& dir) {
+	for (int i = 0; i < NCELL; i++) {
+		remove(format_string("%s/%s_%g_%g.frc", dir.c_str(), cache.get_key().c_str(),
+		                     10.25 + i, 55.75).c_str());
+	}
+}
+
+}
+
+TEST_CASE("forcingcache/replay", "Replayed forcing equals recorded forcing") {
+
+	const std::string dir = ".";
+
+	FakeInput* uncached = new FakeInput;
+	ForcingCacheInput recorder(uncached, "fake", dir);
+	std::map<double, double> recorded = simulate_forcing(recorder);
+
+	SECTION("same", "The same grid list") {
+		FakeInput* replayed_input = new FakeInput;
+		ForcingCacheInput replayer(replayed_input, "fake", dir);
+		std::map<double, double> replayed = simulate_forcing(replayer);
+
+		REQUIRE(recorder.get_key() == replayer.get_key());
+		REQUIRE(uncached->nreplayed == 0);
+		REQUIRE(replayed_input->nreplayed == NCELL);
+		REQUIRE(recorded == replayed);
+	}
+
+	SECTION("reversed", "The grid cells in another order") {
+		FakeInput* replayed_input = new FakeInput(true);
+		ForcingCacheInput replayer(replayed_input, "fake", dir);
+		std::map<double, double> replayed = simulate_forcing(replayer);
+
+		REQUIRE(replayed_input->nreplayed == NCELL);
+		REQUIRE(recorded == replayed);
+	}
+
+	SECTION("no peeking", "A module which can't tell the next grid cell") {
+		FakeInput* replayed_input = new FakeInput(true, false);
+		ForcingCacheInput replayer(replayed_input, "fake", dir);
+		std::map<double, double> replayed = simulate_forcing(replayer);
+
+		// The module prepares the climate, which is then replaced by the cache
+		REQUIRE(replayed_input->nreplayed == 0);
+		REQUIRE(recorded == replayed);
+	}
+
+	remove_cache_files(recorder, dir);
+}
@@ -0,0 +1,149 @@
+///////////////////////////////////////////////////////////////////////////////////////
+/// \file indata_test.cpp
+/// \brief Unit tests for reading land use and management input from CF files
+///
+/// $Date$
+///
+///////////////////////////////////////////////////////////////////////////////////////
+
+#include "config.h"
+#include "catch.hpp"
+
+#ifdef HAVE_NETCDF
+
+#include "indata.h"
+#include <netcdf.h>
+#include <stdio.h>
+#include <string.h>
+
+using namespace InData;
+
+namespace {
+
+const char* TEST_FILE = "indata_test.nc";
+
+const int FIRST_YEAR = 1901;
+const int NYEARS = 3;
+
+void put_text(int ncid, int varid, const char* name, const char* value) {
+	REQUIRE(nc_put_att_text(ncid, varid, name, strlen(value), value) == NC_NOERR);
+}
+
+/// Writes a synthetic CF file with data for two grid cells
+/** TeWW is static, 100+x at location x. If yearly, TeCo has one time
+ *  step per year from FIRST_YEAR, 10*x+t in time step t.
+ */
+void write_file(bool yearly) {
+
+	int ncid;
+	REQUIRE(nc_create(TEST_FILE, NC_CLOBBER, &ncid) == NC_NOERR);
+
+	int time_dim, lat_dim, lon_dim;
+	REQUIRE(nc_def_dim(ncid, "lat", 1, &lat_dim) == NC_NOERR);
+	REQUIRE(nc_def_dim(ncid, "lon", 2, &lon_dim) == NC_NOERR);
+
+	int time_var, lat_var, lon_var, static_var, yearly_var;
+	REQUIRE(nc_def_var(ncid, "lat", NC_DOUBLE, 1, &lat_dim, &lat_var) == NC_NOERR);
+	REQUIRE(nc_def_var(ncid, "lon", NC_DOUBLE, 1, &lon_dim, &lon_var) == NC_NOERR);
+
+	int static_dims[] = { lat_dim, lon_dim };
+	REQUIRE(nc_def_var(ncid, "TeWW", NC_DOUBLE, 2, static_dims, &static_var) == NC_NOERR);
+
+	put_text(ncid, lat_var, "units", "degrees_north");
+	put_text(ncid, lat_var, "standard_name", "latitude");
+	put_text(ncid, lon_var, "units", "degrees_east");
+	put_text(ncid, lon_var, "standard_name", "longitude");
+
+	if (yearly) {
+		REQUIRE(nc_def_dim(ncid, "time", NYEARS, &time_dim) == NC_NOERR);
+		REQUIRE(nc_def_var(ncid, "time", NC_DOUBLE, 1, &time_dim, &time_var) == NC_NOERR);
+
+		int yearly_dims[] = { time_dim, lat_dim, lon_dim };
+		REQUIRE(nc_def_var(ncid, "TeCo", NC_DOUBLE, 3, yearly_dims, &yearly_var) == NC_NOERR);
+
+		put_text(ncid, time_var, "units", "days since 1901-01-01 00:00:00");
+		put_text(ncid, time_var, "calendar", "noleap");
+	}
+
+	REQUIRE(nc_enddef(ncid) == NC_NOERR);
+
+	const double lat = 55.75;
+	const double lon[] = { 12.25, 12.75 };
+	const double static_data[] = { 100, 101 };
+
+	REQUIRE(nc_put_var_double(ncid, lat_var, &lat) == NC_NOERR);
+	REQUIRE(nc_put_var_double(ncid, lon_var, lon) == NC_NOERR);
+	REQUIRE(nc_put_var_double(ncid, static_var, static_data) == NC_NOERR);
+
+	if (yearly) {
+		double time[NYEARS], yearly_data[NYEARS * 2];
+		for (int t = 0; t < NYEARS; ++t) {
+			time[t] = 365 * t;
+			for (int x = 0; x < 2; ++x) {
+				yearly_data[t * 2 + x] = 10 * x + t;
+			}
+		}
+		REQUIRE(nc_put_var_double(ncid, time_var, time) == NC_NOERR);
+		REQUIRE(nc_put_var_double(ncid, yearly_var, yearly_data) == NC_NOERR);
+	}
+
+	REQUIRE(nc_close(ncid) == NC_NOERR);
+}
+
+Coord coord(double lon, double lat) {
+	Coord c;
+	c.id = 0;
+	c.lon = lon;
+	c.lat = lat;
+	return c;
+}
+
+}
+
+TEST_CASE("indata/netcdf_static", "Static variables in a NetCDF file") {
+
+	write_file(false);
+
+	TimeDataD data;
+	REQUIRE(data.Open(TEST_FILE));
+
+	REQUIRE(data.GetFormat() == LOCAL_STATIC);
+	REQUIRE(data.GetnYears() == 1);
+
+	REQUIRE(data.Load(coord(12.75, 55.75)));
+	REQUIRE(data.Get(1901, "TeWW") == 101);
+	REQUIRE(data.Get(2000, "TeWW") == 101);
+
+	REQUIRE(data.Load(coord(12.25, 55.75)));
+	REQUIRE(data.Get(1901, "TeWW") == 100);
+
+	REQUIRE(!data.Load(coord(13.25, 55.75)));
+
+	data.Close();
+	remove(TEST_FILE);
+}
+
+TEST_CASE("indata/netcdf_mixed", "Static and yearly variables in a NetCDF file") {
+
+	write_file(true);
+
+	TimeDataD data;
+	REQUIRE(data.Open(TEST_FILE));
+
+	REQUIRE(data.GetFormat() == LOCAL_YEARLY);
+	REQUIRE(data.GetFirstyear() == FIRST_YEAR);
+	REQUIRE(data.GetnYears() == NYEARS);
+
+	REQUIRE(data.Load(coord(12.75, 55.75)));
+
+	for (int t = 0; t < NYEARS; ++t) {
+		REQUIRE(data.Get(FIRST_YEAR + t, "TeCo") == 10 + t);
+		// The static value in every year
+		REQUIRE(data.Get(FIRST_YEAR + t, "TeWW") == 101);
+	}
+
+	data.Close();
+	remove(TEST_FILE);
+}
+
+#endif // HAVE_NETCDF
@@ -85,3 +85,15 @@ TEST_CASE("Historic/periodic", "Some basic tests of the period functions in Hist
 	REQUIRE(history.min() == Approx(2));
 	REQUIRE(history.max() == Approx(4));
 }
+
+TEST_CASE("sample_size", "Tests of sample size for a relative standard error") {
+
+	REQUIRE(sample_size(0, 0.05) == 1);
+
+	// cv/sqrt(n) <= tolerance
+	REQUIRE(sample_size(0.5, 0.25) == 4);
+	REQUIRE(sample_size(0.75, 0.25) == 9);
+	REQUIRE(sample_size(0.8, 0.25) == 11);
+
+	REQUIRE(sample_size(1e10, 1e-4) == 1000000000);
+}
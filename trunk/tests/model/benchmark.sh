@@ -0,0 +1,80 @@
+#!/bin/bash
+
+# Times runs of the model test demo (see compare_runs.sh) with one or more
+# guess binaries, typically a build of a change and a build of the code
+# before it. The binaries are run in turn, so changes in the load of the
+# machine affect them alike, and the median and fastest wall and user
+# times of each are printed.
+#
+#   benchmark.sh [-n <runs>] [-i <ins file>] <guess binary>... [-- <setting>...]
+#
+# -n gives the number of runs per binary (default 5). -i chooses the
+# instruction file in this directory to run (default demo.ins, bvoc.ins
+# adds BVOC emissions). Settings after -- are added to the instruction
+# file, for instance:
+#
+#   benchmark.sh -i bvoc.ins new/guess old/guess -- "npatch 30"
+#
+# The runs are done in a directory named benchmark in the current
+# working directory.
+
+NRUNS=5
+INSFILE=demo.ins
+
+while getopts "n:i:" opt; do
+    case $opt in
+	n) NRUNS=$OPTARG ;;
+	i) INSFILE=$OPTARG ;;
+	*) exit 1 ;;
+    esac
+done
+shift $((OPTIND-1))
+
+BINARIES=()
+while [ $# -gt 0 ] && [ "$1" != "--" ]; do
+    BINARIES+=("$1")
+    shift
+done
+if [ "$1" == "--" ]; then
+    shift
+fi
+
+if [ ${#BINARIES[@]} -eq 0 ]; then
+    echo "Usage: $0 [-n <runs>] [-i <ins file>] <guess binary>... [-- <setting>...]"
+    exit 1
+fi
+
+DATA_DIR=$(cd $(dirname $0) && pwd)
+WORK_DIR=$(pwd)/benchmark
+
+rm -rf $WORK_DIR
+mkdir -p $WORK_DIR
+cp $DATA_DIR/*.ins $DATA_DIR/*.txt $WORK_DIR/
+echo "import \"$INSFILE\"" > $WORK_DIR/run.ins
+for setting in "$@"; do
+    echo "$setting" >> $WORK_DIR/run.ins
+done
+
+# Median and minimum of the numbers on standard input
+summarize() {
+    sort -g | awk '{ v[NR] = $1 } END { printf "median %8.2f s  min %8.2f s", v[int((NR+1)/2)], v[1] }'
+}
+
+TIMEFORMAT="%R %U"
+for ((run = 0; run < NRUNS; run++)); do
+    for ((b = 0; b < ${#BINARIES[@]}; b++)); do
+	{ time (cd $WORK_DIR && ${BINARIES[$b]} -input demo run.ins > guess.log 2>&1) ; } 2>> $WORK_DIR/times_$b.txt
+	if ! grep -q Finished $WORK_DIR/guess.log; then
+	    echo "Run with ${BINARIES[$b]} failed:"
+	    tail -n 20 $WORK_DIR/guess.log
+	    exit 1
+	fi
+    done
+done
+
+echo "$NRUNS runs of $INSFILE $*"
+for ((b = 0; b < ${#BINARIES[@]}; b++)); do
+    echo "${BINARIES[$b]}"
+    echo "  wall $(cut -d' ' -f1 $WORK_DIR/times_$b.txt | summarize)"
+    echo "  user $(cut -d' ' -f2 $WORK_DIR/times_$b.txt | summarize)"
+done
@@ -0,0 +1,183 @@
+#!/bin/bash
+
+# Model level tests. Each test runs the small demo in this directory
+# (three boreal/arctic grid cells with monthly forcing, see demo.ins)
+# twice in different ways which should give the same results, and
+# compares every output file of the two runs.
+#
+# The tests are registered with ctest in the top level CMakeLists.txt,
+# but can also be run by hand:
+#
+#   compare_runs.sh <guess binary> <test> [<mpirun>]
+#
+# Available tests:
+#
+#   dormantfastpath  Canopy exchange with and without the shortcut for
+#                    dormant vegetation (ifdormantfastpath).
+#
+#   patchorder       The patches of each stand simulated in the usual
+#                    and in reverse order (ifreversepatchorder). Patches
+#                    draw from their own random streams and don't share
+#                    state within a day, so the order doesn't matter.
+#
+#   migration        A serial run against a parallel run with two
+#                    processes and grid cell migration (-migrate), where
+#                    the second process starts with an empty gridlist so
+#                    it only simulates grid cells migrated to it. The
+#                    test fails if no grid cell is migrated.
+#
+#   ioforwarding     A serial run against a parallel run with three
+#                    processes, where the first only reads the forcing
+#                    for the other two (-io-procs 1). The two compute
+#                    processes split the gridlist and have no climate
+#                    or soil files. Also checks that the run stops if
+#                    the I/O process has grid cells in its gridlist.
+#
+# The runs are done in a directory named after the test in the current
+# working directory.
+
+if [ $# -lt 2 ]; then
+    echo "Usage: $0 <guess binary> <test> [<mpirun>]"
+    exit 1
+fi
+
+GUESS=$1
+TEST=$2
+MPIRUN=${3:-mpiexec}
+DATA_DIR=$(cd $(dirname $0) && pwd)
+WORK_DIR=$(pwd)/model_test_$TEST
+
+# Sets up a run directory with the demo and an instruction file
+# run.ins which imports demo.ins followed by the given settings
+setup_run() {
+    local dir=$1
+    shift
+    rm -rf $dir
+    mkdir -p $dir
+    cp $DATA_DIR/demo.ins $DATA_DIR/*.txt $dir/
+    echo 'import "demo.ins"' > $dir/run.ins
+    for setting in "$@"; do
+	echo "$setting" >> $dir/run.ins
+    done
+}
+
+# Runs guess with the demo input in the given directory
+run_guess() {
+    local dir=$1
+    shift
+    (cd $dir && "$@" -input demo run.ins > guess.log 2>&1)
+    if [ $? -ne 0 ]; then
+	echo "Run in $dir failed:"
+	tail -n 20 $dir/guess.log
+	exit 1
+    fi
+}
+
+# Compares all output files in the reference directory with the
+# output files in the other directory (or directories, whose outputs are
+# merged, as with the outputs of the processes in a parallel run).
+# Rows are sorted before they are compared, so the order in which grid
+# cells are written doesn't matter.
+compare_outputs() {
+    local reference=$1
+    shift
+    local failed=0
+    local nfiles=0
+    for file in $reference/*.out; do
+	local name=$(basename $file)
+	local others=""
+	for dir in "$@"; do
+	    others="$others $dir/$name"
+	done
+	if ! cmp -s <(tail -n +2 $file | sort) <(for other in $others; do tail -n +2 $other; done | sort); then
+	    echo "$name differs"
+	    failed=1
+	fi
+	nfiles=$((nfiles+1))
+    done
+    if [ $nfiles -eq 0 ]; then
+	echo "No output files in $reference"
+	exit 1
+    fi
+    if [ $failed -ne 0 ]; then
+	exit 1
+    fi
+    echo "$nfiles output files identical"
+}
+
+case $TEST in
+    dormantfastpath)
+	setup_run $WORK_DIR/fast "ifdormantfastpath 1"
+	setup_run $WORK_DIR/full "ifdormantfastpath 0"
+	run_guess $WORK_DIR/fast $GUESS
+	run_guess $WORK_DIR/full $GUESS
+	compare_outputs $WORK_DIR/full $WORK_DIR/fast
+	;;
+    patchorder)
+	setup_run $WORK_DIR/forward "ifreversepatchorder 0"
+	setup_run $WORK_DIR/reverse "ifreversepatchorder 1"
+	run_guess $WORK_DIR/forward $GUESS
+	run_guess $WORK_DIR/reverse $GUESS
+	compare_outputs $WORK_DIR/forward $WORK_DIR/reverse
+	;;
+    migration)
+	# Allow the test to run as root (as in containers) and with more
+	# processes than cores, which mpiexec of Open MPI refuses by default
+	export OMPI_ALLOW_RUN_AS_ROOT=1 OMPI_ALLOW_RUN_AS_ROOT_CONFIRM=1
+	export OMPI_MCA_rmaps_base_oversubscribe=1
+
+	setup_run $WORK_DIR/serial
+	setup_run $WORK_DIR/parallel/run1
+	setup_run $WORK_DIR/parallel/run2
+	: > $WORK_DIR/parallel/run2/gridlist.txt
+	run_guess $WORK_DIR/serial $GUESS
+	(cd $WORK_DIR/parallel && $MPIRUN -n 2 $GUESS -parallel -migrate -input demo run.ins > guess.log 2>&1)
+	if [ $? -ne 0 ]; then
+	    echo "Parallel run failed:"
+	    tail -n 20 $WORK_DIR/parallel/guess.log
+	    exit 1
+	fi
+	nmigrated=$(cat $WORK_DIR/parallel/guess.log $WORK_DIR/parallel/run*/guess.log | grep -c "migrated to process")
+	if [ $nmigrated -eq 0 ]; then
+	    echo "No grid cell migrated"
+	    exit 1
+	fi
+	echo "$nmigrated grid cells migrated"
+	compare_outputs $WORK_DIR/serial $WORK_DIR/parallel/run1 $WORK_DIR/parallel/run2
+	;;
+    ioforwarding)
+	export OMPI_ALLOW_RUN_AS_ROOT=1 OMPI_ALLOW_RUN_AS_ROOT_CONFIRM=1
+	export OMPI_MCA_rmaps_base_oversubscribe=1
+
+	setup_run $WORK_DIR/serial
+	for run in 1 2 3; do
+	    setup_run $WORK_DIR/parallel/run$run
+	done
+	: > $WORK_DIR/parallel/run1/gridlist.txt
+	head -n 2 $DATA_DIR/gridlist.txt > $WORK_DIR/parallel/run2/gridlist.txt
+	tail -n +3 $DATA_DIR/gridlist.txt > $WORK_DIR/parallel/run3/gridlist.txt
+	for run in 2 3; do
+	    rm $WORK_DIR/parallel/run$run/{temp,prec,sun,soil}.txt
+	done
+	run_guess $WORK_DIR/serial $GUESS
+	(cd $WORK_DIR/parallel && $MPIRUN -n 3 $GUESS -parallel -io-procs 1 -input demo run.ins > guess.log 2>&1)
+	if [ $? -ne 0 ]; then
+	    echo "Parallel run failed:"
+	    tail -n 20 $WORK_DIR/parallel/guess.log
+	    exit 1
+	fi
+	compare_outputs $WORK_DIR/serial $WORK_DIR/parallel/run2 $WORK_DIR/parallel/run3
+
+	# An I/O process with grid cells of its own must stop the run
+	cp $DATA_DIR/gridlist.txt $WORK_DIR/parallel/run1/
+	(cd $WORK_DIR/parallel && $MPIRUN -n 3 $GUESS -parallel -io-procs 1 -input demo run.ins > guess.log 2>&1)
+	if [ $? -eq 0 ] || ! cat $WORK_DIR/parallel/guess.log $WORK_DIR/parallel/run1/guess.log | grep -q "empty gridlist"; then
+	    echo "Parallel run with grid cells in the I/O process's gridlist didn't fail"
+	    exit 1
+	fi
+	;;
+    *)
+	echo "Unknown test: $TEST"
+	exit 1
+	;;
+esac
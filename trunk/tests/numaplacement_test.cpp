@@ -0,0 +1,108 @@
+///////////////////////////////////////////////////////////////////////////////////////
+/// \file numaplacement_test.cpp
+/// \brief Unit tests for the NUMA placement module
+///
+/// $Date$
+///
+///////////////////////////////////////////////////////////////////////////////////////
+
+#include "config.h"
+#include "catch.hpp"
+
+#include "numaplacement.h"
+
+using namespace GuessNuma;
+
+TEST_CASE("numa/cpulist", "Tests for parse_cpulist()") {
+	std::vector<int> cpus;
+
+	REQUIRE(parse_cpulist("0-3,8,10-11", cpus));
+	REQUIRE(cpus.size() == 7);
+	REQUIRE(cpus[0] == 0);
+	REQUIRE(cpus[3] == 3);
+	REQUIRE(cpus[4] == 8);
+	REQUIRE(cpus[6] == 11);
+
+	// Duplicates are removed and the list is sorted
+	REQUIRE(parse_cpulist("4,2-3,3", cpus));
+	REQUIRE(cpus.size() == 3);
+	REQUIRE(cpus[0] == 2);
+
+	REQUIRE(!parse_cpulist("", cpus));
+	REQUIRE(!parse_cpulist("3-1", cpus));
+	REQUIRE(!parse_cpulist("a", cpus));
+	REQUIRE(!parse_cpulist("1-2x", cpus));
+}
+
+TEST_CASE("numa/topology", "Tests for parse_topology()") {
+	Topology topology;
+
+	REQUIRE(parse_topology("0-3;4-7", topology));
+	REQUIRE(topology.node_cpus.size() == 2);
+	REQUIRE(topology.ncpus() == 8);
+	REQUIRE(topology.node_cpus[1][0] == 4);
+
+	REQUIRE(!parse_topology("0-3;", topology));
+}
+
+TEST_CASE("numa/placement", "Tests for compute_placement()") {
+	Topology topology;
+	REQUIRE(parse_topology("0-3;4-7", topology));
+
+	// No placement requested
+	Placement p = compute_placement(topology, NUMA_NONE, 0, 4);
+	REQUIRE(p.node == -1);
+	REQUIRE(p.cpus.empty());
+
+	// Compact fills node 0 first
+	p = compute_placement(topology, NUMA_COMPACT, 3, 8);
+	REQUIRE(p.node == 0);
+	REQUIRE(p.cpus.size() == 1);
+	REQUIRE(p.cpus[0] == 3);
+
+	p = compute_placement(topology, NUMA_COMPACT, 4, 8);
+	REQUIRE(p.node == 1);
+	REQUIRE(p.cpus[0] == 4);
+
+	// Oversubscription wraps around
+	p = compute_placement(topology, NUMA_COMPACT, 9, 10);
+	REQUIRE(p.cpus[0] == 1);
+
+	// Spread alternates between the nodes
+	p = compute_placement(topology, NUMA_SPREAD, 0, 4);
+	REQUIRE(p.node == 0);
+	REQUIRE(p.cpus[0] == 0);
+
+	p = compute_placement(topology, NUMA_SPREAD, 1, 4);
+	REQUIRE(p.node == 1);
+	REQUIRE(p.cpus[0] == 4);
+
+	// ...and spaces the processes on a node evenly over its cores
+	p = compute_placement(topology, NUMA_SPREAD, 3, 4);
+	REQUIRE(p.node == 1);
+	REQUIRE(p.cpus[0] == 6);
+
+	p = compute_placement(topology, NUMA_SPREAD, 3, 8);
+	REQUIRE(p.node == 1);
+	REQUIRE(p.cpus[0] == 5);
+
+	// Oversubscription wraps around on the node
+	p = compute_placement(topology, NUMA_SPREAD, 9, 10);
+	REQUIRE(p.node == 1);
+	REQUIRE(p.cpus[0] == 4);
+
+	// Node binds to the whole node
+	p = compute_placement(topology, NUMA_NODE, 1, 2);
+	REQUIRE(p.node == 1);
+	REQUIRE(p.cpus.size() == 4);
+}
+
+TEST_CASE("numa/policy", "Tests for parse_policy()") {
+	numapolicytype policy;
+
+	REQUIRE(parse_policy("Spread", policy));
+	REQUIRE(policy == NUMA_SPREAD);
+	REQUIRE(std::string(policy_name(policy)) == "spread");
+
+	REQUIRE(!parse_policy("scatter", policy));
+}
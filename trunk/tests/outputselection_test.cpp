@@ -0,0 +1,133 @@
+///////////////////////////////////////////////////////////////////////////////////////
+/// \file outputselection_test.cpp
+/// \brief Unit tests for the selection of output tables and columns
+///
+/// $Date$
+///
+///////////////////////////////////////////////////////////////////////////////////////
+
+#include "config.h"
+#include "catch.hpp"
+
+#include "outputmodule.h"
+#include "guess.h"
+
+using namespace GuessOutput;
+
+namespace {
+
+/// An output channel keeping the last finished row of each table
+class RowChannel : public OutputChannel {
+public:
+	void finish_row(const Table& table, double lon, double lat, int year) {
+		rows.resize(std::max((int)rows.size(), table.id() + 1));
+		rows[table.id()] = get_current_row(table);
+		clear_current_row(table);
+	}
+
+	void finish_row(const Table& table, double lon, double lat, int year, int day) {
+		finish_row(table, lon, lat, year);
+	}
+
+	void close_table(Table& table) {}
+
+	const TableDescriptor& descriptor(const Table& table) const {
+		return get_table_descriptor(table);
+	}
+
+	std::vector<std::vector<double> > rows;
+};
+
+ColumnDescriptors pft_columns() {
+	ColumnDescriptors columns;
+	columns += ColumnDescriptor("BNE", 8, 3);
+	columns += ColumnDescriptor("TeBS", 8, 3);
+	columns += ColumnDescriptor("C3G", 8, 3);
+	columns += ColumnDescriptor("Total", 8, 3);
+	return columns;
+}
+
+}
+
+TEST_CASE("outputselection/columns", "Only the selected columns are kept by the output channel") {
+
+	OutputVariableRegistry& registry = OutputVariableRegistry::get_instance();
+	registry.clear();
+	registry.select("cmass.out:Total,BNE lai.out");
+
+	REQUIRE(registry.table_selected("cmass.out"));
+	REQUIRE(registry.table_selected("lai.out"));
+	REQUIRE(!registry.table_selected("anpp.out"));
+	REQUIRE(!registry.table_selected(""));
+
+	const ColumnDescriptors columns = pft_columns();
+	REQUIRE(registry.selected_columns("lai.out", columns).empty());
+
+	std::vector<bool> selection = registry.selected_columns("cmass.out", columns);
+	REQUIRE(selection.size() == 4);
+	REQUIRE(selection[0]);
+	REQUIRE(!selection[1]);
+	REQUIRE(!selection[2]);
+	REQUIRE(selection[3]);
+
+	RowChannel channel;
+	Table cmass = channel.create_table(TableDescriptor("cmass.out", columns, selection));
+	Table lai = channel.create_table(TableDescriptor("lai.out", columns));
+
+	REQUIRE(channel.descriptor(cmass).columns().size() == 2);
+	REQUIRE(channel.descriptor(cmass).columns()[1].title() == "Total");
+
+	for (int year = 0; year < 2; year++) {
+		OutputRows out(&channel, 0.0, 0.0, year);
+		for (int i = 0; i < 4; i++) {
+			out.add_value(cmass, year * 10 + i);
+			out.add_value(lai, year * 10 + i);
+		}
+	}
+
+	REQUIRE(channel.rows[cmass.id()].size() == 2);
+	REQUIRE(channel.rows[cmass.id()][0] == 10);
+	REQUIRE(channel.rows[cmass.id()][1] == 13);
+	REQUIRE(channel.rows[lai.id()].size() == 4);
+
+	registry.clear();
+}
+
+TEST_CASE("outputselection/computations", "Computations are needed by selected tables and their dependants") {
+
+	OutputVariableRegistry& registry = OutputVariableRegistry::get_instance();
+	registry.clear();
+
+	registry.declare_computation("a", OUTPUT_COST_INDIVIDUAL);
+	registry.declare_computation("b", OUTPUT_COST_PATCH);
+	registry.declare_computation("c", OUTPUT_COST_GRIDCELL);
+	registry.depends("c", "a");
+
+	SECTION("all", "Everything is needed without a selection") {
+		registry.resolve();
+		REQUIRE(registry.needed("a"));
+		REQUIRE(registry.needed("b"));
+		REQUIRE(registry.needed("c"));
+	}
+
+	SECTION("tables", "Only what the selected tables need") {
+		registry.select("x.out");
+		registry.depends(Table(), "b");
+		registry.depends(Table(0), "c");
+		registry.resolve();
+		REQUIRE(registry.needed("a"));
+		REQUIRE(!registry.needed("b"));
+		REQUIRE(registry.needed("c"));
+	}
+
+	SECTION("required", "Required computations are needed without tables") {
+		registry.select("x.out");
+		registry.require("b");
+		registry.resolve();
+		REQUIRE(!registry.needed("a"));
+		REQUIRE(registry.needed("b"));
+		REQUIRE(!registry.needed("c"));
+	}
+
+	registry.clear();
+}
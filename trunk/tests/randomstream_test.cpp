@@ -0,0 +1,150 @@
+///////////////////////////////////////////////////////////////////////////////////////
+/// \file randomstream_test.cpp
+/// \brief Unit tests for the counter-based random streams
+///
+/// $Date$
+///
+///////////////////////////////////////////////////////////////////////////////////////
+
+#include "config.h"
+#include "catch.hpp"
+
+#include "driver.h"
+#include "archive.h"
+
+#include <sstream>
+#include <vector>
+
+namespace {
+
+const int NPATCH = 5;
+const int NDRAW = 100;
+
+RandomStream patch_stream(int patch, RandomProcess process = RANDOM_ESTABLISHMENT) {
+	return RandomStream(12.25, 55.75, 0, patch, 10, 180, process);
+}
+
+/// First numbers drawn by each patch of a grid cell, by stand and patch position
+/** \param reverse Whether to go through the stands and patches backwards */
+std::vector<std::vector<double> > draw_patches(Gridcell& gridcell, bool reverse) {
+
+	const int nstand = gridcell.nbr_stands();
+	std::vector<std::vector<double> > draws(nstand);
+
+	for (int i = 0; i < nstand; i++) {
+		const int s = reverse ? nstand - 1 - i : i;
+		Stand& stand = gridcell[s];
+		draws[s].resize(stand.nobj);
+		for (unsigned int j = 0; j < stand.nobj; j++) {
+			const unsigned int p = reverse ? stand.nobj - 1 - j : j;
+			RandomStream stream(stand[p], RANDOM_MORTALITY);
+			draws[s][p] = randfrac(stream);
+		}
+	}
+	return draws;
+}
+
+/// Copies a grid cell through serialize(), as when it migrates or is restored
+void copy_gridcell(Gridcell& from, Gridcell& to, bool tagged) {
+
+	std::stringstream ss;
+	{
+		ArchiveOutStream arch(ss);
+		arch.set_format(ARCHIVE_VERSION, tagged);
+		from.serialize(arch);
+	}
+	ArchiveInStream arch(ss);
+	arch.set_format(ARCHIVE_VERSION, tagged);
+	to.serialize(arch);
+}
+
+}
+
+TEST_CASE("randomstream/order", "The numbers of a patch don't depend on the order patches draw in") {
+
+	// Each patch draws all its numbers before the next patch
+	std::vector<std::vector<double> > sequential(NPATCH);
+	for (int p = 0; p < NPATCH; p++) {
+		RandomStream stream = patch_stream(p);
+		for (int i = 0; i < NDRAW; i++) {
+			sequential[p].push_back(randfrac(stream));
+		}
+	}
+
+	// Patches in reverse order, taking turns
+	std::vector<RandomStream> streams;
+	for (int p = NPATCH - 1; p >= 0; p--) {
+		streams.push_back(patch_stream(p));
+	}
+	std::vector<std::vector<double> > interleaved(NPATCH);
+	for (int i = 0; i < NDRAW; i++) {
+		for (int s = 0; s < NPATCH; s++) {
+			interleaved[NPATCH - 1 - s].push_back(randfrac(streams[s]));
+		}
+	}
+
+	REQUIRE(sequential == interleaved);
+}
+
+TEST_CASE("randomstream/gridcell", "Patches draw the same numbers whatever their order, and after moving the grid cell") {
+
+	date.init(1);
+	date.year = 10;
+	date.day = 180;
+
+	Gridcell gridcell;
+	gridcell.set_coordinates(12.25, 55.75);
+	gridcell.create_stand(NATURAL, 2);
+	gridcell.create_stand(NATURAL, 3);
+	gridcell.create_stand(NATURAL, 2);
+
+	// A stand removed by land cover change leaves a gap in the stand ids
+	Gridcell::iterator removed = gridcell.begin();
+	++removed;
+	gridcell.delete_stand(++removed);
+
+	const std::vector<std::vector<double> > forward = draw_patches(gridcell, false);
+
+	REQUIRE(draw_patches(gridcell, true) == forward);
+
+	SECTION("migrated", "Grid cell sent to another process") {
+		Gridcell received;
+		received.set_coordinates(12.25, 55.75);
+		copy_gridcell(gridcell, received, false);
+		REQUIRE(draw_patches(received, false) == forward);
+
+		// A stand created later gets the same id as in the original grid cell
+		REQUIRE(received.create_stand(NATURAL, 1).id == gridcell.create_stand(NATURAL, 1).id);
+	}
+
+	SECTION("restored", "Grid cell read from a state file") {
+		Gridcell restored;
+		restored.set_coordinates(12.25, 55.75);
+		copy_gridcell(gridcell, restored, true);
+		REQUIRE(draw_patches(restored, false) == forward);
+	}
+}
+
+TEST_CASE("randomstream/keys", "Different keys give different numbers in the range 0-1") {
+
+	RandomStream a = patch_stream(0);
+	RandomStream b = patch_stream(1);
+	RandomStream c = patch_stream(0, RANDOM_MORTALITY);
+	RandomStream d(12.25, 55.75, 0, 0, 10, 181, RANDOM_ESTABLISHMENT);
+
+	double sum = 0;
+	int same = 0;
+	for (int i = 0; i < NDRAW; i++) {
+		const double x = a.randfrac();
+		REQUIRE(x > 0);
+		REQUIRE(x < 1);
+		sum += x;
+		if (x == b.randfrac() || x == c.randfrac() || x == d.randfrac()) {
+			same++;
+		}
+	}
+	const double mean = sum / NDRAW;
+	REQUIRE(same == 0);
+	REQUIRE(mean > 0.4);
+	REQUIRE(mean < 0.6);
+}
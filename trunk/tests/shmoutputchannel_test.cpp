@@ -0,0 +1,208 @@
+///////////////////////////////////////////////////////////////////////////////////////
+/// \file shmoutputchannel_test.cpp
+/// \brief Unit tests for the shared memory output channel
+///
+/// $Date$
+///
+///////////////////////////////////////////////////////////////////////////////////////
+
+#include "config.h"
+#include "catch.hpp"
+
+#ifndef _WIN32
+
+#include "shmoutputchannel.h"
+#include "guess.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+using namespace GuessOutput;
+
+namespace {
+
+std::string read_file(const std::string& path) {
+	std::string content;
+	FILE* f = fopen(path.c_str(), "r");
+	if (f) {
+		char buf[1024];
+		size_t n;
+		while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+			content.append(buf, n);
+		}
+		fclose(f);
+	}
+	return content;
+}
+
+/// Reads all available records, appending the text of each table as a consumer would
+void consume(ShmOutputReader& reader, std::vector<std::string>& text) {
+	int type;
+	while ((type = reader.next()) != -1) {
+		const int table = reader.table();
+		if (type == SHM_SCHEMA) {
+			text.resize(std::max((int)text.size(), table + 1));
+		}
+		else if (type == SHM_ROW) {
+			if (text[table].empty()) {
+				text[table] = reader.format_header(table, reader.row().day >= 0);
+			}
+			text[table] += reader.format_row();
+		}
+	}
+}
+
+std::string shm_name() {
+	xtring name;
+	name.printf("/guess_test_%d", (int)getpid());
+	return (char*)name;
+}
+
+}
+
+TEST_CASE("shmoutput/files", "The stream has the same content as the output files") {
+
+	char dir_template[] = "/tmp/guess_shm_test_XXXXXX";
+	REQUIRE(mkdtemp(dir_template) != NULL);
+	const std::string dir = std::string(dir_template) + "/";
+
+	// A small buffer so records have to wrap around, the rows are
+	// read as they are written
+	const std::string name = shm_name();
+	ShmOutputChannel* channel = new ShmOutputChannel(name.c_str(), 2048, true, 2,
+	                                                 new FileOutputChannel(dir.c_str(), 2));
+
+	ShmRingBuffer ring;
+	REQUIRE(ring.attach(name.c_str()));
+	ShmOutputReader reader(ring);
+	std::vector<std::string> text;
+
+	ColumnDescriptors annual_columns;
+	annual_columns += ColumnDescriptor("Total", 8, 3);
+	annual_columns += ColumnDescriptor("VeryLongTitle", 10, 1);
+
+	ColumnDescriptors daily_columns;
+	daily_columns += ColumnDescriptor("Flux", 12, 5);
+
+	Table unused = channel->create_table(TableDescriptor("", annual_columns));
+	Table annual = channel->create_table(TableDescriptor("annual.out", annual_columns));
+	Table daily = channel->create_table(TableDescriptor("daily.out", daily_columns));
+
+	REQUIRE(unused.invalid());
+
+	for (int year = 0; year < 10; year++) {
+		{
+			OutputRows out(channel, 12.25, -55.75, year);
+			out.add_value(annual, year * 1.0005);
+			out.add_value(annual, -1e12 * year);
+			out.add_value(unused, 1.0);
+		}
+		consume(reader, text);
+
+		for (int day = 0; day < 20; day++) {
+			{
+				OutputRows out(channel, 12.25, -55.75, year, day);
+				out.add_value(daily, 1.0 / (day + 1));
+			}
+			consume(reader, text);
+		}
+	}
+
+	REQUIRE(ring.dropped() == 0);
+
+	const std::string annual_file = read_file(dir + "annual.out");
+	const std::string daily_file = read_file(dir + "daily.out");
+
+	REQUIRE(!annual_file.empty());
+	REQUIRE(text.size() == 2);
+	REQUIRE(reader.schema(annual.id()).name == "annual.out");
+	REQUIRE(text[annual.id()] == annual_file);
+	REQUIRE(text[daily.id()] == daily_file);
+
+	delete channel;
+
+	REQUIRE(reader.next() == SHM_END);
+	REQUIRE(ring.finished());
+
+	remove((dir + "annual.out").c_str());
+	remove((dir + "daily.out").c_str());
+	rmdir(dir_template);
+}
+
+TEST_CASE("shmoutput/drop", "Rows are dropped when the buffer is full") {
+
+	const std::string name = shm_name();
+	ShmOutputChannel* channel = new ShmOutputChannel(name.c_str(), 1024, true, 2, NULL);
+
+	ShmRingBuffer ring;
+	REQUIRE(ring.attach(name.c_str()));
+	ShmOutputReader reader(ring);
+
+	ColumnDescriptors columns;
+	columns += ColumnDescriptor("Value", 8, 1);
+	Table table = channel->create_table(TableDescriptor("values.out", columns));
+
+	// Nothing is read while writing, so the buffer fills up
+	const int NROWS = 100;
+	for (int year = 0; year < NROWS; year++) {
+		OutputRows out(channel, 0.0, 0.0, year);
+		out.add_value(table, year);
+	}
+
+	REQUIRE(ring.dropped() > 0);
+
+	REQUIRE(reader.next() == SHM_SCHEMA);
+
+	// The rows that fitted come first and in order
+	int nrows = 0;
+	while (reader.next() == SHM_ROW) {
+		REQUIRE(reader.row().year == nrows);
+		REQUIRE(reader.values()[0] == nrows);
+		nrows++;
+	}
+	const int nsent = nrows + (int)ring.dropped();
+	REQUIRE(nsent == NROWS);
+
+	delete channel;
+
+	REQUIRE(reader.next() == SHM_END);
+}
+
+TEST_CASE("shmoutput/noconsumer", "A full buffer nobody reads doesn't hang the model when dropping") {
+
+	const std::string name = shm_name();
+	ShmOutputChannel* channel = new ShmOutputChannel(name.c_str(), 1024, true, 2, NULL);
+
+	// Attached, but never reading until the model is done
+	ShmRingBuffer ring;
+	REQUIRE(ring.attach(name.c_str()));
+	ShmOutputReader reader(ring);
+
+	ColumnDescriptors columns;
+	columns += ColumnDescriptor("Value", 8, 1);
+	Table table = channel->create_table(TableDescriptor("values.out", columns));
+
+	const int NROWS = 100;
+	for (int year = 0; year < NROWS; year++) {
+		OutputRows out(channel, 0.0, 0.0, year);
+		out.add_value(table, year);
+	}
+
+	// Neither closing the table nor ending the output may wait forever
+	channel->close_table(table);
+	delete channel;
+
+	// Every row and the close and end records were either written or dropped
+	REQUIRE(reader.next() == SHM_SCHEMA);
+	int nrecords = 0;
+	while (reader.next() != -1) {
+		nrecords++;
+	}
+	REQUIRE(ring.dropped() > 0);
+	const int nsent = nrecords + (int)ring.dropped();
+	REQUIRE(nsent == NROWS + 2);
+	REQUIRE(ring.finished());
+}
+
+#endif // !_WIN32
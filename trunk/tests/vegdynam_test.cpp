@@ -0,0 +1,123 @@
+///////////////////////////////////////////////////////////////////////////////////////
+/// \file vegdynam_test.cpp
+/// \brief Unit tests for the merging of similar cohorts
+///
+/// $Date$
+///
+///////////////////////////////////////////////////////////////////////////////////////
+
+#include "config.h"
+#include "catch.hpp"
+
+#include "vegdynam.h"
+#include "growth.h"
+
+namespace {
+
+/// A tree PFT with the allometry parameters of a temperate broadleaved tree
+void init_pft(Pft& pft) {
+	pft.lifeform = TREE;
+	pft.landcover = NATURAL;
+	pft.sla = 20.0;
+	pft.k_latosa = 6000.0;
+	pft.wooddens = 200.0;
+	pft.k_allom1 = 250.0;
+	pft.k_allom2 = 60.0;
+	pft.k_allom3 = 0.67;
+	pft.k_rp = 1.6;
+	pft.crownarea_max = 50.0;
+}
+
+/// Adds a cohort to the vegetation, with its pools scaled by size
+Individual& add_cohort(Vegetation& vegetation, Pft& pft, double size) {
+
+	Individual& indiv = vegetation.createobj(pft, vegetation);
+	indiv.alive = true;
+	indiv.age = 20;
+	indiv.densindiv = 0.05;
+
+	indiv.cmass_leaf = 0.2 * size;
+	indiv.cmass_root = 0.2 * size;
+	indiv.cmass_sap = 2.0 * size;
+	indiv.cmass_heart = 3.0 * size;
+	indiv.nmass_leaf = 0.004 * size;
+	indiv.nmass_root = 0.003 * size;
+	indiv.nmass_sap = 0.006 * size;
+	indiv.nmass_heart = 0.009 * size;
+	indiv.nstore_labile = 0.001 * size;
+	indiv.nstore_longterm = 0.002 * size;
+
+	// As at the start of growth()
+	indiv.cmass_veg = indiv.cmass_leaf + indiv.cmass_root + indiv.cmass_wood();
+	indiv.nmass_veg = indiv.nmass_leaf + indiv.nmass_root + indiv.nmass_wood();
+
+	allometry(indiv);
+	return indiv;
+}
+
+/// C, N and vegetation C and N of the vegetation in a patch
+void totals(Vegetation& vegetation, double& c, double& n, double& cveg, double& nveg) {
+
+	Individual::invalidate_all_day_caches();
+
+	c = n = cveg = nveg = 0.0;
+	for (unsigned int i = 0; i < vegetation.nobj; i++) {
+		const Individual& indiv = vegetation[i];
+		c += indiv.ccont();
+		n += indiv.ncont();
+		cveg += indiv.cmass_veg;
+		nveg += indiv.nmass_veg;
+	}
+}
+
+}
+
+TEST_CASE("vegdynam/merge", "Merging cohorts conserves C and N") {
+
+	date.init(1);
+
+	init_pft(pftlist.createobj());
+
+	const bool old_ifmergecohorts = ifmergecohorts;
+	const double old_tols[] = { merge_height_tol, merge_dbh_tol, merge_biomass_tol };
+	const int old_max_indiv = max_indiv_per_patch;
+	ifmergecohorts = true;
+	merge_height_tol = merge_dbh_tol = merge_biomass_tol = 0.1;
+	max_indiv_per_patch = 0;
+
+	{
+		Gridcell gridcell;
+		Stand& stand = gridcell.create_stand(NATURAL, 1);
+		Patch& patch = stand[0];
+		Vegetation& vegetation = patch.vegetation;
+		Pft& pft = pftlist[0];
+
+		add_cohort(vegetation, pft, 1.0);
+		add_cohort(vegetation, pft, 1.02);
+		// Too large to merge with the others
+		add_cohort(vegetation, pft, 3.0);
+
+		double c, n, cveg, nveg;
+		totals(vegetation, c, n, cveg, nveg);
+
+		merge_cohorts(patch);
+
+		REQUIRE(vegetation.nobj == 2);
+		REQUIRE(patch.pft[pft.id].cohort_merges == 1);
+
+		double c_merged, n_merged, cveg_merged, nveg_merged;
+		totals(vegetation, c_merged, n_merged, cveg_merged, nveg_merged);
+
+		REQUIRE(c_merged == Approx(c));
+		REQUIRE(n_merged == Approx(n));
+		REQUIRE(cveg_merged == Approx(cveg));
+		REQUIRE(nveg_merged == Approx(nveg));
+	}
+
+	pftlist.killall();
+	ifmergecohorts = old_ifmergecohorts;
+	merge_height_tol = old_tols[0];
+	merge_dbh_tol = old_tols[1];
+	merge_biomass_tol = old_tols[2];
+	max_indiv_per_patch = old_max_indiv;
+}